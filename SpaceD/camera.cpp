@@ -143,7 +143,7 @@ bool Camera::isVisible(const Model& model)
 
 	for (const auto& plane: _frustum._planes)
 	{
-		if (XMVectorGetX(XMPlaneDotCoord(plane, posVec)) < -model.GetBiggestDimensionRad())
+		if (XMVectorGetX(XMPlaneDotCoord(plane, posVec)) < -model.GetBoundingSphereRadius())
 		{
 			return false;
 		}
@@ -173,6 +173,16 @@ const XMMATRIX& Camera::GetProjectionMatrix() const
 	return _projMatrix;	
 }
 
+FLOAT Camera::GetZNear() const
+{
+	return DEFAULT_ZNEAR;
+}
+
+FLOAT Camera::GetZFar() const
+{
+	return DEFAULT_ZFAR;
+}
+
 const XMFLOAT3& Camera::GetPos() const
 {
 	return _pos;
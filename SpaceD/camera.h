@@ -40,6 +40,9 @@ public:
 	const XMMATRIX& GetProjectionMatrix() const;
 	const math::Frustum& GetFrustum() const;
 
+	FLOAT GetZNear() const;
+	FLOAT GetZFar() const;
+
 	const XMFLOAT3& GetPos() const;
 
 private:
@@ -8,8 +8,12 @@
 #include "inputhandler.h"
 #include "camera.h"
 #include "scene.h"
+#include "rendering/assetpreloader.h"
 #include "rendering/objloader.h"
+#include "rendering/d3d11renderdevice.h"
 #include "rendering/renderer.h"
+#include "rendering/softwarerenderdevice.h"
+#include "rendering/textureloader.h"
 #include "rendering/models/model.h"
 #include "gameentities/playershipgameentity.h"
 #include "gameentities/trainingbotgameentity.h"
@@ -19,8 +23,12 @@
 #include "util/debug/debugprompt.h"
 
 // Remote Headers
-#include <sstream>
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <vector>
 #include <Psapi.h>
 
 namespace
@@ -28,13 +36,19 @@ namespace
 	Game* game = 0;
 }
 
+const std::string Game::HEADLESS_OUTPUT_DIRECTORY = "../output/";
+const std::string Game::HEADLESS_REFERENCE_PATH = "../headless_reference.txt";
+const FLOAT Game::HEADLESS_FRAME_TIME = 1.0f / 60.0f;
+const std::string Game::STARTUP_ASSET_MANIFEST_PATH = "../res/startup_assets.txt";
+
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
 	return game->MsgProc(hwnd, msg, wParam, lParam);
 }
 
-Game::Game(HINSTANCE hInstance, const LPCSTR clientName, const int clientWidth, const int clientHeight)
-	: _debugMode(false)
+Game::Game(HINSTANCE hInstance, const LPCSTR clientName, const int clientWidth, const int clientHeight, const RenderMode renderMode)
+	: _softwareRenderDevice(nullptr)
+	, _debugMode(false)
 	, _paused(false)
 	, _minimized(false)
 	, _maximized(false)
@@ -44,9 +58,40 @@ Game::Game(HINSTANCE hInstance, const LPCSTR clientName, const int clientWidth,
 	// be members of a class)
 	game = this;
 
+	// The software device can only read back RGBA textures. Decided before any texture is requested.
+	if (renderMode == RenderMode::HEADLESS)
+	{
+		TextureLoader::Get().SetCompressedTexturesEnabled(false);
+	}
+
+	// Everything the last session loaded starts reading on worker threads while the window, device and shaders are created
+	_assetPreloader = std::make_unique<AssetPreloader>(STARTUP_ASSET_MANIFEST_PATH);
+	_assetPreloader->Start();
+
 	_gameTimer    = std::make_unique<GameTimer>();
 	_clientWindow = std::make_unique<ClientWindow>(hInstance, WndProc, clientName, clientWidth, clientHeight);
-	_renderer     = std::make_unique<Renderer>(*_clientWindow);
+
+	switch (renderMode)
+	{
+		case RenderMode::IMMEDIATE:
+		{
+			_renderer = std::make_unique<Renderer>(*_clientWindow);
+		} break;
+
+		case RenderMode::DEFERRED_CONTEXTS:
+		{
+			_renderer = std::make_unique<Renderer>(*_clientWindow, std::make_unique<D3D11RenderDevice>(*_clientWindow, true));
+		} break;
+
+		case RenderMode::HEADLESS:
+		{
+			CreateDirectory(HEADLESS_OUTPUT_DIRECTORY.c_str(), 0);
+			auto softwareRenderDevice = std::make_unique<SoftwareRenderDevice>(clientWidth, clientHeight, HEADLESS_OUTPUT_DIRECTORY);
+			_softwareRenderDevice = softwareRenderDevice.get();
+			_renderer = std::make_unique<Renderer>(*_clientWindow, std::move(softwareRenderDevice));
+		} break;
+	}
+
 	_inputHandler = std::make_unique<InputHandler>(*_clientWindow);
 	_scene        = std::make_unique<Scene>(*_renderer, _camera, *_inputHandler, *_clientWindow);
 	_debugPrompt  = std::make_unique<DebugPrompt>(*_renderer, *_scene, *_inputHandler);
@@ -64,10 +109,13 @@ Game::Game(HINSTANCE hInstance, const LPCSTR clientName, const int clientWidth,
 
 	_scene->InsertDirectionalLight(dirLight2);
 
+	_assetPreloader->Finish(_renderer->GetDevice());
 }
 
 Game::~Game()
 {
+	// Assets loaded during play, such as projectiles, are preloaded from the next startup on as well
+	_assetPreloader->WriteManifest();
 }
 
 void Game::Run()
@@ -109,6 +157,30 @@ void Game::Run()
 	}
 }
 
+bool Game::RunHeadless(const UINT frameCount, const bool updateReference)
+{
+	MSG msg = {};
+
+	// Frames are captured, so they must not depend on how far the texture loads got
+	TextureLoader::Get().WaitForPendingTextures(_renderer->GetDevice());
+
+	for (auto frame = 0U; frame < frameCount && msg.message != WM_QUIT; ++frame)
+	{
+		// Messages are still pumped so the window stays responsive, but activation and input do not affect the run
+		while (PeekMessage(&msg, 0, 0, 0, PM_REMOVE))
+		{
+			TranslateMessage(&msg);
+			DispatchMessage(&msg);
+		}
+
+		Update(HEADLESS_FRAME_TIME);
+		Render();
+		_inputHandler->OnFrameEnd();
+	}
+
+	return CheckHeadlessReference(updateReference);
+}
+
 LRESULT Game::MsgProc(HWND handle, UINT msg, WPARAM wParam, LPARAM lParam)
 {
 	switch (msg)
@@ -298,6 +370,8 @@ void Game::Update(const FLOAT deltaTime)
 
 void Game::Render()
 {
+	TextureLoader::Get().CreateDecodedTextures(_renderer->GetDevice());
+
 	_renderer->ClearViews();
 	_scene->Render();
 
@@ -338,11 +412,63 @@ void Game::CalculateFrameStats()
 		outs << "    "
 			<< "FPS: " << fps << "    "
 			<< "Frame Time: " << mspf << " (ms)   "
-		    << "Mem Usage: " << mem << " (MB)";
+		    << "Mem Usage: " << mem << " (MB)   "
+			<< "Draws: " << _renderer->GetLastFrameStats()._drawCount << "   "
+			<< "Uploads: " << _renderer->GetLastFrameStats()._bytesUploaded / 1024.0f << " (KB/frame)";
 		_clientWindow->UpdateCaption(outs.str());		
 
 		// Reset for next average.
 		frameCnt = 0;
 		timeElapsed += 1.0f;
 	}
+}
+
+bool Game::CheckHeadlessReference(const bool updateReference) const
+{
+	const auto& frameChecksums = _softwareRenderDevice->GetFrameChecksums();
+
+	std::ifstream referenceStream(HEADLESS_REFERENCE_PATH);
+	if (updateReference || !referenceStream.is_open())
+	{
+		referenceStream.close();
+		std::ofstream newReferenceStream(HEADLESS_REFERENCE_PATH);
+		newReferenceStream << std::hex;
+		for (const auto frameChecksum: frameChecksums)
+		{
+			newReferenceStream << frameChecksum << "\n";
+		}
+
+		const auto recorded = newReferenceStream.good();
+		OutputDebugString(((recorded ? "Recorded " : "Could not record ") + std::to_string(frameChecksums.size()) + " headless reference frames in " + HEADLESS_REFERENCE_PATH + "\n").c_str());
+		return recorded;
+	}
+
+	std::vector<std::uint64_t> referenceChecksums;
+	std::uint64_t referenceChecksum;
+	while (referenceStream >> std::hex >> referenceChecksum)
+	{
+		referenceChecksums.push_back(referenceChecksum);
+	}
+
+	// Every rendered frame needs a reference, but a run shorter than the recorded one checks just the frames it has
+	auto mismatchCount = 0U;
+	const auto checkedFrameCount = (std::min)(frameChecksums.size(), referenceChecksums.size());
+	for (auto frame = 0U; frame < checkedFrameCount; ++frame)
+	{
+		if (frameChecksums[frame] != referenceChecksums[frame])
+		{
+			std::ostringstream mismatchStream;
+			mismatchStream << "Headless frame " << frame << " differs from the reference: checksum " << std::hex << frameChecksums[frame] << ", expected " << referenceChecksums[frame] << "\n";
+			OutputDebugString(mismatchStream.str().c_str());
+			mismatchCount++;
+		}
+	}
+
+	const auto passed = mismatchCount == 0 && checkedFrameCount == frameChecksums.size();
+
+	std::ostringstream reportStream;
+	reportStream << "Headless reference check " << (passed ? "PASSED" : "FAILED") << ": " << mismatchCount << " of " << checkedFrameCount << " frames differ, " 
+	             << frameChecksums.size() - checkedFrameCount << " rendered frames have no reference (" << HEADLESS_REFERENCE_PATH << ", rerun with -updatereference to replace it)\n";
+	OutputDebugString(reportStream.str().c_str());
+	return passed;
 }
\ No newline at end of file
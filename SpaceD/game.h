@@ -10,6 +10,7 @@
 
 // Remote Headers
 #include <memory>
+#include <string>
 #include <Windows.h>
 #include <Windowsx.h>
 
@@ -22,14 +23,29 @@ class Renderer;
 class Camera;
 class Scene;
 class DebugPrompt;
+class AssetPreloader;
+class SoftwareRenderDevice;
 
 class Game final
 {
 public:
-	Game(HINSTANCE hInstance, const LPCSTR clientName, const int clientWidth, const int clientHeight);
+	enum class RenderMode
+	{
+		IMMEDIATE,          // D3D11, all commands recorded on the immediate context
+		DEFERRED_CONTEXTS,  // D3D11, commands recorded on deferred contexts by worker threads
+		HEADLESS            // Software render device, every frame is written to HEADLESS_OUTPUT_DIRECTORY
+	};
+
+public:
+	Game(HINSTANCE hInstance, const LPCSTR clientName, const int clientWidth, const int clientHeight, const RenderMode renderMode = RenderMode::IMMEDIATE);
 	~Game();
 
 	void Run();
+
+	// Simulates and renders a fixed number of frames at a fixed time step, independent of wall clock time, and checks
+	// them against the reference frame checksums. Without a reference, or with updateReference, the frames become it.
+	// False when a frame differs from its reference or the reference could not be written.
+	bool RunHeadless(const UINT frameCount, const bool updateReference);
 	
 	LRESULT MsgProc(HWND handle, UINT msg, WPARAM wParam, LPARAM lParam);
 
@@ -38,12 +54,21 @@ private:
 	void Update(const FLOAT deltaTime);
 	void Render();
 	void CalculateFrameStats();
+	bool CheckHeadlessReference(const bool updateReference) const;
+
+private:
+	static const std::string HEADLESS_OUTPUT_DIRECTORY;
+	static const std::string HEADLESS_REFERENCE_PATH;
+	static const FLOAT HEADLESS_FRAME_TIME;
+	static const std::string STARTUP_ASSET_MANIFEST_PATH;
 
 private:
+	std::unique_ptr<AssetPreloader> _assetPreloader;
 	std::unique_ptr<InputHandler> _inputHandler;
     std::unique_ptr<ClientWindow> _clientWindow;
 	std::unique_ptr<GameTimer> _gameTimer;
 	std::unique_ptr<Renderer> _renderer;		
+	SoftwareRenderDevice* _softwareRenderDevice;  // Owned by _renderer, null unless headless
 	std::unique_ptr<Scene> _scene;
 	std::unique_ptr<DebugPrompt> _debugPrompt;
 	std::shared_ptr<GameEntity> _ship;	
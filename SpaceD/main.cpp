@@ -4,12 +4,879 @@
 /********************************************************************/
 
 // Local Headers
+#include "camera.h"
 #include "game.h"
+#include "inputhandler.h"
+#include "scene.h"
+#include "gameentities/trainingbotgameentity.h"
+#include "rendering/clusteredlightgrid.h"
+#include "rendering/meshfile.h"
+#include "rendering/models/model.h"
+#include "rendering/objloader.h"
+#include "rendering/recordingrenderdevice.h"
+#include "rendering/renderer.h"
+#include "rendering/softwarerenderdevice.h"
+#include "rendering/textureloader.h"
+#include "rendering/vertexpacking.h"
+#include "rendering/shaders/default3dwithlightingshader.h"
+#include "rendering/shaders/defaultuishader.h"
+#include "util/assetpack.h"
+#include "util/clientwindow.h"
+#include "util/mappedfile.h"
+#include "util/objparser.h"
+#include "util/pngreader.h"
+#include "util/stringutils.h"
+#include "util/textureatlas.h"
+#include "util/texturebuilder.h"
+#include "util/threadpool.h"
+#include "util/virtualfilesystem.h"
+#include "util/workpartitioner.h"
 
 // Remote Headers
 #include <vld.h>
 #include <Windows.h>
 #include <Windowsx.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const UINT DEFAULT_HEADLESS_FRAME_COUNT = 60U;
+static const UINT PNG_BENCHMARK_ITERATIONS = 10U;
+static const UINT OBJ_BENCHMARK_ITERATIONS = 5U;
+static const UINT OBJ_BENCHMARK_SPHERE_SEGMENTS = 256U;
+static const UINT PARTITIONER_CHECK_ITERATIONS = 1000U;
+static const UINT CULL_BENCHMARK_ENTITY_COUNT = 1000U;
+static const UINT CULL_BENCHMARK_ITERATIONS = 200U;
+static const UINT LIGHT_GRID_BENCHMARK_LIGHT_COUNT = 384U;
+static const UINT LIGHT_GRID_BENCHMARK_LIGHT_SETS = 10U;
+static const UINT LIGHT_GRID_BENCHMARK_ITERATIONS = 50U;
+static const UINT VERTEX_PACKING_CHECK_SEAM_STEPS = 256U;
+static const UINT VERTEX_PACKING_CHECK_RANDOM_NORMALS = 100000U;
+static const int OFFLINE_SCENE_WIDTH = 800;
+static const int OFFLINE_SCENE_HEIGHT = 900;
+static const std::string MODEL_DIRECTORY_PATH = "../res/models/";
+static const std::string ASSET_DIRECTORY_PATH = "../res/";
+static const std::string ASSET_PACK_PATH = "../res.pak";
+
+// Shaders are compiled from their loose sources along with their includes and cached next to them, and the startup 
+// asset manifest is rewritten every session, so neither is packed
+static const char* UNPACKED_ASSET_PREFIXES[] = { "shaders/", "startup_assets.txt" };
+
+// Game entity models share atlases so that they can be drawn without switching textures. The background scrolls
+// its texcoords and the scene cell swaps its texture at runtime, so those two keep textures of their own.
+static const char* ATLASED_MODEL_NAMES[] = { "enemy_training_bot", "projectile_dps_basic", "ship_dps", "ship_tank" };
+
+// Every file with the given extension shipped in the asset directories, where each asset lives in a directory of its own
+static std::vector<std::string> FindShippedAssets(const std::vector<std::string>& assetRootDirectories, const std::string& extension)
+{
+	std::vector<std::string> assetPaths;
+	for (const auto& assetRootDirectory: assetRootDirectories)
+	{
+		WIN32_FIND_DATA assetDirectoryData;
+		auto assetDirectoryHandle = FindFirstFile((assetRootDirectory + "*").c_str(), &assetDirectoryData);
+		if (assetDirectoryHandle == INVALID_HANDLE_VALUE)
+		{
+			continue;
+		}
+
+		do
+		{
+			const std::string assetDirectoryName = assetDirectoryData.cFileName;
+			if ((assetDirectoryData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0 || assetDirectoryName == "." || assetDirectoryName == "..")
+			{
+				continue;
+			}
+
+			const auto assetDirectory = assetRootDirectory + assetDirectoryName + "/";
+			WIN32_FIND_DATA assetData;
+			auto assetHandle = FindFirstFile((assetDirectory + "*" + extension).c_str(), &assetData);
+			if (assetHandle == INVALID_HANDLE_VALUE)
+			{
+				continue;
+			}
+
+			do
+			{
+				assetPaths.push_back(assetDirectory + assetData.cFileName);
+			} while (FindNextFile(assetHandle, &assetData));
+			FindClose(assetHandle);
+
+		} while (FindNextFile(assetDirectoryHandle, &assetDirectoryData));
+		FindClose(assetDirectoryHandle);
+	}
+
+	return assetPaths;
+}
+
+// Every PNG shipped under res/models and res/fonts
+static std::vector<std::string> FindShippedTextures()
+{
+	return FindShippedAssets({ MODEL_DIRECTORY_PATH, "../res/fonts/" }, ".png");
+}
+
+// Window, renderer and scene for the command line modes that drive a Scene directly instead of running the game
+struct OfflineScene
+{
+	OfflineScene(HINSTANCE hInstance, std::unique_ptr<RenderDevice> renderDevice)
+		: _window(hInstance, DefWindowProc, "Space-D", OFFLINE_SCENE_WIDTH, OFFLINE_SCENE_HEIGHT)
+		, _renderer(_window, std::move(renderDevice))
+		, _inputHandler(_window)
+		, _scene(_renderer, _camera, _inputHandler, _window)
+	{
+	}
+
+	ClientWindow _window;
+	Renderer _renderer;
+	Camera _camera;
+	InputHandler _inputHandler;
+	Scene _scene;
+};
+
+// Renders a scripted scene through a RecordingRenderDevice and checks the draws, state changes and uploaded bytes of 
+// its frame against the counts the script implies. The default camera looks straight down on the origin from 90 units 
+// up, so the bots placed around the origin are in view and the ones along the grid's left edge are not. Resources 
+// are created on the WARP device of a SoftwareRenderDevice behind the recording one, which writes no frames.
+static bool RunRenderRecordingCheck(HINSTANCE hInstance)
+{
+	const XMFLOAT3 visibleBotPositions[] = 
+	{ 
+		XMFLOAT3(-8.0f, 0.0f, -13.0f), XMFLOAT3(8.0f, 0.0f, -13.0f), XMFLOAT3(0.0f, 0.0f, -5.0f), XMFLOAT3(-8.0f, 0.0f, 3.0f), XMFLOAT3(8.0f, 0.0f, 3.0f) 
+	};
+	const XMFLOAT3 hiddenBotPositions[] = 
+	{ 
+		XMFLOAT3(-50.0f, 0.0f, -50.0f), XMFLOAT3(-50.0f, 0.0f, -35.0f), XMFLOAT3(-50.0f, 0.0f, -20.0f), XMFLOAT3(-50.0f, 0.0f, 20.0f), XMFLOAT3(-50.0f, 0.0f, 35.0f) 
+	};
+
+	// The software device only reads back RGBA textures
+	TextureLoader::Get().SetCompressedTexturesEnabled(false);
+
+	auto recordingDevice = std::make_unique<RecordingRenderDevice>(std::make_unique<SoftwareRenderDevice>(OFFLINE_SCENE_WIDTH, OFFLINE_SCENE_HEIGHT, std::string()));
+	auto& recording = *recordingDevice;
+	OfflineScene offlineScene(hInstance, std::move(recordingDevice));
+
+	for (const auto& position: visibleBotPositions)
+	{
+		offlineScene._scene.InsertEntity(std::make_shared<TrainingBotGameEntity>(offlineScene._scene, offlineScene._renderer, position));
+	}
+
+	for (const auto& position: hiddenBotPositions)
+	{
+		offlineScene._scene.InsertEntity(std::make_shared<TrainingBotGameEntity>(offlineScene._scene, offlineScene._renderer, position));
+	}
+
+	auto directionalLight = std::make_shared<DirectionalLight>();
+	directionalLight->_direction = XMFLOAT3(0.0f, -0.8f, 0.0f);
+	offlineScene._scene.InsertDirectionalLight(directionalLight);
+
+	offlineScene._camera.Update(offlineScene._window);
+	TextureLoader::Get().WaitForPendingTextures(offlineScene._renderer.GetDevice());
+
+	// The first frame starts from the device's initial state; the second is the steady state every later frame repeats
+	for (auto frame = 0U; frame < 2U; ++frame)
+	{
+		recording.ClearCommands();
+		offlineScene._renderer.ClearViews();
+		offlineScene._scene.Render();
+		offlineScene._renderer.Present();
+	}
+
+	const auto visibleBotCount = static_cast<UINT>(sizeof(visibleBotPositions) / sizeof(visibleBotPositions[0]));
+
+	// The scrolling background with the UI shader, then every bot in view with the lighting shader. Depth testing is 
+	// switched off and back on around the background, and each shader is bound once.
+	const auto expectedDrawCount = 1U + visibleBotCount;
+	const auto expectedStateChangeCount = 4U;
+	const auto expectedBytesUploaded = static_cast<UINT>(sizeof(DefaultUiShader::ConstantBuffer) + 
+	                                                     sizeof(Default3dWithLightingShader::PerFrameConstantBuffer) + 
+	                                                     sizeof(ClusteredLightGrid::ClusterLightRange) * ClusteredLightGrid::CLUSTER_COUNT +
+	                                                     sizeof(Default3dWithLightingShader::ConstantBuffer) * visibleBotCount);
+
+	auto uiDrawCount = 0U;
+	auto lightingDrawCount = 0U;
+	auto textDrawCount = 0U;
+	for (const auto& command: recording.GetCommands())
+	{
+		if (command._type == RecordingRenderDevice::CommandType::DRAW_MODEL && command._argument == shader_type::DEFAULT_UI) uiDrawCount++;
+		if (command._type == RecordingRenderDevice::CommandType::DRAW_MODEL && command._argument == shader_type::DEFAULT_3D_WITH_LIGHTING) lightingDrawCount++;
+		if (command._type == RecordingRenderDevice::CommandType::DRAW_TEXT) textDrawCount++;
+	}
+
+	const auto& frameStats = recording.GetLastFrameStats();
+	const auto passed = frameStats._drawCount == expectedDrawCount && frameStats._stateChangeCount == expectedStateChangeCount && 
+	                    frameStats._bytesUploaded == expectedBytesUploaded && uiDrawCount == 1U && lightingDrawCount == visibleBotCount && textDrawCount == 0U;
+
+	std::stringstream reportStream;
+	reportStream << (passed ? "PASSED" : "FAILED") << "\n"
+	             << "Draws: " << frameStats._drawCount << " (expected " << expectedDrawCount << ", " << uiDrawCount << " UI, " << lightingDrawCount << " lit, " << textDrawCount << " text)\n"
+	             << "State changes: " << frameStats._stateChangeCount << " (expected " << expectedStateChangeCount << ")\n"
+	             << "Bytes uploaded: " << frameStats._bytesUploaded << " (expected " << expectedBytesUploaded << ")\n"
+	             << "Commands recorded: " << recording.GetCommands().size() << "\n";
+
+	OutputDebugString(reportStream.str().c_str());
+	MessageBox(0, reportStream.str().c_str(), "Render recording check", MB_OK);
+	return passed;
+}
+
+// Times the entity render preparation on a scene with most of its entities out of view, against the path it replaced.
+// The old path builds every resident's world, inverse transpose and world view projection matrices and then asks the 
+// camera whether it is visible; the new one culls cells and spheres first and builds the matrices of the survivors only. 
+// The default camera sees roughly x in [-33, 33], so the hidden entities are kept along the grid's left edge.
+static bool RunCullBenchmark(HINSTANCE hInstance)
+{
+	OfflineScene offlineScene(hInstance, std::make_unique<SoftwareRenderDevice>(OFFLINE_SCENE_WIDTH, OFFLINE_SCENE_HEIGHT, std::string()));
+	offlineScene._camera.Update(offlineScene._window);
+
+	std::mt19937 randomEngine(30U);
+	std::uniform_real_distribution<FLOAT> visibleXDistribution(-25.0f, 25.0f);
+	std::uniform_real_distribution<FLOAT> visibleZDistribution(-28.0f, 18.0f);
+	std::uniform_real_distribution<FLOAT> hiddenXDistribution(-52.0f, -42.0f);
+	std::uniform_real_distribution<FLOAT> hiddenZDistribution(-52.0f, 37.0f);
+
+	std::vector<std::shared_ptr<GameEntity>> entities;
+	for (auto i = 0U; i < CULL_BENCHMARK_ENTITY_COUNT; ++i)
+	{
+		const auto visible = i % 10 == 0;
+		const auto position = visible ? XMFLOAT3(visibleXDistribution(randomEngine), 0.0f, visibleZDistribution(randomEngine)) : 
+		                                XMFLOAT3(hiddenXDistribution(randomEngine), 0.0f, hiddenZDistribution(randomEngine));
+
+		entities.push_back(std::make_shared<TrainingBotGameEntity>(offlineScene._scene, offlineScene._renderer, position));
+		offlineScene._scene.InsertEntity(entities.back());
+	}
+
+	auto& camera = offlineScene._camera;
+	const auto viewProjection = camera.GetViewMatrix() * camera.GetProjectionMatrix();
+
+	// Summed into so that the matrix work is not optimized away
+	auto matrixChecksum = 0.0f;
+	auto perEntityVisibleCount = 0U;
+	auto cellCulledVisibleCount = 0U;
+
+	const auto perEntityStartTime = std::chrono::high_resolution_clock::now();
+	for (auto iteration = 0U; iteration < CULL_BENCHMARK_ITERATIONS; ++iteration)
+	{
+		perEntityVisibleCount = 0U;
+		for (const auto& entity: entities)
+		{
+			const auto worldMatrix = entity->GetModel().CalculateWorldMatrix();
+			const auto worldInverseTranspose = math::InverseTranspose(worldMatrix);
+			const auto worldViewProjection = worldMatrix * camera.GetViewMatrix() * camera.GetProjectionMatrix();
+
+			if (camera.isVisible(entity->GetModel()))
+			{
+				matrixChecksum += XMVectorGetX(worldInverseTranspose.r[0]) + XMVectorGetX(worldViewProjection.r[0]);
+				perEntityVisibleCount++;
+			}
+		}
+	}
+	const auto perEntitySeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - perEntityStartTime).count();
+
+	const auto cellCulledStartTime = std::chrono::high_resolution_clock::now();
+	for (auto iteration = 0U; iteration < CULL_BENCHMARK_ITERATIONS; ++iteration)
+	{
+		offlineScene._scene.PrepareVisibleEntities();
+		for (const auto* entity: offlineScene._scene.GetVisibleEntities())
+		{
+			const auto worldMatrix = entity->GetModel().CalculateWorldMatrix();
+			const auto worldInverseTranspose = math::InverseTranspose(worldMatrix);
+			matrixChecksum += XMVectorGetX(worldInverseTranspose.r[0]) + XMVectorGetX((worldMatrix * viewProjection).r[0]);
+		}
+		cellCulledVisibleCount = static_cast<UINT>(offlineScene._scene.GetVisibleEntities().size());
+	}
+	const auto cellCulledSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - cellCulledStartTime).count();
+
+	const auto passed = perEntityVisibleCount == cellCulledVisibleCount;
+
+	std::stringstream reportStream;
+	reportStream << CULL_BENCHMARK_ENTITY_COUNT << " entities, " << CULL_BENCHMARK_ITERATIONS << " iterations\n";
+	reportStream << "Per entity matrices then visibility: " << perEntitySeconds * 1000.0 / CULL_BENCHMARK_ITERATIONS << " ms per frame, " << perEntityVisibleCount << " visible\n";
+	reportStream << "Cell and sphere culling then matrices: " << cellCulledSeconds * 1000.0 / CULL_BENCHMARK_ITERATIONS << " ms per frame, " << cellCulledVisibleCount << " visible\n";
+	reportStream << "Speedup: " << perEntitySeconds / cellCulledSeconds << "x (checksum " << matrixChecksum << ")\n";
+	reportStream << (passed ? "PASSED" : "FAILED") << ": both paths " << (passed ? "keep" : "do not keep") << " the same number of entities\n";
+
+	OutputDebugString(reportStream.str().c_str());
+	MessageBox(0, reportStream.str().c_str(), "Cull benchmark", MB_OK);
+	return passed;
+}
+
+// Builds the clustered light grid for sets of random point lights scattered over the scene grid, seen from the default 
+// camera, reports the average build time and checks every set's SSE light assignment against a scalar sphere/box test
+static bool RunLightGridBenchmark(HINSTANCE hInstance)
+{
+	ClientWindow window(hInstance, DefWindowProc, "Space-D", OFFLINE_SCENE_WIDTH, OFFLINE_SCENE_HEIGHT);
+	Camera camera;
+	camera.Update(window);
+
+	std::mt19937 randomEngine(40U);
+	std::uniform_real_distribution<FLOAT> horizontalDistribution(-45.0f, 45.0f);
+	std::uniform_real_distribution<FLOAT> heightDistribution(0.0f, 10.0f);
+	std::uniform_real_distribution<FLOAT> rangeDistribution(2.0f, 15.0f);
+
+	ClusteredLightGrid lightGrid;
+	std::vector<PointLight> lights(LIGHT_GRID_BENCHMARK_LIGHT_COUNT);
+	auto totalBuildSeconds = 0.0;
+	auto totalLightIndexCount = 0ULL;
+	auto totalOverflowingClusterCount = 0ULL;
+	auto mismatchingClusterCount = 0U;
+
+	for (auto lightSet = 0U; lightSet < LIGHT_GRID_BENCHMARK_LIGHT_SETS; ++lightSet)
+	{
+		for (auto& light: lights)
+		{
+			light._position = XMFLOAT3(horizontalDistribution(randomEngine), heightDistribution(randomEngine), horizontalDistribution(randomEngine));
+			light._range = rangeDistribution(randomEngine);
+		}
+
+		// The first build of the first set also computes the cluster bounds
+		lightGrid.Build(lights, camera.GetViewMatrix(), camera.GetProjectionMatrix(), camera.GetZNear(), camera.GetZFar());
+
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		for (auto iteration = 0U; iteration < LIGHT_GRID_BENCHMARK_ITERATIONS; ++iteration)
+		{
+			lightGrid.Build(lights, camera.GetViewMatrix(), camera.GetProjectionMatrix(), camera.GetZNear(), camera.GetZFar());
+		}
+		totalBuildSeconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+		totalLightIndexCount += lightGrid.GetLightIndices().size();
+		totalOverflowingClusterCount += lightGrid.GetOverflowingClusterCount();
+		mismatchingClusterCount += lightGrid.CountAssignmentMismatches();
+	}
+
+	const auto buildCount = LIGHT_GRID_BENCHMARK_LIGHT_SETS * LIGHT_GRID_BENCHMARK_ITERATIONS;
+
+	std::stringstream reportStream;
+	reportStream << LIGHT_GRID_BENCHMARK_LIGHT_COUNT << " point lights, " << LIGHT_GRID_BENCHMARK_LIGHT_SETS << " light sets, " << buildCount << " builds\n";
+	reportStream << "Build time: " << totalBuildSeconds * 1000.0 / buildCount << " ms on average\n";
+	reportStream << "Light indices: " << totalLightIndexCount / LIGHT_GRID_BENCHMARK_LIGHT_SETS << " per build on average, " 
+	             << totalOverflowingClusterCount / LIGHT_GRID_BENCHMARK_LIGHT_SETS << " overflowing clusters\n";
+	reportStream << (mismatchingClusterCount == 0 ? "PASSED" : "FAILED") << ": " << mismatchingClusterCount << " clusters disagree with the scalar sphere/box test\n";
+
+	OutputDebugString(reportStream.str().c_str());
+	MessageBox(0, reportStream.str().c_str(), "Light grid benchmark", MB_OK);
+	return mismatchingClusterCount == 0;
+}
+
+// Checks work_partitioner::PartitionByCost on edge cases and on random workloads: ranges must be non empty, contiguous 
+// and in order, cover every item, stay within the partition count and each cost no more than an equal share plus one item
+static bool RunPartitionerCheck()
+{
+	std::stringstream reportStream;
+	auto failureCount = 0U;
+	const auto check = [&](const bool condition, const std::string& description)
+	{
+		if (!condition)
+		{
+			reportStream << "FAILED: " << description << "\n";
+			failureCount++;
+		}
+	};
+
+	const auto isWellFormed = [](const std::vector<work_partitioner::Range>& ranges, const UINT itemCount, const UINT maxPartitionCount)
+	{
+		if (ranges.empty() || ranges.size() > maxPartitionCount || ranges.front()._begin != 0 || ranges.back()._end != itemCount)
+		{
+			return false;
+		}
+
+		for (auto i = 0U; i < ranges.size(); ++i)
+		{
+			if (ranges[i]._begin >= ranges[i]._end || (i > 0 && ranges[i]._begin != ranges[i - 1]._end))
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+
+	check(work_partitioner::PartitionByCost({}, 4, 0).empty(), "no items give no ranges");
+	check(work_partitioner::PartitionByCost({ 1, 2, 3 }, 0, 0).empty(), "a partition count of zero gives no ranges");
+
+	const auto zeroCostRanges = work_partitioner::PartitionByCost({ 0, 0, 0, 0, 0, 0 }, 3, 0);
+	check(isWellFormed(zeroCostRanges, 6, 3), "zero cost items are still split into well formed ranges");
+	check(work_partitioner::PartitionByCost({ 0, 0, 0, 0 }, 4, 1).size() == 1, "zero cost items below the minimum cost collapse to one range");
+
+	const auto collapsedRanges = work_partitioner::PartitionByCost({ 5, 5, 5, 5, 5, 5, 5, 5 }, 8, 100);
+	check(collapsedRanges.size() == 1 && collapsedRanges[0]._begin == 0 && collapsedRanges[0]._end == 8, "a workload cheaper than the minimum cost collapses to one range");
+	check(work_partitioner::PartitionByCost({ 5, 5, 5, 5, 5, 5, 5, 5 }, 8, 20).size() == 2, "the minimum cost caps the partition count");
+
+	const auto scarceItemRanges = work_partitioner::PartitionByCost({ 7, 1, 3 }, 8, 0);
+	check(isWellFormed(scarceItemRanges, 3, 8) && scarceItemRanges.size() == 3, "more partitions than items give one range per item");
+
+	const auto orderedRanges = work_partitioner::PartitionByCost({ 1, 1, 1, 1, 1, 1, 1, 1 }, 4, 0);
+	check(orderedRanges.size() == 4 && orderedRanges[0]._end == 2 && orderedRanges[1]._end == 4 && orderedRanges[2]._end == 6, "equal costs split into equal ranges in item order");
+
+	const auto skewedRanges = work_partitioner::PartitionByCost({ 100, 1, 1, 1, 1, 1, 1, 1 }, 2, 0);
+	check(skewedRanges.size() == 2 && skewedRanges[0]._end == 1, "an expensive first item gets a range of its own");
+
+	std::mt19937 randomEngine(38U);
+	for (auto iteration = 0U; iteration < PARTITIONER_CHECK_ITERATIONS; ++iteration)
+	{
+		const auto itemCount = std::uniform_int_distribution<UINT>(1, 300)(randomEngine);
+		const auto maxPartitionCount = std::uniform_int_distribution<UINT>(1, 16)(randomEngine);
+		const auto maxItemCost = std::uniform_int_distribution<UINT>(0, 1000)(randomEngine);
+
+		std::vector<UINT> itemCosts(itemCount);
+		unsigned long long totalCost = 0;
+		UINT largestItemCost = 0;
+		for (auto& itemCost: itemCosts)
+		{
+			itemCost = std::uniform_int_distribution<UINT>(0, maxItemCost)(randomEngine);
+			totalCost += itemCost;
+			largestItemCost = (std::max)(largestItemCost, itemCost);
+		}
+
+		const auto ranges = work_partitioner::PartitionByCost(itemCosts, maxPartitionCount, 0);
+		if (!isWellFormed(ranges, itemCount, maxPartitionCount))
+		{
+			check(false, "random workload " + std::to_string(iteration) + " gives malformed ranges");
+			continue;
+		}
+
+		for (const auto& range: ranges)
+		{
+			unsigned long long rangeCost = 0;
+			for (auto i = range._begin; i < range._end; ++i)
+			{
+				rangeCost += itemCosts[i];
+			}
+
+			if (rangeCost * ranges.size() > totalCost + static_cast<unsigned long long>(largestItemCost) * ranges.size())
+			{
+				check(false, "random workload " + std::to_string(iteration) + " has a range costing more than an equal share plus one item");
+				break;
+			}
+		}
+	}
+
+	reportStream << (failureCount == 0 ? "PASSED" : "FAILED") << ": " << failureCount << " failures over the edge cases and " << PARTITIONER_CHECK_ITERATIONS << " random workloads\n";
+
+	OutputDebugString(reportStream.str().c_str());
+	MessageBox(0, reportStream.str().c_str(), "Work partitioner check", MB_OK);
+	return failureCount == 0;
+}
+
+// Decodes every shipped PNG texture a number of times and reports the decode throughput
+static void RunPngBenchmark()
+{
+	std::stringstream reportStream;
+	auto totalBytes = 0.0;
+	auto totalMilliseconds = 0.0;
+
+	for (const auto& texturePath: FindShippedTextures())
+	{
+		std::ifstream fileStream(texturePath, std::ios::binary);
+		const std::vector<std::uint8_t> fileData((std::istreambuf_iterator<char>(fileStream)), std::istreambuf_iterator<char>());
+
+		png_reader::ImageInfo imageInfo;
+		if (fileData.empty() || !png_reader::ReadInfo(&fileData[0], fileData.size(), imageInfo))
+		{
+			reportStream << texturePath << ": not a PNG\n";
+			continue;
+		}
+
+		std::vector<std::uint8_t> pixels(static_cast<size_t>(imageInfo._width) * imageInfo._height * 4);
+		auto decoded = true;
+
+		const auto decodeStart = std::chrono::high_resolution_clock::now();
+		for (auto i = 0U; i < PNG_BENCHMARK_ITERATIONS && decoded; ++i)
+		{
+			decoded = png_reader::DecodeRGBA(&fileData[0], fileData.size(), &pixels[0], imageInfo._width * 4);
+		}
+		const auto decodeEnd = std::chrono::high_resolution_clock::now();
+
+		if (!decoded)
+		{
+			reportStream << texturePath << ": decode failed\n";
+			continue;
+		}
+
+		const auto milliseconds = std::chrono::duration<double, std::milli>(decodeEnd - decodeStart).count() / PNG_BENCHMARK_ITERATIONS;
+		const auto megabytes = pixels.size() / (1024.0 * 1024.0);
+		totalBytes += pixels.size();
+		totalMilliseconds += milliseconds;
+
+		reportStream << texturePath << " (" << imageInfo._width << "x" << imageInfo._height << "): " << milliseconds << "ms, " << megabytes / (milliseconds / 1000.0) << "MB/s\n";
+	}
+
+	if (totalMilliseconds > 0.0)
+	{
+		reportStream << "Total: " << totalMilliseconds << "ms, " << (totalBytes / (1024.0 * 1024.0)) / (totalMilliseconds / 1000.0) << "MB/s decoded\n";
+	}
+
+	OutputDebugString(reportStream.str().c_str());
+	MessageBox(0, reportStream.str().c_str(), "PNG decode benchmark", MB_OK);
+}
+
+// The getline, split and stof loop OBJLoader parsed models with before obj_parser, kept as the benchmark's baseline. 
+// Like the original it only reads triangles written as p/t/n, and throws on anything else.
+static void ParseOBJWithStreams(const std::string& objText, obj_parser::ParsedOBJ& outParsedOBJ)
+{
+	outParsedOBJ._positions.clear();
+	outParsedOBJ._texcoords.clear();
+	outParsedOBJ._normals.clear();
+	outParsedOBJ._corners.clear();
+
+	std::istringstream objStream(objText);
+	std::string line;
+	while (std::getline(objStream, line))
+	{
+		if (line.size() < 2)
+		{
+			continue;
+		}
+
+		const auto lineSplitBySpace = string_utils::split(line, ' ');
+		if (line[0] == 'm')
+		{
+			auto* color = line[1] == 'a' ? outParsedOBJ._ambient : (line[1] == 'd' ? outParsedOBJ._diffuse : outParsedOBJ._specular);
+			for (auto i = 0U; i < 4; ++i)
+			{
+				color[i] = std::stof(lineSplitBySpace.at(i + 1));
+			}
+		}
+		else if (line[0] == 'v')
+		{
+			auto& attributes = line[1] == 't' ? outParsedOBJ._texcoords : (line[1] == 'n' ? outParsedOBJ._normals : outParsedOBJ._positions);
+			for (auto i = 1U; i < (line[1] == 't' ? 3U : 4U); ++i)
+			{
+				attributes.push_back(std::stof(lineSplitBySpace.at(i)));
+			}
+		}
+		else if (line[0] == 'f')
+		{
+			for (auto i = 1; i < 4; ++i)
+			{
+				const auto faceEntrySplitByDash = string_utils::split(lineSplitBySpace.at(i), '/');
+				outParsedOBJ._corners.push_back({ static_cast<std::uint32_t>(std::stoi(faceEntrySplitByDash.at(0)) - 1), 
+				                                  static_cast<std::uint32_t>(std::stoi(faceEntrySplitByDash.at(1)) - 1), 
+				                                  static_cast<std::uint32_t>(std::stoi(faceEntrySplitByDash.at(2)) - 1) });
+			}
+		}
+	}
+}
+
+// A UV sphere written the way the game's models are, for when no OBJ files are shipped or given
+static std::string GenerateBenchmarkOBJ()
+{
+	std::ostringstream objStream;
+	objStream << "ma 0.5 0.5 0.5 1.0\nmd 0.8 0.8 0.8 1.0\nms 0.9 0.9 0.9 16.0\n";
+
+	const auto segments = OBJ_BENCHMARK_SPHERE_SEGMENTS;
+	for (auto ring = 0U; ring <= segments; ++ring)
+	{
+		const auto theta = XM_PI * ring / segments;
+		for (auto segment = 0U; segment <= segments; ++segment)
+		{
+			const auto phi = XM_2PI * segment / segments;
+			const auto x = std::sin(theta) * std::cos(phi);
+			const auto y = std::cos(theta);
+			const auto z = std::sin(theta) * std::sin(phi);
+			objStream << "v " << x << " " << y << " " << z << "\n";
+			objStream << "vt " << static_cast<FLOAT>(segment) / segments << " " << static_cast<FLOAT>(ring) / segments << "\n";
+			objStream << "vn " << x << " " << y << " " << z << "\n";
+		}
+	}
+
+	for (auto ring = 0U; ring < segments; ++ring)
+	{
+		for (auto segment = 0U; segment < segments; ++segment)
+		{
+			const auto i0 = ring * (segments + 1) + segment + 1;
+			const auto i1 = i0 + 1;
+			const auto i2 = i0 + segments + 1;
+			const auto i3 = i2 + 1;
+			objStream << "f " << i0 << "/" << i0 << "/" << i0 << " " << i2 << "/" << i2 << "/" << i2 << " " << i1 << "/" << i1 << "/" << i1 << "\n";
+			objStream << "f " << i1 << "/" << i1 << "/" << i1 << " " << i2 << "/" << i2 << "/" << i2 << " " << i3 << "/" << i3 << "/" << i3 << "\n";
+		}
+	}
+
+	return objStream.str();
+}
+
+// Times obj_parser against the stream based loop it replaced on the same text, from memory so that neither pays for disk reads
+static void BenchmarkOBJText(const std::string& objName, const std::string& objText, std::stringstream& reportStream)
+{
+	obj_parser::ParsedOBJ parsedOBJ;
+	std::string parseError;
+	auto parsed = true;
+
+	const auto parseStart = std::chrono::high_resolution_clock::now();
+	for (auto i = 0U; i < OBJ_BENCHMARK_ITERATIONS && parsed; ++i)
+	{
+		parsed = obj_parser::Parse(objText.data(), objText.size(), parsedOBJ, parseError);
+	}
+	const auto parseEnd = std::chrono::high_resolution_clock::now();
+
+	if (!parsed)
+	{
+		reportStream << objName << ": " << parseError << "\n";
+		return;
+	}
+
+	obj_parser::ParsedOBJ streamParsedOBJ;
+	const auto streamParseStart = std::chrono::high_resolution_clock::now();
+	try
+	{
+		for (auto i = 0U; i < OBJ_BENCHMARK_ITERATIONS; ++i)
+		{
+			ParseOBJWithStreams(objText, streamParsedOBJ);
+		}
+	}
+	catch (const std::exception&)
+	{
+		streamParsedOBJ._corners.clear();
+	}
+	const auto streamParseEnd = std::chrono::high_resolution_clock::now();
+
+	const auto milliseconds = std::chrono::duration<double, std::milli>(parseEnd - parseStart).count() / OBJ_BENCHMARK_ITERATIONS;
+	const auto triangleCount = parsedOBJ._corners.size() / 3;
+	reportStream << objName << " (" << triangleCount << " triangles, " << objText.size() / 1024 << "KB): obj_parser " << milliseconds << "ms, " 
+	             << (objText.size() / (1024.0 * 1024.0)) / (milliseconds / 1000.0) << "MB/s, " << triangleCount / (milliseconds / 1000.0) << " triangles/s";
+
+	// Only a baseline that read the same triangles is a fair comparison
+	if (streamParsedOBJ._corners.size() != parsedOBJ._corners.size() || streamParsedOBJ._positions.size() != parsedOBJ._positions.size())
+	{
+		reportStream << "; getline/stof baseline could not read it\n";
+		return;
+	}
+
+	const auto streamMilliseconds = std::chrono::duration<double, std::milli>(streamParseEnd - streamParseStart).count() / OBJ_BENCHMARK_ITERATIONS;
+	reportStream << "; getline/stof baseline " << streamMilliseconds << "ms, obj_parser is " << streamMilliseconds / milliseconds << "x faster\n";
+}
+
+// Parses the given OBJ files (every shipped one when none are given, or a generated sphere when none are shipped either)
+// a number of times with both obj_parser and the loop it replaced, and reports both timings and their ratio
+static void RunOBJBenchmark(std::vector<std::string> objPaths)
+{
+	if (objPaths.empty())
+	{
+		objPaths = FindShippedAssets({ MODEL_DIRECTORY_PATH }, ".obj");
+	}
+
+	std::stringstream reportStream;
+	if (objPaths.empty())
+	{
+		BenchmarkOBJText("Generated sphere", GenerateBenchmarkOBJ(), reportStream);
+	}
+
+	for (const auto& objPath: objPaths)
+	{
+		MappedFile objFile(objPath);
+		if (!objFile.IsOpen())
+		{
+			reportStream << objPath << ": not found\n";
+			continue;
+		}
+
+		BenchmarkOBJText(objPath, std::string(reinterpret_cast<const char*>(objFile.GetData()), objFile.GetSize()), reportStream);
+	}
+
+	OutputDebugString(reportStream.str().c_str());
+	MessageBox(0, reportStream.str().c_str(), "OBJ parse benchmark", MB_OK);
+}
+
+// Builds the mip mapped, block compressed version of every shipped texture next to its PNG, in parallel, 
+// followed by the model texture atlases and their layout
+static void RunTextureBuild(const texture_builder::BuildOptions& options)
+{
+	const auto texturePaths = FindShippedTextures();
+	std::vector<std::string> reports(texturePaths.size());
+
+	ThreadPool threadPool;
+	threadPool.ParallelFor(static_cast<UINT>(texturePaths.size()), [&](const UINT textureIndex)
+	{
+		texture_builder::BuildTexture(texturePaths[textureIndex], options, reports[textureIndex]);
+	});
+
+	std::stringstream reportStream;
+	for (const auto& report: reports)
+	{
+		reportStream << report << "\n";
+	}
+
+	std::vector<std::string> atlasSourcePaths;
+	for (const auto* modelName: ATLASED_MODEL_NAMES)
+	{
+		atlasSourcePaths.push_back(MODEL_DIRECTORY_PATH + modelName + "/" + modelName + ".png");
+	}
+
+	std::string atlasReport;
+	texture_atlas::BuildAtlases(atlasSourcePaths, MODEL_DIRECTORY_PATH, options, atlasReport);
+	reportStream << atlasReport;
+
+	OutputDebugString(reportStream.str().c_str());
+	MessageBox(0, reportStream.str().c_str(), "Texture build", MB_OK);
+}
+
+// Compiles every shipped OBJ model into the binary mesh format next to it
+static void RunMeshBuild()
+{
+	std::stringstream reportStream;
+	for (const auto& objPath: FindShippedAssets({ MODEL_DIRECTORY_PATH }, ".obj"))
+	{
+		const auto buildStart = std::chrono::high_resolution_clock::now();
+		const auto modelData = OBJLoader::Get().LoadOBJData(objPath);
+		const auto meshFilePath = mesh_file::GetMeshFilePath(objPath);
+		if (!modelData || !mesh_file::Write(meshFilePath, objPath, *modelData))
+		{
+			reportStream << objPath << ": could not compile\n";
+			continue;
+		}
+
+		const auto buildEnd = std::chrono::high_resolution_clock::now();
+		reportStream << meshFilePath << ": " << modelData->vertexData.size() << " vertices" << (modelData->packedVertexData.empty() ? "" : " (packed)") << ", " 
+		             << modelData->indexData.size() << " indices in " << std::chrono::duration<float, std::milli>(buildEnd - buildStart).count() << "ms\n";
+	}
+
+	OutputDebugString(reportStream.str().c_str());
+	MessageBox(0, reportStream.str().c_str(), "Mesh build", MB_OK);
+}
+
+// Round trips normals at the poles, along the octahedral fold seams and at random through vertex_packing::PackVertices,
+// checks they stay within the packing tolerances and that degenerate normals are flagged, and reports the vertex bytes 
+// packing saves over the shipped models
+static bool RunVertexPackingCheck()
+{
+	std::vector<XMFLOAT3> edgeCaseNormals =
+	{
+		// Poles, where the encoding is exact or meets the folded lower hemisphere's corners
+		XMFLOAT3(0.0f, 0.0f, 1.0f), XMFLOAT3(0.0f, 0.0f, -1.0f), 
+		XMFLOAT3(1.0f, 0.0f, 0.0f), XMFLOAT3(-1.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT3(0.0f, -1.0f, 0.0f),
+
+		// Just off the lower pole, where a tiny change of direction crosses between corners of the unfolded square
+		XMFLOAT3(1e-4f, 1e-4f, -1.0f), XMFLOAT3(-1e-4f, 1e-4f, -1.0f), XMFLOAT3(1e-4f, -1e-4f, -1.0f), XMFLOAT3(-1e-4f, -1e-4f, -1.0f),
+
+		// Octant corners
+		XMFLOAT3(1.0f, 1.0f, 1.0f), XMFLOAT3(-1.0f, 1.0f, -1.0f), XMFLOAT3(1.0f, -1.0f, -1.0f), XMFLOAT3(-1.0f, -1.0f, -1.0f)
+	};
+
+	// The equator is the fold line, and the x = 0 and y = 0 planes of the lower hemisphere are where the folded halves
+	// meet on the square's edges; each is sampled exactly on the seam and just either side of it
+	for (auto step = 0U; step < VERTEX_PACKING_CHECK_SEAM_STEPS; ++step)
+	{
+		const auto angle = 2.0f * math::PI * step / VERTEX_PACKING_CHECK_SEAM_STEPS;
+		const auto c = std::cos(angle);
+		const auto s = std::sin(angle);
+
+		for (const auto offset: { 0.0f, 1e-4f, -1e-4f })
+		{
+			edgeCaseNormals.push_back(XMFLOAT3(c, s, offset));
+			edgeCaseNormals.push_back(XMFLOAT3(offset, c, s));
+			edgeCaseNormals.push_back(XMFLOAT3(c, offset, s));
+		}
+	}
+
+	const auto makeVertices = [](const std::vector<XMFLOAT3>& normals, std::mt19937& randomEngine)
+	{
+		std::uniform_real_distribution<FLOAT> texcoordDistribution(0.0f, 1.0f);
+
+		std::vector<Vertex> vertices;
+		for (const auto& normal: normals)
+		{
+			const auto invLength = 1.0f / std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+			vertices.emplace_back(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT2(texcoordDistribution(randomEngine), texcoordDistribution(randomEngine)), 
+			                      XMFLOAT3(normal.x * invLength, normal.y * invLength, normal.z * invLength));
+		}
+		return vertices;
+	};
+
+	std::mt19937 randomEngine(35U);
+
+	// Texcoords at the ends of the range and on either side of its middle, where half precision steps are coarsest
+	auto edgeCaseVertices = makeVertices(edgeCaseNormals, randomEngine);
+	const FLOAT edgeCaseTexcoords[] = { 0.0f, 1.0f, 0.5f, 0.5f - 1.0f / 4096.0f, 1.0f - 1.0f / 4096.0f, 1.0f / 4096.0f };
+	for (auto i = 0U; i < edgeCaseVertices.size(); ++i)
+	{
+		edgeCaseVertices[i]._tex = XMFLOAT2(edgeCaseTexcoords[i % 6], edgeCaseTexcoords[(i / 6) % 6]);
+	}
+
+	// Uniform over the sphere
+	std::normal_distribution<FLOAT> normalDistribution(0.0f, 1.0f);
+	std::vector<XMFLOAT3> randomNormals;
+	while (randomNormals.size() < VERTEX_PACKING_CHECK_RANDOM_NORMALS)
+	{
+		const XMFLOAT3 normal(normalDistribution(randomEngine), normalDistribution(randomEngine), normalDistribution(randomEngine));
+		if (normal.x * normal.x + normal.y * normal.y + normal.z * normal.z > 1e-6f)
+		{
+			randomNormals.push_back(normal);
+		}
+	}
+	const auto randomVertices = makeVertices(randomNormals, randomEngine);
+
+	std::vector<PackedVertex> packedVertices;
+	const auto edgeCaseError = vertex_packing::PackVertices(edgeCaseVertices, packedVertices);
+	const auto randomError = vertex_packing::PackVertices(randomVertices, packedVertices);
+
+	// Zero length and non finite normals have no direction to keep, so they must pack as +Z and be counted rather than measured
+	const std::vector<Vertex> degenerateVertices =
+	{
+		Vertex(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT2(0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f)),
+		Vertex(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT2(0.0f, 0.0f), XMFLOAT3(1e-30f, 0.0f, -1e-30f)),
+		Vertex(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT2(0.0f, 0.0f), XMFLOAT3(std::numeric_limits<FLOAT>::quiet_NaN(), 0.0f, 1.0f)),
+		Vertex(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT2(0.0f, 0.0f), XMFLOAT3(std::numeric_limits<FLOAT>::infinity(), 0.0f, 0.0f))
+	};
+	const auto degenerateError = vertex_packing::PackVertices(degenerateVertices, packedVertices);
+	const auto degenerateNormalsHandled = degenerateError._degenerateNormalCount == degenerateVertices.size() && degenerateError._maxNormalAngleError == 0.0f &&
+		std::all_of(packedVertices.begin(), packedVertices.end(), [](const PackedVertex& packedVertex) { return packedVertex._normal[0] == 0 && packedVertex._normal[1] == 0; });
+
+	const auto passed = edgeCaseError.IsWithinTolerance() && randomError.IsWithinTolerance() && 
+		edgeCaseError._degenerateNormalCount == 0 && randomError._degenerateNormalCount == 0 && degenerateNormalsHandled;
+
+	std::stringstream reportStream;
+	reportStream << (passed ? "PASSED" : "FAILED") << " (tolerances: texcoord " << vertex_packing::MAX_TEXCOORD_ERROR << ", normal " << vertex_packing::MAX_NORMAL_ANGLE_ERROR << " rad)\n";
+	reportStream << edgeCaseVertices.size() << " edge cases: max texcoord error " << edgeCaseError._maxTexcoordError << ", max normal error " << edgeCaseError._maxNormalAngleError << " rad\n";
+	reportStream << randomVertices.size() << " random normals: max texcoord error " << randomError._maxTexcoordError << ", max normal error " << randomError._maxNormalAngleError << " rad\n";
+	reportStream << degenerateVertices.size() << " degenerate normals: " << degenerateError._degenerateNormalCount << " counted, " << (degenerateNormalsHandled ? "all packed as +Z" : "NOT all packed as +Z") << "\n";
+
+	// Models whose packing exceeds the tolerances keep the full vertex format and save nothing
+	auto packedModelCount = 0U;
+	auto modelCount = 0U;
+	auto unpackedVertexBytes = 0ULL;
+	auto packedVertexBytes = 0ULL;
+	for (const auto& objPath: FindShippedAssets({ MODEL_DIRECTORY_PATH }, ".obj"))
+	{
+		const auto modelData = OBJLoader::Get().LoadOBJData(objPath);
+		if (!modelData)
+		{
+			continue;
+		}
+
+		modelCount++;
+		unpackedVertexBytes += modelData->vertexData.size() * sizeof(Vertex);
+		if (modelData->packedVertexData.empty())
+		{
+			packedVertexBytes += modelData->vertexData.size() * sizeof(Vertex);
+		}
+		else
+		{
+			packedVertexBytes += modelData->packedVertexData.size() * sizeof(PackedVertex);
+			packedModelCount++;
+		}
+	}
+
+	reportStream << packedModelCount << " of " << modelCount << " models packed: " << unpackedVertexBytes << " -> " << packedVertexBytes << " vertex bytes, " 
+	             << unpackedVertexBytes - packedVertexBytes << " saved\n";
+
+	OutputDebugString(reportStream.str().c_str());
+	MessageBox(0, reportStream.str().c_str(), "Vertex packing check", MB_OK);
+	return passed;
+}
+
+// Bundles the asset directory into the pack the game mounts at startup. Meant to run after the texture and mesh builds.
+static void RunPackBuild()
+{
+	std::string packReport;
+	asset_pack::Build(ASSET_DIRECTORY_PATH, std::vector<std::string>(std::begin(UNPACKED_ASSET_PREFIXES), std::end(UNPACKED_ASSET_PREFIXES)), ASSET_PACK_PATH, packReport);
+
+	OutputDebugString((packReport + "\n").c_str());
+	MessageBox(0, packReport.c_str(), "Asset pack build", MB_OK);
+}
 
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE prevInstance, PSTR cmdLine, int showCmd)
 {
@@ -17,9 +884,132 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE prevInstance, PSTR cmdLine, in
 	auto clientWidth   = 800;
 	auto clientHeight  = 900;
 	auto clientName = "Space-D";
+
+	// "-headless [frameCount]" renders a fixed number of frames on the CPU, writes them out as PNGs and checks them against the 
+	// reference frame checksums, exiting with 1 when one differs ("-updatereference" records this run's frames as the new reference),
+	// "-deferred" records the frame's draws on worker threads, "-pngbenchmark" only measures texture decoding and exits,
+	// "-objbenchmark [paths...]" only measures OBJ parsing (of the shipped models, or a generated one, by default) against the old loader and exits,
+	// "-buildtextures [box|kaiser] [bc1|bc3|bc7]" builds the compressed textures and model atlases and exits (Kaiser mips and BC1/BC7 by opacity by default),
+	// "-buildmeshes" compiles the OBJ models into their binary form and exits,
+	// "-recordingcheck" renders a scripted scene through the recording device and checks its counts, exiting with 1 when they are off,
+	// "-cullbenchmark" times the entity render preparation against the per entity path it replaced, exiting with 1 when their results differ,
+	// "-lightgridbenchmark" times the clustered light grid build and checks its light assignment, exiting with 1 when it is off,
+	// "-packingcheck" round trips edge case and random normals through the vertex packing and reports the bytes it saves, exiting with 1 when it fails,
+	// "-partitionercheck" checks the cost partitioner on edge cases and random workloads, exiting with 1 when it fails,
+	// "-buildpack" bundles the assets into a single pack and exits, "-loosefiles" reads every asset loose even when a pack is present
+	std::istringstream cmdLineStream(cmdLine);
+	std::string option;
+	auto renderMode = Game::RenderMode::IMMEDIATE;
+	auto headlessFrameCount = DEFAULT_HEADLESS_FRAME_COUNT;
+	auto looseFiles = false;
+	auto updateHeadlessReference = false;
+	while (cmdLineStream >> option)
+	{
+		if (option == "-deferred" && renderMode != Game::RenderMode::HEADLESS)
+		{
+			renderMode = Game::RenderMode::DEFERRED_CONTEXTS;
+		}
+		else if (option == "-buildtextures")
+		{
+			texture_builder::BuildOptions buildOptions;
+			buildOptions._mipFilter = mip_generator::MipFilter::KAISER;
+			buildOptions._forceFormat = false;
+			buildOptions._format = block_compressor::BlockFormat::BC7;
+
+			std::string buildOption;
+			while (cmdLineStream >> buildOption)
+			{
+				if (buildOption == "box")    buildOptions._mipFilter = mip_generator::MipFilter::BOX;
+				if (buildOption == "kaiser") buildOptions._mipFilter = mip_generator::MipFilter::KAISER;
+				if (buildOption == "bc1")    { buildOptions._forceFormat = true; buildOptions._format = block_compressor::BlockFormat::BC1; }
+				if (buildOption == "bc3")    { buildOptions._forceFormat = true; buildOptions._format = block_compressor::BlockFormat::BC3; }
+				if (buildOption == "bc7")    { buildOptions._forceFormat = true; buildOptions._format = block_compressor::BlockFormat::BC7; }
+			}
+
+			RunTextureBuild(buildOptions);
+			return 0;
+		}
+		else if (option == "-buildmeshes")
+		{
+			RunMeshBuild();
+			return 0;
+		}
+		else if (option == "-buildpack")
+		{
+			RunPackBuild();
+			return 0;
+		}
+		else if (option == "-loosefiles")
+		{
+			looseFiles = true;
+		}
+		else if (option == "-updatereference")
+		{
+			updateHeadlessReference = true;
+		}
+		else if (option == "-objbenchmark")
+		{
+			std::vector<std::string> objPaths;
+			std::string objPath;
+			while (cmdLineStream >> objPath)
+			{
+				objPaths.push_back(objPath);
+			}
+
+			RunOBJBenchmark(objPaths);
+			return 0;
+		}
+		else if (option == "-recordingcheck")
+		{
+			return RunRenderRecordingCheck(hInstance) ? 0 : 1;
+		}
+		else if (option == "-cullbenchmark")
+		{
+			return RunCullBenchmark(hInstance) ? 0 : 1;
+		}
+		else if (option == "-lightgridbenchmark")
+		{
+			return RunLightGridBenchmark(hInstance) ? 0 : 1;
+		}
+		else if (option == "-packingcheck")
+		{
+			return RunVertexPackingCheck() ? 0 : 1;
+		}
+		else if (option == "-partitionercheck")
+		{
+			return RunPartitionerCheck() ? 0 : 1;
+		}
+		else if (option == "-pngbenchmark")
+		{
+			RunPngBenchmark();
+			return 0;
+		}
+		else if (option == "-headless")
+		{
+			renderMode = Game::RenderMode::HEADLESS;
+			if (!(cmdLineStream >> headlessFrameCount))
+			{
+				headlessFrameCount = DEFAULT_HEADLESS_FRAME_COUNT;
+				cmdLineStream.clear();
+			}
+		}
+	}
+
+	// Without a pack, or with -loosefiles while editing assets, everything is read loose as before
+	if (!looseFiles)
+	{
+		VirtualFileSystem::Get().Mount(ASSET_PACK_PATH, ASSET_DIRECTORY_PATH);
+	}
 	
-	Game game(hInstance, clientName, clientWidth, clientHeight);
-	game.Run();
+	Game game(hInstance, clientName, clientWidth, clientHeight, renderMode);
+	if (renderMode == Game::RenderMode::HEADLESS)
+	{
+		return game.RunHeadless(headlessFrameCount, updateHeadlessReference) ? 0 : 1;
+	}
+	else
+	{
+		game.Run();
+	}
 
 	return 0;
 }
@@ -0,0 +1,111 @@
+/************************************************************************/
+/** assetpreloader.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                  **/
+/************************************************************************/
+
+// Local Headers
+#include "assetpreloader.h"
+#include "objloader.h"
+#include "textureloader.h"
+
+// Remote Headers
+#include <fstream>
+#include <sstream>
+#include <Windows.h>
+
+namespace
+{
+	static const std::string MODEL_ENTRY = "model";
+	static const std::string TEXTURE_ENTRY = "texture";
+}
+
+AssetPreloader::AssetPreloader(const std::string& manifestPath)
+	: _manifestPath(manifestPath)
+	, _startTime(std::chrono::high_resolution_clock::now())
+	, _preloadedModelCount(0)
+	, _preloadedTextureCount(0)
+{
+}
+
+AssetPreloader::~AssetPreloader()
+{
+}
+
+void AssetPreloader::Start()
+{
+	_startTime = std::chrono::high_resolution_clock::now();
+
+	std::ifstream manifestStream(_manifestPath);
+	std::string line;
+	while (std::getline(manifestStream, line))
+	{
+		const auto entryEnd = line.find(' ');
+		if (entryEnd == std::string::npos)
+		{
+			continue;
+		}
+
+		const auto entryType = line.substr(0, entryEnd);
+		const auto assetPath = line.substr(entryEnd + 1);
+		if (entryType == MODEL_ENTRY)
+		{
+			OBJLoader::Get().PreloadOBJData(assetPath);
+			_preloadedModelCount++;
+		}
+		else if (entryType == TEXTURE_ENTRY)
+		{
+			TextureLoader::Get().PreloadTexture(assetPath);
+			_preloadedTextureCount++;
+		}
+	}
+}
+
+void AssetPreloader::Finish(comptr<ID3D11Device> device)
+{
+	// Entries the level no longer uses are waited on too, so that no worker still holds them afterwards
+	OBJLoader::Get().WaitForPreloadedModels();
+	TextureLoader::Get().WaitForPendingTextures(device);
+
+	const auto finishTime = std::chrono::high_resolution_clock::now();
+
+	std::stringstream reportStream;
+	reportStream << "Startup assets (" << _preloadedModelCount << " models and " << _preloadedTextureCount << " textures preloaded from " << _manifestPath << "):\n";
+
+	auto assetMilliseconds = 0.0f;
+	for (const auto& modelPath: OBJLoader::Get().GetLoadedModelPaths())
+	{
+		const auto milliseconds = OBJLoader::Get().GetLoadMilliseconds(modelPath);
+		assetMilliseconds += milliseconds;
+		reportStream << "  Model " << modelPath << ": " << milliseconds << "ms\n";
+	}
+
+	for (const auto& texturePath: TextureLoader::Get().GetRequestedTexturePaths())
+	{
+		const auto milliseconds = TextureLoader::Get().GetLoadMilliseconds(texturePath);
+		assetMilliseconds += milliseconds;
+		reportStream << "  Texture " << texturePath << ": " << milliseconds << "ms\n";
+	}
+
+	reportStream << "Startup took " << std::chrono::duration<FLOAT, std::milli>(finishTime - _startTime).count() << "ms; reading the assets took " 
+	             << assetMilliseconds << "ms summed across all threads\n";
+	OutputDebugString(reportStream.str().c_str());
+}
+
+void AssetPreloader::WriteManifest() const
+{
+	std::ofstream manifestStream(_manifestPath);
+	if (!manifestStream.is_open())
+	{
+		return;
+	}
+
+	for (const auto& modelPath: OBJLoader::Get().GetLoadedModelPaths())
+	{
+		manifestStream << MODEL_ENTRY << " " << modelPath << "\n";
+	}
+
+	for (const auto& texturePath: TextureLoader::Get().GetRequestedTexturePaths())
+	{
+		manifestStream << TEXTURE_ENTRY << " " << texturePath << "\n";
+	}
+}
\ No newline at end of file
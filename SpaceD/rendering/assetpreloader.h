@@ -0,0 +1,43 @@
+/**********************************************************************/
+/** assetpreloader.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                **/
+/**********************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "d3dcommon.h"
+
+// Remote Headers
+#include <chrono>
+#include <string>
+
+// Startup asset preloading. Every session leaves behind a manifest of the models and textures it loaded, and the 
+// next startup requests all of them from the OBJ and texture loaders before the renderer even exists, so reading, 
+// parsing and decoding run on the loaders' workers alongside device creation and shader compilation instead of 
+// one asset at a time as the level is built. GPU textures are then created together on the main thread.
+class AssetPreloader final
+{
+public:
+	AssetPreloader(const std::string& manifestPath);
+	~AssetPreloader();
+
+	// Requests every asset in the manifest; needs no device. A missing manifest preloads nothing.
+	void Start();
+
+	// Collects every preloaded model, creates every texture still in flight and reports how long each startup asset took
+	void Finish(comptr<ID3D11Device> device);
+
+	// Rewrites the manifest with everything loaded so far, for the next startup to preload
+	void WriteManifest() const;
+
+private:
+	AssetPreloader(const AssetPreloader& rhs) = delete;
+	AssetPreloader& operator = (const AssetPreloader& rhs) = delete;
+
+private:
+	const std::string _manifestPath;
+	std::chrono::high_resolution_clock::time_point _startTime;
+	UINT _preloadedModelCount;
+	UINT _preloadedTextureCount;
+};
\ No newline at end of file
@@ -0,0 +1,303 @@
+/****************************************************************************/
+/** clusteredlightgrid.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                      **/
+/****************************************************************************/
+
+// Local Headers
+#include "clusteredlightgrid.h"
+#include "lightselector.h"
+
+// Remote Headers
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace
+{
+	const UINT CLUSTERS_PER_SLICE = ClusteredLightGrid::CLUSTER_COUNT_X * ClusteredLightGrid::CLUSTER_COUNT_Y;
+	static_assert(CLUSTERS_PER_SLICE % 4 == 0, "Depth slices must hold whole groups of four clusters");
+}
+
+ClusteredLightGrid::ClusteredLightGrid()
+	: _clusterLightRanges(CLUSTER_COUNT)
+	, _clusterMinX(CLUSTER_COUNT), _clusterMinY(CLUSTER_COUNT), _clusterMinZ(CLUSTER_COUNT)
+	, _clusterMaxX(CLUSTER_COUNT), _clusterMaxY(CLUSTER_COUNT), _clusterMaxZ(CLUSTER_COUNT)
+	, _clusterCandidates(CLUSTER_COUNT)
+	, _nearZ(0.0f)
+	, _farZ(0.0f)
+	, _depthSliceScale(0.0f)
+	, _depthSliceBias(0.0f)
+	, _overflowingClusterCount(0)
+{
+	std::memset(&_boundsProjection, 0, sizeof(_boundsProjection));
+	std::memset(&_clusterLightRanges[0], 0, sizeof(ClusterLightRange) * CLUSTER_COUNT);
+}
+
+ClusteredLightGrid::~ClusteredLightGrid()
+{
+}
+
+void ClusteredLightGrid::Build(const std::vector<PointLight>& lights, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, const FLOAT nearZ, const FLOAT farZ)
+{
+	XMFLOAT4X4 projection;
+	XMStoreFloat4x4(&projection, projectionMatrix);
+	if (nearZ != _nearZ || farZ != _farZ || std::memcmp(&projection, &_boundsProjection, sizeof(projection)) != 0)
+	{
+		_nearZ = nearZ;
+		_farZ  = farZ;
+		_boundsProjection = projection;
+
+		// Exponential slicing keeps clusters roughly cubic in view space
+		const auto logDepthRatio = std::log(_farZ / _nearZ);
+		_depthSliceScale = CLUSTER_COUNT_Z / logDepthRatio;
+		_depthSliceBias  = -(CLUSTER_COUNT_Z * std::log(_nearZ)) / logDepthRatio;
+
+		BuildClusterBounds(projectionMatrix);
+	}
+
+	const auto lightCount = lights.size() < MAX_LIGHTS ? static_cast<UINT>(lights.size()) : MAX_LIGHTS;
+	_lights.assign(lights.begin(), lights.begin() + lightCount);
+	_viewSpaceLights.assign(lights.begin(), lights.begin() + lightCount);
+
+	for (auto& candidates: _clusterCandidates)
+	{
+		candidates.clear();
+	}
+
+	for (auto lightIndex = 0U; lightIndex < lightCount; ++lightIndex)
+	{
+		auto& viewSpaceLight = _viewSpaceLights[lightIndex];
+		XMStoreFloat3(&viewSpaceLight._position, XMVector3Transform(XMLoadFloat3(&viewSpaceLight._position), viewMatrix));
+		AssignLight(lightIndex, viewSpaceLight._position, viewSpaceLight._range);
+	}
+
+	CompactClusterLists();
+}
+
+UINT ClusteredLightGrid::GetClusterIndex(const FLOAT ndcX, const FLOAT ndcY, const FLOAT viewDepth) const
+{
+	return GetClusterIndex(ndcX, ndcY, viewDepth, _depthSliceScale, _depthSliceBias);
+}
+
+UINT ClusteredLightGrid::GetClusterIndex(const FLOAT ndcX, const FLOAT ndcY, const FLOAT viewDepth, const FLOAT depthSliceScale, const FLOAT depthSliceBias)
+{
+	auto tileX = static_cast<INT>((ndcX * 0.5f + 0.5f) * CLUSTER_COUNT_X);
+	auto tileY = static_cast<INT>((0.5f - ndcY * 0.5f) * CLUSTER_COUNT_Y);
+	tileX = tileX < 0 ? 0 : (tileX >= static_cast<INT>(CLUSTER_COUNT_X) ? CLUSTER_COUNT_X - 1 : tileX);
+	tileY = tileY < 0 ? 0 : (tileY >= static_cast<INT>(CLUSTER_COUNT_Y) ? CLUSTER_COUNT_Y - 1 : tileY);
+
+	return GetDepthSlice(viewDepth, depthSliceScale, depthSliceBias) * CLUSTERS_PER_SLICE + tileY * CLUSTER_COUNT_X + tileX;
+}
+
+FLOAT ClusteredLightGrid::GetDepthSliceScale() const
+{
+	return _depthSliceScale;
+}
+
+FLOAT ClusteredLightGrid::GetDepthSliceBias() const
+{
+	return _depthSliceBias;
+}
+
+const std::vector<PointLight>& ClusteredLightGrid::GetLights() const
+{
+	return _lights;
+}
+
+const std::vector<ClusteredLightGrid::ClusterLightRange>& ClusteredLightGrid::GetClusterLightRanges() const
+{
+	return _clusterLightRanges;
+}
+
+const std::vector<UINT>& ClusteredLightGrid::GetLightIndices() const
+{
+	return _lightIndices;
+}
+
+UINT ClusteredLightGrid::GetOverflowingClusterCount() const
+{
+	return _overflowingClusterCount;
+}
+
+UINT ClusteredLightGrid::CountAssignmentMismatches() const
+{
+	auto mismatchCount = 0U;
+	std::vector<UINT> referenceCandidates;
+
+	for (auto clusterIndex = 0U; clusterIndex < CLUSTER_COUNT; ++clusterIndex)
+	{
+		referenceCandidates.clear();
+		for (auto lightIndex = 0U; lightIndex < _viewSpaceLights.size(); ++lightIndex)
+		{
+			const auto& viewSpaceLight = _viewSpaceLights[lightIndex];
+			if (viewSpaceLight._position.z + viewSpaceLight._range < _nearZ || viewSpaceLight._position.z - viewSpaceLight._range > _farZ)
+			{
+				continue;
+			}
+
+			const auto dx = (std::max)(_clusterMinX[clusterIndex] - viewSpaceLight._position.x, 0.0f) + (std::max)(viewSpaceLight._position.x - _clusterMaxX[clusterIndex], 0.0f);
+			const auto dy = (std::max)(_clusterMinY[clusterIndex] - viewSpaceLight._position.y, 0.0f) + (std::max)(viewSpaceLight._position.y - _clusterMaxY[clusterIndex], 0.0f);
+			const auto dz = (std::max)(_clusterMinZ[clusterIndex] - viewSpaceLight._position.z, 0.0f) + (std::max)(viewSpaceLight._position.z - _clusterMaxZ[clusterIndex], 0.0f);
+			if (dx * dx + dy * dy + dz * dz <= viewSpaceLight._range * viewSpaceLight._range)
+			{
+				referenceCandidates.push_back(lightIndex);
+			}
+		}
+
+		if (referenceCandidates != _clusterCandidates[clusterIndex])
+		{
+			mismatchCount++;
+		}
+	}
+
+	return mismatchCount;
+}
+
+void ClusteredLightGrid::BuildClusterBounds(const XMMATRIX& projectionMatrix)
+{
+	XMVECTOR determinant;
+	const auto inverseProjection = XMMatrixInverse(&determinant, projectionMatrix);
+
+	for (auto slice = 0U; slice < CLUSTER_COUNT_Z; ++slice)
+	{
+		const auto sliceNear = _nearZ * std::pow(_farZ / _nearZ, static_cast<FLOAT>(slice) / CLUSTER_COUNT_Z);
+		const auto sliceFar  = _nearZ * std::pow(_farZ / _nearZ, static_cast<FLOAT>(slice + 1) / CLUSTER_COUNT_Z);
+
+		for (auto tileY = 0U; tileY < CLUSTER_COUNT_Y; ++tileY)
+		{
+			for (auto tileX = 0U; tileX < CLUSTER_COUNT_X; ++tileX)
+			{
+				const auto clusterIndex = slice * CLUSTERS_PER_SLICE + tileY * CLUSTER_COUNT_X + tileX;
+				auto boundsMin = XMVectorReplicate(FLT_MAX);
+				auto boundsMax = XMVectorReplicate(-FLT_MAX);
+
+				// The cluster's 8 corners: the tile's corner rays through the near plane, scaled out to the slice depths
+				for (auto corner = 0U; corner < 4; ++corner)
+				{
+					const auto ndcX = -1.0f + 2.0f * (tileX + (corner & 1)) / CLUSTER_COUNT_X;
+					const auto ndcY =  1.0f - 2.0f * (tileY + (corner >> 1)) / CLUSTER_COUNT_Y;
+
+					auto ray = XMVector4Transform(XMVectorSet(ndcX, ndcY, 0.0f, 1.0f), inverseProjection);
+					ray = XMVectorDivide(ray, XMVectorSplatW(ray));
+					ray = XMVectorDivide(ray, XMVectorSplatZ(ray));
+
+					const auto nearCorner = XMVectorScale(ray, sliceNear);
+					const auto farCorner  = XMVectorScale(ray, sliceFar);
+					boundsMin = XMVectorMin(boundsMin, XMVectorMin(nearCorner, farCorner));
+					boundsMax = XMVectorMax(boundsMax, XMVectorMax(nearCorner, farCorner));
+				}
+
+				_clusterMinX[clusterIndex] = XMVectorGetX(boundsMin);
+				_clusterMinY[clusterIndex] = XMVectorGetY(boundsMin);
+				_clusterMinZ[clusterIndex] = XMVectorGetZ(boundsMin);
+				_clusterMaxX[clusterIndex] = XMVectorGetX(boundsMax);
+				_clusterMaxY[clusterIndex] = XMVectorGetY(boundsMax);
+				_clusterMaxZ[clusterIndex] = XMVectorGetZ(boundsMax);
+			}
+		}
+	}
+}
+
+UINT ClusteredLightGrid::GetDepthSlice(const FLOAT viewDepth, const FLOAT depthSliceScale, const FLOAT depthSliceBias)
+{
+	if (viewDepth <= 0.0f)
+	{
+		return 0;
+	}
+
+	// Depths outside [near, far] fall into the first or last slice
+	const auto slice = static_cast<INT>(std::floor(std::log(viewDepth) * depthSliceScale + depthSliceBias));
+	return slice < 0 ? 0 : (slice >= static_cast<INT>(CLUSTER_COUNT_Z) ? CLUSTER_COUNT_Z - 1 : slice);
+}
+
+void ClusteredLightGrid::AssignLight(const UINT lightIndex, const XMFLOAT3& viewPos, const FLOAT range)
+{
+	if (viewPos.z + range < _nearZ || viewPos.z - range > _farZ)
+	{
+		return;
+	}
+
+	const auto firstSlice = GetDepthSlice(viewPos.z - range, _depthSliceScale, _depthSliceBias);
+	const auto lastSlice  = GetDepthSlice(viewPos.z + range, _depthSliceScale, _depthSliceBias);
+
+	const auto centerX = _mm_set1_ps(viewPos.x);
+	const auto centerY = _mm_set1_ps(viewPos.y);
+	const auto centerZ = _mm_set1_ps(viewPos.z);
+	const auto rangeSquared = _mm_set1_ps(range * range);
+	const auto zero = _mm_setzero_ps();
+
+	// Sphere against four cluster boxes at a time: squared distance from the centre to each box
+	for (auto slice = firstSlice; slice <= lastSlice; ++slice)
+	{
+		for (auto clusterIndex = slice * CLUSTERS_PER_SLICE; clusterIndex < (slice + 1) * CLUSTERS_PER_SLICE; clusterIndex += 4)
+		{
+			const auto dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&_clusterMinX[clusterIndex]), centerX), zero), _mm_max_ps(_mm_sub_ps(centerX, _mm_loadu_ps(&_clusterMaxX[clusterIndex])), zero));
+			const auto dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&_clusterMinY[clusterIndex]), centerY), zero), _mm_max_ps(_mm_sub_ps(centerY, _mm_loadu_ps(&_clusterMaxY[clusterIndex])), zero));
+			const auto dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&_clusterMinZ[clusterIndex]), centerZ), zero), _mm_max_ps(_mm_sub_ps(centerZ, _mm_loadu_ps(&_clusterMaxZ[clusterIndex])), zero));
+
+			const auto distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			const auto overlapMask = _mm_movemask_ps(_mm_cmple_ps(distanceSquared, rangeSquared));
+			if (overlapMask == 0)
+			{
+				continue;
+			}
+
+			for (auto lane = 0U; lane < 4; ++lane)
+			{
+				if (overlapMask & (1 << lane))
+				{
+					_clusterCandidates[clusterIndex + lane].push_back(lightIndex);
+				}
+			}
+		}
+	}
+}
+
+void ClusteredLightGrid::CompactClusterLists()
+{
+	_lightIndices.clear();
+	_overflowingClusterCount = 0;
+
+	for (auto clusterIndex = 0U; clusterIndex < CLUSTER_COUNT; ++clusterIndex)
+	{
+		const auto& candidates = _clusterCandidates[clusterIndex];
+
+		auto& range = _clusterLightRanges[clusterIndex];
+		range._offset = static_cast<UINT>(_lightIndices.size());
+
+		if (candidates.size() <= MAX_LIGHTS_PER_CLUSTER)
+		{
+			range._count = static_cast<UINT>(candidates.size());
+			_lightIndices.insert(_lightIndices.end(), candidates.begin(), candidates.end());
+			continue;
+		}
+
+		// Too many lights reach this cluster; keep the ones with the most influence on its bounding sphere
+		_overflowingClusterCount++;
+
+		_selectionScratch.clear();
+		for (const auto lightIndex: candidates)
+		{
+			_selectionScratch.push_back(_viewSpaceLights[lightIndex]);
+		}
+
+		const XMFLOAT3 clusterCenter(0.5f * (_clusterMinX[clusterIndex] + _clusterMaxX[clusterIndex]),
+		                             0.5f * (_clusterMinY[clusterIndex] + _clusterMaxY[clusterIndex]),
+		                             0.5f * (_clusterMinZ[clusterIndex] + _clusterMaxZ[clusterIndex]));
+		const auto halfX = 0.5f * (_clusterMaxX[clusterIndex] - _clusterMinX[clusterIndex]);
+		const auto halfY = 0.5f * (_clusterMaxY[clusterIndex] - _clusterMinY[clusterIndex]);
+		const auto halfZ = 0.5f * (_clusterMaxZ[clusterIndex] - _clusterMinZ[clusterIndex]);
+		const auto clusterRadius = std::sqrt(halfX * halfX + halfY * halfY + halfZ * halfZ);
+
+		_selectedIndices.resize(MAX_LIGHTS_PER_CLUSTER);
+		range._count = light_selector::SelectPointLights(&_selectionScratch[0], static_cast<UINT>(_selectionScratch.size()), clusterCenter, clusterRadius, 
+		                                                 MAX_LIGHTS_PER_CLUSTER, &_selectedIndices[0]);
+
+		for (auto i = 0U; i < range._count; ++i)
+		{
+			_lightIndices.push_back(candidates[_selectedIndices[i]]);
+		}
+	}
+}
\ No newline at end of file
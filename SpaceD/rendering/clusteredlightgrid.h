@@ -0,0 +1,90 @@
+/**************************************************************************/
+/** clusteredlightgrid.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                    **/
+/**************************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "lightdef.h"
+
+// Remote Headers
+#include <vector>
+
+// View space froxel grid over the camera frustum: 16x9 screen tiles, each split into 24 exponentially 
+// spaced depth slices. Built on the CPU every frame, it lists for every cluster the point lights whose 
+// range overlaps it, so the lighting shader only evaluates those for a pixel. The cluster layout and 
+// depth slicing here must match default3dwithlighting.ps.
+class ClusteredLightGrid final
+{
+public:
+	static const UINT CLUSTER_COUNT_X = 16U;
+	static const UINT CLUSTER_COUNT_Y = 9U;
+	static const UINT CLUSTER_COUNT_Z = 24U;
+	static const UINT CLUSTER_COUNT = CLUSTER_COUNT_X * CLUSTER_COUNT_Y * CLUSTER_COUNT_Z;
+
+	static const UINT MAX_LIGHTS = 1024U;
+
+	// Clusters reached by more lights keep only the most influential ones, picked by light_selector
+	static const UINT MAX_LIGHTS_PER_CLUSTER = 16U;
+
+	// Range of a cluster's entries in the light index list
+	struct ClusterLightRange
+	{
+		UINT _offset;
+		UINT _count;
+	};
+
+public:
+	ClusteredLightGrid();
+	~ClusteredLightGrid();
+
+	// Light positions are in world space. Cluster bounds are only recomputed when the projection changes.
+	void Build(const std::vector<PointLight>& lights, const XMMATRIX& viewMatrix, const XMMATRIX& projectionMatrix, const FLOAT nearZ, const FLOAT farZ);
+
+	// Cluster of a point given its normalized device x and y and its view space depth (the clip space w)
+	UINT GetClusterIndex(const FLOAT ndcX, const FLOAT ndcY, const FLOAT viewDepth) const;
+	static UINT GetClusterIndex(const FLOAT ndcX, const FLOAT ndcY, const FLOAT viewDepth, const FLOAT depthSliceScale, const FLOAT depthSliceBias);
+
+	// slice = log(viewDepth) * scale + bias
+	FLOAT GetDepthSliceScale() const;
+	FLOAT GetDepthSliceBias() const;
+
+	const std::vector<PointLight>& GetLights() const;
+	const std::vector<ClusterLightRange>& GetClusterLightRanges() const;
+	const std::vector<UINT>& GetLightIndices() const;
+
+	UINT GetOverflowingClusterCount() const;
+
+	// Tests every light of the last build against every cluster with a scalar sphere/box test and returns the number
+	// of clusters whose candidate list differs from the one the SSE assignment produced. Slow, meant for self checks.
+	UINT CountAssignmentMismatches() const;
+
+private:
+	void BuildClusterBounds(const XMMATRIX& projectionMatrix);
+	static UINT GetDepthSlice(const FLOAT viewDepth, const FLOAT depthSliceScale, const FLOAT depthSliceBias);
+	void AssignLight(const UINT lightIndex, const XMFLOAT3& viewPos, const FLOAT range);
+	void CompactClusterLists();
+
+private:
+	std::vector<PointLight> _lights;
+	std::vector<PointLight> _viewSpaceLights;
+	std::vector<ClusterLightRange> _clusterLightRanges;
+	std::vector<UINT> _lightIndices;
+
+	// Cluster bounds in view space, structure of arrays so that four clusters are tested at once.
+	// A slice holds 144 clusters, so slices stay 16 byte aligned.
+	std::vector<FLOAT> _clusterMinX, _clusterMinY, _clusterMinZ;
+	std::vector<FLOAT> _clusterMaxX, _clusterMaxY, _clusterMaxZ;
+
+	std::vector<std::vector<UINT>> _clusterCandidates;
+	std::vector<PointLight> _selectionScratch;
+	std::vector<UINT> _selectedIndices;
+
+	XMFLOAT4X4 _boundsProjection;
+	FLOAT _nearZ;
+	FLOAT _farZ;
+	FLOAT _depthSliceScale;
+	FLOAT _depthSliceBias;
+	UINT _overflowingClusterCount;
+};
\ No newline at end of file
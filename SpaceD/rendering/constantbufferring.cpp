@@ -0,0 +1,156 @@
+/****************************************************************************/
+/** constantbufferring.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                      **/
+/****************************************************************************/
+
+// Local Headers
+#include "constantbufferring.h"
+
+// Remote Headers
+#include <cassert>
+#include <cstring>
+
+ConstantBufferRing::ConstantBufferRing(comptr<ID3D11Device> device, comptr<ID3D11DeviceContext> deviceContext, comptr<ID3D11DeviceContext1> deviceContext1, const UINT capacity)
+	: _deviceContext(deviceContext)
+	, _deviceContext1(deviceContext1)
+	, _ringBuffer(0)
+	, _capacity(capacity)
+	, _head(0)
+	, _enabled(false)
+	, _discardOnNextMap(false)
+	, _bytesUploadedThisFrame(0)
+	, _uploadCountThisFrame(0)
+	, _bytesUploadedLastFrame(0)
+	, _uploadCountLastFrame(0)
+{
+	assert(_capacity % SLICE_ALIGNMENT == 0);
+
+	// Constant buffer offsetting and no-overwrite maps on constant buffers are both D3D11.1 features
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+	if (_deviceContext1 && SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+	{
+		_enabled = options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+	}
+
+	if (!_enabled)
+	{
+		OutputDebugString("Constant buffer offsetting not supported, falling back to per shader dynamic buffers\n");
+		return;
+	}
+
+	D3D11_BUFFER_DESC cbd = {};
+	cbd.Usage          = D3D11_USAGE_DYNAMIC;
+	cbd.BindFlags      = D3D11_BIND_CONSTANT_BUFFER;
+	cbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	cbd.ByteWidth      = _capacity;
+
+	HR(device->CreateBuffer(&cbd, 0, _ringBuffer.GetAddressOf()));
+}
+
+ConstantBufferRing::~ConstantBufferRing()
+{
+}
+
+bool ConstantBufferRing::IsEnabled() const
+{
+	return _enabled;
+}
+
+ConstantBufferRing::Slice ConstantBufferRing::Allocate(const void* data, const UINT byteSize)
+{
+	assert(_enabled);
+
+	const auto alignedSize = GetAlignedSize(byteSize);
+
+	// Wrap around and let the driver rename the buffer memory once the ring fills up.
+	// Slices handed out before the wrap remain valid for the draws that already reference them.
+	auto mapType = _discardOnNextMap ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+	if (_head + alignedSize > _capacity)
+	{
+		_head = 0;
+		mapType = D3D11_MAP_WRITE_DISCARD;
+	}
+	_discardOnNextMap = false;
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource = {};
+	HR(_deviceContext->Map(_ringBuffer.Get(), 0, mapType, 0, &mappedResource));
+	std::memcpy(static_cast<BYTE*>(mappedResource.pData) + _head, data, byteSize);
+	_deviceContext->Unmap(_ringBuffer.Get(), 0);
+
+	Slice slice;
+	slice._buffer        = _ringBuffer.Get();
+	slice._firstConstant = _head / CONSTANT_SIZE;
+	slice._constantCount = alignedSize / CONSTANT_SIZE;
+
+	_head += alignedSize;
+	_bytesUploadedThisFrame += byteSize;
+	_uploadCountThisFrame++;
+
+	return slice;
+}
+
+void ConstantBufferRing::UploadWhole(comptr<ID3D11Buffer> buffer, const void* data, const UINT byteSize)
+{
+	D3D11_MAPPED_SUBRESOURCE mappedResource = {};
+	HR(_deviceContext->Map(buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
+	std::memcpy(mappedResource.pData, data, byteSize);
+	_deviceContext->Unmap(buffer.Get(), 0);
+
+	_bytesUploadedThisFrame += byteSize;
+	_uploadCountThisFrame++;
+}
+
+UINT ConstantBufferRing::GetAlignedSize(const UINT byteSize) const
+{
+	// Slice offsets and sizes must be multiples of 16 constants
+	return (byteSize + SLICE_ALIGNMENT - 1) & ~(SLICE_ALIGNMENT - 1);
+}
+
+bool ConstantBufferRing::ReserveContiguous(const UINT totalAlignedSize)
+{
+	assert(_enabled);
+
+	if (totalAlignedSize > _capacity)
+	{
+		return false;
+	}
+
+	if (_head + totalAlignedSize > _capacity)
+	{
+		_head = 0;
+		_discardOnNextMap = true;
+	}
+
+	return true;
+}
+
+void ConstantBufferRing::BindSlice(const UINT slot, const Slice& slice)
+{
+	BindSlice(_deviceContext1.Get(), slot, slice);
+}
+
+void ConstantBufferRing::BindSlice(ID3D11DeviceContext1* context, const UINT slot, const Slice& slice) const
+{
+	assert(_enabled);
+
+	context->VSSetConstantBuffers1(slot, 1, &slice._buffer, &slice._firstConstant, &slice._constantCount);
+	context->PSSetConstantBuffers1(slot, 1, &slice._buffer, &slice._firstConstant, &slice._constantCount);
+}
+
+void ConstantBufferRing::OnFrameEnd()
+{
+	_bytesUploadedLastFrame = _bytesUploadedThisFrame;
+	_uploadCountLastFrame   = _uploadCountThisFrame;
+	_bytesUploadedThisFrame = 0;
+	_uploadCountThisFrame   = 0;
+}
+
+UINT ConstantBufferRing::GetBytesUploadedLastFrame() const
+{
+	return _bytesUploadedLastFrame;
+}
+
+UINT ConstantBufferRing::GetUploadCountLastFrame() const
+{
+	return _uploadCountLastFrame;
+}
\ No newline at end of file
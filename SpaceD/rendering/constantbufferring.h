@@ -0,0 +1,68 @@
+/**************************************************************************/
+/** constantbufferring.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                    **/
+/**************************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "d3dcommon.h"
+
+// Remote Headers
+
+class ConstantBufferRing final
+{
+public:
+	struct Slice
+	{
+		ID3D11Buffer* _buffer;
+		UINT _firstConstant;
+		UINT _constantCount;
+	};
+
+public:
+	ConstantBufferRing(comptr<ID3D11Device> device, comptr<ID3D11DeviceContext> deviceContext, comptr<ID3D11DeviceContext1> deviceContext1, const UINT capacity);
+	~ConstantBufferRing();
+
+	// Whether per draw slices (VSSetConstantBuffers1 offsets + WRITE_NO_OVERWRITE maps) are supported by the device.
+	// When they are not, callers fall back to UploadWhole on their own dynamic buffers.
+	bool IsEnabled() const;
+
+	Slice Allocate(const void* data, const UINT byteSize);
+	void UploadWhole(comptr<ID3D11Buffer> buffer, const void* data, const UINT byteSize);
+
+	// Size a slice of byteSize occupies in the ring
+	UINT GetAlignedSize(const UINT byteSize) const;
+
+	// Makes sure the next totalAlignedSize bytes of slices are allocated without the ring wrapping, so 
+	// that none of them is renamed away before draws recorded for later execution consume it.
+	// Returns false when they do not fit in the ring at all.
+	bool ReserveContiguous(const UINT totalAlignedSize);
+
+	void BindSlice(const UINT slot, const Slice& slice);
+	void BindSlice(ID3D11DeviceContext1* context, const UINT slot, const Slice& slice) const;
+
+	void OnFrameEnd();
+
+	UINT GetBytesUploadedLastFrame() const;
+	UINT GetUploadCountLastFrame() const;
+
+private:
+	static const UINT CONSTANT_SIZE = 16U;
+	static const UINT SLICE_ALIGNMENT = 256U;
+
+private:
+	comptr<ID3D11DeviceContext> _deviceContext;
+	comptr<ID3D11DeviceContext1> _deviceContext1;
+	comptr<ID3D11Buffer> _ringBuffer;
+
+	UINT _capacity;
+	UINT _head;
+	bool _enabled;
+	bool _discardOnNextMap;
+
+	UINT _bytesUploadedThisFrame;
+	UINT _uploadCountThisFrame;
+	UINT _bytesUploadedLastFrame;
+	UINT _uploadCountLastFrame;
+};
\ No newline at end of file
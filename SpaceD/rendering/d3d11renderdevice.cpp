@@ -0,0 +1,646 @@
+/***************************************************************************/
+/** d3d11renderdevice.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                     **/
+/***************************************************************************/
+
+// Local Headers
+#include "d3d11renderdevice.h"
+#include "renderingcontext.h"
+#include "clusteredlightgrid.h"
+#include "shaders/default3dshader.h"
+#include "shaders/default3dwithlightingshader.h"
+#include "shaders/defaulttextshader.h"
+#include "shaders/defaultuishader.h"
+#include "shaders/shadercache.h"
+#include "models/model.h"
+#include "../util/threadpool.h"
+
+// Remote Headers
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+const UINT D3D11RenderDevice::CONSTANT_BUFFER_RING_CAPACITY = 1024U * 1024U;
+const UINT D3D11RenderDevice::INITIAL_TEXT_VERTEX_CAPACITY = 1024U * 6U;
+const UINT D3D11RenderDevice::MIN_DRAWS_PER_COMMAND_LIST = 8U;
+
+D3D11RenderDevice::D3D11RenderDevice(ClientWindow& clientWindow, const bool deferredRecording)
+	: _renderingContext(new RenderingContext(clientWindow))
+	, _activeShaderType(Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING)
+	, _activeShaderVariant(0)
+	, _textVertexBuffer(0)
+	, _textVertexBufferCapacity(0)
+	, _deferredRecording(deferredRecording)
+	, _replayingSmallFrames(false)
+{
+	_constantBufferRing = std::make_unique<ConstantBufferRing>(_renderingContext->_device, _renderingContext->_deviceContext, _renderingContext->_deviceContext1, CONSTANT_BUFFER_RING_CAPACITY);
+
+	LoadShaders();
+	EnsureTextVertexCapacity(INITIAL_TEXT_VERTEX_CAPACITY);
+
+	// Bound every frame, so they have to exist before the first grid arrives
+	const UINT noLights[2] = {};
+	UploadStructuredBuffer(_lightGridBuffers[0], noLights, sizeof(PointLight), 0);
+	UploadStructuredBuffer(_lightGridBuffers[1], noLights, sizeof(ClusteredLightGrid::ClusterLightRange), 0);
+	UploadStructuredBuffer(_lightGridBuffers[2], noLights, sizeof(UINT), 0);
+
+	_frameStartState._shader = _activeShaderType;
+	_frameStartState._shaderVariant = _activeShaderVariant;
+	_frameStartState._depthStencilEnabled = true;
+	_frameStartState._wireframe = false;
+
+	// Deferred contexts can not map the constant ring with no-overwrite, so recorded draws only bind slices 
+	// that are written up front on the immediate context
+	if (_deferredRecording && !_constantBufferRing->IsEnabled())
+	{
+		OutputDebugString("Deferred recording needs constant buffer offsetting, falling back to immediate recording\n");
+		_deferredRecording = false;
+	}
+
+	if (_deferredRecording)
+	{
+		D3D11_FEATURE_DATA_THREADING threadingSupport = {};
+		HR(_renderingContext->_device->CheckFeatureSupport(D3D11_FEATURE_THREADING, &threadingSupport, sizeof(threadingSupport)));
+		OutputDebugString(threadingSupport.DriverCommandLists ? "Driver supports command lists natively\n" : "Command lists are emulated by the runtime\n");
+
+		_threadPool = std::make_unique<ThreadPool>();
+
+		// One deferred context per thread that can take part in recording, the calling one included
+		const auto contextCount = _threadPool->GetWorkerCount() + 1;
+		_deferredContexts.resize(contextCount);
+		_deferredContexts1.resize(contextCount);
+		_commandLists.resize(contextCount);
+		for (auto i = 0U; i < contextCount; ++i)
+		{
+			HR(_renderingContext->_device->CreateDeferredContext(0, _deferredContexts[i].GetAddressOf()));
+			HR(_deferredContexts[i].As(&_deferredContexts1[i]));
+		}
+	}
+}
+
+D3D11RenderDevice::~D3D11RenderDevice()
+{
+}
+
+void D3D11RenderDevice::OnResize()
+{
+	_renderingContext->OnResize();
+}
+
+void D3D11RenderDevice::ClearViews()
+{
+	// Clears go straight to the immediate context and therefore ahead of any buffered draw
+	assert(_deferredCommands.empty());
+
+	float bkgcol[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	_renderingContext->_deviceContext->ClearRenderTargetView(_renderingContext->_renderTargetView.Get(), bkgcol);
+	_renderingContext->_deviceContext->ClearDepthStencilView(_renderingContext->_depthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+}
+
+void D3D11RenderDevice::Present()
+{
+	if (_deferredRecording)
+	{
+		ExecuteDeferredCommands();
+	}
+
+	HR(_renderingContext->_swapChain->Present(1, 0));
+
+	_constantBufferRing->OnFrameEnd();
+	_frameStats._bytesUploaded += _constantBufferRing->GetBytesUploadedLastFrame();
+
+	_lastFrameStats = _frameStats;
+	_frameStats = FrameStats();
+}
+
+void D3D11RenderDevice::SetShader(const Shader::ShaderType shader, const UINT variant)
+{
+	assert(variant < _shaders[shader]->getVariantCount());
+
+	if (_activeShaderType != shader || _activeShaderVariant != variant)
+	{
+		_frameStats._stateChangeCount++;
+	}
+
+	_activeShaderType = shader;
+	_activeShaderVariant = variant;
+
+	if (_deferredRecording)
+	{
+		DeferredCommand command = {};
+		command._type = DeferredCommand::Type::SET_SHADER;
+		command._shader = shader;
+		command._shaderVariant = variant;
+		BufferCommand(command);
+	}
+}
+
+void D3D11RenderDevice::SetDepthStencilEnabled(const bool depthStencilEnabled)
+{
+	_frameStats._stateChangeCount++;
+
+	if (_deferredRecording)
+	{
+		DeferredCommand command = {};
+		command._type = DeferredCommand::Type::SET_DEPTH_STENCIL_ENABLED;
+		command._flag = depthStencilEnabled;
+		BufferCommand(command);
+		return;
+	}
+
+	_renderingContext->SetDepthStencilEnabled(_renderingContext->_deviceContext.Get(), depthStencilEnabled);
+}
+
+void D3D11RenderDevice::SetWireframe(const bool wireframe)
+{
+	_frameStats._stateChangeCount++;
+
+	if (_deferredRecording)
+	{
+		DeferredCommand command = {};
+		command._type = DeferredCommand::Type::SET_WIREFRAME;
+		command._flag = wireframe;
+		BufferCommand(command);
+		return;
+	}
+
+	_renderingContext->SetWireframe(_renderingContext->_deviceContext.Get(), wireframe);
+}
+
+void D3D11RenderDevice::UpdatePerFrameConstants(const Shader::ShaderType shader, const void* perFrameConstantBufferData, const UINT byteSize)
+{
+	// Also immediate when recording deferred: the update lands before every command list of the frame 
+	// executes, which is correct as long as it happens once per frame
+	const auto& targetShader = _shaders[shader];
+	if (targetShader->getPerFrameConstantBuffer())
+	{
+		assert(byteSize == targetShader->getPerFrameConstantBufferSize());
+		_constantBufferRing->UploadWhole(targetShader->getPerFrameConstantBuffer(), perFrameConstantBufferData, byteSize);
+	}
+}
+
+void D3D11RenderDevice::UpdateLightGrid(const ClusteredLightGrid& lightGrid)
+{
+	// Immediate for the same reason as UpdatePerFrameConstants
+	const auto& lights = lightGrid.GetLights();
+	const auto& clusterLightRanges = lightGrid.GetClusterLightRanges();
+	const auto& lightIndices = lightGrid.GetLightIndices();
+
+	UploadStructuredBuffer(_lightGridBuffers[0], lights.data(), sizeof(PointLight), static_cast<UINT>(lights.size()));
+	UploadStructuredBuffer(_lightGridBuffers[1], clusterLightRanges.data(), sizeof(ClusteredLightGrid::ClusterLightRange), static_cast<UINT>(clusterLightRanges.size()));
+	UploadStructuredBuffer(_lightGridBuffers[2], lightIndices.data(), sizeof(UINT), static_cast<UINT>(lightIndices.size()));
+}
+
+void D3D11RenderDevice::DrawModel(const Model& model, const void* constantBufferData, const UINT byteSize)
+{
+	auto& activeShader = _shaders[_activeShaderType];
+	assert(byteSize == activeShader->getConstantBufferSize());
+
+	// Meshes in the compact vertex format go through the shader's PACKED_VERTEX variant
+	assert(!model.HasPackedVertices() || activeShader->getPackedVertexShader());
+
+	_frameStats._drawCount++;
+
+	if (_deferredRecording)
+	{
+		DeferredCommand command = {};
+		command._type = DeferredCommand::Type::DRAW_MODEL;
+		command._model = &model;
+		command._constantDataOffset = static_cast<UINT>(_deferredConstantData.size());
+		command._constantDataSize = byteSize;
+		BufferCommand(command);
+
+		const auto* constantBytes = static_cast<const BYTE*>(constantBufferData);
+		_deferredConstantData.insert(_deferredConstantData.end(), constantBytes, constantBytes + byteSize);
+		return;
+	}
+
+	auto* deviceContext = _renderingContext->_deviceContext.Get();
+	BindModelPipeline(deviceContext, *activeShader, _activeShaderVariant, model);
+
+	// Per object constants are sub-allocated from the upload ring when the device supports
+	// constant buffer offsets, otherwise they are written to the shader's own dynamic buffer
+	if (_constantBufferRing->IsEnabled())
+	{
+		const auto slice = _constantBufferRing->Allocate(constantBufferData, byteSize);
+		_constantBufferRing->BindSlice(0, slice);
+	}
+	else
+	{
+		_constantBufferRing->UploadWhole(activeShader->getConstantBuffer(), constantBufferData, byteSize);
+		deviceContext->VSSetConstantBuffers(0, 1, activeShader->getConstantBuffer().GetAddressOf());
+		deviceContext->PSSetConstantBuffers(0, 1, activeShader->getConstantBuffer().GetAddressOf());
+	}
+
+	BindPerFrameConstants(deviceContext, *activeShader);
+	deviceContext->DrawIndexed(model.GetIndexCount(), 0, 0);
+}
+
+void D3D11RenderDevice::DrawTextVertices(const std::vector<TextVertex>& vertices, const TextureViewHandle fontTexture)
+{
+	const comptr<ID3D11ShaderResourceView> fontTextureView(static_cast<ID3D11ShaderResourceView*>(fontTexture._view));
+
+	const auto vertexCount = static_cast<UINT>(vertices.size());
+	if (vertexCount == 0)
+	{
+		return;
+	}
+
+	_frameStats._drawCount++;
+	_frameStats._bytesUploaded += sizeof(TextVertex) * vertexCount;
+
+	if (_deferredRecording)
+	{
+		DeferredCommand command = {};
+		command._type = DeferredCommand::Type::DRAW_TEXT;
+		command._firstTextVertex = static_cast<UINT>(_deferredTextVertices.size());
+		command._textVertexCount = vertexCount;
+		command._texture = fontTextureView;
+		BufferCommand(command);
+
+		_deferredTextVertices.insert(_deferredTextVertices.end(), vertices.begin(), vertices.end());
+		return;
+	}
+
+	// All glyph quads of the frame go to the dynamic vertex buffer in one discard map
+	UploadTextVertices(vertices);
+	IssueDrawText(_renderingContext->_deviceContext.Get(), 0, vertexCount, fontTextureView);
+}
+
+const RenderDevice::FrameStats& D3D11RenderDevice::GetLastFrameStats() const
+{
+	return _lastFrameStats;
+}
+
+RenderDevice::DeviceHandle D3D11RenderDevice::GetDeviceHandle() const
+{
+	return { _renderingContext->_device.Get() };
+}
+
+void D3D11RenderDevice::LoadShaders()
+{
+	const auto loadStart = std::chrono::high_resolution_clock::now();
+	const auto cacheHitsBefore = shader_cache::GetHitCount();
+	const auto cacheMissesBefore = shader_cache::GetMissCount();
+
+	_shaders.clear();
+	_shaders.resize(Shader::ShaderType::SHADER_COUNT);
+
+	// Shader types compile (or load from the bytecode cache) independently of each other and device object
+	// creation is free threaded, so each type is prepared on its own thread
+	ThreadPool loadThreadPool(Shader::ShaderType::SHADER_COUNT - 1);
+	loadThreadPool.ParallelFor(Shader::ShaderType::SHADER_COUNT, [this](const UINT shaderIndex)
+	{
+		_shaders[shaderIndex] = CreateShader(static_cast<Shader::ShaderType>(shaderIndex));
+	});
+
+	const auto loadEnd = std::chrono::high_resolution_clock::now();
+
+	std::stringstream loadStream;
+	loadStream << "Shaders loaded in " << std::chrono::duration<FLOAT, std::milli>(loadEnd - loadStart).count() << "ms ("
+	           << shader_cache::GetHitCount() - cacheHitsBefore << " from cache, " 
+	           << shader_cache::GetMissCount() - cacheMissesBefore << " compiled)\n";
+	OutputDebugString(loadStream.str().c_str());
+}
+
+std::unique_ptr<Shader> D3D11RenderDevice::CreateShader(const Shader::ShaderType shader) const
+{
+	switch (shader)
+	{
+		case Shader::ShaderType::DEFAULT_3D: return std::unique_ptr<Shader>(new Default3dShader(_renderingContext->_device));
+		case Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING: return std::unique_ptr<Shader>(new Default3dWithLightingShader(_renderingContext->_device));
+		case Shader::ShaderType::DEFAULT_UI: return std::unique_ptr<Shader>(new DefaultUiShader(_renderingContext->_device));
+		case Shader::ShaderType::DEFAULT_TEXT: return std::unique_ptr<Shader>(new DefaultTextShader(_renderingContext->_device));
+		default: return nullptr;
+	}
+}
+
+void D3D11RenderDevice::EnsureTextVertexCapacity(const UINT vertexCount)
+{
+	if (vertexCount <= _textVertexBufferCapacity)
+	{
+		return;
+	}
+
+	// Grow geometrically so that long debug outputs do not recreate the buffer every frame
+	auto newCapacity = _textVertexBufferCapacity > 0 ? _textVertexBufferCapacity : INITIAL_TEXT_VERTEX_CAPACITY;
+	while (newCapacity < vertexCount)
+	{
+		newCapacity *= 2;
+	}
+
+	_textVertexBuffer.Reset();
+
+	D3D11_BUFFER_DESC vbd = {};
+	vbd.BindFlags      = D3D11_BIND_VERTEX_BUFFER;
+	vbd.ByteWidth      = sizeof(TextVertex) * newCapacity;
+	vbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	vbd.Usage          = D3D11_USAGE_DYNAMIC;
+
+	HR(_renderingContext->_device->CreateBuffer(&vbd, 0, _textVertexBuffer.GetAddressOf()));
+	_textVertexBufferCapacity = newCapacity;
+}
+
+void D3D11RenderDevice::UploadTextVertices(const std::vector<TextVertex>& vertices)
+{
+	const auto vertexCount = static_cast<UINT>(vertices.size());
+	EnsureTextVertexCapacity(vertexCount);
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource = {};
+	HR(_renderingContext->_deviceContext->Map(_textVertexBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
+	std::memcpy(mappedResource.pData, &vertices[0], sizeof(TextVertex) * vertexCount);
+	_renderingContext->_deviceContext->Unmap(_textVertexBuffer.Get(), 0);
+}
+
+void D3D11RenderDevice::UploadStructuredBuffer(StructuredBuffer& structuredBuffer, const void* data, const UINT elementSize, const UINT elementCount)
+{
+	// Buffers are never empty so that the views stay valid to bind
+	const auto requiredCapacity = elementCount > 0 ? elementCount : 1;
+	if (requiredCapacity > structuredBuffer._capacity)
+	{
+		auto newCapacity = structuredBuffer._capacity > 0 ? structuredBuffer._capacity : 1;
+		while (newCapacity < requiredCapacity)
+		{
+			newCapacity *= 2;
+		}
+
+		structuredBuffer._view.Reset();
+		structuredBuffer._buffer.Reset();
+
+		D3D11_BUFFER_DESC sbd = {};
+		sbd.BindFlags           = D3D11_BIND_SHADER_RESOURCE;
+		sbd.ByteWidth           = elementSize * newCapacity;
+		sbd.CPUAccessFlags      = D3D11_CPU_ACCESS_WRITE;
+		sbd.Usage               = D3D11_USAGE_DYNAMIC;
+		sbd.MiscFlags           = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+		sbd.StructureByteStride = elementSize;
+
+		HR(_renderingContext->_device->CreateBuffer(&sbd, 0, structuredBuffer._buffer.GetAddressOf()));
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvd = {};
+		srvd.Format             = DXGI_FORMAT_UNKNOWN;
+		srvd.ViewDimension      = D3D11_SRV_DIMENSION_BUFFER;
+		srvd.Buffer.NumElements = newCapacity;
+
+		HR(_renderingContext->_device->CreateShaderResourceView(structuredBuffer._buffer.Get(), &srvd, structuredBuffer._view.GetAddressOf()));
+		structuredBuffer._capacity = newCapacity;
+	}
+
+	if (elementCount == 0)
+	{
+		return;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource = {};
+	HR(_renderingContext->_deviceContext->Map(structuredBuffer._buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
+	std::memcpy(mappedResource.pData, data, elementSize * elementCount);
+	_renderingContext->_deviceContext->Unmap(structuredBuffer._buffer.Get(), 0);
+
+	_frameStats._bytesUploaded += elementSize * elementCount;
+}
+
+void D3D11RenderDevice::BindModelPipeline(ID3D11DeviceContext* context, const Shader& shader, const UINT variant, const Model& model) const
+{
+	const auto packedVertices = model.HasPackedVertices();
+
+	auto stride = model.GetVertexStride();
+	auto offset = 0U;
+
+	// Input Assembly Stage
+	context->IASetInputLayout(packedVertices ? shader.getPackedInputLayout().Get() : shader.getInputLayout().Get());
+	context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	context->IASetVertexBuffers(0, 1, model.GetVertexBuffer().GetAddressOf(), &stride, &offset);
+	context->IASetIndexBuffer(model.GetIndexBuffer().Get(), model.GetIndexFormat(), 0);
+
+	// Vertex and Pixel Shader Stages
+	context->VSSetShader(packedVertices ? shader.getPackedVertexShader(variant).Get() : shader.getVertexShader(variant).Get(), 0, 0);
+	context->PSSetShader(shader.getPixelShader(variant).Get(), 0, 0);
+	context->PSSetShaderResources(0, 1, model.GetTexture().GetAddressOf());
+}
+
+void D3D11RenderDevice::BindPerFrameConstants(ID3D11DeviceContext* context, const Shader& shader) const
+{
+	// Per frame data lives in slot 1 for the shaders that declare it
+	if (shader.getPerFrameConstantBuffer())
+	{
+		context->VSSetConstantBuffers(1, 1, shader.getPerFrameConstantBuffer().GetAddressOf());
+		context->PSSetConstantBuffers(1, 1, shader.getPerFrameConstantBuffer().GetAddressOf());
+
+		ID3D11ShaderResourceView* lightGridViews[] = { _lightGridBuffers[0]._view.Get(), _lightGridBuffers[1]._view.Get(), _lightGridBuffers[2]._view.Get() };
+		context->PSSetShaderResources(1, 3, lightGridViews);
+	}
+}
+
+void D3D11RenderDevice::IssueDrawText(ID3D11DeviceContext* context, const UINT firstVertex, const UINT vertexCount, comptr<ID3D11ShaderResourceView> fontTexture) const
+{
+	const auto& textShader = _shaders[Shader::ShaderType::DEFAULT_TEXT];
+
+	auto stride = sizeof(TextVertex);
+	auto offset = 0U;
+
+	// Input Assembly Stage
+	context->IASetInputLayout(textShader->getInputLayout().Get());
+	context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	context->IASetVertexBuffers(0, 1, _textVertexBuffer.GetAddressOf(), &stride, &offset);
+
+	// Vertex and Pixel Shader Stages
+	context->VSSetShader(textShader->getVertexShader().Get(), 0, 0);
+	context->PSSetShader(textShader->getPixelShader().Get(), 0, 0);
+	context->PSSetShaderResources(0, 1, fontTexture.GetAddressOf());
+
+	_renderingContext->SetDepthStencilEnabled(context, false);
+	context->Draw(vertexCount, firstVertex);
+	_renderingContext->SetDepthStencilEnabled(context, true);
+}
+
+void D3D11RenderDevice::BufferCommand(const DeferredCommand& command)
+{
+	_deferredCommands.push_back(command);
+}
+
+void D3D11RenderDevice::ExecuteDeferredCommands()
+{
+	if (_deferredCommands.empty())
+	{
+		return;
+	}
+
+	// Write every draw's constants to the ring up front. Nothing may wrap the ring before the command lists 
+	// referencing the slices execute, so the frame either fits contiguously or is replayed immediately.
+	auto totalConstantSize = 0U;
+	for (const auto& command: _deferredCommands)
+	{
+		if (command._type == DeferredCommand::Type::DRAW_MODEL)
+		{
+			totalConstantSize += _constantBufferRing->GetAlignedSize(command._constantDataSize);
+		}
+	}
+
+	const auto constantsFit = _constantBufferRing->ReserveContiguous(totalConstantSize);
+	for (auto& command: _deferredCommands)
+	{
+		if (command._type == DeferredCommand::Type::DRAW_MODEL && constantsFit)
+		{
+			command._slice = _constantBufferRing->Allocate(&_deferredConstantData[command._constantDataOffset], command._constantDataSize);
+		}
+	}
+
+	if (!_deferredTextVertices.empty())
+	{
+		UploadTextVertices(_deferredTextVertices);
+	}
+
+	auto drawCount = 0U;
+	std::vector<UINT> commandCosts(_deferredCommands.size());
+	for (auto i = 0U; i < commandCosts.size(); ++i)
+	{
+		const auto type = _deferredCommands[i]._type;
+		commandCosts[i] = type == DeferredCommand::Type::DRAW_MODEL || type == DeferredCommand::Type::DRAW_TEXT ? 1 : 0;
+		drawCount += commandCosts[i];
+	}
+
+	const auto ranges = work_partitioner::PartitionByCost(commandCosts, static_cast<UINT>(_deferredContexts.size()), MIN_DRAWS_PER_COMMAND_LIST);
+
+	// Logged when frames start or stop fitting in a single command list, rather than every frame
+	const auto replayingSmallFrame = ranges.size() == 1;
+	if (constantsFit && replayingSmallFrame != _replayingSmallFrames)
+	{
+		std::ostringstream fallbackStream;
+		if (replayingSmallFrame)
+		{
+			fallbackStream << "Deferred recording: " << drawCount << " draws are too few for two command lists of at least " << MIN_DRAWS_PER_COMMAND_LIST << ", replaying frames on the immediate context\n";
+		}
+		else
+		{
+			fallbackStream << "Deferred recording: " << drawCount << " draws split over " << ranges.size() << " command lists\n";
+		}
+		OutputDebugString(fallbackStream.str().c_str());
+		_replayingSmallFrames = replayingSmallFrame;
+	}
+
+	// Each chunk starts recording from the state the commands before it leave behind
+	std::vector<PipelineState> initialStates(ranges.size());
+	auto state = _frameStartState;
+	auto rangeIndex = 0U;
+	for (auto i = 0U; i < _deferredCommands.size(); ++i)
+	{
+		if (rangeIndex < ranges.size() && ranges[rangeIndex]._begin == i)
+		{
+			initialStates[rangeIndex++] = state;
+		}
+		AdvancePipelineState(_deferredCommands[i], state);
+	}
+
+	if (!constantsFit || ranges.size() == 1)
+	{
+		// Not worth (or not possible) spreading over threads, replay on the immediate context. Its state was 
+		// reset by the last command list execution, so restore it first.
+		if (!constantsFit)
+		{
+			OutputDebugString("Frame constants exceed the upload ring, replaying the frame on the immediate context\n");
+		}
+
+		auto* deviceContext = _renderingContext->_deviceContext.Get();
+		auto replayState = _frameStartState;
+		_renderingContext->ApplyPipelineState(deviceContext, replayState._depthStencilEnabled, replayState._wireframe);
+		for (const auto& command: _deferredCommands)
+		{
+			if (command._type == DeferredCommand::Type::DRAW_MODEL && !constantsFit)
+			{
+				const auto& shader = *_shaders[replayState._shader];
+				BindModelPipeline(deviceContext, shader, replayState._shaderVariant, *command._model);
+				_constantBufferRing->UploadWhole(shader.getConstantBuffer(), &_deferredConstantData[command._constantDataOffset], command._constantDataSize);
+				deviceContext->VSSetConstantBuffers(0, 1, shader.getConstantBuffer().GetAddressOf());
+				deviceContext->PSSetConstantBuffers(0, 1, shader.getConstantBuffer().GetAddressOf());
+				BindPerFrameConstants(deviceContext, shader);
+				deviceContext->DrawIndexed(command._model->GetIndexCount(), 0, 0);
+				continue;
+			}
+
+			ReplayDeferredCommand(deviceContext, _renderingContext->_deviceContext1.Get(), command, replayState);
+		}
+	}
+	else
+	{
+		_threadPool->ParallelFor(static_cast<UINT>(ranges.size()), [this, &ranges, &initialStates](const UINT contextIndex)
+		{
+			RecordDeferredCommands(contextIndex, ranges[contextIndex], initialStates[contextIndex]);
+		});
+
+		// Command lists run in submission order, which keeps the frame identical to an immediate recording
+		for (auto i = 0U; i < ranges.size(); ++i)
+		{
+			_renderingContext->_deviceContext->ExecuteCommandList(_commandLists[i].Get(), FALSE);
+			_commandLists[i].Reset();
+		}
+	}
+
+	_frameStartState = state;
+	_deferredCommands.clear();
+	_deferredConstantData.clear();
+	_deferredTextVertices.clear();
+}
+
+void D3D11RenderDevice::RecordDeferredCommands(const UINT contextIndex, const work_partitioner::Range& range, const PipelineState& initialState)
+{
+	auto* deferredContext = _deferredContexts[contextIndex].Get();
+
+	auto state = initialState;
+	_renderingContext->ApplyPipelineState(deferredContext, state._depthStencilEnabled, state._wireframe);
+
+	for (auto i = range._begin; i < range._end; ++i)
+	{
+		ReplayDeferredCommand(deferredContext, _deferredContexts1[contextIndex].Get(), _deferredCommands[i], state);
+	}
+
+	HR(deferredContext->FinishCommandList(FALSE, _commandLists[contextIndex].ReleaseAndGetAddressOf()));
+}
+
+void D3D11RenderDevice::ReplayDeferredCommand(ID3D11DeviceContext* context, ID3D11DeviceContext1* context1, const DeferredCommand& command, PipelineState& state) const
+{
+	switch (command._type)
+	{
+		case DeferredCommand::Type::SET_DEPTH_STENCIL_ENABLED:
+		{
+			_renderingContext->SetDepthStencilEnabled(context, command._flag);
+		} break;
+
+		case DeferredCommand::Type::SET_WIREFRAME:
+		{
+			_renderingContext->SetWireframe(context, command._flag);
+		} break;
+
+		case DeferredCommand::Type::DRAW_MODEL:
+		{
+			const auto& shader = *_shaders[state._shader];
+			BindModelPipeline(context, shader, state._shaderVariant, *command._model);
+			_constantBufferRing->BindSlice(context1, 0, command._slice);
+			BindPerFrameConstants(context, shader);
+			context->DrawIndexed(command._model->GetIndexCount(), 0, 0);
+		} break;
+
+		case DeferredCommand::Type::DRAW_TEXT:
+		{
+			IssueDrawText(context, command._firstTextVertex, command._textVertexCount, command._texture);
+		} break;
+
+		default: break;
+	}
+
+	AdvancePipelineState(command, state);
+}
+
+void D3D11RenderDevice::AdvancePipelineState(const DeferredCommand& command, PipelineState& state)
+{
+	switch (command._type)
+	{
+		case DeferredCommand::Type::SET_SHADER: state._shader = command._shader; state._shaderVariant = command._shaderVariant; break;
+		case DeferredCommand::Type::SET_DEPTH_STENCIL_ENABLED: state._depthStencilEnabled = command._flag; break;
+		case DeferredCommand::Type::SET_WIREFRAME: state._wireframe = command._flag; break;
+
+		// Text drawing leaves depth testing enabled behind it
+		case DeferredCommand::Type::DRAW_TEXT: state._depthStencilEnabled = true; break;
+		default: break;
+	}
+}
\ No newline at end of file
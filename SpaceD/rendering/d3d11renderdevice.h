@@ -0,0 +1,148 @@
+/*************************************************************************/
+/** d3d11renderdevice.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                   **/
+/*************************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "d3dcommon.h"
+#include "renderdevice.h"
+#include "constantbufferring.h"
+#include "shaders/shader.h"
+#include "../util/workpartitioner.h"
+
+// Remote Headers
+#include <memory>
+#include <vector>
+
+// Forward declarations
+class RenderingContext;
+class ClientWindow;
+class ThreadPool;
+
+class D3D11RenderDevice final: public RenderDevice
+{
+public:
+	// With deferred recording, the commands of a frame are buffered and, on Present, recorded into deferred contexts 
+	// by worker threads in contiguous chunks of roughly equal draw count. The resulting command lists are then 
+	// executed in order on the immediate context. Requires constant buffer offsetting; the device falls back to 
+	// immediate recording when it is unavailable.
+	D3D11RenderDevice(ClientWindow& clientWindow, const bool deferredRecording = false);
+	~D3D11RenderDevice();
+
+	void OnResize() override;
+	void ClearViews() override;
+	void Present() override;
+
+	void SetShader(const Shader::ShaderType shader, const UINT variant) override;
+	void SetDepthStencilEnabled(const bool depthStencilEnabled) override;
+	void SetWireframe(const bool wireframe) override;
+
+	void UpdatePerFrameConstants(const Shader::ShaderType shader, const void* perFrameConstantBufferData, const UINT byteSize) override;
+	void UpdateLightGrid(const ClusteredLightGrid& lightGrid) override;
+	void DrawModel(const Model& model, const void* constantBufferData, const UINT byteSize) override;
+	void DrawTextVertices(const std::vector<TextVertex>& vertices, const TextureViewHandle fontTexture) override;
+
+	const FrameStats& GetLastFrameStats() const override;
+
+	DeviceHandle GetDeviceHandle() const override;
+
+private:
+	struct PipelineState
+	{
+		Shader::ShaderType _shader;
+		UINT _shaderVariant;
+		bool _depthStencilEnabled;
+		bool _wireframe;
+	};
+
+	// Dynamic structured buffer, grown as needed and rewritten every frame
+	struct StructuredBuffer
+	{
+		StructuredBuffer()
+			: _capacity(0)
+		{
+		}
+
+		comptr<ID3D11Buffer> _buffer;
+		comptr<ID3D11ShaderResourceView> _view;
+		UINT _capacity;
+	};
+
+	// A command buffered for deferred recording. Models are referenced, not copied, and must outlive the frame.
+	struct DeferredCommand
+	{
+		enum class Type
+		{
+			SET_SHADER,
+			SET_DEPTH_STENCIL_ENABLED,
+			SET_WIREFRAME,
+			DRAW_MODEL,
+			DRAW_TEXT
+		};
+
+		Type _type;
+		Shader::ShaderType _shader;
+		UINT _shaderVariant;
+		bool _flag;
+		const Model* _model;
+		UINT _constantDataOffset;
+		UINT _constantDataSize;
+		ConstantBufferRing::Slice _slice;
+		UINT _firstTextVertex;
+		UINT _textVertexCount;
+		comptr<ID3D11ShaderResourceView> _texture;
+	};
+
+private:
+	void LoadShaders();
+	std::unique_ptr<Shader> CreateShader(const Shader::ShaderType shader) const;
+	void EnsureTextVertexCapacity(const UINT vertexCount);
+	void UploadTextVertices(const std::vector<TextVertex>& vertices);
+	void UploadStructuredBuffer(StructuredBuffer& structuredBuffer, const void* data, const UINT elementSize, const UINT elementCount);
+
+	void BindModelPipeline(ID3D11DeviceContext* context, const Shader& shader, const UINT variant, const Model& model) const;
+	void BindPerFrameConstants(ID3D11DeviceContext* context, const Shader& shader) const;
+	void IssueDrawText(ID3D11DeviceContext* context, const UINT firstVertex, const UINT vertexCount, comptr<ID3D11ShaderResourceView> fontTexture) const;
+
+	void BufferCommand(const DeferredCommand& command);
+	void ExecuteDeferredCommands();
+	void RecordDeferredCommands(const UINT contextIndex, const work_partitioner::Range& range, const PipelineState& initialState);
+	void ReplayDeferredCommand(ID3D11DeviceContext* context, ID3D11DeviceContext1* context1, const DeferredCommand& command, PipelineState& state) const;
+	static void AdvancePipelineState(const DeferredCommand& command, PipelineState& state);
+
+private:
+	static const UINT CONSTANT_BUFFER_RING_CAPACITY;
+	static const UINT INITIAL_TEXT_VERTEX_CAPACITY;
+	// Fewest draws worth a command list of their own. Frames draw a few dozen models and text runs, so this has to 
+	// stay small for them to be split over more than one list at all.
+	static const UINT MIN_DRAWS_PER_COMMAND_LIST;
+
+private:
+	std::unique_ptr<RenderingContext> _renderingContext;
+	std::unique_ptr<ConstantBufferRing> _constantBufferRing;
+	std::vector<std::unique_ptr<Shader>> _shaders;
+	Shader::ShaderType _activeShaderType;
+	UINT _activeShaderVariant;
+
+	comptr<ID3D11Buffer> _textVertexBuffer;
+	UINT _textVertexBufferCapacity;
+
+	// Point lights, per cluster light ranges and light indices of the ClusteredLightGrid, at pixel shader slots t1-t3
+	StructuredBuffer _lightGridBuffers[3];
+
+	bool _deferredRecording;
+	std::unique_ptr<ThreadPool> _threadPool;
+	std::vector<comptr<ID3D11DeviceContext>> _deferredContexts;
+	std::vector<comptr<ID3D11DeviceContext1>> _deferredContexts1;
+	std::vector<comptr<ID3D11CommandList>> _commandLists;
+	std::vector<DeferredCommand> _deferredCommands;
+	std::vector<BYTE> _deferredConstantData;
+	std::vector<TextVertex> _deferredTextVertices;
+	PipelineState _frameStartState;
+	bool _replayingSmallFrames;  // Whether the last frame was too small to split, so that only changes are logged
+
+	FrameStats _frameStats;
+	FrameStats _lastFrameStats;
+};
\ No newline at end of file
@@ -9,6 +9,7 @@
 
 // Remote Headers
 #include <d3d11.h>
+#include <d3d11_1.h>
 #include <wrl/client.h>
 #include <dxerr.h>
 #include <stdio.h>
@@ -7,13 +7,13 @@
 
 // Local Headers
 #include "fontengine.h"
-#include "models/model.h"
-#include "models/glyphmodel.h"
 #include "textureloader.h"
 #include "../util/stringutils.h"
+#include "../util/virtualfilesystem.h"
 
 // Remote Headers
-#include <fstream>
+#include <cctype>
+#include <sstream>
 #include <Windows.h>
 
 // Constants
@@ -37,12 +37,18 @@ void FontEngine::LoadFont(const std::string& name, comptr<ID3D11Device> device)
 {
 	LoadFontTexture(device);
 	LoadConfig();
-	LoadGlyphs(device);
+	LoadGlyphs();
 }
 
-Model& FontEngine::GetGlyph(const std::string& character) const
+const FontEngine::Glyph* FontEngine::GetGlyph(const char character) const
 {
-	return *_glyphs.at(character);
+	const auto& glyph = _glyphTable[static_cast<unsigned char>(character)];
+	return glyph._valid ? &glyph : nullptr;
+}
+
+comptr<ID3D11ShaderResourceView> FontEngine::GetTexture() const
+{
+	return _texture.Get();
 }
 
 FLOAT FontEngine::GetSize() const
@@ -66,24 +72,31 @@ void FontEngine::LoadConfig()
 
 	const auto fontConfigPath = FONT_DIRECTORY + _name + "/" + _name + FONT_CFG_EXT;
 
-	std::ifstream fileStream(fontConfigPath);
+	const VirtualFile fontConfigFile(fontConfigPath);
 
-	if (!fileStream.is_open())
+	if (!fontConfigFile.IsOpen())
 	{
 		MessageBox(0, (std::string("Font: ") + fontConfigPath + " was not found").c_str(), 0, MB_ICONWARNING);
 		return;
 	}
 
+	// Read as raw bytes, so line endings checked out as CRLF are trimmed by hand
+	std::istringstream fileStream(std::string(reinterpret_cast<const char*>(fontConfigFile.GetData()), fontConfigFile.GetSize()));
 	std::string line;
 	while (std::getline(fileStream, line))
 	{
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+
 		_fontConfig.push_back(string_utils::split(line, ' '));
 	}
 }
 
-void FontEngine::LoadGlyphs(comptr<ID3D11Device> device)
+void FontEngine::LoadGlyphs()
 {	
-	_glyphs.clear();
+	ZeroMemory(_glyphTable, sizeof(_glyphTable));
 
 	const auto TEX_ROWS       = _fontConfig.size();
 	const auto TEX_COLS       = _fontConfig[0].size();
@@ -91,22 +104,23 @@ void FontEngine::LoadGlyphs(comptr<ID3D11Device> device)
 
 	for (auto i = 0U; i < TEX_ROWS; ++i)
 	{
-		const auto innerVec = _fontConfig[i];
-		for (auto j = 0U; j < TEX_COLS; ++j)
+		for (auto j = 0U; j < TEX_COLS && j < _fontConfig[i].size(); ++j)
 		{
-			std::vector<XMFLOAT2> glyphTexCoords;
-			glyphTexCoords.push_back(XMFLOAT2(j * TEX_GLYPH_SIZE + TEX_GLYPH_SIZE, i * TEX_GLYPH_SIZE + TEX_GLYPH_SIZE)); // bottom right
-			glyphTexCoords.push_back(XMFLOAT2(j * TEX_GLYPH_SIZE,                  i * TEX_GLYPH_SIZE));                  // top left
-			glyphTexCoords.push_back(XMFLOAT2(j * TEX_GLYPH_SIZE,                  i * TEX_GLYPH_SIZE + TEX_GLYPH_SIZE)); // bottom left
-			glyphTexCoords.push_back(XMFLOAT2(j * TEX_GLYPH_SIZE + TEX_GLYPH_SIZE, i * TEX_GLYPH_SIZE));                  // top right
-
-			const auto targetLetter = _fontConfig[i][j];
-			_glyphs[targetLetter] = std::move(std::unique_ptr<Model>(new GlyphModel(targetLetter, glyphTexCoords)));
-			_glyphs[targetLetter]->LoadModelComponents(device);
-			_glyphs[targetLetter]->SetTexture(_texture);
-			_glyphs[targetLetter]->GetTransform()._scale = XMFLOAT3(_size, _size, _size);
+			const auto& targetLetter = _fontConfig[i][j];
+			if (targetLetter.size() != 1)
+			{
+				continue;
+			}
+
+			Glyph glyph;
+			glyph._topLeftTexcoords     = XMFLOAT2(j * TEX_GLYPH_SIZE, i * TEX_GLYPH_SIZE);
+			glyph._bottomRightTexcoords = XMFLOAT2(j * TEX_GLYPH_SIZE + TEX_GLYPH_SIZE, i * TEX_GLYPH_SIZE + TEX_GLYPH_SIZE);
+			glyph._valid                = true;
+
+			// The font only ships upper case glyphs, so lower case characters resolve to the same entry
+			const auto character = static_cast<unsigned char>(targetLetter[0]);
+			_glyphTable[character] = glyph;
+			_glyphTable[static_cast<unsigned char>(std::tolower(character))] = glyph;
 		}
 	}
-}
-
-	
+}
\ No newline at end of file
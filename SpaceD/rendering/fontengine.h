@@ -7,24 +7,33 @@
 
 // Local Headers
 #include "d3dcommon.h"
+#include "textureloader.h"
+#include "../util/math.h"
 
 // Remote Headers
 #include <memory>
 #include <string>	
-#include <unordered_map>
 #include <vector>
 
-class Model;
-
 class FontEngine final
 {
+public:
+	struct Glyph
+	{
+		XMFLOAT2 _topLeftTexcoords;
+		XMFLOAT2 _bottomRightTexcoords;
+		bool _valid;
+	};
+
 public:
 	FontEngine(const std::string& name, comptr<ID3D11Device> device);
 	~FontEngine();
 
 	void LoadFont(const std::string& name, comptr<ID3D11Device> device);
 	
-	Model& GetGlyph(const std::string& character) const;
+	// Returns null for characters the font does not define
+	const Glyph* GetGlyph(const char character) const;
+	comptr<ID3D11ShaderResourceView> GetTexture() const;
 	
 	FLOAT GetSize() const;
 	void SetSize(const FLOAT size);
@@ -32,18 +41,19 @@ public:
 private:
 	void LoadFontTexture(comptr<ID3D11Device> device);
 	void LoadConfig();
-	void LoadGlyphs(comptr<ID3D11Device> device);
+	void LoadGlyphs();
 
 private:
 	static const std::string FONT_DIRECTORY;
 	static const std::string FONT_CFG_EXT;
 	static const std::string FONT_TEXTURE_EXT;
+	static const UINT GLYPH_TABLE_SIZE = 256U;
 
 private:
 	FLOAT _size;
 	std::string _name;
-	std::unordered_map<std::string, std::unique_ptr<Model>> _glyphs;
+	Glyph _glyphTable[GLYPH_TABLE_SIZE];
 	std::vector<std::vector<std::string>> _fontConfig;
 
-	comptr<ID3D11ShaderResourceView> _texture;
+	TextureHandle _texture;
 };
\ No newline at end of file
@@ -0,0 +1,79 @@
+/***********************************************************************/
+/** lightselector.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                 **/
+/***********************************************************************/
+
+// Local Headers
+#include "lightselector.h"
+
+// Remote Headers
+#include <cassert>
+#include <cmath>
+
+namespace light_selector
+{
+	namespace
+	{
+		// Upper bound for the selection size, so that the candidate list can live on the stack
+		const UINT MAX_SELECTABLE_LIGHTS = 16U;
+	}
+
+	FLOAT EstimateInfluence(const PointLight& light, const XMFLOAT3& sphereCenter, const FLOAT sphereRadius)
+	{
+		const auto dx = light._position.x - sphereCenter.x;
+		const auto dy = light._position.y - sphereCenter.y;
+		const auto dz = light._position.z - sphereCenter.z;
+
+		// Distance from the light to the sphere's surface, zero when the light is inside it
+		auto distance = std::sqrt(dx * dx + dy * dy + dz * dz) - sphereRadius;
+		distance = distance > 0.0f ? distance : 0.0f;
+
+		// Same range test the pixel shader applies
+		if (distance > light._range)
+		{
+			return 0.0f;
+		}
+
+		const auto attenuation = light._att.x + light._att.y * distance + light._att.z * distance * distance;
+		const auto intensity = 0.299f * light._diffuse.x + 0.587f * light._diffuse.y + 0.114f * light._diffuse.z;
+
+		return attenuation > 0.0f ? intensity / attenuation : intensity;
+	}
+
+	UINT SelectPointLights(const PointLight* lights, const UINT lightCount, const XMFLOAT3& sphereCenter, const FLOAT sphereRadius, 
+	                       const UINT maxSelectedCount, UINT* outSelectedIndices)
+	{
+		assert(maxSelectedCount <= MAX_SELECTABLE_LIGHTS);
+
+		// Insertion into a small sorted list; the selection size is tiny, so this beats any heap
+		FLOAT selectedInfluences[MAX_SELECTABLE_LIGHTS];
+		auto selectedCount = 0U;
+
+		for (auto lightIndex = 0U; lightIndex < lightCount; ++lightIndex)
+		{
+			const auto influence = EstimateInfluence(lights[lightIndex], sphereCenter, sphereRadius);
+			if (influence <= 0.0f)
+			{
+				continue;
+			}
+
+			if (selectedCount == maxSelectedCount && influence <= selectedInfluences[selectedCount - 1])
+			{
+				continue;
+			}
+
+			auto insertPosition = selectedCount < maxSelectedCount ? selectedCount++ : selectedCount - 1;
+			while (insertPosition > 0 && selectedInfluences[insertPosition - 1] < influence)
+			{
+				selectedInfluences[insertPosition] = selectedInfluences[insertPosition - 1];
+				outSelectedIndices[insertPosition] = outSelectedIndices[insertPosition - 1];
+				insertPosition--;
+			}
+
+			selectedInfluences[insertPosition] = influence;
+			outSelectedIndices[insertPosition] = lightIndex;
+		}
+
+		return selectedCount;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+/*********************************************************************/
+/** lightselector.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                               **/
+/*********************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "lightdef.h"
+
+// Remote Headers
+
+namespace light_selector
+{
+	// Estimated diffuse contribution of a point light to the closest point of a bounding sphere, 
+	// using the light's own range cut off and attenuation. Zero when the light can not reach the sphere.
+	FLOAT EstimateInfluence(const PointLight& light, const XMFLOAT3& sphereCenter, const FLOAT sphereRadius);
+
+	// Writes the indices of up to maxSelectedCount lights with the highest influence on the sphere to 
+	// outSelectedIndices, most influential first, and returns how many were written. Lights that can 
+	// not reach the sphere are never selected.
+	UINT SelectPointLights(const PointLight* lights, const UINT lightCount, const XMFLOAT3& sphereCenter, const FLOAT sphereRadius, 
+	                       const UINT maxSelectedCount, UINT* outSelectedIndices);
+}
\ No newline at end of file
@@ -0,0 +1,170 @@
+/********************************************************************/
+/** meshfile.cpp by Alex Koukoulas (C) 2017 All Rights Reserved    **/
+/** File Description:                                              **/
+/********************************************************************/
+
+// Local Headers
+#include "meshfile.h"
+#include "meshoptimizer.h"
+#include "vertexpacking.h"
+#include "../util/sourcestamp.h"
+#include "../util/virtualfilesystem.h"
+
+// Remote Headers
+#include <fstream>
+
+namespace
+{
+	static const std::uint32_t MESH_FILE_MAGIC = 0x48534D53;  // "SMSH"
+	static const std::uint32_t MESH_FILE_VERSION = 2U;
+	static const std::uint32_t BLOB_ALIGNMENT = 16U;
+	static const std::string MESH_FILE_EXTENSION = ".mesh";
+
+	struct MeshFileHeader
+	{
+		std::uint32_t _magic;
+		std::uint32_t _version;
+		source_stamp::Stamp _sourceStamp;
+
+		std::uint32_t _vertexCount;
+		std::uint32_t _packedVertexCount;  // Zero, or _vertexCount when the model survives packing
+		std::uint32_t _indexCount;
+		std::uint32_t _indexFormat;
+
+		FLOAT _dimensions[3];
+		std::uint32_t _optimizerVersion;   // mesh_optimizer::OPTIMIZER_VERSION the model was optimised with
+		std::uint32_t _packingVersion;     // vertex_packing::PACKING_VERSION the model was packed with
+		std::uint32_t _reserved;
+		Material _material;
+
+		std::uint64_t _vertexOffset;
+		std::uint64_t _packedVertexOffset;
+		std::uint64_t _indexOffset;
+		std::uint64_t _fileSize;
+	};
+
+	static_assert(sizeof(MeshFileHeader) % BLOB_ALIGNMENT == 0, "Mesh file blobs must start aligned after the header");
+	static_assert(sizeof(Vertex) == 32 && sizeof(PackedVertex) == 20, "The mesh file format changed; bump MESH_FILE_VERSION");
+
+	std::uint64_t AlignUp(const std::uint64_t value)
+	{
+		return (value + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT;
+	}
+
+	// Whether count elements of elementSize at offset start aligned, no earlier than inOutBlobEnd, and end within the 
+	// file, checked so that no corrupt count or offset can overflow. Moves inOutBlobEnd past the blob when they do.
+	bool CheckBlobRange(const std::uint64_t offset, const std::uint64_t count, const std::uint64_t elementSize, const std::uint64_t fileSize, std::uint64_t& inOutBlobEnd)
+	{
+		if (offset % BLOB_ALIGNMENT != 0 || offset < inOutBlobEnd || offset > fileSize || count > (fileSize - offset) / elementSize)
+		{
+			return false;
+		}
+
+		inOutBlobEnd = offset + count * elementSize;
+		return true;
+	}
+
+	void WriteBlob(std::ofstream& fileStream, const void* data, const std::uint64_t offset, const std::uint64_t byteSize)
+	{
+		static const char ZERO_PADDING[BLOB_ALIGNMENT] = {};
+		const auto position = static_cast<std::uint64_t>(fileStream.tellp());
+		fileStream.write(ZERO_PADDING, static_cast<std::streamsize>(offset - position));
+		fileStream.write(static_cast<const char*>(data), static_cast<std::streamsize>(byteSize));
+	}
+}
+
+std::string mesh_file::GetMeshFilePath(const std::string& objPath)
+{
+	const auto extensionStart = objPath.find_last_of('.');
+	const auto directoryEnd = objPath.find_last_of("/\\");
+	if (extensionStart == std::string::npos || (directoryEnd != std::string::npos && extensionStart < directoryEnd))
+	{
+		return objPath + MESH_FILE_EXTENSION;
+	}
+
+	return objPath.substr(0, extensionStart) + MESH_FILE_EXTENSION;
+}
+
+bool mesh_file::Write(const std::string& meshFilePath, const std::string& sourcePath, const OBJLoader::ModelData& modelData)
+{
+	MeshFileHeader header = {};
+	if (!source_stamp::GetStamp(sourcePath, header._sourceStamp))
+	{
+		return false;
+	}
+
+	header._magic = MESH_FILE_MAGIC;
+	header._version = MESH_FILE_VERSION;
+	header._optimizerVersion = mesh_optimizer::OPTIMIZER_VERSION;
+	header._packingVersion = vertex_packing::PACKING_VERSION;
+	header._vertexCount = static_cast<std::uint32_t>(modelData.vertexData.size());
+	header._packedVertexCount = static_cast<std::uint32_t>(modelData.packedVertexData.size());
+	header._indexCount = static_cast<std::uint32_t>(modelData.indexData.size());
+	header._indexFormat = modelData.indexFormat;
+	header._dimensions[0] = modelData.dimensions._width;
+	header._dimensions[1] = modelData.dimensions._height;
+	header._dimensions[2] = modelData.dimensions._depth;
+	header._material = modelData.material;
+
+	header._vertexOffset = sizeof(MeshFileHeader);
+	header._packedVertexOffset = AlignUp(header._vertexOffset + sizeof(Vertex) * header._vertexCount);
+	header._indexOffset = AlignUp(header._packedVertexOffset + sizeof(PackedVertex) * header._packedVertexCount);
+	header._fileSize = header._indexOffset + sizeof(UINT) * header._indexCount;
+
+	std::ofstream fileStream(meshFilePath, std::ios::binary);
+	if (!fileStream.is_open())
+	{
+		return false;
+	}
+
+	fileStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	WriteBlob(fileStream, modelData.vertexData.data(), header._vertexOffset, sizeof(Vertex) * header._vertexCount);
+	WriteBlob(fileStream, modelData.packedVertexData.data(), header._packedVertexOffset, sizeof(PackedVertex) * header._packedVertexCount);
+	WriteBlob(fileStream, modelData.indexData.data(), header._indexOffset, sizeof(UINT) * header._indexCount);
+
+	return fileStream.good();
+}
+
+std::shared_ptr<OBJLoader::ModelData> mesh_file::Read(const std::string& meshFilePath, const std::string& sourcePath)
+{
+	const VirtualFile meshFile(meshFilePath);
+	if (!meshFile.IsOpen() || meshFile.GetSize() < sizeof(MeshFileHeader))
+	{
+		return nullptr;
+	}
+
+	const auto& header = *reinterpret_cast<const MeshFileHeader*>(meshFile.GetData());
+	if (header._magic != MESH_FILE_MAGIC || header._version != MESH_FILE_VERSION || header._fileSize != meshFile.GetSize() ||
+		header._optimizerVersion != mesh_optimizer::OPTIMIZER_VERSION || header._packingVersion != vertex_packing::PACKING_VERSION ||
+		(header._packedVertexCount != 0 && header._packedVertexCount != header._vertexCount))
+	{
+		return nullptr;
+	}
+
+	// The blobs follow the header and each other in order, so none can overlap
+	auto blobEnd = static_cast<std::uint64_t>(sizeof(MeshFileHeader));
+	if (!CheckBlobRange(header._vertexOffset, header._vertexCount, sizeof(Vertex), header._fileSize, blobEnd) ||
+		!CheckBlobRange(header._packedVertexOffset, header._packedVertexCount, sizeof(PackedVertex), header._fileSize, blobEnd) ||
+		!CheckBlobRange(header._indexOffset, header._indexCount, sizeof(UINT), header._fileSize, blobEnd))
+	{
+		return nullptr;
+	}
+
+	source_stamp::Stamp sourceStamp;
+	if (source_stamp::GetStamp(sourcePath, sourceStamp) && !source_stamp::IsSameStamp(sourceStamp, header._sourceStamp))
+	{
+		return nullptr;
+	}
+
+	// The blobs are laid out exactly as the vectors hold them, so each is a single copy out of the file view
+	const auto* vertices = reinterpret_cast<const Vertex*>(meshFile.GetData() + header._vertexOffset);
+	const auto* packedVertices = reinterpret_cast<const PackedVertex*>(meshFile.GetData() + header._packedVertexOffset);
+	const auto* indices = reinterpret_cast<const UINT*>(meshFile.GetData() + header._indexOffset);
+
+	return std::make_shared<OBJLoader::ModelData>(std::vector<Vertex>(vertices, vertices + header._vertexCount),
+	                                              std::vector<PackedVertex>(packedVertices, packedVertices + header._packedVertexCount),
+	                                              std::vector<UINT>(indices, indices + header._indexCount),
+	                                              static_cast<DXGI_FORMAT>(header._indexFormat),
+	                                              math::Dimensions(header._dimensions[0], header._dimensions[1], header._dimensions[2]),
+	                                              header._material);
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+/********************************************************************/
+/** meshfile.h by Alex Koukoulas (C) 2017 All Rights Reserved      **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "objloader.h"
+
+// Remote Headers
+#include <memory>
+#include <string>
+
+// Compiled form of an OBJ model: a fixed header carrying the bounds and material, followed by the 
+// deduplicated, cache optimised vertices, their packed form when the model has one, and the indices, 
+// each starting on a 16 byte boundary. Loading it is a matter of mapping the file and copying the blobs out.
+namespace mesh_file
+{
+	// Path of the compiled model for an OBJ: the same path with a .mesh extension
+	std::string GetMeshFilePath(const std::string& objPath);
+
+	// Records the size and write time of the OBJ at sourcePath, against which Read checks for staleness
+	bool Write(const std::string& meshFilePath, const std::string& sourcePath, const OBJLoader::ModelData& modelData);
+
+	// Null when the compiled model is missing, malformed, written by another version of the format, optimiser or 
+	// vertex packing, or its source OBJ has changed since. A compiled model whose source OBJ is absent is taken as it is.
+	std::shared_ptr<OBJLoader::ModelData> Read(const std::string& meshFilePath, const std::string& sourcePath);
+}
\ No newline at end of file
@@ -0,0 +1,258 @@
+/**********************************************************************/
+/** meshoptimizer.cpp by Alex Koukoulas (C) 2017 All Rights Reserved **/
+/** File Description:                                                **/
+/**********************************************************************/
+
+// Local Headers
+#include "meshoptimizer.h"
+
+// Remote Headers
+#include <cmath>
+
+namespace
+{
+	static const FLOAT CACHE_DECAY_POWER   = 1.5f;
+	static const FLOAT LAST_TRIANGLE_SCORE = 0.75f;
+	static const FLOAT VALENCE_BOOST_SCALE = 2.0f;
+	static const FLOAT VALENCE_BOOST_POWER = 0.5f;
+	static const INT   NOT_IN_CACHE        = -1;
+
+	struct VertexCacheData
+	{
+		INT _cachePosition;
+		UINT _remainingValence;
+		FLOAT _score;
+
+		// Offset into the shared vertex to triangle adjacency list
+		UINT _firstTriangle;
+
+		VertexCacheData()
+			: _cachePosition(NOT_IN_CACHE)
+			, _remainingValence(0)
+			, _score(0.0f)
+			, _firstTriangle(0)
+		{
+		}
+	};
+
+	FLOAT CalculateVertexScore(const VertexCacheData& vertexData)
+	{
+		// Vertices no longer used by any remaining triangle should never attract a triangle
+		if (vertexData._remainingValence == 0)
+		{
+			return -1.0f;
+		}
+
+		auto score = 0.0f;
+		if (vertexData._cachePosition != NOT_IN_CACHE)
+		{
+			// The three vertices of the last emitted triangle get a fixed score so that
+			// the next triangle does not simply reuse the same edge over and over
+			if (vertexData._cachePosition < 3)
+			{
+				score = LAST_TRIANGLE_SCORE;
+			}
+			else
+			{
+				const auto scaler = 1.0f / (mesh_optimizer::SIMULATED_CACHE_SIZE - 3);
+				score = std::pow(1.0f - (vertexData._cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+			}
+		}
+
+		// Boost vertices with few remaining triangles so that lone triangles are cleared early
+		score += VALENCE_BOOST_SCALE * std::pow(static_cast<FLOAT>(vertexData._remainingValence), -VALENCE_BOOST_POWER);
+		return score;
+	}
+}
+
+void mesh_optimizer::OptimizeVertexCache(std::vector<UINT>& indices, const UINT vertexCount)
+{
+	const auto triangleCount = static_cast<UINT>(indices.size() / 3);
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// Build the vertex to triangle adjacency
+	std::vector<VertexCacheData> vertexData(vertexCount);
+	for (const auto index: indices)
+	{
+		vertexData[index]._remainingValence++;
+	}
+
+	auto adjacencyOffset = 0U;
+	for (auto& vertex: vertexData)
+	{
+		vertex._firstTriangle = adjacencyOffset;
+		adjacencyOffset += vertex._remainingValence;
+	}
+
+	std::vector<UINT> vertexTriangles(indices.size());
+	std::vector<UINT> vertexTriangleCounts(vertexCount, 0);
+	for (auto triangle = 0U; triangle < triangleCount; ++triangle)
+	{
+		for (auto corner = 0U; corner < 3; ++corner)
+		{
+			const auto index = indices[triangle * 3 + corner];
+			vertexTriangles[vertexData[index]._firstTriangle + vertexTriangleCounts[index]++] = triangle;
+		}
+	}
+
+	for (auto& vertex: vertexData)
+	{
+		vertex._score = CalculateVertexScore(vertex);
+	}
+
+	std::vector<FLOAT> triangleScores(triangleCount);
+	std::vector<bool> triangleEmitted(triangleCount, false);
+	for (auto triangle = 0U; triangle < triangleCount; ++triangle)
+	{
+		triangleScores[triangle] = vertexData[indices[triangle * 3]]._score + vertexData[indices[triangle * 3 + 1]]._score + vertexData[indices[triangle * 3 + 2]]._score;
+	}
+
+	// Simulated LRU cache, with room for the three vertices pushed in by each emitted triangle
+	std::vector<UINT> cache;
+	std::vector<UINT> nextCache;
+	cache.reserve(SIMULATED_CACHE_SIZE + 3);
+	nextCache.reserve(SIMULATED_CACHE_SIZE + 3);
+
+	std::vector<UINT> optimizedIndices;
+	optimizedIndices.reserve(indices.size());
+
+	auto bestTriangle = 0U;
+	auto linearScanCursor = 0U;
+
+	for (auto emittedCount = 0U; emittedCount < triangleCount; ++emittedCount)
+	{
+		// No candidate was found among the cached vertices' triangles; fall back to the
+		// highest scoring triangle left, scanning forward from where the last scan stopped
+		if (triangleEmitted[bestTriangle])
+		{
+			while (triangleEmitted[linearScanCursor])
+			{
+				linearScanCursor++;
+			}
+
+			bestTriangle = linearScanCursor;
+			for (auto triangle = linearScanCursor + 1; triangle < triangleCount; ++triangle)
+			{
+				if (!triangleEmitted[triangle] && triangleScores[triangle] > triangleScores[bestTriangle])
+				{
+					bestTriangle = triangle;
+				}
+			}
+		}
+
+		// Emit the triangle and push its vertices to the front of the cache
+		triangleEmitted[bestTriangle] = true;
+		nextCache.clear();
+
+		for (auto corner = 0U; corner < 3; ++corner)
+		{
+			const auto index = indices[bestTriangle * 3 + corner];
+			optimizedIndices.push_back(index);
+			nextCache.push_back(index);
+
+			// Remove the emitted triangle from the vertex's remaining adjacency
+			auto& vertex = vertexData[index];
+			auto* triangles = &vertexTriangles[vertex._firstTriangle];
+			for (auto i = 0U; i < vertex._remainingValence; ++i)
+			{
+				if (triangles[i] == bestTriangle)
+				{
+					triangles[i] = triangles[vertex._remainingValence - 1];
+					break;
+				}
+			}
+			vertex._remainingValence--;
+		}
+
+		for (const auto index: cache)
+		{
+			if (index != nextCache[0] && index != nextCache[1] && index != nextCache[2])
+			{
+				nextCache.push_back(index);
+			}
+		}
+
+		// Vertices pushed past the end of the cache are evicted; the remaining ones get their new positions
+		for (auto i = 0U; i < nextCache.size(); ++i)
+		{
+			vertexData[nextCache[i]]._cachePosition = i < SIMULATED_CACHE_SIZE ? static_cast<INT>(i) : NOT_IN_CACHE;
+			vertexData[nextCache[i]]._score = CalculateVertexScore(vertexData[nextCache[i]]);
+		}
+
+		if (nextCache.size() > SIMULATED_CACHE_SIZE)
+		{
+			nextCache.resize(SIMULATED_CACHE_SIZE);
+		}
+		cache.swap(nextCache);
+
+		// Rescore the triangles touching the cache and pick the best one for the next iteration
+		auto bestScore = -1.0f;
+		for (const auto index: cache)
+		{
+			const auto& vertex = vertexData[index];
+			for (auto i = 0U; i < vertex._remainingValence; ++i)
+			{
+				const auto triangle = vertexTriangles[vertex._firstTriangle + i];
+				const auto score = vertexData[indices[triangle * 3]]._score + vertexData[indices[triangle * 3 + 1]]._score + vertexData[indices[triangle * 3 + 2]]._score;
+
+				triangleScores[triangle] = score;
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = triangle;
+				}
+			}
+		}
+	}
+
+	indices.swap(optimizedIndices);
+}
+
+void mesh_optimizer::OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<UINT>& indices)
+{
+	static const UINT UNASSIGNED = 0xFFFFFFFF;
+
+	std::vector<UINT> remap(vertices.size(), UNASSIGNED);
+	std::vector<Vertex> reorderedVertices;
+	reorderedVertices.reserve(vertices.size());
+
+	for (auto& index: indices)
+	{
+		if (remap[index] == UNASSIGNED)
+		{
+			remap[index] = static_cast<UINT>(reorderedVertices.size());
+			reorderedVertices.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	// Vertices that no triangle references are dropped
+	vertices.swap(reorderedVertices);
+}
+
+FLOAT mesh_optimizer::CalculateACMR(const std::vector<UINT>& indices, const UINT vertexCount, const UINT cacheSize)
+{
+	const auto triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return 0.0f;
+	}
+
+	// FIFO cache: a vertex's entry is valid while fewer than cacheSize misses happened since it was inserted
+	std::vector<UINT> insertionTimestamps(vertexCount, 0);
+	auto missCount = 0U;
+
+	for (const auto index: indices)
+	{
+		if (insertionTimestamps[index] == 0 || missCount - insertionTimestamps[index] + 1 > cacheSize)
+		{
+			missCount++;
+			insertionTimestamps[index] = missCount;
+		}
+	}
+
+	return static_cast<FLOAT>(missCount) / triangleCount;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+/********************************************************************/
+/** meshoptimizer.h by Alex Koukoulas (C) 2017 All Rights Reserved **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "vertex.h"
+
+// Remote Headers
+#include <vector>
+
+namespace mesh_optimizer
+{
+	// Size of the simulated post-transform cache used both for optimization and for reporting
+	static const UINT SIMULATED_CACHE_SIZE = 32U;
+
+	// Bumped whenever the optimised order changes, so that compiled meshes built by an older optimiser are rebuilt
+	static const UINT OPTIMIZER_VERSION = 1U;
+
+	// Reorders the triangles of an indexed triangle list for post-transform cache locality
+	// using Tom Forsyth's linear-speed vertex cache optimisation
+	void OptimizeVertexCache(std::vector<UINT>& indices, const UINT vertexCount);
+
+	// Reorders the vertices in the order they are first referenced by the index buffer and remaps
+	// the indices accordingly, so that vertex fetches walk the vertex buffer forwards
+	void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<UINT>& indices);
+
+	// Average cache miss ratio (transformed vertices per triangle) of the index buffer on a
+	// simulated FIFO cache. 3.0 is the worst case, values close to 0.5 are excellent
+	FLOAT CalculateACMR(const std::vector<UINT>& indices, const UINT vertexCount, const UINT cacheSize = SIMULATED_CACHE_SIZE);
+}
\ No newline at end of file
@@ -22,9 +22,9 @@ const std::string Model::MODEL_OBJDATA_EXT    = ".obj";
 
 Model::Model(const std::string& modelName)
 	: _name(modelName)
-	, _texture(0)
 	, _vertexBuffer(0)
 	, _indexBuffer(0)
+	, _indexFormat(DXGI_FORMAT_R32_UINT)
 {	
 }
 
@@ -66,6 +66,11 @@ const FLOAT Model::GetAverageDimensionRad() const
 	return ((_dimensions._width + _dimensions._height + _dimensions._depth) / 3) / 2.0f;
 }
 
+const FLOAT Model::GetBoundingSphereRadius() const
+{
+	return GetBiggestDimensionRad() * math::Max3f(_transform.GetScale().x, _transform.GetScale().y, _transform.GetScale().z);
+}
+
 const bool Model::CollidesWith(const Model& model) const
 {
 	return math::DistanceNoSqrt(GetTransform().GetTranslation(), model.GetTransform().GetTranslation()) < 
@@ -87,6 +92,31 @@ UINT Model::GetIndexCount() const
 	return static_cast<UINT>(_rawIndexData.size());
 }
 
+const std::vector<Vertex>& Model::GetRawVertexData() const
+{
+	return _rawVertexData;
+}
+
+const std::vector<UINT>& Model::GetRawIndexData() const
+{
+	return _rawIndexData;
+}
+
+UINT Model::GetVertexStride() const
+{
+	return HasPackedVertices() ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
+bool Model::HasPackedVertices() const
+{
+	return !_rawPackedVertexData.empty();
+}
+
+DXGI_FORMAT Model::GetIndexFormat() const
+{
+	return _indexFormat;
+}
+
 comptr<ID3D11Buffer> Model::GetVertexBuffer() const
 {
 	return _vertexBuffer;
@@ -99,10 +129,10 @@ comptr<ID3D11Buffer> Model::GetIndexBuffer() const
 
 comptr<ID3D11ShaderResourceView> Model::GetTexture() const
 {
-	return _texture;
+	return _texture.Get();
 }
 
-void Model::SetTexture(comptr<ID3D11ShaderResourceView> texture)
+void Model::SetTexture(const TextureHandle& texture)
 {
 	_texture = texture;
 }
@@ -116,16 +146,24 @@ void Model::LoadModelComponents(comptr<ID3D11Device> device)
 
 void Model::LoadModelData()
 {
-	const auto modelData = OBJLoader::Get().LoadOBJData(MODEL_DIRECTORY_PATH + _name + "/" + _name + MODEL_OBJDATA_EXT);
+	// Models whose texture was packed into an atlas at build time get texcoords addressing that atlas instead
+	const auto modelDataPath = MODEL_DIRECTORY_PATH + _name + "/" + _name + MODEL_OBJDATA_EXT;
+	const auto* atlasRegion = TextureLoader::Get().FindAtlasRegion(texture_atlas::GetLayoutPath(MODEL_DIRECTORY_PATH), MODEL_DIRECTORY_PATH + _name + "/" + _name + MODEL_TEXTURE_EXT);
+	const auto modelData = atlasRegion ? OBJLoader::Get().LoadOBJData(modelDataPath, *atlasRegion) : OBJLoader::Get().LoadOBJData(modelDataPath);
 	_rawVertexData = modelData->vertexData;
+	_rawPackedVertexData = modelData->packedVertexData;
 	_rawIndexData = modelData->indexData;
+	_indexFormat = modelData->indexFormat;
 	_dimensions = modelData->dimensions;
 	_material = modelData->material;
+	_atlasTexturePath = modelData->atlasTexturePath;
 }
 
 void Model::LoadTexture(comptr<ID3D11Device> device)
 {
-	_texture = TextureLoader::Get().LoadTexture(MODEL_DIRECTORY_PATH + _name + "/" + _name + MODEL_TEXTURE_EXT, device);
+	// Every model in the same atlas shares its handle, and so the same shader resource view
+	const auto texturePath = _atlasTexturePath.empty() ? MODEL_DIRECTORY_PATH + _name + "/" + _name + MODEL_TEXTURE_EXT : _atlasTexturePath;
+	_texture = TextureLoader::Get().LoadTexture(texturePath, device);
 }
 
 void Model::LoadBuffers(comptr<ID3D11Device> device)
@@ -133,33 +171,39 @@ void Model::LoadBuffers(comptr<ID3D11Device> device)
 	_vertexBuffer.Reset();
 	_indexBuffer.Reset();
 
-	// Describe and create vertex buffer
+	// Describe and create vertex buffer from the packed vertices when the mesh has them
 	D3D11_BUFFER_DESC vbd;
 	vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vbd.ByteWidth = sizeof(Vertex) * _rawVertexData.size();
+	vbd.ByteWidth = GetVertexStride() * _rawVertexData.size();
 	vbd.CPUAccessFlags = 0;
 	vbd.MiscFlags = 0;
 	vbd.StructureByteStride = 0;
 	vbd.Usage = D3D11_USAGE_IMMUTABLE;
 
 	D3D11_SUBRESOURCE_DATA vsrd;
-	vsrd.pSysMem = &_rawVertexData[0];
+	vsrd.pSysMem = HasPackedVertices() ? static_cast<const void*>(&_rawPackedVertexData[0]) : static_cast<const void*>(&_rawVertexData[0]);
 	vsrd.SysMemPitch = 0;
 	vsrd.SysMemSlicePitch = 0;
 
 	device->CreateBuffer(&vbd, &vsrd, _vertexBuffer.GetAddressOf());
 
-	// Describe and create index buffer;
+	// Describe and create index buffer; narrowed to 16 bits when every vertex can be addressed by them
+	std::vector<USHORT> shortIndexData;
+	if (_indexFormat == DXGI_FORMAT_R16_UINT)
+	{
+		shortIndexData.assign(_rawIndexData.begin(), _rawIndexData.end());
+	}
+
 	D3D11_BUFFER_DESC ibd;
 	ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	ibd.ByteWidth = sizeof(UINT) * _rawIndexData.size();
+	ibd.ByteWidth = _indexFormat == DXGI_FORMAT_R16_UINT ? sizeof(USHORT) * shortIndexData.size() : sizeof(UINT) * _rawIndexData.size();
 	ibd.CPUAccessFlags = 0;
 	ibd.MiscFlags = 0;
 	ibd.StructureByteStride = 0;
 	ibd.Usage = D3D11_USAGE_IMMUTABLE;
 
 	D3D11_SUBRESOURCE_DATA isrd;
-	isrd.pSysMem = &_rawIndexData[0];
+	isrd.pSysMem = _indexFormat == DXGI_FORMAT_R16_UINT ? static_cast<const void*>(&shortIndexData[0]) : static_cast<const void*>(&_rawIndexData[0]);
 	isrd.SysMemPitch = 0;
 	isrd.SysMemSlicePitch = 0;
 
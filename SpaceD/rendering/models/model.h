@@ -10,6 +10,7 @@
 #include "../vertex.h"
 #include "../../util/math.h"
 #include "../lightdef.h"
+#include "../textureloader.h"
 
 // Remote Headers
 #include <string>
@@ -39,18 +40,24 @@ public:
 	const math::Dimensions& GetDimensions() const;
 	const FLOAT GetBiggestDimensionRad() const;
 	const FLOAT GetAverageDimensionRad() const;
+	const FLOAT GetBoundingSphereRadius() const;
 	const bool CollidesWith(const Model& model) const;
 
 	const Material& GetMaterial() const;
 	Material& GetMaterial();
 
 	UINT GetIndexCount() const; 
+	const std::vector<Vertex>& GetRawVertexData() const;
+	const std::vector<UINT>& GetRawIndexData() const;
+	UINT GetVertexStride() const;
+	bool HasPackedVertices() const;
+	DXGI_FORMAT GetIndexFormat() const;
 	
 	comptr<ID3D11Buffer> GetVertexBuffer() const;
 	comptr<ID3D11Buffer> GetIndexBuffer() const;
 	comptr<ID3D11ShaderResourceView> GetTexture() const;
 
-	void SetTexture(comptr<ID3D11ShaderResourceView> texture);
+	void SetTexture(const TextureHandle& texture);
 
 
 protected:	
@@ -66,12 +73,15 @@ public:
 protected:
 	const std::string _name;
 
-	comptr<ID3D11ShaderResourceView> _texture;
+	TextureHandle _texture;
+	std::string _atlasTexturePath;
 	comptr<ID3D11Buffer> _vertexBuffer;
 	comptr<ID3D11Buffer> _indexBuffer;
 
 	std::vector<Vertex> _rawVertexData;
+	std::vector<PackedVertex> _rawPackedVertexData;
 	std::vector<UINT>   _rawIndexData;
+	DXGI_FORMAT         _indexFormat;
 
 	math::Transform _transform;
 	math::Dimensions _dimensions;
@@ -5,12 +5,22 @@
 
 // Local Headers
 #include "objloader.h"
-#include "../util/stringutils.h"
+#include "meshfile.h"
+#include "meshoptimizer.h"
+#include "vertexpacking.h"
+#include "../util/objparser.h"
+#include "../util/textureatlas.h"
+#include "../util/threadpool.h"
+#include "../util/virtualfilesystem.h"
 
 // Remote Headers
-#include <fstream>
+#include <algorithm>
+#include <chrono>
 #include <Windows.h>
 
+// Texcoords this far outside [0, 1] are taken to be rounding error rather than wrapping
+static const FLOAT ATLAS_TEXCOORD_TOLERANCE = 1e-4f;
+
 // Internal Structs
 struct OBJIndex 
 {
@@ -22,6 +32,22 @@ struct OBJIndex
 		, _normalIndex(normalIndex)
 	{
 	}
+
+	bool operator == (const OBJIndex& rhs) const
+	{
+		return _posIndex == rhs._posIndex && _texIndex == rhs._texIndex && _normalIndex == rhs._normalIndex;
+	}
+};
+
+struct OBJIndexHasher
+{
+	std::size_t operator()(const OBJIndex& objIndex) const
+	{
+		auto hash = std::hash<UINT>()(objIndex._posIndex);
+		hash ^= std::hash<UINT>()(objIndex._texIndex) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<UINT>()(objIndex._normalIndex) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		return hash;
+	}
 };
 
 OBJLoader& OBJLoader::Get()
@@ -35,171 +61,299 @@ OBJLoader::~OBJLoader()
 }
 
 OBJLoader::OBJLoader()
+	: _loadedModelCount(0)
+	, _packedModelCount(0)
+	, _packedVertexBytesSaved(0)
+	, _threadPool(std::make_unique<ThreadPool>())
 {
 }
 
-std::shared_ptr<OBJLoader::ModelData> OBJLoader::LoadOBJData(const std::string& modelDataPath)
+std::shared_ptr<OBJLoader::ModelData> OBJLoader::LoadOBJData(const std::string& modelDataPath, const texture_atlas::AtlasRegion& atlasRegion)
 {
-	return LoadOBJData(modelDataPath, std::vector<XMFLOAT2>());
+	const auto atlasModelDataKey = modelDataPath + "@" + atlasRegion._atlasPath;
+	if (_objModelData.count(atlasModelDataKey))
+	{
+		return _objModelData[atlasModelDataKey];
+	}
+
+	const auto modelData = LoadOBJData(modelDataPath);
+	if (!modelData)
+	{
+		return nullptr;
+	}
+
+	for (const auto& vertex: modelData->vertexData)
+	{
+		if (vertex._tex.x < -ATLAS_TEXCOORD_TOLERANCE || vertex._tex.x > 1.0f + ATLAS_TEXCOORD_TOLERANCE || 
+			vertex._tex.y < -ATLAS_TEXCOORD_TOLERANCE || vertex._tex.y > 1.0f + ATLAS_TEXCOORD_TOLERANCE)
+		{
+			OutputDebugString((std::string("Not atlasing model: ") + modelDataPath + " its texcoords wrap\n").c_str());
+			_objModelData[atlasModelDataKey] = modelData;
+			return modelData;
+		}
+	}
+
+	auto atlasModelData = std::make_shared<OBJLoader::ModelData>(*modelData);
+	for (auto& vertex: atlasModelData->vertexData)
+	{
+		vertex._tex.x = atlasRegion._texcoordOffset[0] + (std::min)((std::max)(vertex._tex.x, 0.0f), 1.0f) * atlasRegion._texcoordScale[0];
+		vertex._tex.y = atlasRegion._texcoordOffset[1] + (std::min)((std::max)(vertex._tex.y, 0.0f), 1.0f) * atlasRegion._texcoordScale[1];
+	}
+
+	// Texcoords are quantised relative to the whole atlas now, so the packed vertices are redone and rechecked
+	const auto packingError = vertex_packing::PackVertices(atlasModelData->vertexData, atlasModelData->packedVertexData);
+	if (!packingError.IsWithinTolerance())
+	{
+		atlasModelData->packedVertexData.clear();
+	}
+
+	atlasModelData->atlasTexturePath = atlasRegion._atlasPath;
+	_objModelData[atlasModelDataKey] = atlasModelData;
+
+	OutputDebugString((std::string("Atlased model: ") + modelDataPath + " into " + atlasRegion._atlasPath + 
+		               (atlasModelData->packedVertexData.empty() ? " unpacked" : " packed") + "\n").c_str());
+
+	return atlasModelData;
 }
 
-std::shared_ptr<OBJLoader::ModelData> OBJLoader::LoadOBJData(const std::string& modelDataPath, const std::vector<XMFLOAT2> customTexcoords)
+std::shared_ptr<OBJLoader::ModelData> OBJLoader::LoadOBJData(const std::string& modelDataPath)
 {
 	// Model entry exists
-	if (_objModelData.count(modelDataPath) && !math::NonZeroTexCoords(customTexcoords))
+	if (_objModelData.count(modelDataPath))
 	{		
 		// Model found; return cached version		
 		return _objModelData[modelDataPath];		
 	}
 
-	// Load OBJ data normally
-	std::ifstream fileStream(modelDataPath);
+	// A preload of the model may still be running, in which case only its remainder is waited for
+	const auto pendingModelDataIter = _pendingModelData.find(modelDataPath);
+	if (pendingModelDataIter != _pendingModelData.end())
+	{
+		const auto preloadedModelData = pendingModelDataIter->second.get();
+		_pendingModelData.erase(pendingModelDataIter);
+
+		if (preloadedModelData)
+		{
+			CacheModelData(modelDataPath, preloadedModelData);
+		}
+		return preloadedModelData;
+	}
+
+	const auto loadedModelData = ReadModelData(modelDataPath);
+	if (loadedModelData)
+	{
+		CacheModelData(modelDataPath, loadedModelData);
+	}
+	return loadedModelData;
+}
+
+void OBJLoader::PreloadOBJData(const std::string& modelDataPath)
+{
+	if (_objModelData.count(modelDataPath) || _pendingModelData.count(modelDataPath))
+	{
+		return;
+	}
+
+	auto readTask = std::make_shared<std::packaged_task<std::shared_ptr<ModelData>()>>([this, modelDataPath]() { return ReadModelData(modelDataPath); });
+	_pendingModelData[modelDataPath] = readTask->get_future().share();
+	_threadPool->Submit([readTask]() { (*readTask)(); });
+}
+
+void OBJLoader::WaitForPreloadedModels()
+{
+	while (!_pendingModelData.empty())
+	{
+		LoadOBJData(_pendingModelData.begin()->first);
+	}
+}
+
+const std::vector<std::string>& OBJLoader::GetLoadedModelPaths() const
+{
+	return _loadedModelPaths;
+}
+
+FLOAT OBJLoader::GetLoadMilliseconds(const std::string& modelDataPath) const
+{
+	const auto modelDataIter = _objModelData.find(modelDataPath);
+	return modelDataIter == _objModelData.end() ? 0.0f : modelDataIter->second->loadMilliseconds;
+}
+
+void OBJLoader::CacheModelData(const std::string& modelDataPath, std::shared_ptr<ModelData> modelData)
+{
+	if (!_objModelData.count(modelDataPath))
+	{
+		_loadedModelPaths.push_back(modelDataPath);
+	}
+	_objModelData[modelDataPath] = modelData;
+
+	_loadedModelCount++;
+	if (!modelData->packedVertexData.empty())
+	{
+		_packedModelCount++;
+		_packedVertexBytesSaved += modelData->vertexData.size() * (sizeof(Vertex) - sizeof(PackedVertex));
+	}
+
+	OutputDebugString((std::string("Loaded model: ") + modelDataPath + " in " + std::to_string(modelData->loadMilliseconds) + "ms." + 
+		               " Saved " + std::to_string(_packedVertexBytesSaved) + " vertex bytes across " + std::to_string(_packedModelCount) + "/" + std::to_string(_loadedModelCount) + " models so far\n").c_str());
+}
 
-	if (!fileStream.is_open())
+std::shared_ptr<OBJLoader::ModelData> OBJLoader::ReadModelData(const std::string& modelDataPath) const
+{
+	const auto loadStart = std::chrono::high_resolution_clock::now();
+
+	// The compiled form of the model, when present and up to date, needs no parsing at all
+	const auto compiledModelData = mesh_file::Read(mesh_file::GetMeshFilePath(modelDataPath), modelDataPath);
+	if (compiledModelData)
+	{
+		OutputDebugString((std::string("Loaded compiled model: ") + mesh_file::GetMeshFilePath(modelDataPath) + 
+			               " vertices: " + std::to_string(compiledModelData->vertexData.size()) + " indices: " + std::to_string(compiledModelData->indexData.size()) + "\n").c_str());
+
+		compiledModelData->loadMilliseconds = std::chrono::duration<FLOAT, std::milli>(std::chrono::high_resolution_clock::now() - loadStart).count();
+		return compiledModelData;
+	}
+
+	// Load OBJ data normally, parsing straight out of the file view
+	const VirtualFile objFile(modelDataPath);
+	if (!objFile.IsOpen())
 	{
 		MessageBox(0, (std::string("Model: ") + modelDataPath + " was not found").c_str(), 0, MB_ICONWARNING);
 		return nullptr;
 	}
 
-	// Define OBJ parsing data structures 
-	std::vector<XMFLOAT3> posRawData;
-	std::vector<XMFLOAT2> texRawData;
-	std::vector<XMFLOAT3> normalRawData;
-	std::vector<OBJIndex> indexData;
-
-	// Check whether custom tex coords were passed in
-	const auto customTexcoordsGiven = customTexcoords.size() > 0;
-	if (customTexcoordsGiven)
+	obj_parser::ParsedOBJ parsedOBJ;
+	std::string parseError;
+	if (!obj_parser::Parse(reinterpret_cast<const char*>(objFile.GetData()), objFile.GetSize(), parsedOBJ, parseError))
 	{
-		texRawData = customTexcoords;
+		MessageBox(0, (std::string("Model: ") + modelDataPath + " could not be parsed: " + parseError).c_str(), 0, MB_ICONWARNING);
+		return nullptr;
 	}
 
-	// Begin parsing obj file
+	// Bounds include the origin, which models are authored around
 	FLOAT minX = 0.0f;
 	FLOAT maxX = 0.0f;
 	FLOAT minY = 0.0f;
 	FLOAT maxY = 0.0f;
 	FLOAT minZ = 0.0f;
 	FLOAT maxZ = 0.0f;
-	
+
+	for (size_t i = 0; i < parsedOBJ._positions.size(); i += 3)
+	{
+		const auto x = parsedOBJ._positions[i];
+		const auto y = parsedOBJ._positions[i + 1];
+		const auto z = parsedOBJ._positions[i + 2];
+
+		if (x < minX) minX = x;
+		if (x > maxX) maxX = x;
+		if (y < minY) minY = y;
+		if (y > maxY) maxY = y;
+		if (z < minZ) minZ = z;
+		if (z > maxZ) maxZ = z;
+	}
+
 	Material mat;
-	mat._ambient  = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
-	mat._diffuse  = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
-	mat._specular = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+	mat._ambient  = XMFLOAT4(parsedOBJ._ambient);
+	mat._diffuse  = XMFLOAT4(parsedOBJ._diffuse);
+	mat._specular = XMFLOAT4(parsedOBJ._specular);
 	mat._reflect  = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
 
-	std::string line;
-	while (std::getline(fileStream, line))
+	const auto texcoordCount = parsedOBJ._texcoords.size() / 2;
+
+	// Corners without a texcoord or normal get zeroed ones
+	std::vector<OBJIndex> indexData;
+	indexData.reserve(parsedOBJ._corners.size());
+	for (const auto& corner: parsedOBJ._corners)
 	{
-		if (line.size() < 2)
+		if (corner._texcoord != obj_parser::NO_INDEX && corner._texcoord >= texcoordCount)
 		{
-			continue;
+			MessageBox(0, (std::string("Model: ") + modelDataPath + " refers to more texcoords than it has").c_str(), 0, MB_ICONWARNING);
+			return nullptr;
 		}
 
-		auto lineSplitBySpace = string_utils::split(line, ' ');
+		indexData.emplace_back(corner._position, corner._texcoord, corner._normal);
+	}
 
-		// Material attirbute entry
-		if (line[0] == 'm')
+	// Fill in final vertex and index data structures. Face corners referencing the same
+	// position/texcoord/normal triple share a single vertex
+	std::vector<Vertex> finalVertexData;
+	std::vector<UINT>   finalIndexData;
+	std::unordered_map<OBJIndex, UINT, OBJIndexHasher> uniqueVertexIndices;
+
+	finalIndexData.reserve(indexData.size());
+	uniqueVertexIndices.reserve(indexData.size());
+
+	for (const auto& currentOBJIndex: indexData)
+	{
+		const auto uniqueVertexIter = uniqueVertexIndices.find(currentOBJIndex);
+		if (uniqueVertexIter != uniqueVertexIndices.end())
 		{
-			// Ambient entry
-			if (line[1] == 'a')
-			{
-				mat._ambient = XMFLOAT4(std::stof(lineSplitBySpace[1]),
-					                    std::stof(lineSplitBySpace[2]),
-					                    std::stof(lineSplitBySpace[3]),
-					                    std::stof(lineSplitBySpace[4]));
-			}
-			// Diffuse entry
-			else if (line[1] == 'd')
-			{
-				mat._diffuse = XMFLOAT4(std::stof(lineSplitBySpace[1]),
-					                    std::stof(lineSplitBySpace[2]),
-					                    std::stof(lineSplitBySpace[3]),
-					                    std::stof(lineSplitBySpace[4]));
-			}
-			// Specular entry
-			else
-			{
-				mat._specular = XMFLOAT4(std::stof(lineSplitBySpace[1]),
-					                     std::stof(lineSplitBySpace[2]),
-					                     std::stof(lineSplitBySpace[3]),
-					                     std::stof(lineSplitBySpace[4]));
-			}
+			finalIndexData.push_back(uniqueVertexIter->second);
+			continue;
 		}
 
-		// Vertex attribute entry
-		else if (line[0] == 'v')
+		// Extract attribute data from current OBJ Index
+		const auto currentPosData = XMFLOAT3(&parsedOBJ._positions[currentOBJIndex._posIndex * 3]);
+
+		auto currentTexData = XMFLOAT2(0.0f, 0.0f);
+		if (currentOBJIndex._texIndex != obj_parser::NO_INDEX)
 		{
-			// Texcoord entry
-			if (line[1] == 't')
-			{
-				if (!customTexcoordsGiven)
-				{
-				    texRawData.emplace_back(std::stof(lineSplitBySpace[1]), 1 - std::stof(lineSplitBySpace[2]));
-				}
-			}
-			// Normal entry
-			else if (line[1] == 'n')
-			{
-				normalRawData.emplace_back(std::stof(lineSplitBySpace[1]), std::stof(lineSplitBySpace[2]), std::stof(lineSplitBySpace[3]));
-			}
-			// Position entry
-			else
-			{
-				const auto x = std::stof(lineSplitBySpace[1]);
-				const auto y = std::stof(lineSplitBySpace[2]);
-				const auto z = std::stof(lineSplitBySpace[3]);
-
-				if (x < minX) minX = x;
-				if (x > maxX) maxX = x;
-				if (y < minY) minY = y;
-				if (y > maxY) maxY = y;
-				if (z < minZ) minZ = z;
-				if (z > maxZ) maxZ = z;
-
-				posRawData.emplace_back(x, y, z);
-			}
+			// Flipped into D3D's top left origin
+			currentTexData = XMFLOAT2(parsedOBJ._texcoords[currentOBJIndex._texIndex * 2], 1.0f - parsedOBJ._texcoords[currentOBJIndex._texIndex * 2 + 1]);
 		}
-		else if (line[0] == 'f')
+
+		auto currentNormalData = XMFLOAT3(0.0f, 0.0f, 0.0f);
+		if (currentOBJIndex._normalIndex != obj_parser::NO_INDEX)
 		{
-			// For each one of the three face points extract the position, texcoord, and normal indices
-			for (auto i = 1; i < 4; ++i)
-			{
-				auto faceEntry = lineSplitBySpace[i];
-				auto faceEntrySplitByDash = string_utils::split(faceEntry, '/');
-
-				// Add the OBJ index with -1 for its data since they are automatically output with 1-starting index				
-				indexData.emplace_back(std::stoi(faceEntrySplitByDash[0]) - 1, std::stoi(faceEntrySplitByDash[1]) - 1, std::stoi(faceEntrySplitByDash[2]) - 1);
-			}
+			currentNormalData = XMFLOAT3(&parsedOBJ._normals[currentOBJIndex._normalIndex * 3]);
 		}
+
+		// Add them to the final data buffers
+		const auto newVertexIndex = static_cast<UINT>(finalVertexData.size());
+		finalVertexData.emplace_back(currentPosData, currentTexData, currentNormalData);
+		finalIndexData.push_back(newVertexIndex);
+		uniqueVertexIndices[currentOBJIndex] = newVertexIndex;
 	}
-	fileStream.close();
 
-	// Fill in final vertex and index data structures
-	std::vector<Vertex> finalVertexData;
-	std::vector<UINT>   finalIndexData;
+	// Reorder triangles for the post-transform cache and then vertices for fetch locality
+	const auto acmrBefore = mesh_optimizer::CalculateACMR(finalIndexData, static_cast<UINT>(finalVertexData.size()));
+	mesh_optimizer::OptimizeVertexCache(finalIndexData, static_cast<UINT>(finalVertexData.size()));
+	mesh_optimizer::OptimizeVertexFetch(finalVertexData, finalIndexData);
+	const auto acmrAfter = mesh_optimizer::CalculateACMR(finalIndexData, static_cast<UINT>(finalVertexData.size()));
 
-	for (size_t i = 0; i < indexData.size(); ++i)
-	{
-		// Extract current OBJ index
-		auto currentOBJIndex = indexData[i];
+	OutputDebugString((std::string("Optimized model: ") + modelDataPath + 
+		               " ACMR (" + std::to_string(mesh_optimizer::SIMULATED_CACHE_SIZE) + " entry FIFO): " + std::to_string(acmrBefore) + " -> " + std::to_string(acmrAfter) + "\n").c_str());
 
-		// Extract attribute data indices from current OBJ Index
-		auto currentPosData = posRawData[currentOBJIndex._posIndex];
-		auto currentTexData = texRawData[currentOBJIndex._texIndex];
-		auto currentNormalData = normalRawData[currentOBJIndex._normalIndex];
+	// Use the compact vertex format when the mesh survives quantisation within tolerance
+	std::vector<PackedVertex> packedVertexData;
+	const auto packingError = vertex_packing::PackVertices(finalVertexData, packedVertexData);
 
-		// Add them to the final data buffers
-		finalVertexData.emplace_back(currentPosData, currentTexData, currentNormalData);
-		finalIndexData.push_back(i);
+	if (!packingError.IsWithinTolerance())
+	{
+		packedVertexData.clear();
 	}
 
+	OutputDebugString((std::string("Packing model: ") + modelDataPath + 
+		               (packingError.IsWithinTolerance() ? " packed" : " unpacked") + 
+		               " (max texcoord error: " + std::to_string(packingError._maxTexcoordError) + ", max normal error: " + std::to_string(packingError._maxNormalAngleError) + 
+		               " rad, " + std::to_string(packingError._degenerateNormalCount) + " degenerate normals)\n").c_str());
+
+	const auto indexFormat = finalVertexData.size() <= MAX_16BIT_INDEXED_VERTICES ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+	const auto indexSize = indexFormat == DXGI_FORMAT_R16_UINT ? sizeof(USHORT) : sizeof(UINT);
+
+	const auto vertexSize = packedVertexData.empty() ? sizeof(Vertex) : sizeof(PackedVertex);
+	const auto dedupedByteCount = finalVertexData.size() * vertexSize + finalIndexData.size() * indexSize;
+	const auto flatByteCount = indexData.size() * (sizeof(Vertex) + sizeof(UINT));
+
+	OutputDebugString((std::string("Parsed model: ") + modelDataPath + 
+		               " vertices: " + std::to_string(finalVertexData.size()) + " (from " + std::to_string(indexData.size()) + " face corners)" + 
+		               " indices: " + std::to_string(finalIndexData.size()) + (indexFormat == DXGI_FORMAT_R16_UINT ? " (16bit)" : " (32bit)") +
+		               " bytes: " + std::to_string(dedupedByteCount) + " (was " + std::to_string(flatByteCount) + ")\n").c_str());
+
 	// Calculate model dimensions
 	math::Dimensions dimensions(math::Absf(maxX, minX), math::Absf(maxY, minY), math::Absf(maxZ, minZ));
 
 	// Can't use make shared with private constructors (even if OBJLoader is Model's friend)
-	auto loadedModelData = std::make_shared<OBJLoader::ModelData>(finalVertexData, finalIndexData, dimensions, mat);
-	_objModelData[modelDataPath] = loadedModelData;
+	auto loadedModelData = std::make_shared<OBJLoader::ModelData>(finalVertexData, packedVertexData, finalIndexData, indexFormat, dimensions, mat);
+	loadedModelData->loadMilliseconds = std::chrono::duration<FLOAT, std::milli>(std::chrono::high_resolution_clock::now() - loadStart).count();
 
 	return loadedModelData;
 }
@@ -11,42 +11,90 @@
 #include "lightdef.h"
 
 // Remote Headers
+#include <future>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+class ThreadPool;
+namespace texture_atlas { struct AtlasRegion; }
+
 class OBJLoader final
 {
 public:
 	struct ModelData
 	{		
 		std::vector<Vertex> vertexData;
+		std::vector<PackedVertex> packedVertexData;
 		std::vector<UINT> indexData;
+		DXGI_FORMAT indexFormat;
 		math::Dimensions dimensions;
 		Material material;
 
-		ModelData(const std::vector<Vertex>& rawVertexData, const std::vector<UINT>& rawIndexData, const math::Dimensions& dims, const Material& mat)
+		// The atlas the texcoords were remapped into, empty when they address the model's own texture
+		std::string atlasTexturePath;
+
+		// Time spent reading the model from disk, wherever that happened
+		FLOAT loadMilliseconds;
+
+		// packedVertexData is left empty when packing the mesh would exceed the quantisation error tolerances
+		ModelData(const std::vector<Vertex>& rawVertexData, const std::vector<PackedVertex>& rawPackedVertexData, const std::vector<UINT>& rawIndexData, const DXGI_FORMAT idxFormat, const math::Dimensions& dims, const Material& mat)
 			: vertexData(rawVertexData)
+			, packedVertexData(rawPackedVertexData)
 			, indexData(rawIndexData)
+			, indexFormat(idxFormat)
 			, dimensions(dims)
 			, material(mat)
+			, loadMilliseconds(0.0f)
 		{
 		}
 	};
 
+public:
+	// Meshes with at most this many unique vertices are indexed with DXGI_FORMAT_R16_UINT
+	static const UINT MAX_16BIT_INDEXED_VERTICES = 65535U;
+
 public:
 	static OBJLoader& Get();
 	~OBJLoader();
 
 	std::shared_ptr<ModelData> LoadOBJData(const std::string& modelDataPath);
-	std::shared_ptr<ModelData> LoadOBJData(const std::string& modelDataPath, const std::vector<XMFLOAT2> customTexcoords);
+
+	// Loads the model with its texcoords moved into the region its texture occupies in an atlas. Meshes with texcoords 
+	// outside [0, 1] rely on wrapping, which an atlas cannot do, and are returned untouched with no atlasTexturePath.
+	std::shared_ptr<ModelData> LoadOBJData(const std::string& modelDataPath, const texture_atlas::AtlasRegion& atlasRegion);
+
+	// Starts reading the model on a worker. A later LoadOBJData of the same path picks up the result, 
+	// waiting only for whatever part of the read is still left.
+	void PreloadOBJData(const std::string& modelDataPath);
+
+	// Moves every finished or still running preload into the cache
+	void WaitForPreloadedModels();
+
+	// Every model read so far, in the order they were first cached
+	const std::vector<std::string>& GetLoadedModelPaths() const;
+	FLOAT GetLoadMilliseconds(const std::string& modelDataPath) const;
 
 private:
 	OBJLoader();
 	OBJLoader(const OBJLoader& rhs) = delete;
 	OBJLoader& operator = (const OBJLoader& rhs) = delete;
 
+	void CacheModelData(const std::string& modelDataPath, std::shared_ptr<ModelData> modelData);
+
+	// Touches no loader state, so it may run on any thread
+	std::shared_ptr<ModelData> ReadModelData(const std::string& modelDataPath) const;
+
 private:	
 	std::unordered_map<std::string, std::shared_ptr<ModelData>> _objModelData;
+	std::unordered_map<std::string, std::shared_future<std::shared_ptr<ModelData>>> _pendingModelData;
+	std::vector<std::string> _loadedModelPaths;
+
+	UINT _loadedModelCount;
+	UINT _packedModelCount;
+	size_t _packedVertexBytesSaved;
+
+	// Last, so that the workers are joined before anything they use is destroyed
+	std::unique_ptr<ThreadPool> _threadPool;
 };
\ No newline at end of file
@@ -0,0 +1,148 @@
+/*******************************************************************************/
+/** recordingrenderdevice.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                         **/
+/*******************************************************************************/
+
+// Local Headers
+#include "recordingrenderdevice.h"
+#include "clusteredlightgrid.h"
+#include "models/model.h"
+
+// Remote Headers
+
+RecordingRenderDevice::RecordingRenderDevice(std::unique_ptr<RenderDevice> forwardDevice)
+	: _forwardDevice(std::move(forwardDevice))
+	, _activeShaderType(shader_type::DEFAULT_3D_WITH_LIGHTING)
+	, _activeShaderVariant(0)
+	, _depthStencilEnabled(true)
+	, _wireframe(false)
+{
+}
+
+RecordingRenderDevice::~RecordingRenderDevice()
+{
+}
+
+void RecordingRenderDevice::OnResize()
+{
+	if (_forwardDevice) _forwardDevice->OnResize();
+}
+
+void RecordingRenderDevice::ClearViews()
+{
+	Record(CommandType::CLEAR_VIEWS, 0, 0, 0);
+	if (_forwardDevice) _forwardDevice->ClearViews();
+}
+
+void RecordingRenderDevice::Present()
+{
+	Record(CommandType::PRESENT, 0, 0, 0);
+	if (_forwardDevice) _forwardDevice->Present();
+
+	_lastFrameStats = _frameStats;
+	_frameStats = FrameStats();
+}
+
+void RecordingRenderDevice::SetShader(const shader_type::ShaderType shader, const UINT variant)
+{
+	if (_activeShaderType != shader || _activeShaderVariant != variant)
+	{
+		_frameStats._stateChangeCount++;
+	}
+
+	_activeShaderType = shader;
+	_activeShaderVariant = variant;
+	Record(CommandType::SET_SHADER, shader, 0, variant);
+	if (_forwardDevice) _forwardDevice->SetShader(shader, variant);
+}
+
+void RecordingRenderDevice::SetDepthStencilEnabled(const bool depthStencilEnabled)
+{
+	if (_depthStencilEnabled != depthStencilEnabled)
+	{
+		_frameStats._stateChangeCount++;
+	}
+
+	_depthStencilEnabled = depthStencilEnabled;
+	Record(CommandType::SET_DEPTH_STENCIL_ENABLED, depthStencilEnabled ? 1 : 0, 0, 0);
+	if (_forwardDevice) _forwardDevice->SetDepthStencilEnabled(depthStencilEnabled);
+}
+
+void RecordingRenderDevice::SetWireframe(const bool wireframe)
+{
+	if (_wireframe != wireframe)
+	{
+		_frameStats._stateChangeCount++;
+	}
+
+	_wireframe = wireframe;
+	Record(CommandType::SET_WIREFRAME, wireframe ? 1 : 0, 0, 0);
+	if (_forwardDevice) _forwardDevice->SetWireframe(wireframe);
+}
+
+void RecordingRenderDevice::UpdatePerFrameConstants(const shader_type::ShaderType shader, const void* perFrameConstantBufferData, const UINT byteSize)
+{
+	_frameStats._bytesUploaded += byteSize;
+	Record(CommandType::UPDATE_PER_FRAME_CONSTANTS, shader, byteSize, 0);
+	if (_forwardDevice) _forwardDevice->UpdatePerFrameConstants(shader, perFrameConstantBufferData, byteSize);
+}
+
+void RecordingRenderDevice::UpdateLightGrid(const ClusteredLightGrid& lightGrid)
+{
+	const auto lightCount = static_cast<UINT>(lightGrid.GetLights().size());
+	const auto byteSize = static_cast<UINT>(sizeof(PointLight) * lightCount + 
+	                                        sizeof(ClusteredLightGrid::ClusterLightRange) * lightGrid.GetClusterLightRanges().size() + 
+	                                        sizeof(UINT) * lightGrid.GetLightIndices().size());
+
+	_frameStats._bytesUploaded += byteSize;
+	Record(CommandType::UPDATE_LIGHT_GRID, 0, byteSize, lightCount);
+	if (_forwardDevice) _forwardDevice->UpdateLightGrid(lightGrid);
+}
+
+void RecordingRenderDevice::DrawModel(const Model& model, const void* constantBufferData, const UINT byteSize)
+{
+	_frameStats._drawCount++;
+	_frameStats._bytesUploaded += byteSize;
+	Record(CommandType::DRAW_MODEL, _activeShaderType, byteSize, model.GetIndexCount());
+	if (_forwardDevice) _forwardDevice->DrawModel(model, constantBufferData, byteSize);
+}
+
+void RecordingRenderDevice::DrawTextVertices(const std::vector<TextVertex>& vertices, const TextureViewHandle fontTexture)
+{
+	if (vertices.empty())
+	{
+		return;
+	}
+
+	const auto byteSize = static_cast<UINT>(sizeof(TextVertex) * vertices.size());
+
+	_frameStats._drawCount++;
+	_frameStats._bytesUploaded += byteSize;
+	Record(CommandType::DRAW_TEXT, shader_type::DEFAULT_TEXT, byteSize, static_cast<UINT>(vertices.size()));
+	if (_forwardDevice) _forwardDevice->DrawTextVertices(vertices, fontTexture);
+}
+
+const RenderDevice::FrameStats& RecordingRenderDevice::GetLastFrameStats() const
+{
+	return _lastFrameStats;
+}
+
+RenderDevice::DeviceHandle RecordingRenderDevice::GetDeviceHandle() const
+{
+	return _forwardDevice ? _forwardDevice->GetDeviceHandle() : DeviceHandle{ nullptr };
+}
+
+const std::vector<RecordingRenderDevice::Command>& RecordingRenderDevice::GetCommands() const
+{
+	return _commands;
+}
+
+void RecordingRenderDevice::ClearCommands()
+{
+	_commands.clear();
+}
+
+void RecordingRenderDevice::Record(const CommandType type, const UINT argument, const UINT byteSize, const UINT elementCount)
+{
+	_commands.emplace_back(type, argument, byteSize, elementCount);
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+/*****************************************************************************/
+/** recordingrenderdevice.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                       **/
+/*****************************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "renderdevice.h"
+
+// Remote Headers
+#include <memory>
+#include <vector>
+
+// Records every command issued to it into an in memory stream, optionally forwarding
+// them to another device. With no forward device nothing touches the GPU, so draw counts,
+// state changes and uploaded bytes of a frame can be inspected without one.
+class RecordingRenderDevice final: public RenderDevice
+{
+public:
+	enum class CommandType
+	{
+		CLEAR_VIEWS,
+		PRESENT,
+		SET_SHADER,
+		SET_DEPTH_STENCIL_ENABLED,
+		SET_WIREFRAME,
+		UPDATE_PER_FRAME_CONSTANTS,
+		UPDATE_LIGHT_GRID,
+		DRAW_MODEL,
+		DRAW_TEXT
+	};
+
+	struct Command
+	{
+		CommandType _type;
+		UINT _argument;      // Shader type for shader commands, the flag for state toggles
+		UINT _byteSize;      // Bytes uploaded by the command
+		UINT _elementCount;  // Indices or vertices drawn, point lights for light grid updates, the variant for shader commands
+
+		Command(const CommandType type, const UINT argument, const UINT byteSize, const UINT elementCount)
+			: _type(type)
+			, _argument(argument)
+			, _byteSize(byteSize)
+			, _elementCount(elementCount)
+		{
+		}
+	};
+
+public:
+	RecordingRenderDevice(std::unique_ptr<RenderDevice> forwardDevice);
+	~RecordingRenderDevice();
+
+	void OnResize() override;
+	void ClearViews() override;
+	void Present() override;
+
+	void SetShader(const shader_type::ShaderType shader, const UINT variant) override;
+	void SetDepthStencilEnabled(const bool depthStencilEnabled) override;
+	void SetWireframe(const bool wireframe) override;
+
+	void UpdatePerFrameConstants(const shader_type::ShaderType shader, const void* perFrameConstantBufferData, const UINT byteSize) override;
+	void UpdateLightGrid(const ClusteredLightGrid& lightGrid) override;
+	void DrawModel(const Model& model, const void* constantBufferData, const UINT byteSize) override;
+	void DrawTextVertices(const std::vector<TextVertex>& vertices, const TextureViewHandle fontTexture) override;
+
+	const FrameStats& GetLastFrameStats() const override;
+
+	// Null when there is no forward device
+	DeviceHandle GetDeviceHandle() const override;
+
+	const std::vector<Command>& GetCommands() const;
+	void ClearCommands();
+
+private:
+	void Record(const CommandType type, const UINT argument, const UINT byteSize, const UINT elementCount);
+
+private:
+	std::unique_ptr<RenderDevice> _forwardDevice;
+	std::vector<Command> _commands;
+
+	shader_type::ShaderType _activeShaderType;
+	UINT _activeShaderVariant;
+	bool _depthStencilEnabled;
+	bool _wireframe;
+
+	FrameStats _frameStats;
+	FrameStats _lastFrameStats;
+};
\ No newline at end of file
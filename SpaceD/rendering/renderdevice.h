@@ -0,0 +1,72 @@
+/********************************************************************/
+/** renderdevice.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "vertex.h"
+#include "shaders/shadertype.h"
+
+// Remote Headers
+#include <vector>
+
+// Forward declarations
+class ClusteredLightGrid;
+class Model;
+
+// Backend independent set of commands the Renderer issues a frame through. Resources (model buffers, textures) 
+// are still created on the D3D11 device handed out by GetDeviceHandle, but the interface itself names no D3D types.
+class RenderDevice
+{
+public:
+	// Opaque references to resources living on the D3D11 side of the engine. Only the code that created a resource 
+	// and the backends that draw with it look inside. Neither owns what it refers to.
+	struct DeviceHandle
+	{
+		void* _device;  // ID3D11Device
+	};
+
+	struct TextureViewHandle
+	{
+		void* _view;    // ID3D11ShaderResourceView
+	};
+
+	struct FrameStats
+	{
+		UINT _drawCount;
+		UINT _stateChangeCount;
+		UINT _bytesUploaded;
+
+		FrameStats()
+			: _drawCount(0)
+			, _stateChangeCount(0)
+			, _bytesUploaded(0)
+		{
+		}
+	};
+
+public:
+	virtual ~RenderDevice() {}
+
+	virtual void OnResize() = 0;
+	virtual void ClearViews() = 0;
+	virtual void Present() = 0;
+
+	// variant is the shader_permutation variant index of the shader type
+	virtual void SetShader(const shader_type::ShaderType shader, const UINT variant) = 0;
+	virtual void SetDepthStencilEnabled(const bool depthStencilEnabled) = 0;
+	virtual void SetWireframe(const bool wireframe) = 0;
+
+	virtual void UpdatePerFrameConstants(const shader_type::ShaderType shader, const void* perFrameConstantBufferData, const UINT byteSize) = 0;
+	virtual void UpdateLightGrid(const ClusteredLightGrid& lightGrid) = 0;
+	virtual void DrawModel(const Model& model, const void* constantBufferData, const UINT byteSize) = 0;
+	virtual void DrawTextVertices(const std::vector<TextVertex>& vertices, const TextureViewHandle fontTexture) = 0;
+
+	// Counters of the last presented frame
+	virtual const FrameStats& GetLastFrameStats() const = 0;
+
+	// Null when the backend has no device of its own
+	virtual DeviceHandle GetDeviceHandle() const = 0;
+};
\ No newline at end of file
@@ -7,23 +7,71 @@
 
 // Local Headers
 #include "renderer.h"
+#include "d3d11renderdevice.h"
+#include "clusteredlightgrid.h"
 #include "fontengine.h"
-#include "renderingcontext.h"
+#include "textbatcher.h"
 #include "shaders/default3dshader.h"
 #include "shaders/default3dwithlightingshader.h"
 #include "shaders/defaultuishader.h"
+#include "shaders/shaderpermutation.h"
 #include "../util/clientwindow.h"
 #include "models/model.h"
 
 // Remote Headers
-#include <algorithm>
+
+namespace
+{
+	// Sizes of the per object and per frame constant buffer structs each shader type expects
+	UINT GetConstantBufferSize(const Shader::ShaderType shader)
+	{
+		switch (shader)
+		{
+			case Shader::ShaderType::DEFAULT_3D: return sizeof(Default3dShader::ConstantBuffer);
+			case Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING: return sizeof(Default3dWithLightingShader::ConstantBuffer);
+			case Shader::ShaderType::DEFAULT_UI: return sizeof(DefaultUiShader::ConstantBuffer);
+			default: return 0;
+		}
+	}
+
+	// Feature state of a draw, from which its shader variant is picked. The lighting state is per frame.
+	UINT GetPermutationKey(const Shader::ShaderType shader, const void* constantBufferData, const UINT lightingPermutationKey)
+	{
+		switch (shader)
+		{
+			case Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING: return lightingPermutationKey;
+			case Shader::ShaderType::DEFAULT_UI:
+			{
+				const auto& cb = *static_cast<const DefaultUiShader::ConstantBuffer*>(constantBufferData);
+				return shader_permutation::MakeKey(0, false, cb.gSrollTexCoordsEnabled != 0, cb.gColorEnabled != 0);
+			}
+			default: return 0;
+		}
+	}
+
+	UINT GetPerFrameConstantBufferSize(const Shader::ShaderType shader)
+	{
+		switch (shader)
+		{
+			case Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING: return sizeof(Default3dWithLightingShader::PerFrameConstantBuffer);
+			default: return 0;
+		}
+	}
+}
 
 Renderer::Renderer(ClientWindow& clientWindow)
-	: _clientWindow(clientWindow)
-	, _renderingContext(new RenderingContext(clientWindow))
+	: Renderer(clientWindow, std::make_unique<D3D11RenderDevice>(clientWindow))
+{
+}
+
+Renderer::Renderer(ClientWindow& clientWindow, std::unique_ptr<RenderDevice> renderDevice)
+	: _renderDevice(std::move(renderDevice))
 	, _activeShaderType(Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING)
+	, _boundShaderType(Shader::ShaderType::SHADER_COUNT)
+	, _boundShaderVariant(0)
+	, _lightingPermutationKey(shader_permutation::MakeKey(shader_permutation::MAX_DIRECTIONAL_LIGHTS, true, false, false))
+	, _clientWindow(clientWindow)
 {
-	LoadShaders();
 	LoadFonts();
 	LoadDebugAssets();
 }
@@ -34,23 +82,23 @@ Renderer::~Renderer()
 
 void Renderer::OnResize()
 {
-	_renderingContext->OnResize();
+	_renderDevice->OnResize();
 }
 
 void Renderer::ClearViews()
 {
-	float bkgcol[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
-	_renderingContext->_deviceContext->ClearRenderTargetView(_renderingContext->_renderTargetView.Get(), bkgcol);
-	_renderingContext->_deviceContext->ClearDepthStencilView(_renderingContext->_depthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+	_renderDevice->ClearViews();
 }
 
 void Renderer::Present()
 {
-	HR(_renderingContext->_swapChain->Present(1, 0));
+	FlushText();
+	_renderDevice->Present();
 }
 
 void Renderer::SetShader(const Shader::ShaderType shader)
 {
+	// Bound on the next draw, see BindShaderVariant
 	_activeShaderType = shader;
 }
 
@@ -66,70 +114,40 @@ void Renderer::RenderText(const INT text, const XMFLOAT2& pos, const XMFLOAT4& c
 
 void Renderer::RenderText(const std::string& text, const XMFLOAT2& pos, const XMFLOAT4& color)
 {
-	std::string upperText(text);
-	std::transform(text.begin(), text.end(), upperText.begin(), ::toupper);
-
-	const auto currentShader = _activeShaderType;
-    SetShader(Shader::ShaderType::DEFAULT_UI);
-	
+	// Glyph quads are only accumulated here; all text of the frame goes out in a single draw in FlushText
 	const auto glyphSize = _fontEngine->GetSize() * _clientWindow.GetAspectRatio();
-
-	DefaultUiShader::ConstantBuffer cb;
-	cb.gColor = color;
-	cb.gColorEnabled = 1;
-	cb.gSrollTexCoordsEnabled = 0;
-	cb.gTexCoordOffsets.x = 0.0f;
-	cb.gTexCoordOffsets.y = 0.0f;
-
-	XMFLOAT2 posCounter(pos);
-
-	for (auto i = 0U; i < upperText.size(); ++i)
-	{
-		if (upperText[i] == ' ')
-		{
-			posCounter.x += glyphSize;
-			continue;
-		}
-		posCounter.x += glyphSize * 2;
-
-		const auto letter = std::string(1, upperText[i]);
-		auto& glyph  = _fontEngine->GetGlyph(letter);
-		
-		glyph.GetTransform()._translation.x = posCounter.x;
-		glyph.GetTransform()._translation.y = posCounter.y;
-		glyph.GetTransform()._scale = XMFLOAT3(glyphSize, glyphSize, glyphSize);
-		cb.gWorld = glyph.CalculateWorldMatrix();
-		
-		RenderModel(glyph, &cb);
-	}
-
-	SetShader(currentShader);
+	_textBatcher->AddText(text, pos, color, glyphSize, *_fontEngine);
 }
 
 void Renderer::RenderModel(const Model& model, const void* constantBufferData)
 {	
-	auto& activeShader = _shaders[_activeShaderType];
-	_renderingContext->_deviceContext->UpdateSubresource(activeShader->getConstantBuffer().Get(), 0, 0, constantBufferData, 0, 0);
-
-	auto stride = sizeof(Vertex);
-	auto offset = 0U;
+	BindShaderVariant(constantBufferData);
+	_renderDevice->DrawModel(model, constantBufferData, GetConstantBufferSize(_activeShaderType));
+}
 
-	// Input Assembly Stage
-	_renderingContext->_deviceContext->IASetInputLayout(activeShader->getInputLayout().Get());
-	_renderingContext->_deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	_renderingContext->_deviceContext->IASetVertexBuffers(0, 1, model.GetVertexBuffer().GetAddressOf(), &stride, &offset);
-	_renderingContext->_deviceContext->IASetIndexBuffer(model.GetIndexBuffer().Get(), DXGI_FORMAT_R32_UINT, 0);
+void Renderer::UpdatePerFrameConstants(const Shader::ShaderType shader, const void* perFrameConstantBufferData)
+{
+	const auto byteSize = GetPerFrameConstantBufferSize(shader);
+	if (byteSize > 0)
+	{
+		_renderDevice->UpdatePerFrameConstants(shader, perFrameConstantBufferData, byteSize);
+	}
 
-	// Vertex Shader Stage
-	_renderingContext->_deviceContext->VSSetShader(activeShader->getVertexShader().Get(), 0, 0);
-	_renderingContext->_deviceContext->VSSetConstantBuffers(0, 1, activeShader->getConstantBuffer().GetAddressOf());
+	if (shader == Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING)
+	{
+		const auto& perFrameCb = *static_cast<const Default3dWithLightingShader::PerFrameConstantBuffer*>(perFrameConstantBufferData);
+		const auto pointLights = (_lightingPermutationKey & shader_permutation::POINT_LIGHTS_BIT) != 0;
+		_lightingPermutationKey = shader_permutation::MakeKey(static_cast<UINT>(perFrameCb.gDirectionalLightCount), pointLights, false, false);
+	}
+}
 
-	// Pixel Shader Stage
-	_renderingContext->_deviceContext->PSSetShader(activeShader->getPixelShader().Get(), 0, 0);
-	_renderingContext->_deviceContext->PSSetShaderResources(0, 1, model.GetTexture().GetAddressOf());
-	_renderingContext->_deviceContext->PSSetConstantBuffers(0, 1, activeShader->getConstantBuffer().GetAddressOf());
+void Renderer::UpdateLightGrid(const ClusteredLightGrid& lightGrid)
+{
+	_renderDevice->UpdateLightGrid(lightGrid);
 
-	_renderingContext->_deviceContext->DrawIndexed(model.GetIndexCount(), 0, 0);
+	// Without any point light the variant skipping the cluster loop is used
+	const auto directionalLightCount = shader_permutation::GetDirectionalLightCount(_lightingPermutationKey);
+	_lightingPermutationKey = shader_permutation::MakeKey(directionalLightCount, !lightGrid.GetLights().empty(), false, false);
 }
 
 void Renderer::RenderDebugSphere(const XMFLOAT3& pos, const XMFLOAT3& scale, const XMMATRIX& viewMatrix, const XMMATRIX& projMatrix)
@@ -145,9 +163,9 @@ void Renderer::RenderDebugSphere(const XMFLOAT3& pos, const XMFLOAT3& scale, con
 	cb.gWorldInvTranspose = math::InverseTranspose(cb.gWorld);
 	cb.gWorldViewProj = cb.gWorld * viewMatrix * projMatrix;
 
-	_renderingContext->SetWireframe(true);
+	_renderDevice->SetWireframe(true);
 	RenderModel(*_debugSphereModel, &cb);
-	_renderingContext->SetWireframe(false);
+	_renderDevice->SetWireframe(false);
 	SetShader(currentShader);
 }
 
@@ -156,37 +174,48 @@ void Renderer::RenderPointLight(const XMFLOAT3& pos, const FLOAT range, const XM
 	RenderDebugSphere(pos, XMFLOAT3(range * 2, range * 2, range * 2), viewMatrix, projMatrix);
 }
 
-comptr<ID3D11Device> Renderer::GetDevice() const
+const RenderDevice::FrameStats& Renderer::GetLastFrameStats() const
 {
-	return _renderingContext->_device;
+	return _renderDevice->GetLastFrameStats();
 }
 
-comptr<ID3D11DeviceContext> Renderer::GetDeviceContext() const
+comptr<ID3D11Device> Renderer::GetDevice() const
 {
-	return _renderingContext->_deviceContext;
+	return static_cast<ID3D11Device*>(_renderDevice->GetDeviceHandle()._device);
 }
 
 void Renderer::SetDepthStencilEnabled(const bool depthStencilEnabled)
 {
-	_renderingContext->SetDepthStencilEnabled(depthStencilEnabled);
+	_renderDevice->SetDepthStencilEnabled(depthStencilEnabled);
 }
 
-void Renderer::LoadShaders()
+void Renderer::FlushText()
 {
-	_shaders.clear();
-	_shaders.resize(Shader::ShaderType::SHADER_COUNT);
-	_shaders[Shader::ShaderType::DEFAULT_3D] = std::move(std::unique_ptr<Shader>(new Default3dShader(_renderingContext->_device)));
-	_shaders[Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING] = std::move(std::unique_ptr<Shader>(new Default3dWithLightingShader(_renderingContext->_device)));
-	_shaders[Shader::ShaderType::DEFAULT_UI] = std::move(std::unique_ptr<Shader>(new DefaultUiShader(_renderingContext->_device)));
+	_renderDevice->DrawTextVertices(_textBatcher->GetVertices(), { _fontEngine->GetTexture().Get() });
+	_textBatcher->OnFrameEnd();
+}
+
+void Renderer::BindShaderVariant(const void* constantBufferData)
+{
+	const auto permutationKey = GetPermutationKey(_activeShaderType, constantBufferData, _lightingPermutationKey);
+	const auto variant = shader_permutation::GetVariantIndex(_activeShaderType, permutationKey);
+
+	if (_activeShaderType != _boundShaderType || variant != _boundShaderVariant)
+	{
+		_renderDevice->SetShader(_activeShaderType, variant);
+		_boundShaderType = _activeShaderType;
+		_boundShaderVariant = variant;
+	}
 }
 
 void Renderer::LoadFonts()
 {
-	_fontEngine = std::make_unique<FontEngine>("orena", _renderingContext->_device);
+	_fontEngine = std::make_unique<FontEngine>("orena", GetDevice());
+	_textBatcher = std::make_unique<TextBatcher>();
 }
 
 void Renderer::LoadDebugAssets()
 {
 	_debugSphereModel = std::make_unique<Model>("debug_sphere");
-	_debugSphereModel->LoadModelComponents(_renderingContext->_device);
+	_debugSphereModel->LoadModelComponents(GetDevice());
 }
\ No newline at end of file
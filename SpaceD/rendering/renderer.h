@@ -8,6 +8,7 @@
 // Local Headers
 #include "d3dcommon.h"
 #include "../util/math.h"
+#include "renderdevice.h"
 #include "shaders/shader.h"
 
 // Remote Headers
@@ -15,7 +16,8 @@
 #include <vector>
 
 // Forward declarations
-class RenderingContext;
+class ClusteredLightGrid;
+class TextBatcher;
 class ClientWindow;
 class FontEngine;
 class Model;
@@ -23,7 +25,9 @@ class Model;
 class Renderer final
 {
 public:
+	// Renders through a D3D11RenderDevice created for the window
 	Renderer(ClientWindow& clientWindow);
+	Renderer(ClientWindow& clientWindow, std::unique_ptr<RenderDevice> renderDevice);
 	~Renderer();
 
 	void OnResize();
@@ -37,23 +41,32 @@ public:
 	void RenderDebugSphere(const XMFLOAT3& pos, const XMFLOAT3& scale, const XMMATRIX& viewMatrix, const XMMATRIX& projMatrix);
 	void RenderPointLight(const XMFLOAT3& pos, const FLOAT range, const XMMATRIX& viewMatrix, const XMMATRIX& projMatrix);
 	void RenderModel(const Model& model, const void* constantBufferData);
+	void UpdatePerFrameConstants(const Shader::ShaderType shader, const void* perFrameConstantBufferData);
+	void UpdateLightGrid(const ClusteredLightGrid& lightGrid);
 
 	void SetDepthStencilEnabled(const bool depthStencilEnabled);
 
+	const RenderDevice::FrameStats& GetLastFrameStats() const;
+
 	comptr<ID3D11Device> GetDevice() const;
-	comptr<ID3D11DeviceContext> GetDeviceContext() const;
 
 private:
-	void LoadShaders();
 	void LoadFonts();
 	void LoadDebugAssets();
+	void FlushText();
+	void BindShaderVariant(const void* constantBufferData);
 
 private:
+	std::unique_ptr<RenderDevice> _renderDevice;
 	std::unique_ptr<Model> _debugSphereModel;
 	std::unique_ptr<FontEngine> _fontEngine;
-	std::unique_ptr<RenderingContext> _renderingContext;
-	std::vector<std::unique_ptr<Shader>> _shaders;
+	std::unique_ptr<TextBatcher> _textBatcher;
 	Shader::ShaderType _activeShaderType;
+
+	// The device is only switched to a shader once a draw has picked its permutation variant
+	Shader::ShaderType _boundShaderType;
+	UINT _boundShaderVariant;
+	UINT _lightingPermutationKey;
 	ClientWindow& _clientWindow;
 
 };
\ No newline at end of file
@@ -21,6 +21,7 @@
 RenderingContext::RenderingContext(ClientWindow& clientWindow)
 	: _device(0)
 	, _deviceContext(0)
+	, _deviceContext1(0)
 	, _swapChain(0)
 	, _renderTargetView(0)
 	, _depthStencilView(0)
@@ -92,14 +93,25 @@ void RenderingContext::OnResize()
 	_deviceContext->RSSetViewports(1, &_screenViewport);
 }
 
-void RenderingContext::SetWireframe(const bool wireframe)
+void RenderingContext::SetWireframe(ID3D11DeviceContext* context, const bool wireframe) const
 {
-	_deviceContext->RSSetState(wireframe ? _wireframeRastState.Get(): _defaultRastState.Get());
+	context->RSSetState(wireframe ? _wireframeRastState.Get(): _defaultRastState.Get());
 }
 
-void RenderingContext::SetDepthStencilEnabled(const bool depthStencilEnabled)
+void RenderingContext::SetDepthStencilEnabled(ID3D11DeviceContext* context, const bool depthStencilEnabled) const
 {
-	_deviceContext->OMSetDepthStencilState(depthStencilEnabled ? _depthStencilEnabledState.Get() : _depthStencilDisabledState.Get(), 1);
+	context->OMSetDepthStencilState(depthStencilEnabled ? _depthStencilEnabledState.Get() : _depthStencilDisabledState.Get(), 1);
+}
+
+void RenderingContext::ApplyPipelineState(ID3D11DeviceContext* context, const bool depthEnabled, const bool wireframe) const
+{
+	context->OMSetRenderTargets(1, _renderTargetView.GetAddressOf(), _depthStencilView.Get());
+	context->RSSetViewports(1, &_screenViewport);
+	context->OMSetBlendState(_blendState.Get(), 0, 0xFFFFFFFF);
+	context->PSSetSamplers(0, 1, _samplerState.GetAddressOf());
+
+	SetWireframe(context, wireframe);
+	SetDepthStencilEnabled(context, depthEnabled);
 }
 
 void RenderingContext::InitD3D()
@@ -155,6 +167,12 @@ void RenderingContext::InitD3D()
 		PostQuitMessage(-1);
 	}
 
+	// The D3D11.1 context interface is only present on the 11.1 runtime (used for constant buffer offsetting)
+	if (FAILED(_deviceContext.As(&_deviceContext1)))
+	{
+		_deviceContext1.Reset();
+	}
+
 	// Check MSAA 4x support
 	HR(_device->CheckMultisampleQualityLevels(DXGI_FORMAT_R8G8B8A8_UNORM, 4, &_msaaQuality));
 	std::ostringstream msaaQualityStream;
@@ -13,13 +13,13 @@
 #include "vertex.h"
 
 // Forward Declarations
-class Renderer;
+class D3D11RenderDevice;
 class ClientWindow;
 class Model;
 
 class RenderingContext final
 {
-	friend class Renderer;
+	friend class D3D11RenderDevice;
 
 public:
 	~RenderingContext();
@@ -29,12 +29,17 @@ private:
 	
 	void InitD3D();
 	void OnResize();
-	void SetWireframe(const bool wireframe);
-	void SetDepthStencilEnabled(const bool depthEnabled);
+	void SetWireframe(ID3D11DeviceContext* context, const bool wireframe) const;
+	void SetDepthStencilEnabled(ID3D11DeviceContext* context, const bool depthEnabled) const;
+
+	// Binds the views and every fixed function state the immediate context is set up with, for 
+	// deferred contexts which start out from the default pipeline state
+	void ApplyPipelineState(ID3D11DeviceContext* context, const bool depthEnabled, const bool wireframe) const;
 
 private:
 	comptr<ID3D11Device> _device;
 	comptr<ID3D11DeviceContext> _deviceContext;
+	comptr<ID3D11DeviceContext1> _deviceContext1;
 	comptr<IDXGISwapChain> _swapChain;
 	comptr<ID3D11RenderTargetView> _renderTargetView;
 	comptr<ID3D11DepthStencilView> _depthStencilView;
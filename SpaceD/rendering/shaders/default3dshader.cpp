@@ -15,19 +15,22 @@ Default3dShader::~Default3dShader()
 }
 
 Default3dShader::Default3dShader(comptr<ID3D11Device> device)
-	: Shader("default3d", device)
+	: Shader("default3d", ShaderType::DEFAULT_3D, device)
 {
 	PrepareConstantBuffersAndLayout(device);
+	PreparePackedVertexVariant(device);
 }
 
 void Default3dShader::PrepareConstantBuffersAndLayout(comptr<ID3D11Device> device)
 {
 	D3D11_BUFFER_DESC cbd = {};
-	cbd.Usage             = D3D11_USAGE_DEFAULT;
+	cbd.Usage             = D3D11_USAGE_DYNAMIC;
 	cbd.BindFlags         = D3D11_BIND_CONSTANT_BUFFER;
+	cbd.CPUAccessFlags    = D3D11_CPU_ACCESS_WRITE;
 	cbd.ByteWidth         = sizeof(ConstantBuffer);
 
 	device->CreateBuffer(&cbd, 0, &_constantBuffer);
+	_constantBufferSize = cbd.ByteWidth;
 
 	D3D11_INPUT_ELEMENT_DESC vertexDesc[] =
 	{
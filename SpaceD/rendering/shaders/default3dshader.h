@@ -13,10 +13,12 @@
 
 // Forward declare friends
 class Renderer;
+class D3D11RenderDevice;
 
 class Default3dShader: public Shader
 {
 	friend class Renderer;
+	friend class D3D11RenderDevice;
 
 public:
 	struct ConstantBuffer
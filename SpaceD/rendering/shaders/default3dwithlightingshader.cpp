@@ -15,19 +15,27 @@ Default3dWithLightingShader::~Default3dWithLightingShader()
 }
 
 Default3dWithLightingShader::Default3dWithLightingShader(comptr<ID3D11Device> device)
-	: Shader("default3dwithlighting", device)
+	: Shader("default3dwithlighting", ShaderType::DEFAULT_3D_WITH_LIGHTING, device)
 {
 	PrepareConstantBuffersAndLayout(device);
+	PreparePackedVertexVariant(device);
 }
 
 void Default3dWithLightingShader::PrepareConstantBuffersAndLayout(comptr<ID3D11Device> device)
 {
 	D3D11_BUFFER_DESC cbd = {};
-	cbd.Usage = D3D11_USAGE_DEFAULT;
+	cbd.Usage = D3D11_USAGE_DYNAMIC;
 	cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	cbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 	cbd.ByteWidth = sizeof(ConstantBuffer);
 
 	device->CreateBuffer(&cbd, 0, &_constantBuffer);
+	_constantBufferSize = cbd.ByteWidth;
+
+	cbd.ByteWidth = sizeof(PerFrameConstantBuffer);
+
+	device->CreateBuffer(&cbd, 0, &_perFrameConstantBuffer);
+	_perFrameConstantBufferSize = cbd.ByteWidth;
 
 	D3D11_INPUT_ELEMENT_DESC vertexDesc[] =
 	{
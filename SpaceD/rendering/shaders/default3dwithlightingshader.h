@@ -14,29 +14,37 @@
 
 // Forward declare friends
 class Renderer;
+class D3D11RenderDevice;
 
 class Default3dWithLightingShader: public Shader
 {
 	friend class Renderer;
+	friend class D3D11RenderDevice;
 
 public:
-	static const UINT MAX_POINT_LIGHTS = 16U;
 	static const UINT MAX_DIRECTIONAL_LIGHTS = 4U;
 
 public:
+	// Per object data, uploaded for every draw call
 	struct ConstantBuffer
 	{
 		XMMATRIX gWorld;
 		XMMATRIX gWorldInvTranspose;
-		XMMATRIX gWorldViewProj;
 		Material gMaterial;
+	};
+
+	// Per frame data (lights, eye position and view projection), uploaded once per frame.
+	// Point lights are not part of it; they come from the ClusteredLightGrid structured buffers.
+	struct PerFrameConstantBuffer
+	{
+		XMMATRIX gViewProj;
 		DirectionalLight gDirectionalLights[MAX_DIRECTIONAL_LIGHTS];
-		PointLight gPointLights[MAX_POINT_LIGHTS];
 		SpotLight gSpotLight;
 		XMFLOAT3 gEyePosW;
 		int gDirectionalLightCount;
-		int gPointLightCount;
-		XMFLOAT3 gPad;
+		XMFLOAT2 gClusterScreenToTile;
+		FLOAT gClusterDepthScale;
+		FLOAT gClusterDepthBias;
 	};
 
 public:
@@ -0,0 +1,31 @@
+/***************************************************************************/
+/** defaulttextshader.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                     **/
+/***************************************************************************/
+
+// Local Headers
+#include "defaulttextshader.h"
+
+// Remote Headers
+
+DefaultTextShader::~DefaultTextShader()
+{
+}
+
+DefaultTextShader::DefaultTextShader(comptr<ID3D11Device> device)
+	: Shader("defaulttext", ShaderType::DEFAULT_TEXT, device)
+{
+	PrepareConstantBuffersAndLayout(device);
+}
+
+void DefaultTextShader::PrepareConstantBuffersAndLayout(comptr<ID3D11Device> device)
+{
+	D3D11_INPUT_ELEMENT_DESC vertexDesc[] =
+	{
+		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 20, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+	};
+
+	HR(device->CreateInputLayout(vertexDesc, ARRAYSIZE(vertexDesc), _vsBlob->GetBufferPointer(), _vsBlob->GetBufferSize(), &_inputLayout));
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+/*************************************************************************/
+/** defaulttextshader.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                   **/
+/*************************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "shader.h"
+#include "../../util/math.h"
+
+// Remote Headers
+
+// Text is drawn from batched, screen space TextVertex quads with per vertex colors, 
+// so this shader has no constant buffer
+class DefaultTextShader: public Shader
+{
+	friend class Renderer;
+	friend class D3D11RenderDevice;
+
+public:
+	~DefaultTextShader();
+
+private:
+	DefaultTextShader(comptr<ID3D11Device> device);
+
+protected:
+	void PrepareConstantBuffersAndLayout(comptr<ID3D11Device> device) override;
+};
\ No newline at end of file
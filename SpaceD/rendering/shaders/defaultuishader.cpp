@@ -14,19 +14,22 @@ DefaultUiShader::~DefaultUiShader()
 }
 
 DefaultUiShader::DefaultUiShader(comptr<ID3D11Device> device)
-	: Shader("defaultui", device)
+	: Shader("defaultui", ShaderType::DEFAULT_UI, device)
 {
 	PrepareConstantBuffersAndLayout(device);
+	PreparePackedVertexVariant(device);
 }
 
 void DefaultUiShader::PrepareConstantBuffersAndLayout(comptr<ID3D11Device> device)
 {
 	D3D11_BUFFER_DESC cbd = {};
-	cbd.Usage = D3D11_USAGE_DEFAULT;
+	cbd.Usage = D3D11_USAGE_DYNAMIC;
 	cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	cbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 	cbd.ByteWidth = sizeof(ConstantBuffer);
 
 	device->CreateBuffer(&cbd, 0, &_constantBuffer);
+	_constantBufferSize = cbd.ByteWidth;
 
 	D3D11_INPUT_ELEMENT_DESC vertexDesc[] =
 	{
@@ -14,6 +14,7 @@
 class DefaultUiShader: Shader
 {
 	friend class Renderer;
+	friend class D3D11RenderDevice;
 
 public:
 	struct ConstantBuffer
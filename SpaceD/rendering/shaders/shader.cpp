@@ -7,10 +7,49 @@
 
 // Local Headers
 #include "shader.h"
+#include "shadercache.h"
+#include "shaderpermutation.h"
 
 // Remote Headers
 #include <d3dx11.h>
 
+namespace
+{
+	// Macro list for one permutation variant; owns the strings the macros point to
+	struct VariantDefines
+	{
+		VariantDefines(const UINT key, const bool packedVertex)
+			: _directionalLightCount(std::to_string(shader_permutation::GetDirectionalLightCount(key)))
+		{
+			const auto flag = [](const bool enabled) { return enabled ? "1" : "0"; };
+
+			_macros.push_back({ "DIRECTIONAL_LIGHT_COUNT", _directionalLightCount.c_str() });
+			_macros.push_back({ "POINT_LIGHTS", flag((key & shader_permutation::POINT_LIGHTS_BIT) != 0) });
+			_macros.push_back({ "SCROLL_TEXCOORDS", flag((key & shader_permutation::SCROLL_TEXCOORDS_BIT) != 0) });
+			_macros.push_back({ "COLOR_OVERRIDE", flag((key & shader_permutation::COLOR_OVERRIDE_BIT) != 0) });
+			if (packedVertex)
+			{
+				_macros.push_back({ "PACKED_VERTEX", "1" });
+			}
+			_macros.push_back({ 0, 0 });
+		}
+
+		std::string _directionalLightCount;
+		std::vector<D3D10_SHADER_MACRO> _macros;
+	};
+
+	// Variant with the lowest index whose key agrees with key on the given feature bits
+	UINT FindFirstEquivalentVariant(const Shader::ShaderType shader, const UINT key, const UINT stageFeatures)
+	{
+		auto variant = 0U;
+		while ((shader_permutation::GetVariantKey(shader, variant) & stageFeatures) != (key & stageFeatures))
+		{
+			variant++;
+		}
+		return variant;
+	}
+}
+
 // Constant members
 const std::string Shader::SHADER_DIRECTORY_PATH = "../res/shaders/";
 
@@ -22,14 +61,22 @@ const std::string Shader::SHADER_PIXEL_EXT          = ".ps";
 const std::string Shader::SHADER_PIXEL_ENTRY_NAME   = "PS";
 const std::string Shader::SHADER_PIXEL_PROFILE_NAME = "ps_5_0"; 
 
-Shader::Shader(const std::string& name, comptr<ID3D11Device> device)
+const UINT Shader::SHADER_COMPILE_FLAGS = D3D10_SHADER_ENABLE_STRICTNESS;
+
+Shader::Shader(const std::string& name, const ShaderType type, comptr<ID3D11Device> device)
 	: _name(name)
-	, _vShader(0)
-    , _pShader(0)
+	, _type(type)
+	, _vShaders(shader_permutation::GetVariantCount(type))
+	, _pShaders(shader_permutation::GetVariantCount(type))
 	, _inputLayout(0)
+	, _packedInputLayout(0)
     , _constantBuffer(0)
+    , _perFrameConstantBuffer(0)
     , _vsBlob(0)
     , _psBlob(0)
+    , _packedVsBlob(0)
+	, _constantBufferSize(0)
+	, _perFrameConstantBufferSize(0)
 {
 	Compile(device);
 }
@@ -38,14 +85,19 @@ Shader::~Shader()
 {
 }
 
-comptr<ID3D11VertexShader> Shader::getVertexShader() const
+UINT Shader::getVariantCount() const
 {
-	return _vShader;
+	return static_cast<UINT>(_vShaders.size());
 }
 
-comptr<ID3D11PixelShader> Shader::getPixelShader() const
+comptr<ID3D11VertexShader> Shader::getVertexShader(const UINT variant /* 0 */) const
 {
-	return _pShader;
+	return _vShaders[variant];
+}
+
+comptr<ID3D11PixelShader> Shader::getPixelShader(const UINT variant /* 0 */) const
+{
+	return _pShaders[variant];
 }
 
 comptr<ID3D11InputLayout> Shader::getInputLayout() const
@@ -53,11 +105,36 @@ comptr<ID3D11InputLayout> Shader::getInputLayout() const
 	return _inputLayout;
 }
 
+comptr<ID3D11VertexShader> Shader::getPackedVertexShader(const UINT variant /* 0 */) const
+{
+	return _packedVShaders.empty() ? nullptr : _packedVShaders[variant];
+}
+
+comptr<ID3D11InputLayout> Shader::getPackedInputLayout() const
+{
+	return _packedInputLayout;
+}
+
 comptr<ID3D11Buffer> Shader::getConstantBuffer() const
 {
 	return _constantBuffer;
 }
 
+comptr<ID3D11Buffer> Shader::getPerFrameConstantBuffer() const
+{
+	return _perFrameConstantBuffer;
+}
+
+UINT Shader::getConstantBufferSize() const
+{
+	return _constantBufferSize;
+}
+
+UINT Shader::getPerFrameConstantBufferSize() const
+{
+	return _perFrameConstantBufferSize;
+}
+
 comptr<ID3D10Blob> Shader::getVertexShaderBlob() const
 {
 	return _vsBlob;
@@ -68,32 +145,100 @@ comptr<ID3D10Blob> Shader::getPixelShaderBlob() const
 	return _psBlob;
 }
 
-void Shader::Compile(comptr<ID3D11Device> device)
+void Shader::PreparePackedVertexVariant(comptr<ID3D11Device> device)
 {
-	ID3D10Blob* errorMessage;
+	const auto vertexShaderPath = SHADER_DIRECTORY_PATH + _name + SHADER_VERTEX_EXT;
 
-	HRESULT result = D3DX11CompileFromFile(std::string(SHADER_DIRECTORY_PATH + _name + SHADER_VERTEX_EXT).c_str(), 0, 0, SHADER_VERTEX_ENTRY_NAME.c_str(), SHADER_VERTEX_PROFILE_NAME.c_str(), D3D10_SHADER_ENABLE_STRICTNESS, 0, 0, &_vsBlob, &errorMessage, 0);
+	_packedVShaders.resize(_vShaders.size());
+	for (auto variant = 0U; variant < _packedVShaders.size(); ++variant)
+	{
+		const auto key = shader_permutation::GetVariantKey(_type, variant);
+		const auto sharedVariant = FindFirstEquivalentVariant(_type, key, shader_permutation::VERTEX_STAGE_FEATURES);
+		if (sharedVariant < variant)
+		{
+			_packedVShaders[variant] = _packedVShaders[sharedVariant];
+			continue;
+		}
 
-	if (FAILED(result))
+		auto packedVsBlob = CompileVariant(vertexShaderPath, SHADER_VERTEX_ENTRY_NAME, SHADER_VERTEX_PROFILE_NAME, key, true);
+		HR(device->CreateVertexShader(packedVsBlob->GetBufferPointer(), packedVsBlob->GetBufferSize(), 0, &_packedVShaders[variant]));
+
+		if (variant == 0)
+		{
+			_packedVsBlob = packedVsBlob;
+		}
+	}
+
+	D3D11_INPUT_ELEMENT_DESC packedVertexDesc[] =
 	{
-		if (errorMessage)
+		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, 16, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+	};
+
+	// Every variant has the same input signature
+	HR(device->CreateInputLayout(packedVertexDesc, ARRAYSIZE(packedVertexDesc), _packedVsBlob->GetBufferPointer(), _packedVsBlob->GetBufferSize(), &_packedInputLayout));
+}
+
+void Shader::Compile(comptr<ID3D11Device> device)
+{
+	const auto vertexShaderPath = SHADER_DIRECTORY_PATH + _name + SHADER_VERTEX_EXT;
+	const auto pixelShaderPath  = SHADER_DIRECTORY_PATH + _name + SHADER_PIXEL_EXT;
+
+	// Variants that only differ in features one stage ignores share that stage's shader object
+	for (auto variant = 0U; variant < _vShaders.size(); ++variant)
+	{
+		const auto key = shader_permutation::GetVariantKey(_type, variant);
+
+		const auto sharedVertexVariant = FindFirstEquivalentVariant(_type, key, shader_permutation::VERTEX_STAGE_FEATURES);
+		if (sharedVertexVariant < variant)
 		{
-			MessageBoxA(0, (char*)errorMessage->GetBufferPointer(), 0, 0);
+			_vShaders[variant] = _vShaders[sharedVertexVariant];
 		}
 		else
 		{
-			DXTrace(__FILE__, (DWORD)__LINE__, result, "D3DX11CompileFromFile", true);
+			auto vsBlob = CompileVariant(vertexShaderPath, SHADER_VERTEX_ENTRY_NAME, SHADER_VERTEX_PROFILE_NAME, key, false);
+			HR(device->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), 0, &_vShaders[variant]));
+			if (variant == 0) _vsBlob = vsBlob;
+		}
+
+		const auto sharedPixelVariant = FindFirstEquivalentVariant(_type, key, shader_permutation::PIXEL_STAGE_FEATURES);
+		if (sharedPixelVariant < variant)
+		{
+			_pShaders[variant] = _pShaders[sharedPixelVariant];
+		}
+		else
+		{
+			auto psBlob = CompileVariant(pixelShaderPath, SHADER_PIXEL_ENTRY_NAME, SHADER_PIXEL_PROFILE_NAME, key, false);
+			HR(device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), 0, &_pShaders[variant]));
+			if (variant == 0) _psBlob = psBlob;
 		}
 	}
+}
 
-	if (errorMessage)
+comptr<ID3D10Blob> Shader::CompileVariant(const std::string& path, const std::string& entryName, const std::string& profileName, const UINT key, const bool packedVertex) const
+{
+	const VariantDefines defines(key, packedVertex);
+	return CompileFromFile(path, entryName, profileName, &defines._macros[0]);
+}
+
+comptr<ID3D10Blob> Shader::CompileFromFile(const std::string& path, const std::string& entryName, const std::string& profileName, const D3D10_SHADER_MACRO* defines) const
+{
+	// Unchanged shaders are loaded from the bytecode cache instead of being compiled again
+	const auto cacheKey = shader_cache::ComputeKey(path, entryName, profileName, defines, SHADER_COMPILE_FLAGS);
+	if (cacheKey != 0)
 	{
-		errorMessage->Release();
+		auto cachedBlob = shader_cache::Load(cacheKey);
+		if (cachedBlob)
+		{
+			return cachedBlob;
+		}
 	}
 
-	HR(device->CreateVertexShader(_vsBlob->GetBufferPointer(), _vsBlob->GetBufferSize(), 0, &_vShader));
+	comptr<ID3D10Blob> shaderBlob;
+	ID3D10Blob* errorMessage = 0;
 
-	result = D3DX11CompileFromFile(std::string(SHADER_DIRECTORY_PATH + _name + SHADER_PIXEL_EXT).c_str(), 0, 0, SHADER_PIXEL_ENTRY_NAME.c_str(), SHADER_PIXEL_PROFILE_NAME.c_str(), D3D10_SHADER_ENABLE_STRICTNESS, 0, 0, &_psBlob, &errorMessage, 0);
+	HRESULT result = D3DX11CompileFromFile(path.c_str(), defines, 0, entryName.c_str(), profileName.c_str(), SHADER_COMPILE_FLAGS, 0, 0, &shaderBlob, &errorMessage, 0);
 
 	if (FAILED(result))
 	{
@@ -107,10 +252,15 @@ void Shader::Compile(comptr<ID3D11Device> device)
 		}
 	}
 
-	HR(device->CreatePixelShader(_psBlob->GetBufferPointer(), _psBlob->GetBufferSize(), 0, &_pShader));
-
 	if (errorMessage)
 	{
 		errorMessage->Release();
 	}
+
+	if (SUCCEEDED(result) && cacheKey != 0)
+	{
+		shader_cache::Store(cacheKey, shaderBlob);
+	}
+
+	return shaderBlob;
 }
\ No newline at end of file
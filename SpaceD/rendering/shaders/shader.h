@@ -7,37 +7,46 @@
 
 // Local Headers
 #include "../d3dcommon.h"
+#include "shadertype.h"
 
 // Remote Headers
 #include <string>
+#include <vector>
 
 class Shader
 {
 public:
-	enum ShaderType
-	{
-		DEFAULT_3D = 0,
-		DEFAULT_3D_WITH_LIGHTING = 1,
-		DEFAULT_UI = 2,
-		SHADER_COUNT = 3
-	};
+	typedef shader_type::ShaderType ShaderType;
 
 public:
-	Shader(const std::string& name, comptr<ID3D11Device> device);
+	// Compiles every permutation variant of the shader type, see shader_permutation
+	Shader(const std::string& name, const ShaderType type, comptr<ID3D11Device> device);
 	virtual ~Shader();
 
-	comptr<ID3D11VertexShader> getVertexShader() const;
-	comptr<ID3D11PixelShader> getPixelShader() const;
+	UINT getVariantCount() const;
+	comptr<ID3D11VertexShader> getVertexShader(const UINT variant = 0) const;
+	comptr<ID3D11PixelShader> getPixelShader(const UINT variant = 0) const;
 	comptr<ID3D11InputLayout> getInputLayout() const;
+	comptr<ID3D11VertexShader> getPackedVertexShader(const UINT variant = 0) const;
+	comptr<ID3D11InputLayout> getPackedInputLayout() const;
 	comptr<ID3D11Buffer> getConstantBuffer() const;
+	comptr<ID3D11Buffer> getPerFrameConstantBuffer() const;
+	UINT getConstantBufferSize() const;
+	UINT getPerFrameConstantBufferSize() const;
 	comptr<ID3D10Blob> getVertexShaderBlob() const;
 	comptr<ID3D10Blob> getPixelShaderBlob() const;
 
 protected:
 	virtual void PrepareConstantBuffersAndLayout(comptr<ID3D11Device> device) = 0;
 
+	// Compiles the vertex shader variants again with PACKED_VERTEX defined and creates the PackedVertex input layout 
+	// for them. Called by the shaders that render models.
+	void PreparePackedVertexVariant(comptr<ID3D11Device> device);
+
 private:
 	void Compile(comptr<ID3D11Device> device);
+	comptr<ID3D10Blob> CompileVariant(const std::string& path, const std::string& entryName, const std::string& profileName, const UINT key, const bool packedVertex) const;
+	comptr<ID3D10Blob> CompileFromFile(const std::string& path, const std::string& entryName, const std::string& profileName, const D3D10_SHADER_MACRO* defines) const;
 
 protected:
 	static const std::string SHADER_DIRECTORY_PATH;
@@ -50,13 +59,25 @@ protected:
 	static const std::string SHADER_PIXEL_ENTRY_NAME;
 	static const std::string SHADER_PIXEL_PROFILE_NAME;
 
+	static const UINT SHADER_COMPILE_FLAGS;
+
 protected:
-	const std::string& _name;
+	const std::string _name;
+	const ShaderType _type;
+
+	// Indexed by permutation variant
+	std::vector<comptr<ID3D11VertexShader>> _vShaders;
+	std::vector<comptr<ID3D11PixelShader>> _pShaders;
+	std::vector<comptr<ID3D11VertexShader>> _packedVShaders;
 
-	comptr<ID3D11VertexShader> _vShader;
-	comptr<ID3D11PixelShader> _pShader;
 	comptr<ID3D11InputLayout> _inputLayout;
+	comptr<ID3D11InputLayout> _packedInputLayout;
 	comptr<ID3D11Buffer> _constantBuffer;
+	comptr<ID3D11Buffer> _perFrameConstantBuffer;
 	comptr<ID3D10Blob> _vsBlob;
 	comptr<ID3D10Blob> _psBlob;
+	comptr<ID3D10Blob> _packedVsBlob;
+
+	UINT _constantBufferSize;
+	UINT _perFrameConstantBufferSize;
 };
\ No newline at end of file
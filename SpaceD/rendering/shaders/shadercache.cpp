@@ -0,0 +1,215 @@
+/*********************************************************************/
+/** shadercache.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                               **/
+/*********************************************************************/
+
+// Local Headers
+#include "shadercache.h"
+
+// Remote Headers
+#include <atomic>
+#include <d3dcompiler.h>
+#include <d3dx11.h>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#pragma comment(lib, "d3dcompiler.lib")
+
+namespace
+{
+	const std::string SHADER_CACHE_DIRECTORY_PATH = "../res/shaders/cache/";
+	const std::string SHADER_CACHE_EXT = ".cso";
+
+	// Bumped whenever the entry layout or what goes into the key changes
+	const UINT CACHE_FORMAT_VERSION = 1U;
+	const UINT CACHE_ENTRY_MAGIC = 0x43534453U; // "SDSC"
+
+	// Nested includes deeper than this are not followed
+	const UINT MAX_INCLUDE_DEPTH = 16U;
+
+	const UINT64 FNV_OFFSET_BASIS = 14695981039346656037ULL;
+	const UINT64 FNV_PRIME = 1099511628211ULL;
+
+	struct CacheEntryHeader
+	{
+		UINT _magic;
+		UINT _version;
+		UINT64 _key;
+		UINT _bytecodeSize;
+		UINT _pad;
+	};
+
+	std::atomic<UINT> sHitCount(0);
+	std::atomic<UINT> sMissCount(0);
+
+	void HashBytes(const void* data, const size_t byteCount, UINT64& hash)
+	{
+		const auto* bytes = static_cast<const BYTE*>(data);
+		for (auto i = 0U; i < byteCount; ++i)
+		{
+			hash = (hash ^ bytes[i]) * FNV_PRIME;
+		}
+	}
+
+	void HashString(const std::string& str, UINT64& hash)
+	{
+		// The terminator separates consecutive strings, so "ab" + "c" and "a" + "bc" hash differently
+		HashBytes(str.c_str(), str.size() + 1, hash);
+	}
+
+	bool ReadTextFile(const std::string& path, std::string& outContents)
+	{
+		std::ifstream fileStream(path, std::ios::binary);
+		if (!fileStream)
+		{
+			return false;
+		}
+
+		std::stringstream contentStream;
+		contentStream << fileStream.rdbuf();
+		outContents = contentStream.str();
+		return true;
+	}
+
+	std::string GetDirectory(const std::string& path)
+	{
+		const auto separatorPos = path.find_last_of("/\\");
+		return separatorPos == std::string::npos ? std::string() : path.substr(0, separatorPos + 1);
+	}
+
+	// Folds the files source includes into the hash, in the order they appear. Missing includes are 
+	// hashed by name only; the compile then fails anyway and reports them.
+	void HashIncludes(const std::string& source, const std::string& directory, const UINT depth, UINT64& hash)
+	{
+		if (depth >= MAX_INCLUDE_DEPTH)
+		{
+			return;
+		}
+
+		std::istringstream sourceStream(source);
+		std::string line;
+		while (std::getline(sourceStream, line))
+		{
+			const auto directivePos = line.find_first_not_of(" \t");
+			if (directivePos == std::string::npos || line.compare(directivePos, 8, "#include") != 0)
+			{
+				continue;
+			}
+
+			const auto nameBegin = line.find_first_of("\"<", directivePos + 8);
+			const auto nameEnd = nameBegin == std::string::npos ? std::string::npos : line.find_first_of("\">", nameBegin + 1);
+			if (nameEnd == std::string::npos)
+			{
+				continue;
+			}
+
+			const auto includePath = directory + line.substr(nameBegin + 1, nameEnd - nameBegin - 1);
+			HashString(includePath, hash);
+
+			std::string includeSource;
+			if (ReadTextFile(includePath, includeSource))
+			{
+				HashString(includeSource, hash);
+				HashIncludes(includeSource, GetDirectory(includePath), depth + 1, hash);
+			}
+		}
+	}
+
+	std::string GetEntryPath(const UINT64 key)
+	{
+		std::stringstream pathStream;
+		pathStream << SHADER_CACHE_DIRECTORY_PATH << std::hex << std::setw(16) << std::setfill('0') << key << SHADER_CACHE_EXT;
+		return pathStream.str();
+	}
+}
+
+UINT64 shader_cache::ComputeKey(const std::string& path, const std::string& entryName, const std::string& profileName, const D3D10_SHADER_MACRO* defines, const UINT flags)
+{
+	std::string source;
+	if (!ReadTextFile(path, source))
+	{
+		return 0;
+	}
+
+	auto hash = FNV_OFFSET_BASIS;
+
+	const UINT versions[] = { CACHE_FORMAT_VERSION, D3DX11_SDK_VERSION, flags };
+	HashBytes(versions, sizeof(versions), hash);
+
+	HashString(source, hash);
+	HashIncludes(source, GetDirectory(path), 0, hash);
+	HashString(entryName, hash);
+	HashString(profileName, hash);
+
+	for (auto* define = defines; define && define->Name; ++define)
+	{
+		HashString(define->Name, hash);
+		HashString(define->Definition ? define->Definition : "", hash);
+	}
+
+	// 0 is reserved for "not cacheable"
+	return hash != 0 ? hash : 1;
+}
+
+comptr<ID3D10Blob> shader_cache::Load(const UINT64 key)
+{
+	std::ifstream entryStream(GetEntryPath(key), std::ios::binary);
+
+	CacheEntryHeader header = {};
+	if (!entryStream || !entryStream.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+		header._magic != CACHE_ENTRY_MAGIC || header._version != CACHE_FORMAT_VERSION || header._key != key || header._bytecodeSize == 0)
+	{
+		sMissCount++;
+		return nullptr;
+	}
+
+	comptr<ID3D10Blob> bytecode;
+	if (FAILED(D3DCreateBlob(header._bytecodeSize, &bytecode)) || 
+		!entryStream.read(static_cast<char*>(bytecode->GetBufferPointer()), header._bytecodeSize))
+	{
+		sMissCount++;
+		return nullptr;
+	}
+
+	sHitCount++;
+	return bytecode;
+}
+
+void shader_cache::Store(const UINT64 key, comptr<ID3D10Blob> bytecode)
+{
+	CreateDirectory(SHADER_CACHE_DIRECTORY_PATH.c_str(), 0);
+
+	CacheEntryHeader header = {};
+	header._magic = CACHE_ENTRY_MAGIC;
+	header._version = CACHE_FORMAT_VERSION;
+	header._key = key;
+	header._bytecodeSize = static_cast<UINT>(bytecode->GetBufferSize());
+
+	// Written to a temporary file first so that an interrupted write never leaves a truncated entry behind
+	const auto entryPath = GetEntryPath(key);
+	const auto temporaryPath = entryPath + ".tmp";
+	{
+		std::ofstream entryStream(temporaryPath, std::ios::binary | std::ios::trunc);
+		entryStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		entryStream.write(static_cast<const char*>(bytecode->GetBufferPointer()), header._bytecodeSize);
+		if (!entryStream)
+		{
+			OutputDebugString(("Could not write shader cache entry " + entryPath + "\n").c_str());
+			return;
+		}
+	}
+
+	MoveFileEx(temporaryPath.c_str(), entryPath.c_str(), MOVEFILE_REPLACE_EXISTING);
+}
+
+UINT shader_cache::GetHitCount()
+{
+	return sHitCount;
+}
+
+UINT shader_cache::GetMissCount()
+{
+	return sMissCount;
+}
\ No newline at end of file
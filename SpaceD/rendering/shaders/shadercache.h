@@ -0,0 +1,29 @@
+/********************************************************************/
+/** shadercache.h by Alex Koukoulas (C) 2017 All Rights Reserved   **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "../d3dcommon.h"
+
+// Remote Headers
+#include <string>
+
+// Compiled shader bytecode kept on disk between runs. Entries are keyed by a hash of everything that 
+// affects the compiler output: the source, the files it includes (recursively), the entry point, profile, 
+// defines and flags, and the D3DX version. Editing any of those simply produces a new key, so stale 
+// entries are never loaded. All functions are safe to call from several threads at once.
+namespace shader_cache
+{
+	// Returns 0 when the source can not be read, in which case nothing should be cached
+	UINT64 ComputeKey(const std::string& path, const std::string& entryName, const std::string& profileName, const D3D10_SHADER_MACRO* defines, const UINT flags);
+
+	// Bytecode stored under key, or null when there is no valid entry for it
+	comptr<ID3D10Blob> Load(const UINT64 key);
+	void Store(const UINT64 key, comptr<ID3D10Blob> bytecode);
+
+	UINT GetHitCount();
+	UINT GetMissCount();
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+/*************************************************************************/
+/** shaderpermutation.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                   **/
+/*************************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "shader.h"
+
+// Remote Headers
+
+// Shader features that are specialised at compile time instead of branched on at runtime. A permutation key 
+// packs the feature state of a draw; every shader type compiles one variant per distinct combination of the 
+// features it uses, and the Renderer binds the variant matching the key of each draw. Key to variant 
+// mapping is all constexpr, so the table is resolved by the compiler.
+namespace shader_permutation
+{
+	// Key layout
+	const UINT DIRECTIONAL_LIGHT_COUNT_MASK = 0x7U;
+	const UINT POINT_LIGHTS_BIT             = 1U << 3;
+	const UINT SCROLL_TEXCOORDS_BIT         = 1U << 4;
+	const UINT COLOR_OVERRIDE_BIT           = 1U << 5;
+
+	const UINT MAX_DIRECTIONAL_LIGHTS = 4U;
+
+	// Key bits each pipeline stage reads; variants that only differ elsewhere share that stage's bytecode
+	const UINT VERTEX_STAGE_FEATURES = SCROLL_TEXCOORDS_BIT;
+	const UINT PIXEL_STAGE_FEATURES  = DIRECTIONAL_LIGHT_COUNT_MASK | POINT_LIGHTS_BIT | COLOR_OVERRIDE_BIT;
+
+	constexpr UINT MakeKey(const UINT directionalLightCount, const bool pointLights, const bool scrollTexCoords, const bool colorOverride)
+	{
+		return (directionalLightCount < MAX_DIRECTIONAL_LIGHTS ? directionalLightCount : MAX_DIRECTIONAL_LIGHTS) |
+		       (pointLights ? POINT_LIGHTS_BIT : 0U) | 
+		       (scrollTexCoords ? SCROLL_TEXCOORDS_BIT : 0U) | 
+		       (colorOverride ? COLOR_OVERRIDE_BIT : 0U);
+	}
+
+	constexpr UINT GetDirectionalLightCount(const UINT key)
+	{
+		return key & DIRECTIONAL_LIGHT_COUNT_MASK;
+	}
+
+	constexpr UINT GetVariantCount(const Shader::ShaderType shader)
+	{
+		return shader == Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING ? (MAX_DIRECTIONAL_LIGHTS + 1) * 2 :
+		       shader == Shader::ShaderType::DEFAULT_UI ? 4U : 1U;
+	}
+
+	// Features a shader type does not use are ignored, so any key maps to a valid variant
+	constexpr UINT GetVariantIndex(const Shader::ShaderType shader, const UINT key)
+	{
+		return shader == Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING ? GetDirectionalLightCount(key) * 2 + ((key & POINT_LIGHTS_BIT) ? 1U : 0U) :
+		       shader == Shader::ShaderType::DEFAULT_UI ? ((key & SCROLL_TEXCOORDS_BIT) ? 2U : 0U) + ((key & COLOR_OVERRIDE_BIT) ? 1U : 0U) : 0U;
+	}
+
+	// Inverse of GetVariantIndex, used to compile each variant with its defines
+	constexpr UINT GetVariantKey(const Shader::ShaderType shader, const UINT variant)
+	{
+		return shader == Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING ? MakeKey(variant / 2, (variant & 1) != 0, false, false) :
+		       shader == Shader::ShaderType::DEFAULT_UI ? MakeKey(0, false, (variant & 2) != 0, (variant & 1) != 0) : 0U;
+	}
+
+	static_assert(GetVariantIndex(Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING, GetVariantKey(Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING, 7)) == 7, "Lighting variant keys must round trip");
+	static_assert(GetVariantIndex(Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING, MakeKey(9, true, true, true)) == GetVariantCount(Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING) - 1, "Light counts must clamp to the last variant");
+	static_assert(GetVariantIndex(Shader::ShaderType::DEFAULT_UI, GetVariantKey(Shader::ShaderType::DEFAULT_UI, 2)) == 2, "UI variant keys must round trip");
+	static_assert(GetVariantIndex(Shader::ShaderType::DEFAULT_3D, MakeKey(4, true, true, true)) == 0, "Shaders without features have a single variant");
+}
\ No newline at end of file
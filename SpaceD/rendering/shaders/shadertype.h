@@ -0,0 +1,24 @@
+/********************************************************************/
+/** shadertype.h by Alex Koukoulas (C) 2017 All Rights Reserved    **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+
+// Remote Headers
+
+// The shader types, apart from Shader so that code which only names them, like the RenderDevice interface, 
+// needs none of the D3D headers. Shader::ShaderType refers to the same type.
+namespace shader_type
+{
+	enum ShaderType
+	{
+		DEFAULT_3D = 0,
+		DEFAULT_3D_WITH_LIGHTING = 1,
+		DEFAULT_UI = 2,
+		DEFAULT_TEXT = 3,
+		SHADER_COUNT = 4
+	};
+}
\ No newline at end of file
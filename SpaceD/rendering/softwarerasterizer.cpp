@@ -0,0 +1,458 @@
+/****************************************************************************/
+/** softwarerasterizer.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                      **/
+/****************************************************************************/
+
+// Local Headers
+#include "softwarerasterizer.h"
+
+// Remote Headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace
+{
+	// Triangles are clipped against the near plane, which keeps w positive for any perspective projection. 
+	// Whatever still has a vertex this close to or behind the eye plane, from a degenerate projection, is dropped.
+	const FLOAT MIN_CLIP_W = 1e-5f;
+
+	// Coverage offset applied to edges that are not top or left ones, so shared edges are only drawn once
+	const FLOAT NON_TOP_LEFT_EDGE_BIAS = 1e-4f;
+
+	// Edge distance in pixels below which a pixel counts as part of a wireframe outline
+	const FLOAT WIREFRAME_EDGE_WIDTH = 1.0f;
+
+	std::uint32_t PackColor(const FLOAT r, const FLOAT g, const FLOAT b, const FLOAT a)
+	{
+		const auto toByte = [](const FLOAT c) { return static_cast<std::uint32_t>((std::min)((std::max)(c, 0.0f), 1.0f) * 255.0f + 0.5f); };
+		return toByte(r) | (toByte(g) << 8) | (toByte(b) << 16) | (toByte(a) << 24);
+	}
+
+	// Every attribute is linear in clip space, so a vertex on the segment between two others interpolates them all
+	RasterVertex LerpVertex(const RasterVertex& a, const RasterVertex& b, const FLOAT t)
+	{
+		const auto lerp = [t](const FLOAT from, const FLOAT to) { return from + (to - from) * t; };
+
+		RasterVertex result;
+		for (auto i = 0U; i < 4; ++i)
+		{
+			result._clipPos[i] = lerp(a._clipPos[i], b._clipPos[i]);
+			result._mul[i] = lerp(a._mul[i], b._mul[i]);
+			result._add[i] = lerp(a._add[i], b._add[i]);
+		}
+		result._texcoord[0] = lerp(a._texcoord[0], b._texcoord[0]);
+		result._texcoord[1] = lerp(a._texcoord[1], b._texcoord[1]);
+		return result;
+	}
+
+	__m128 EvaluatePlane(const FLOAT a, const FLOAT b, const FLOAT c, const __m128 x, const __m128 y)
+	{
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a), x), _mm_mul_ps(_mm_set1_ps(b), y)), _mm_set1_ps(c));
+	}
+
+	__m128 Saturate(const __m128 value)
+	{
+		return _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	}
+
+	__m128 UnpackChannel(const __m128i pixels, const int shift)
+	{
+		const auto channel = _mm_and_si128(_mm_srli_epi32(pixels, shift), _mm_set1_epi32(0xFF));
+		return _mm_mul_ps(_mm_cvtepi32_ps(channel), _mm_set1_ps(1.0f / 255.0f));
+	}
+
+	__m128i PackChannel(const __m128 value, const int shift)
+	{
+		const auto channel = _mm_cvtps_epi32(_mm_mul_ps(Saturate(value), _mm_set1_ps(255.0f)));
+		return _mm_slli_epi32(channel, shift);
+	}
+}
+
+SoftwareRasterizer::SoftwareRasterizer(const UINT width, const UINT height, ThreadPool& threadPool)
+	: _threadPool(threadPool)
+	, _width(width)
+	, _height(height)
+	, _tileCountX((width + TILE_SIZE - 1) / TILE_SIZE)
+	, _tileCountY((height + TILE_SIZE - 1) / TILE_SIZE)
+	, _bufferStride(_tileCountX * TILE_SIZE)
+	, _clearPending(true)
+	, _clearColor(0)
+{
+	// Buffers are padded to whole tiles so the 4 wide inner loop never needs bounds checks
+	_colorBuffer.resize(_bufferStride * _tileCountY * TILE_SIZE, 0);
+	_depthBuffer.resize(_bufferStride * _tileCountY * TILE_SIZE, 1.0f);
+	_tileBins.resize(_tileCountX * _tileCountY);
+	_tilePixelsWritten.resize(_tileCountX * _tileCountY, 0);
+
+	std::memset(&_frameStats, 0, sizeof(_frameStats));
+	std::memset(&_lastFrameStats, 0, sizeof(_lastFrameStats));
+}
+
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+}
+
+UINT SoftwareRasterizer::GetWidth() const
+{
+	return _width;
+}
+
+UINT SoftwareRasterizer::GetHeight() const
+{
+	return _height;
+}
+
+void SoftwareRasterizer::Clear(const FLOAT clearColor[4])
+{
+	_clearPending = true;
+	_clearColor = PackColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+
+	_triangles.clear();
+	for (auto& tileBin: _tileBins)
+	{
+		tileBin.clear();
+	}
+}
+
+void SoftwareRasterizer::AddTriangle(const RasterVertex& v0, const RasterVertex& v1, const RasterVertex& v2, const RasterState& state)
+{
+	_frameStats._triangleCount++;
+
+	if (v0._clipPos[2] >= 0.0f && v1._clipPos[2] >= 0.0f && v2._clipPos[2] >= 0.0f)
+	{
+		if (!SetupTriangle(v0, v1, v2, state))
+		{
+			_frameStats._rejectedTriangleCount++;
+		}
+		return;
+	}
+
+	// Clipped against the near plane z = 0 before the perspective divide, as D3D does, so that a triangle reaching
+	// behind the camera keeps the part in front of it. Cutting off one corner leaves a quad, drawn as two triangles.
+	const RasterVertex* vertices[3] = { &v0, &v1, &v2 };
+	RasterVertex clippedVertices[4];
+	auto clippedVertexCount = 0U;
+	for (auto i = 0U; i < 3; ++i)
+	{
+		const auto& current = *vertices[i];
+		const auto& next = *vertices[(i + 1) % 3];
+		const auto currentInside = current._clipPos[2] >= 0.0f;
+		if (currentInside)
+		{
+			clippedVertices[clippedVertexCount++] = current;
+		}
+
+		if (currentInside != (next._clipPos[2] >= 0.0f))
+		{
+			const auto t = current._clipPos[2] / (current._clipPos[2] - next._clipPos[2]);
+			clippedVertices[clippedVertexCount++] = LerpVertex(current, next, t);
+		}
+	}
+
+	auto anySetUp = false;
+	for (auto i = 1U; i + 1 < clippedVertexCount; ++i)
+	{
+		anySetUp |= SetupTriangle(clippedVertices[0], clippedVertices[i], clippedVertices[i + 1], state);
+	}
+
+	if (!anySetUp)
+	{
+		_frameStats._rejectedTriangleCount++;
+	}
+}
+
+bool SoftwareRasterizer::SetupTriangle(const RasterVertex& v0, const RasterVertex& v1, const RasterVertex& v2, const RasterState& state)
+{
+	const RasterVertex* vertices[3] = { &v0, &v1, &v2 };
+
+	FLOAT screenX[3], screenY[3], screenZ[3], invW[3];
+	for (auto i = 0U; i < 3; ++i)
+	{
+		const auto& clipPos = vertices[i]->_clipPos;
+		if (clipPos[3] <= MIN_CLIP_W)
+		{
+			return false;
+		}
+
+		invW[i]    = 1.0f / clipPos[3];
+		screenX[i] = (clipPos[0] * invW[i] * 0.5f + 0.5f) * _width;
+		screenY[i] = (0.5f - clipPos[1] * invW[i] * 0.5f) * _height;
+		screenZ[i] = clipPos[2] * invW[i];
+	}
+
+	const auto signedArea = (screenX[1] - screenX[0]) * (screenY[2] - screenY[0]) - (screenX[2] - screenX[0]) * (screenY[1] - screenY[0]);
+	if (std::abs(signedArea) < 1e-8f)
+	{
+		return false;
+	}
+
+	Triangle triangle;
+	triangle._state = state;
+
+	triangle._minX = (std::max)(0, static_cast<INT>(std::floor((std::min)(screenX[0], (std::min)(screenX[1], screenX[2])))));
+	triangle._minY = (std::max)(0, static_cast<INT>(std::floor((std::min)(screenY[0], (std::min)(screenY[1], screenY[2])))));
+	triangle._maxX = (std::min)(static_cast<INT>(_width) - 1, static_cast<INT>(std::ceil((std::max)(screenX[0], (std::max)(screenX[1], screenX[2])))));
+	triangle._maxY = (std::min)(static_cast<INT>(_height) - 1, static_cast<INT>(std::ceil((std::max)(screenY[0], (std::max)(screenY[1], screenY[2])))));
+	if (triangle._minX > triangle._maxX || triangle._minY > triangle._maxY)
+	{
+		return false;
+	}
+
+	// Edge i is the one opposite vertex i, oriented so that the interior evaluates positive
+	// regardless of winding (the rasterizer state culls nothing)
+	const auto orientation = signedArea > 0.0f ? 1.0f : -1.0f;
+	for (auto i = 0U; i < 3; ++i)
+	{
+		const auto j = (i + 1) % 3;
+		const auto k = (i + 2) % 3;
+
+		auto& edge = triangle._edges[i];
+		edge._a = (screenY[j] - screenY[k]) * orientation;
+		edge._b = (screenX[k] - screenX[j]) * orientation;
+		edge._c = (screenX[j] * screenY[k] - screenX[k] * screenY[j]) * orientation;
+
+		const auto isTopLeft = edge._a > 0.0f || (edge._a == 0.0f && edge._b > 0.0f);
+		if (!isTopLeft)
+		{
+			edge._c -= NON_TOP_LEFT_EDGE_BIAS;
+		}
+
+		triangle._edgeInvLengths[i] = 1.0f / std::sqrt(edge._a * edge._a + edge._b * edge._b);
+	}
+
+	// Any attribute interpolates as sum(edge_i * attribute_i) / (2 * area), so its plane
+	// follows directly from the edge planes. Perspective correct attributes are set up divided by w.
+	const auto invDoubleArea = 1.0f / std::abs(signedArea);
+	const auto makePlane = [&](const FLOAT attributes[3])
+	{
+		Plane plane = { 0.0f, 0.0f, 0.0f };
+		for (auto i = 0U; i < 3; ++i)
+		{
+			const auto weight = attributes[i] * invDoubleArea;
+			plane._a += triangle._edges[i]._a * weight;
+			plane._b += triangle._edges[i]._b * weight;
+			plane._c += triangle._edges[i]._c * weight;
+		}
+		return plane;
+	};
+
+	triangle._z    = makePlane(screenZ);
+	triangle._invW = makePlane(invW);
+
+	const FLOAT uOverW[3] = { v0._texcoord[0] * invW[0], v1._texcoord[0] * invW[1], v2._texcoord[0] * invW[2] };
+	const FLOAT vOverW[3] = { v0._texcoord[1] * invW[0], v1._texcoord[1] * invW[1], v2._texcoord[1] * invW[2] };
+	triangle._uOverW = makePlane(uOverW);
+	triangle._vOverW = makePlane(vOverW);
+
+	for (auto c = 0U; c < 4; ++c)
+	{
+		const FLOAT mulOverW[3] = { v0._mul[c] * invW[0], v1._mul[c] * invW[1], v2._mul[c] * invW[2] };
+		const FLOAT addOverW[3] = { v0._add[c] * invW[0], v1._add[c] * invW[1], v2._add[c] * invW[2] };
+		triangle._mul[c] = makePlane(mulOverW);
+		triangle._add[c] = makePlane(addOverW);
+	}
+
+	// Bin the triangle into every tile its bounds touch. Bins keep submission order,
+	// which keeps blending and equal depth results identical to a serial draw.
+	const auto triangleIndex = static_cast<UINT>(_triangles.size());
+	_triangles.push_back(triangle);
+
+	for (auto tileY = triangle._minY / static_cast<INT>(TILE_SIZE); tileY <= triangle._maxY / static_cast<INT>(TILE_SIZE); ++tileY)
+	{
+		for (auto tileX = triangle._minX / static_cast<INT>(TILE_SIZE); tileX <= triangle._maxX / static_cast<INT>(TILE_SIZE); ++tileX)
+		{
+			_tileBins[tileY * _tileCountX + tileX].push_back(triangleIndex);
+		}
+	}
+
+	return true;
+}
+
+void SoftwareRasterizer::Resolve()
+{
+	const auto rasterStart = std::chrono::high_resolution_clock::now();
+
+	// Tiles own disjoint parts of the colour and depth buffers, so they rasterize without any locking
+	_threadPool.ParallelFor(_tileCountX * _tileCountY, [this](const UINT tileIndex)
+	{
+		RasterizeTile(tileIndex);
+	});
+
+	const auto rasterEnd = std::chrono::high_resolution_clock::now();
+
+	_frameStats._pixelsWritten = 0;
+	for (const auto pixelsWritten: _tilePixelsWritten)
+	{
+		_frameStats._pixelsWritten += pixelsWritten;
+	}
+	_frameStats._rasterMilliseconds = std::chrono::duration<FLOAT, std::milli>(rasterEnd - rasterStart).count();
+
+	_lastFrameStats = _frameStats;
+	std::memset(&_frameStats, 0, sizeof(_frameStats));
+
+	_clearPending = false;
+	_triangles.clear();
+	for (auto& tileBin: _tileBins)
+	{
+		tileBin.clear();
+	}
+}
+
+void SoftwareRasterizer::ReadPixels(std::vector<std::uint8_t>& outRGBA) const
+{
+	outRGBA.resize(_width * _height * 4);
+	for (auto y = 0U; y < _height; ++y)
+	{
+		std::memcpy(&outRGBA[y * _width * 4], &_colorBuffer[y * _bufferStride], _width * 4);
+	}
+}
+
+const SoftwareRasterizer::FrameStats& SoftwareRasterizer::GetLastFrameStats() const
+{
+	return _lastFrameStats;
+}
+
+void SoftwareRasterizer::RasterizeTile(const UINT tileIndex)
+{
+	const auto tileMinX = static_cast<INT>((tileIndex % _tileCountX) * TILE_SIZE);
+	const auto tileMinY = static_cast<INT>((tileIndex / _tileCountX) * TILE_SIZE);
+
+	if (_clearPending)
+	{
+		for (auto y = tileMinY; y < tileMinY + static_cast<INT>(TILE_SIZE); ++y)
+		{
+			std::fill_n(&_colorBuffer[y * _bufferStride + tileMinX], TILE_SIZE, _clearColor);
+			std::fill_n(&_depthBuffer[y * _bufferStride + tileMinX], TILE_SIZE, 1.0f);
+		}
+	}
+
+	std::uint64_t pixelsWritten = 0;
+	for (const auto triangleIndex: _tileBins[tileIndex])
+	{
+		RasterizeTriangle(_triangles[triangleIndex], tileMinX, tileMinY, pixelsWritten);
+	}
+
+	_tilePixelsWritten[tileIndex] = pixelsWritten;
+}
+
+void SoftwareRasterizer::RasterizeTriangle(const Triangle& triangle, const INT tileMinX, const INT tileMinY, std::uint64_t& pixelsWritten)
+{
+	const auto& state = triangle._state;
+
+	// Tiles start on multiples of 4, so rounding the start down keeps every 4 pixel group aligned to the tile
+	const auto startX = (std::max)(triangle._minX, tileMinX) & ~3;
+	const auto endX   = (std::min)(triangle._maxX, tileMinX + static_cast<INT>(TILE_SIZE) - 1);
+	const auto startY = (std::max)(triangle._minY, tileMinY);
+	const auto endY   = (std::min)(triangle._maxY, tileMinY + static_cast<INT>(TILE_SIZE) - 1);
+
+	const auto laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const auto zero = _mm_setzero_ps();
+	const auto one  = _mm_set1_ps(1.0f);
+	const auto addThreshold = _mm_set1_ps(state._addAlphaThreshold);
+
+	for (auto y = startY; y <= endY; ++y)
+	{
+		const auto pixelY = _mm_set1_ps(y + 0.5f);
+
+		for (auto x = startX; x <= endX; x += 4)
+		{
+			const auto pixelX = _mm_add_ps(_mm_set1_ps(static_cast<FLOAT>(x)), laneOffsets);
+
+			const auto e0 = EvaluatePlane(triangle._edges[0]._a, triangle._edges[0]._b, triangle._edges[0]._c, pixelX, pixelY);
+			const auto e1 = EvaluatePlane(triangle._edges[1]._a, triangle._edges[1]._b, triangle._edges[1]._c, pixelX, pixelY);
+			const auto e2 = EvaluatePlane(triangle._edges[2]._a, triangle._edges[2]._b, triangle._edges[2]._c, pixelX, pixelY);
+
+			auto mask = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+			if (_mm_movemask_ps(mask) == 0)
+			{
+				continue;
+			}
+
+			if (state._wireframe)
+			{
+				const auto d0 = _mm_mul_ps(e0, _mm_set1_ps(triangle._edgeInvLengths[0]));
+				const auto d1 = _mm_mul_ps(e1, _mm_set1_ps(triangle._edgeInvLengths[1]));
+				const auto d2 = _mm_mul_ps(e2, _mm_set1_ps(triangle._edgeInvLengths[2]));
+				mask = _mm_and_ps(mask, _mm_cmplt_ps(_mm_min_ps(d0, _mm_min_ps(d1, d2)), _mm_set1_ps(WIREFRAME_EDGE_WIDTH)));
+			}
+
+			// Depth beyond the far plane is clipped per pixel, as is the sliver the near plane clip leaves to rounding
+			const auto z = EvaluatePlane(triangle._z._a, triangle._z._b, triangle._z._c, pixelX, pixelY);
+			mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(z, zero), _mm_cmple_ps(z, one)));
+
+			auto* depth = &_depthBuffer[y * _bufferStride + x];
+			if (state._depthEnabled)
+			{
+				const auto storedDepth = _mm_loadu_ps(depth);
+				mask = _mm_and_ps(mask, _mm_cmplt_ps(z, storedDepth));
+				_mm_storeu_ps(depth, _mm_or_ps(_mm_and_ps(mask, z), _mm_andnot_ps(mask, storedDepth)));
+			}
+
+			const auto laneMask = _mm_movemask_ps(mask);
+			if (laneMask == 0)
+			{
+				continue;
+			}
+
+			// Perspective correct attributes
+			const auto w = _mm_div_ps(one, EvaluatePlane(triangle._invW._a, triangle._invW._b, triangle._invW._c, pixelX, pixelY));
+			const auto u = _mm_mul_ps(EvaluatePlane(triangle._uOverW._a, triangle._uOverW._b, triangle._uOverW._c, pixelX, pixelY), w);
+			const auto v = _mm_mul_ps(EvaluatePlane(triangle._vOverW._a, triangle._vOverW._b, triangle._vOverW._c, pixelX, pixelY), w);
+
+			// Point sampled texture fetch with wrap addressing. This is a gather, so it stays per lane.
+			alignas(16) FLOAT laneU[4], laneV[4];
+			alignas(16) std::uint32_t texels[4] = { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF };
+			if (state._texture && !state._texture->_texels.empty())
+			{
+				_mm_store_ps(laneU, u);
+				_mm_store_ps(laneV, v);
+
+				const auto* texture = state._texture;
+				for (auto lane = 0; lane < 4; ++lane)
+				{
+					if ((laneMask & (1 << lane)) == 0)
+					{
+						continue;
+					}
+
+					const auto texelX = (std::min)(static_cast<UINT>((laneU[lane] - std::floor(laneU[lane])) * texture->_width), texture->_width - 1);
+					const auto texelY = (std::min)(static_cast<UINT>((laneV[lane] - std::floor(laneV[lane])) * texture->_height), texture->_height - 1);
+					texels[lane] = texture->_texels[texelY * texture->_width + texelX];
+				}
+			}
+
+			const auto texelPixels = _mm_load_si128(reinterpret_cast<const __m128i*>(texels));
+			const __m128 texel[4] = { UnpackChannel(texelPixels, 0), UnpackChannel(texelPixels, 8), UnpackChannel(texelPixels, 16), UnpackChannel(texelPixels, 24) };
+
+			// colour = texel * mul + (texel.a >= threshold ? add : 0)
+			const auto addMask = _mm_cmpge_ps(texel[3], addThreshold);
+			__m128 color[4];
+			for (auto c = 0U; c < 4; ++c)
+			{
+				const auto mul = _mm_mul_ps(EvaluatePlane(triangle._mul[c]._a, triangle._mul[c]._b, triangle._mul[c]._c, pixelX, pixelY), w);
+				const auto add = _mm_mul_ps(EvaluatePlane(triangle._add[c]._a, triangle._add[c]._b, triangle._add[c]._c, pixelX, pixelY), w);
+				color[c] = Saturate(_mm_add_ps(_mm_mul_ps(texel[c], mul), _mm_and_ps(addMask, add)));
+			}
+
+			// SRC_ALPHA / INV_SRC_ALPHA blending on colour, the source alpha replaces the destination one
+			auto* target = reinterpret_cast<__m128i*>(&_colorBuffer[y * _bufferStride + x]);
+			const auto destination = _mm_loadu_si128(target);
+			const auto invAlpha = _mm_sub_ps(one, color[3]);
+
+			auto blended = PackChannel(color[3], 24);
+			for (auto c = 0; c < 3; ++c)
+			{
+				const auto blendedChannel = _mm_add_ps(_mm_mul_ps(color[c], color[3]), _mm_mul_ps(UnpackChannel(destination, c * 8), invAlpha));
+				blended = _mm_or_si128(blended, PackChannel(blendedChannel, c * 8));
+			}
+
+			const auto integerMask = _mm_castps_si128(mask);
+			_mm_storeu_si128(target, _mm_or_si128(_mm_and_si128(integerMask, blended), _mm_andnot_si128(integerMask, destination)));
+
+			pixelsWritten += (laneMask & 1) + ((laneMask >> 1) & 1) + ((laneMask >> 2) & 1) + ((laneMask >> 3) & 1);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+/**************************************************************************/
+/** softwarerasterizer.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                    **/
+/**************************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "../util/threadpool.h"
+
+// Remote Headers
+#include <cstdint>
+#include <vector>
+
+typedef int INT;
+typedef float FLOAT;
+
+// RGBA8 texels, red in the lowest byte, rows top to bottom
+struct RasterTexture
+{
+	UINT _width;
+	UINT _height;
+	std::vector<std::uint32_t> _texels;
+};
+
+// Post vertex shader data of one vertex. The pixel colour is texture * _mul, plus _add
+// for texels whose alpha reaches the state's threshold, mirroring the game's pixel shaders.
+struct RasterVertex
+{
+	FLOAT _clipPos[4];
+	FLOAT _texcoord[2];
+	FLOAT _mul[4];
+	FLOAT _add[4];
+};
+
+struct RasterState
+{
+	const RasterTexture* _texture;
+	FLOAT _addAlphaThreshold;
+	bool _depthEnabled;
+	bool _wireframe;
+};
+
+// Tiled, multi threaded SSE rasteriser. Triangles are clipped to the near plane and set up as they are added, and 
+// rasterised tile by tile in submission order on Resolve, with LESS depth testing and src alpha blending.
+class SoftwareRasterizer final
+{
+public:
+	struct FrameStats
+	{
+		UINT _triangleCount;
+		UINT _rejectedTriangleCount;
+		std::uint64_t _pixelsWritten;
+		FLOAT _rasterMilliseconds;
+	};
+
+public:
+	SoftwareRasterizer(const UINT width, const UINT height, ThreadPool& threadPool);
+	~SoftwareRasterizer();
+
+	UINT GetWidth() const;
+	UINT GetHeight() const;
+
+	// Discards the triangles added so far; the clear itself happens during the next Resolve
+	void Clear(const FLOAT clearColor[4]);
+	void AddTriangle(const RasterVertex& v0, const RasterVertex& v1, const RasterVertex& v2, const RasterState& state);
+	void Resolve();
+
+	// Cropped RGBA8 copy of the colour buffer
+	void ReadPixels(std::vector<std::uint8_t>& outRGBA) const;
+
+	const FrameStats& GetLastFrameStats() const;
+
+private:
+	struct Plane
+	{
+		FLOAT _a, _b, _c;
+	};
+
+	struct Triangle
+	{
+		Plane _edges[3];
+		FLOAT _edgeInvLengths[3];
+		Plane _z;
+		Plane _invW;
+		Plane _uOverW;
+		Plane _vOverW;
+		Plane _mul[4];
+		Plane _add[4];
+		INT _minX, _minY, _maxX, _maxY;
+		RasterState _state;
+	};
+
+private:
+	// Sets up and bins a triangle lying in front of the near plane. False when it covers no pixels.
+	bool SetupTriangle(const RasterVertex& v0, const RasterVertex& v1, const RasterVertex& v2, const RasterState& state);
+	void RasterizeTile(const UINT tileIndex);
+	void RasterizeTriangle(const Triangle& triangle, const INT tileMinX, const INT tileMinY, std::uint64_t& pixelsWritten);
+
+private:
+	static const UINT TILE_SIZE = 64U;
+
+private:
+	ThreadPool& _threadPool;
+
+	const UINT _width;
+	const UINT _height;
+	const UINT _tileCountX;
+	const UINT _tileCountY;
+	const UINT _bufferStride;
+
+	std::vector<std::uint32_t> _colorBuffer;
+	std::vector<FLOAT> _depthBuffer;
+
+	std::vector<Triangle> _triangles;
+	std::vector<std::vector<UINT>> _tileBins;
+	std::vector<std::uint64_t> _tilePixelsWritten;
+
+	bool _clearPending;
+	std::uint32_t _clearColor;
+
+	FrameStats _frameStats;
+	FrameStats _lastFrameStats;
+};
\ No newline at end of file
@@ -0,0 +1,492 @@
+/******************************************************************************/
+/** softwarerenderdevice.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                        **/
+/******************************************************************************/
+
+// Local Headers
+#include "softwarerenderdevice.h"
+#include "shaders/default3dshader.h"
+#include "shaders/defaultuishader.h"
+#include "models/model.h"
+#include "../util/pngwriter.h"
+
+// Remote Headers
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+const FLOAT SoftwareRenderDevice::TEXT_ADD_ALPHA_THRESHOLD = 0.8f;
+
+namespace
+{
+	// Ambient + diffuse and specular sums of the lighting equation at one point, as in default3dwithlighting.ps
+	struct LightingTerms
+	{
+		XMVECTOR _ambient;
+		XMVECTOR _diffuse;
+		XMVECTOR _specular;
+	};
+
+	void AccumulateDiffuseAndSpecular(const Material& material, const XMFLOAT4& lightDiffuse, const XMFLOAT4& lightSpecular, const XMVECTOR lightVec, const XMVECTOR normal, const XMVECTOR toEye, const FLOAT scale, LightingTerms& terms)
+	{
+		const auto diffuseFactor = XMVectorGetX(XMVector3Dot(lightVec, normal));
+		if (diffuseFactor <= 0.0f)
+		{
+			return;
+		}
+
+		const auto reflected  = XMVector3Reflect(XMVectorNegate(lightVec), normal);
+		const auto specFactor = std::pow((std::max)(XMVectorGetX(XMVector3Dot(reflected, toEye)), 0.0f), material._specular.w);
+
+		terms._diffuse  += XMLoadFloat4(&material._diffuse) * XMLoadFloat4(&lightDiffuse) * (diffuseFactor * scale);
+		terms._specular += XMLoadFloat4(&material._specular) * XMLoadFloat4(&lightSpecular) * (specFactor * scale);
+	}
+
+	void ComputeDirectionalLight(const Material& material, const DirectionalLight& light, const XMVECTOR normal, const XMVECTOR toEye, LightingTerms& terms)
+	{
+		terms._ambient += XMLoadFloat4(&material._ambient) * XMLoadFloat4(&light._ambient);
+		AccumulateDiffuseAndSpecular(material, light._diffuse, light._specular, XMVectorNegate(XMLoadFloat3(&light._direction)), normal, toEye, 1.0f, terms);
+	}
+
+	void ComputePointLight(const Material& material, const PointLight& light, const XMVECTOR pos, const XMVECTOR normal, const XMVECTOR toEye, LightingTerms& terms)
+	{
+		auto lightVec = XMLoadFloat3(&light._position) - pos;
+		const auto d = XMVectorGetX(XMVector3Length(lightVec));
+		if (d > light._range || d <= 0.0f)
+		{
+			return;
+		}
+
+		lightVec /= d;
+
+		terms._ambient += XMLoadFloat4(&material._ambient) * XMLoadFloat4(&light._ambient);
+
+		const auto att = 1.0f / (light._att.x + light._att.y * d + light._att.z * d * d);
+		AccumulateDiffuseAndSpecular(material, light._diffuse, light._specular, lightVec, normal, toEye, att, terms);
+	}
+
+	void ComputeSpotLight(const Material& material, const SpotLight& light, const XMVECTOR pos, const XMVECTOR normal, const XMVECTOR toEye, LightingTerms& terms)
+	{
+		auto lightVec = XMLoadFloat3(&light._position) - pos;
+		const auto d = XMVectorGetX(XMVector3Length(lightVec));
+		if (d > light._range || d <= 0.0f)
+		{
+			return;
+		}
+
+		lightVec /= d;
+
+		const auto spot = std::pow((std::max)(XMVectorGetX(XMVector3Dot(XMVectorNegate(lightVec), XMLoadFloat3(&light._direction))), 0.0f), light._spot);
+		terms._ambient += XMLoadFloat4(&material._ambient) * XMLoadFloat4(&light._ambient) * spot;
+
+		const auto att = spot / (light._att.x + light._att.y * d + light._att.z * d * d);
+		AccumulateDiffuseAndSpecular(material, light._diffuse, light._specular, lightVec, normal, toEye, att, terms);
+	}
+
+	std::uint64_t HashPixels(const std::vector<std::uint8_t>& pixels)
+	{
+		auto hash = 14695981039346656037ULL;
+		for (const auto byte: pixels)
+		{
+			hash = (hash ^ byte) * 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	void SetShading(RasterVertex& vertex, const XMVECTOR mul, const XMVECTOR add)
+	{
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(vertex._mul), mul);
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(vertex._add), add);
+	}
+}
+
+SoftwareRenderDevice::SoftwareRenderDevice(const UINT width, const UINT height, const std::string& outputDirectory)
+	: _threadPool(std::make_unique<ThreadPool>())
+	, _outputDirectory(outputDirectory)
+	, _frameIndex(0)
+	, _activeShaderType(Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING)
+	, _depthStencilEnabled(true)
+	, _wireframe(false)
+{
+	// WARP is always available, also on machines without any GPU
+	D3D_FEATURE_LEVEL featureLevel;
+	HR(D3D11CreateDevice(0, 
+	                     D3D_DRIVER_TYPE_WARP, 
+	                     0, 
+	                     0, 
+	                     0, 0, // default feature levels
+	                     D3D11_SDK_VERSION, 
+	                     &_device, 
+	                     &featureLevel, 
+	                     &_deviceContext));
+
+	_rasterizer = std::make_unique<SoftwareRasterizer>(width, height, *_threadPool);
+	std::memset(&_lightingFrameConstants, 0, sizeof(_lightingFrameConstants));
+}
+
+SoftwareRenderDevice::~SoftwareRenderDevice()
+{
+}
+
+void SoftwareRenderDevice::OnResize()
+{
+	// Headless frames keep the size they were created with
+}
+
+void SoftwareRenderDevice::ClearViews()
+{
+	const FLOAT clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	_rasterizer->Clear(clearColor);
+}
+
+void SoftwareRenderDevice::Present()
+{
+	_rasterizer->Resolve();
+	_rasterizer->ReadPixels(_framePixels);
+
+	// The swap chain ignores alpha when presenting, so neither should the written frame
+	for (auto i = 3U; i < _framePixels.size(); i += 4)
+	{
+		_framePixels[i] = 0xFF;
+	}
+	_frameChecksums.push_back(HashPixels(_framePixels));
+
+	std::ostringstream framePath;
+	framePath << _outputDirectory << "frame_" << std::setw(5) << std::setfill('0') << _frameIndex++ << ".png";
+	if (!_outputDirectory.empty() && !png_writer::WriteRGBA(framePath.str(), _rasterizer->GetWidth(), _rasterizer->GetHeight(), &_framePixels[0]))
+	{
+		OutputDebugString(("Could not write frame " + framePath.str() + "\n").c_str());
+	}
+
+	const auto& rasterStats = _rasterizer->GetLastFrameStats();
+	std::ostringstream statsStream;
+	statsStream << "Software frame " << framePath.str() << ": " << rasterStats._triangleCount << " triangles (" << rasterStats._rejectedTriangleCount 
+	            << " rejected), " << rasterStats._pixelsWritten << " pixels written, raster " << rasterStats._rasterMilliseconds << " ms on " 
+	            << _threadPool->GetWorkerCount() + 1 << " threads, checksum " << std::hex << _frameChecksums.back() << "\n";
+	OutputDebugString(statsStream.str().c_str());
+
+	_lastFrameStats = _frameStats;
+	_frameStats = FrameStats();
+}
+
+void SoftwareRenderDevice::SetShader(const Shader::ShaderType shader, const UINT /* variant */)
+{
+	// The emulated shader paths branch on the same constant buffer flags the permutation variants are selected from
+	if (_activeShaderType != shader)
+	{
+		_frameStats._stateChangeCount++;
+	}
+
+	_activeShaderType = shader;
+}
+
+void SoftwareRenderDevice::SetDepthStencilEnabled(const bool depthStencilEnabled)
+{
+	_depthStencilEnabled = depthStencilEnabled;
+	_frameStats._stateChangeCount++;
+}
+
+void SoftwareRenderDevice::SetWireframe(const bool wireframe)
+{
+	_wireframe = wireframe;
+	_frameStats._stateChangeCount++;
+}
+
+void SoftwareRenderDevice::UpdatePerFrameConstants(const Shader::ShaderType shader, const void* perFrameConstantBufferData, const UINT byteSize)
+{
+	if (shader != Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING)
+	{
+		return;
+	}
+
+	assert(byteSize == sizeof(Default3dWithLightingShader::PerFrameConstantBuffer));
+
+	Default3dWithLightingShader::PerFrameConstantBuffer perFrameCb;
+	std::memcpy(&perFrameCb, perFrameConstantBufferData, sizeof(perFrameCb));
+
+	XMStoreFloat4x4(&_lightingFrameConstants._viewProj, perFrameCb.gViewProj);
+	std::memcpy(_lightingFrameConstants._directionalLights, perFrameCb.gDirectionalLights, sizeof(perFrameCb.gDirectionalLights));
+	_lightingFrameConstants._spotLight = perFrameCb.gSpotLight;
+	_lightingFrameConstants._eyePosW = perFrameCb.gEyePosW;
+	_lightingFrameConstants._directionalLightCount = (std::min)(perFrameCb.gDirectionalLightCount, static_cast<INT>(Default3dWithLightingShader::MAX_DIRECTIONAL_LIGHTS));
+	_lightingFrameConstants._clusterDepthScale = perFrameCb.gClusterDepthScale;
+	_lightingFrameConstants._clusterDepthBias = perFrameCb.gClusterDepthBias;
+
+	_frameStats._bytesUploaded += byteSize;
+}
+
+void SoftwareRenderDevice::UpdateLightGrid(const ClusteredLightGrid& lightGrid)
+{
+	_lightGridBuffers._pointLights = lightGrid.GetLights();
+	_lightGridBuffers._clusterLightRanges = lightGrid.GetClusterLightRanges();
+	_lightGridBuffers._lightIndices = lightGrid.GetLightIndices();
+
+	_frameStats._bytesUploaded += static_cast<UINT>(sizeof(PointLight) * _lightGridBuffers._pointLights.size() + 
+	                                                sizeof(ClusteredLightGrid::ClusterLightRange) * _lightGridBuffers._clusterLightRanges.size() + 
+	                                                sizeof(UINT) * _lightGridBuffers._lightIndices.size());
+}
+
+void SoftwareRenderDevice::DrawModel(const Model& model, const void* constantBufferData, const UINT byteSize)
+{
+	auto addAlphaThreshold = -FLT_MAX;
+	switch (_activeShaderType)
+	{
+		case Shader::ShaderType::DEFAULT_3D:
+		{
+			assert(byteSize == sizeof(Default3dShader::ConstantBuffer));
+			TransformDefault3d(model, constantBufferData);
+		} break;
+
+		case Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING:
+		{
+			assert(byteSize == sizeof(Default3dWithLightingShader::ConstantBuffer));
+			TransformDefault3dWithLighting(model, constantBufferData);
+		} break;
+
+		case Shader::ShaderType::DEFAULT_UI:
+		{
+			assert(byteSize == sizeof(DefaultUiShader::ConstantBuffer));
+			TransformDefaultUi(model, constantBufferData, addAlphaThreshold);
+		} break;
+
+		default:
+		{
+			OutputDebugString("Shader type not supported by the software render device\n");
+			return;
+		}
+	}
+
+	SubmitIndexedTriangles(model.GetRawIndexData(), GetRasterTexture(model.GetTexture()), addAlphaThreshold, _depthStencilEnabled);
+
+	_frameStats._drawCount++;
+	_frameStats._bytesUploaded += byteSize;
+}
+
+void SoftwareRenderDevice::DrawTextVertices(const std::vector<TextVertex>& vertices, const TextureViewHandle fontTexture)
+{
+	const auto vertexCount = static_cast<UINT>(vertices.size());
+	if (vertexCount == 0)
+	{
+		return;
+	}
+
+	// Glyph quads are laid out in normalized device coordinates already, see defaulttext.vs
+	_transformedVertices.resize(vertexCount);
+	_textIndices.resize(vertexCount);
+	for (auto i = 0U; i < vertexCount; ++i)
+	{
+		auto& vertex = _transformedVertices[i];
+		vertex._clipPos[0] = vertices[i]._pos.x;
+		vertex._clipPos[1] = vertices[i]._pos.y;
+		vertex._clipPos[2] = vertices[i]._pos.z;
+		vertex._clipPos[3] = 1.0f;
+		vertex._texcoord[0] = vertices[i]._tex.x;
+		vertex._texcoord[1] = vertices[i]._tex.y;
+		SetShading(vertex, XMVectorSplatOne(), XMLoadFloat4(&vertices[i]._color));
+
+		_textIndices[i] = i;
+	}
+
+	SubmitIndexedTriangles(_textIndices, GetRasterTexture(static_cast<ID3D11ShaderResourceView*>(fontTexture._view)), TEXT_ADD_ALPHA_THRESHOLD, false);
+
+	_frameStats._drawCount++;
+	_frameStats._bytesUploaded += sizeof(TextVertex) * vertexCount;
+}
+
+const RenderDevice::FrameStats& SoftwareRenderDevice::GetLastFrameStats() const
+{
+	return _lastFrameStats;
+}
+
+const std::vector<std::uint64_t>& SoftwareRenderDevice::GetFrameChecksums() const
+{
+	return _frameChecksums;
+}
+
+RenderDevice::DeviceHandle SoftwareRenderDevice::GetDeviceHandle() const
+{
+	return { _device.Get() };
+}
+
+void SoftwareRenderDevice::TransformDefault3d(const Model& model, const void* constantBufferData)
+{
+	Default3dShader::ConstantBuffer cb;
+	std::memcpy(&cb, constantBufferData, sizeof(cb));
+
+	const auto& vertices = model.GetRawVertexData();
+	_transformedVertices.resize(vertices.size());
+	for (auto i = 0U; i < vertices.size(); ++i)
+	{
+		auto& vertex = _transformedVertices[i];
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(vertex._clipPos), XMVector3Transform(XMLoadFloat3(&vertices[i]._pos), cb.gWorldViewProj));
+		vertex._texcoord[0] = vertices[i]._tex.x;
+		vertex._texcoord[1] = vertices[i]._tex.y;
+		SetShading(vertex, XMVectorSplatOne(), XMVectorZero());
+	}
+}
+
+void SoftwareRenderDevice::TransformDefault3dWithLighting(const Model& model, const void* constantBufferData)
+{
+	Default3dWithLightingShader::ConstantBuffer cb;
+	std::memcpy(&cb, constantBufferData, sizeof(cb));
+
+	const auto& frame = _lightingFrameConstants;
+	const auto viewProj = XMLoadFloat4x4(&frame._viewProj);
+	const auto eyePos = XMLoadFloat3(&frame._eyePosW);
+	const auto& material = cb.gMaterial;
+	const auto& lightGrid = _lightGridBuffers;
+
+	const auto& vertices = model.GetRawVertexData();
+	_transformedVertices.resize(vertices.size());
+	for (auto i = 0U; i < vertices.size(); ++i)
+	{
+		const auto posW    = XMVector3Transform(XMLoadFloat3(&vertices[i]._pos), cb.gWorld);
+		const auto normalW = XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&vertices[i]._normal), cb.gWorldInvTranspose));
+		const auto toEye   = XMVector3Normalize(eyePos - posW);
+		const auto clipPos = XMVector4Transform(XMVectorSetW(posW, 1.0f), viewProj);
+
+		LightingTerms terms = { XMVectorZero(), XMVectorZero(), XMVectorZero() };
+		for (auto lightIndex = 0; lightIndex < frame._directionalLightCount; ++lightIndex)
+		{
+			ComputeDirectionalLight(material, frame._directionalLights[lightIndex], normalW, toEye, terms);
+		}
+
+		// Only the point lights of the vertex's cluster are evaluated, like in default3dwithlighting.ps
+		if (!lightGrid._clusterLightRanges.empty())
+		{
+			const auto clipW = XMVectorGetW(clipPos);
+			const auto ndcX = clipW > 0.0f ? XMVectorGetX(clipPos) / clipW : 0.0f;
+			const auto ndcY = clipW > 0.0f ? XMVectorGetY(clipPos) / clipW : 0.0f;
+			const auto clusterIndex = ClusteredLightGrid::GetClusterIndex(ndcX, ndcY, clipW, frame._clusterDepthScale, frame._clusterDepthBias);
+
+			const auto& range = lightGrid._clusterLightRanges[clusterIndex];
+			for (auto entry = range._offset; entry < range._offset + range._count; ++entry)
+			{
+				ComputePointLight(material, lightGrid._pointLights[lightGrid._lightIndices[entry]], posW, normalW, toEye, terms);
+			}
+		}
+		ComputeSpotLight(material, frame._spotLight, posW, normalW, toEye, terms);
+
+		// litColor = texel * (ambient + diffuse) + spec, with alpha taken from the material's diffuse
+		auto& vertex = _transformedVertices[i];
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(vertex._clipPos), clipPos);
+		vertex._texcoord[0] = vertices[i]._tex.x;
+		vertex._texcoord[1] = vertices[i]._tex.y;
+		SetShading(vertex, XMVectorSetW(terms._ambient + terms._diffuse, 0.0f), XMVectorSetW(terms._specular, material._diffuse.w));
+	}
+}
+
+void SoftwareRenderDevice::TransformDefaultUi(const Model& model, const void* constantBufferData, FLOAT& outAddAlphaThreshold)
+{
+	DefaultUiShader::ConstantBuffer cb;
+	std::memcpy(&cb, constantBufferData, sizeof(cb));
+
+	// See defaultui.ps: the colour is only added to texels with enough alpha
+	outAddAlphaThreshold = TEXT_ADD_ALPHA_THRESHOLD;
+	const auto add = cb.gColorEnabled ? XMLoadFloat4(&cb.gColor) : XMVectorZero();
+	const auto texCoordOffsets = cb.gSrollTexCoordsEnabled ? cb.gTexCoordOffsets : XMFLOAT2(0.0f, 0.0f);
+
+	const auto& vertices = model.GetRawVertexData();
+	_transformedVertices.resize(vertices.size());
+	for (auto i = 0U; i < vertices.size(); ++i)
+	{
+		auto& vertex = _transformedVertices[i];
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(vertex._clipPos), XMVectorSetW(XMVector3Transform(XMLoadFloat3(&vertices[i]._pos), cb.gWorld), 1.0f));
+		vertex._texcoord[0] = vertices[i]._tex.x + texCoordOffsets.x;
+		vertex._texcoord[1] = vertices[i]._tex.y + texCoordOffsets.y;
+		SetShading(vertex, XMVectorSplatOne(), add);
+	}
+}
+
+void SoftwareRenderDevice::SubmitIndexedTriangles(const std::vector<UINT>& indices, const RasterTexture* texture, const FLOAT addAlphaThreshold, const bool depthEnabled)
+{
+	RasterState state;
+	state._texture = texture;
+	state._addAlphaThreshold = addAlphaThreshold;
+	state._depthEnabled = depthEnabled;
+	state._wireframe = _wireframe;
+
+	for (auto i = 0U; i + 2 < indices.size(); i += 3)
+	{
+		_rasterizer->AddTriangle(_transformedVertices[indices[i]], _transformedVertices[indices[i + 1]], _transformedVertices[indices[i + 2]], state);
+	}
+}
+
+const RasterTexture* SoftwareRenderDevice::GetRasterTexture(comptr<ID3D11ShaderResourceView> textureView)
+{
+	if (!textureView)
+	{
+		return nullptr;
+	}
+
+	auto cachedTextureIter = _textureCache.find(textureView.Get());
+	if (cachedTextureIter != _textureCache.end())
+	{
+		return &cachedTextureIter->second._texture;
+	}
+
+	// Keep a reference to the view so that its address cannot be reused by another texture while cached
+	auto& cachedTexture = _textureCache[textureView.Get()];
+	cachedTexture._view = textureView;
+	cachedTexture._texture._width = 0;
+	cachedTexture._texture._height = 0;
+
+	comptr<ID3D11Resource> resource;
+	textureView->GetResource(resource.GetAddressOf());
+
+	comptr<ID3D11Texture2D> texture;
+	if (FAILED(resource.As(&texture)))
+	{
+		return &cachedTexture._texture;
+	}
+
+	D3D11_TEXTURE2D_DESC textureDesc;
+	texture->GetDesc(&textureDesc);
+
+	const auto isRGBA = textureDesc.Format == DXGI_FORMAT_R8G8B8A8_UNORM || textureDesc.Format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	const auto isBGRA = textureDesc.Format == DXGI_FORMAT_B8G8R8A8_UNORM || textureDesc.Format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+	if (!isRGBA && !isBGRA)
+	{
+		// Rendered untextured (white) rather than guessing at the layout
+		OutputDebugString("Software render device cannot read back texture format, rendering it white\n");
+		return &cachedTexture._texture;
+	}
+
+	// Copy the top mip to a staging texture the CPU can map
+	D3D11_TEXTURE2D_DESC stagingDesc = textureDesc;
+	stagingDesc.MipLevels      = 1;
+	stagingDesc.ArraySize      = 1;
+	stagingDesc.Usage          = D3D11_USAGE_STAGING;
+	stagingDesc.BindFlags      = 0;
+	stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	stagingDesc.MiscFlags      = 0;
+
+	comptr<ID3D11Texture2D> stagingTexture;
+	HR(_device->CreateTexture2D(&stagingDesc, 0, stagingTexture.GetAddressOf()));
+	_deviceContext->CopySubresourceRegion(stagingTexture.Get(), 0, 0, 0, 0, texture.Get(), 0, 0);
+
+	D3D11_MAPPED_SUBRESOURCE mappedResource = {};
+	HR(_deviceContext->Map(stagingTexture.Get(), 0, D3D11_MAP_READ, 0, &mappedResource));
+
+	auto& rasterTexture = cachedTexture._texture;
+	rasterTexture._width = textureDesc.Width;
+	rasterTexture._height = textureDesc.Height;
+	rasterTexture._texels.resize(textureDesc.Width * textureDesc.Height);
+	for (auto y = 0U; y < textureDesc.Height; ++y)
+	{
+		const auto* sourceRow = reinterpret_cast<const std::uint32_t*>(static_cast<const BYTE*>(mappedResource.pData) + y * mappedResource.RowPitch);
+		auto* targetRow = &rasterTexture._texels[y * textureDesc.Width];
+		for (auto x = 0U; x < textureDesc.Width; ++x)
+		{
+			const auto texel = sourceRow[x];
+			targetRow[x] = isRGBA ? texel : (texel & 0xFF00FF00) | ((texel >> 16) & 0xFF) | ((texel & 0xFF) << 16);
+		}
+	}
+
+	_deviceContext->Unmap(stagingTexture.Get(), 0);
+	return &rasterTexture;
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+/****************************************************************************/
+/** softwarerenderdevice.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                      **/
+/****************************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "renderdevice.h"
+#include "softwarerasterizer.h"
+#include "clusteredlightgrid.h"
+#include "lightdef.h"
+#include "shaders/default3dwithlightingshader.h"
+
+// Remote Headers
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Rasterizes frames on the CPU and writes every presented frame to a PNG, so rendering can be checked
+// and its fill cost measured with no GPU. The default3d, default3dwithlighting, defaultui and text
+// shader paths are emulated with the vertex and index data Models keep. Lighting is evaluated per vertex.
+class SoftwareRenderDevice final: public RenderDevice
+{
+public:
+	// With an empty outputDirectory frames are rasterized but not written
+	SoftwareRenderDevice(const UINT width, const UINT height, const std::string& outputDirectory);
+	~SoftwareRenderDevice();
+
+	void OnResize() override;
+	void ClearViews() override;
+	void Present() override;
+
+	void SetShader(const Shader::ShaderType shader, const UINT variant) override;
+	void SetDepthStencilEnabled(const bool depthStencilEnabled) override;
+	void SetWireframe(const bool wireframe) override;
+
+	void UpdatePerFrameConstants(const Shader::ShaderType shader, const void* perFrameConstantBufferData, const UINT byteSize) override;
+	void UpdateLightGrid(const ClusteredLightGrid& lightGrid) override;
+	void DrawModel(const Model& model, const void* constantBufferData, const UINT byteSize) override;
+	void DrawTextVertices(const std::vector<TextVertex>& vertices, const TextureViewHandle fontTexture) override;
+
+	const FrameStats& GetLastFrameStats() const override;
+
+	// 64 bit FNV-1a hash of every presented frame's pixels, in presentation order, for comparing runs without the PNGs
+	const std::vector<std::uint64_t>& GetFrameChecksums() const;
+
+	// WARP device. Assets still create their buffers and textures through it, and textures are read back from it.
+	DeviceHandle GetDeviceHandle() const override;
+
+private:
+	// The parts of Default3dWithLightingShader::PerFrameConstantBuffer the vertex lighting needs, without the XMMATRIX alignment requirement
+	struct LightingFrameConstants
+	{
+		XMFLOAT4X4 _viewProj;
+		DirectionalLight _directionalLights[Default3dWithLightingShader::MAX_DIRECTIONAL_LIGHTS];
+		SpotLight _spotLight;
+		XMFLOAT3 _eyePosW;
+		INT _directionalLightCount;
+		FLOAT _clusterDepthScale;
+		FLOAT _clusterDepthBias;
+	};
+
+	// Copy of the last uploaded ClusteredLightGrid lists, standing in for the structured buffers
+	struct LightGridBuffers
+	{
+		std::vector<PointLight> _pointLights;
+		std::vector<ClusteredLightGrid::ClusterLightRange> _clusterLightRanges;
+		std::vector<UINT> _lightIndices;
+	};
+
+	struct CachedTexture
+	{
+		comptr<ID3D11ShaderResourceView> _view;
+		RasterTexture _texture;
+	};
+
+private:
+	void TransformDefault3d(const Model& model, const void* constantBufferData);
+	void TransformDefault3dWithLighting(const Model& model, const void* constantBufferData);
+	void TransformDefaultUi(const Model& model, const void* constantBufferData, FLOAT& outAddAlphaThreshold);
+	void SubmitIndexedTriangles(const std::vector<UINT>& indices, const RasterTexture* texture, const FLOAT addAlphaThreshold, const bool depthEnabled);
+
+	const RasterTexture* GetRasterTexture(comptr<ID3D11ShaderResourceView> textureView);
+
+private:
+	static const FLOAT TEXT_ADD_ALPHA_THRESHOLD;
+
+private:
+	comptr<ID3D11Device> _device;
+	comptr<ID3D11DeviceContext> _deviceContext;
+
+	std::unique_ptr<ThreadPool> _threadPool;
+	std::unique_ptr<SoftwareRasterizer> _rasterizer;
+	std::unordered_map<ID3D11ShaderResourceView*, CachedTexture> _textureCache;
+
+	LightingFrameConstants _lightingFrameConstants;
+	LightGridBuffers _lightGridBuffers;
+	std::vector<RasterVertex> _transformedVertices;
+	std::vector<UINT> _textIndices;
+	std::vector<std::uint8_t> _framePixels;
+	std::vector<std::uint64_t> _frameChecksums;
+
+	const std::string _outputDirectory;
+	UINT _frameIndex;
+
+	Shader::ShaderType _activeShaderType;
+	bool _depthStencilEnabled;
+	bool _wireframe;
+
+	FrameStats _frameStats;
+	FrameStats _lastFrameStats;
+};
\ No newline at end of file
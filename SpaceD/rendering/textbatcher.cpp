@@ -0,0 +1,36 @@
+/**********************************************************************/
+/** textbatcher.cpp by Alex Koukoulas (C) 2017 All Rights Reserved   **/
+/** File Description:                                                **/
+/**********************************************************************/
+
+// Local Headers
+#include "textbatcher.h"
+#include "fontengine.h"
+
+// Remote Headers
+
+TextBatcher::TextBatcher()
+{
+	_vertices.reserve(INITIAL_GLYPH_CAPACITY * VERTICES_PER_GLYPH);
+}
+
+TextBatcher::~TextBatcher()
+{
+}
+
+void TextBatcher::AddText(const std::string& text, const XMFLOAT2& pos, const XMFLOAT4& color, const FLOAT glyphSize, const FontEngine& fontEngine)
+{
+	const auto& layout = _layoutCache.GetLayout(text, pos, color, glyphSize, fontEngine);
+	_vertices.insert(_vertices.end(), layout.begin(), layout.end());
+}
+
+const std::vector<TextVertex>& TextBatcher::GetVertices() const
+{
+	return _vertices;
+}
+
+void TextBatcher::OnFrameEnd()
+{
+	_vertices.clear();
+	_layoutCache.OnFrameEnd();
+}
\ No newline at end of file
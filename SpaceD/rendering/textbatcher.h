@@ -0,0 +1,39 @@
+/********************************************************************/
+/** textbatcher.h by Alex Koukoulas (C) 2017 All Rights Reserved   **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "textlayoutcache.h"
+#include "vertex.h"
+
+// Remote Headers
+#include <string>
+#include <vector>
+
+class FontEngine;
+
+// Accumulates the glyph quads of every string rendered during a frame so that
+// the render device can upload them to a single dynamic vertex buffer and draw them at once
+class TextBatcher final
+{
+public:
+	TextBatcher();
+	~TextBatcher();
+
+	void AddText(const std::string& text, const XMFLOAT2& pos, const XMFLOAT4& color, const FLOAT glyphSize, const FontEngine& fontEngine);
+
+	// This frame's quads, VERTICES_PER_GLYPH vertices per glyph
+	const std::vector<TextVertex>& GetVertices() const;
+	void OnFrameEnd();
+
+private:
+	static const UINT VERTICES_PER_GLYPH = 6U;
+	static const UINT INITIAL_GLYPH_CAPACITY = 1024U;
+
+private:
+	std::vector<TextVertex> _vertices;
+	TextLayoutCache _layoutCache;
+};
\ No newline at end of file
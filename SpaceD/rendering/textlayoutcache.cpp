@@ -0,0 +1,206 @@
+/************************************************************************/
+/** textlayoutcache.cpp by Alex Koukoulas (C) 2017 All Rights Reserved **/
+/** File Description:                                                  **/
+/************************************************************************/
+
+// Local Headers
+#include "textlayoutcache.h"
+#include "fontengine.h"
+
+// Remote Headers
+#include <functional>
+
+namespace
+{
+	void HashCombine(size_t& seed, const size_t value)
+	{
+		seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	}
+
+	void HashCombine(size_t& seed, const FLOAT value)
+	{
+		HashCombine(seed, std::hash<FLOAT>()(value));
+	}
+}
+
+TextLayoutCache::TextLayoutCache()
+	: _frameCounter(0)
+{
+}
+
+TextLayoutCache::~TextLayoutCache()
+{
+}
+
+const std::vector<TextVertex>& TextLayoutCache::GetLayout(const std::string& text, const XMFLOAT2& pos, const XMFLOAT4& color, const FLOAT glyphSize, const FontEngine& fontEngine)
+{
+	const auto slotKey = CalculateSlotKey(pos, glyphSize, fontEngine);
+	const auto layoutKey = CalculateLayoutKey(slotKey, text, color);
+
+	// Unchanged string; reuse the cached quads as they are
+	auto layoutIter = _layouts.find(layoutKey);
+	if (layoutIter != _layouts.end() && Matches(layoutIter->second, text, pos, color, glyphSize, fontEngine))
+	{
+		layoutIter->second._lastUsedFrame = _frameCounter;
+		_slots[slotKey] = layoutKey;
+		return layoutIter->second._vertices;
+	}
+
+	Layout newLayout;
+	newLayout._text       = text;
+	newLayout._pos        = pos;
+	newLayout._color      = color;
+	newLayout._glyphSize  = glyphSize;
+	newLayout._fontEngine = &fontEngine;
+	newLayout._lastUsedFrame = _frameCounter;
+
+	// Edited string at the same slot; keep the quads of the common prefix and lay out the rest
+	auto firstChangedChar = size_t(0);
+	const auto slotIter = _slots.find(slotKey);
+	if (slotIter != _slots.end())
+	{
+		const auto previousLayoutIter = _layouts.find(slotIter->second);
+		if (previousLayoutIter != _layouts.end() && previousLayoutIter->first != layoutKey)
+		{
+			const auto& previousLayout = previousLayoutIter->second;
+			if (Matches(previousLayout, previousLayout._text, pos, color, glyphSize, fontEngine))
+			{
+				const auto maxPrefix = text.size() < previousLayout._text.size() ? text.size() : previousLayout._text.size();
+				while (firstChangedChar < maxPrefix && text[firstChangedChar] == previousLayout._text[firstChangedChar])
+				{
+					++firstChangedChar;
+				}
+
+				const auto prefixVertexCount = firstChangedChar < previousLayout._charVertexOffsets.size() ? 
+					                           previousLayout._charVertexOffsets[firstChangedChar] : previousLayout._vertices.size();
+
+				newLayout._charVertexOffsets.assign(previousLayout._charVertexOffsets.begin(), previousLayout._charVertexOffsets.begin() + firstChangedChar);
+				newLayout._charPenPositions.assign(previousLayout._charPenPositions.begin(), previousLayout._charPenPositions.begin() + firstChangedChar);
+				newLayout._vertices.assign(previousLayout._vertices.begin(), previousLayout._vertices.begin() + prefixVertexCount);
+			}
+		}
+	}
+
+	LayoutFrom(newLayout, firstChangedChar);
+
+	_slots[slotKey] = layoutKey;
+	auto& storedLayout = _layouts[layoutKey];
+	storedLayout = std::move(newLayout);
+	return storedLayout._vertices;
+}
+
+void TextLayoutCache::OnFrameEnd()
+{
+	++_frameCounter;
+
+	for (auto layoutIter = _layouts.begin(); layoutIter != _layouts.end();)
+	{
+		if (_frameCounter - layoutIter->second._lastUsedFrame > EVICTION_FRAME_COUNT)
+		{
+			layoutIter = _layouts.erase(layoutIter);
+		}
+		else
+		{
+			++layoutIter;
+		}
+	}
+
+	// A slot points at the last layout drawn there, so it goes when that layout does
+	for (auto slotIter = _slots.begin(); slotIter != _slots.end();)
+	{
+		if (_layouts.find(slotIter->second) == _layouts.end())
+		{
+			slotIter = _slots.erase(slotIter);
+		}
+		else
+		{
+			++slotIter;
+		}
+	}
+}
+
+size_t TextLayoutCache::CalculateSlotKey(const XMFLOAT2& pos, const FLOAT glyphSize, const FontEngine& fontEngine)
+{
+	auto seed = std::hash<const FontEngine*>()(&fontEngine);
+	HashCombine(seed, glyphSize);
+	HashCombine(seed, pos.x);
+	HashCombine(seed, pos.y);
+	return seed;
+}
+
+size_t TextLayoutCache::CalculateLayoutKey(const size_t slotKey, const std::string& text, const XMFLOAT4& color)
+{
+	auto seed = slotKey;
+	HashCombine(seed, std::hash<std::string>()(text));
+	HashCombine(seed, color.x);
+	HashCombine(seed, color.y);
+	HashCombine(seed, color.z);
+	HashCombine(seed, color.w);
+	return seed;
+}
+
+bool TextLayoutCache::Matches(const Layout& layout, const std::string& text, const XMFLOAT2& pos, const XMFLOAT4& color, const FLOAT glyphSize, const FontEngine& fontEngine)
+{
+	return layout._fontEngine == &fontEngine && 
+		   layout._glyphSize == glyphSize    &&
+		   layout._pos.x == pos.x            && layout._pos.y == pos.y     &&
+		   layout._color.x == color.x        && layout._color.y == color.y &&
+		   layout._color.z == color.z        && layout._color.w == color.w &&
+		   layout._text == text;
+}
+
+void TextLayoutCache::LayoutFrom(Layout& layout, const size_t firstCharIndex)
+{
+	const auto& text = layout._text;
+	const auto glyphSize = layout._glyphSize;
+
+	// Pen position at firstCharIndex is the one after the last kept character
+	auto penX = layout._pos.x;
+	if (firstCharIndex > 0)
+	{
+		const auto lastKeptChar = text[firstCharIndex - 1];
+		penX = layout._charPenPositions[firstCharIndex - 1] + (lastKeptChar == ' ' ? glyphSize : glyphSize * 2);
+	}
+
+	layout._charVertexOffsets.resize(firstCharIndex);
+	layout._charPenPositions.resize(firstCharIndex);
+	layout._charVertexOffsets.reserve(text.size());
+	layout._charPenPositions.reserve(text.size());
+
+	for (auto i = firstCharIndex; i < text.size(); ++i)
+	{
+		const auto character = text[i];
+
+		layout._charVertexOffsets.push_back(static_cast<UINT>(layout._vertices.size()));
+		layout._charPenPositions.push_back(penX);
+
+		if (character == ' ')
+		{
+			penX += glyphSize;
+			continue;
+		}
+		penX += glyphSize * 2;
+
+		const auto* glyph = layout._fontEngine->GetGlyph(character);
+		if (!glyph)
+		{
+			continue;
+		}
+
+		const auto left   = penX - glyphSize;
+		const auto right  = penX + glyphSize;
+		const auto top    = layout._pos.y + glyphSize;
+		const auto bottom = layout._pos.y - glyphSize;
+
+		const auto& tl = glyph->_topLeftTexcoords;
+		const auto& br = glyph->_bottomRightTexcoords;
+		const auto& color = layout._color;
+
+		layout._vertices.emplace_back(XMFLOAT3(left,  top,    0.0f), XMFLOAT2(tl.x, tl.y), color);
+		layout._vertices.emplace_back(XMFLOAT3(right, top,    0.0f), XMFLOAT2(br.x, tl.y), color);
+		layout._vertices.emplace_back(XMFLOAT3(left,  bottom, 0.0f), XMFLOAT2(tl.x, br.y), color);
+		layout._vertices.emplace_back(XMFLOAT3(left,  bottom, 0.0f), XMFLOAT2(tl.x, br.y), color);
+		layout._vertices.emplace_back(XMFLOAT3(right, top,    0.0f), XMFLOAT2(br.x, tl.y), color);
+		layout._vertices.emplace_back(XMFLOAT3(right, bottom, 0.0f), XMFLOAT2(br.x, br.y), color);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+/**********************************************************************/
+/** textlayoutcache.h by Alex Koukoulas (C) 2017 All Rights Reserved **/
+/** File Description:                                                **/
+/**********************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "vertex.h"
+
+// Remote Headers
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class FontEngine;
+
+// Keeps the glyph quads of recently rendered strings so that unchanged strings skip layout 
+// entirely, and strings edited in place (same font, size and position) are only re-laid out 
+// from their first changed character onwards
+class TextLayoutCache final
+{
+public:
+	TextLayoutCache();
+	~TextLayoutCache();
+
+	const std::vector<TextVertex>& GetLayout(const std::string& text, const XMFLOAT2& pos, const XMFLOAT4& color, const FLOAT glyphSize, const FontEngine& fontEngine);
+
+	// Evicts layouts that have not been requested for a while, along with the slots that pointed at them
+	void OnFrameEnd();
+
+private:
+	struct Layout
+	{
+		std::string _text;
+		XMFLOAT2 _pos;
+		XMFLOAT4 _color;
+		FLOAT _glyphSize;
+		const FontEngine* _fontEngine;
+		
+		// Vertex offset and pen position at the start of every character
+		std::vector<UINT> _charVertexOffsets;
+		std::vector<FLOAT> _charPenPositions;
+		std::vector<TextVertex> _vertices;
+
+		UINT _lastUsedFrame;
+	};
+
+private:
+	static size_t CalculateSlotKey(const XMFLOAT2& pos, const FLOAT glyphSize, const FontEngine& fontEngine);
+	static size_t CalculateLayoutKey(const size_t slotKey, const std::string& text, const XMFLOAT4& color);
+	static bool Matches(const Layout& layout, const std::string& text, const XMFLOAT2& pos, const XMFLOAT4& color, const FLOAT glyphSize, const FontEngine& fontEngine);
+	static void LayoutFrom(Layout& layout, const size_t firstCharIndex);
+
+private:
+	static const UINT EVICTION_FRAME_COUNT = 120U;
+
+private:
+	std::unordered_map<size_t, Layout> _layouts;
+	std::unordered_map<size_t, size_t> _slots;
+	UINT _frameCounter;
+};
\ No newline at end of file
@@ -7,9 +7,65 @@
 
 // Local Headers
 #include "textureloader.h"
+#include "../util/ddsfile.h"
+#include "../util/pngreader.h"
+#include "../util/sourcestamp.h"
+#include "../util/texturebuilder.h"
+#include "../util/threadpool.h"
+#include "../util/virtualfilesystem.h"
 
 // Remote Headers
-#include <D3DX11.h>
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace
+{
+	const UINT TEXTURE_LOADER_WORKER_COUNT = 2U;
+
+	// Decoded rows start on 16 byte boundaries, any pitch is accepted by the upload
+	const UINT TEXTURE_ROW_PITCH_ALIGNMENT = 16U;
+
+	DXGI_FORMAT GetDxgiFormat(const block_compressor::BlockFormat format)
+	{
+		switch (format)
+		{
+			case block_compressor::BlockFormat::BC1: return DXGI_FORMAT_BC1_UNORM;
+			case block_compressor::BlockFormat::BC3: return DXGI_FORMAT_BC3_UNORM;
+			default: return DXGI_FORMAT_BC7_UNORM;
+		}
+	}
+
+	const char* GetFormatName(const DXGI_FORMAT format)
+	{
+		switch (format)
+		{
+			case DXGI_FORMAT_BC1_UNORM: return "BC1";
+			case DXGI_FORMAT_BC3_UNORM: return "BC3";
+			case DXGI_FORMAT_BC7_UNORM: return "BC7";
+			default: return "RGBA8";
+		}
+	}
+}
+
+TextureHandle::TextureHandle()
+{
+}
+
+TextureHandle::TextureHandle(std::shared_ptr<Slot> slot)
+	: _slot(slot)
+{
+}
+
+comptr<ID3D11ShaderResourceView> TextureHandle::Get() const
+{
+	return _slot ? _slot->_view : nullptr;
+}
+
+bool TextureHandle::IsReady() const
+{
+	return _slot && _slot->_ready;
+}
 
 TextureLoader& TextureLoader::Get()
 {
@@ -22,22 +78,307 @@ TextureLoader::~TextureLoader()
 }
 
 TextureLoader::TextureLoader()
+	: _pendingTextureCount(0)
+	, _compressedTexturesEnabled(true)
+	, _threadPool(std::make_unique<ThreadPool>(TEXTURE_LOADER_WORKER_COUNT))
+{
+}
+
+TextureHandle TextureLoader::LoadTexture(const std::string& texturePath, comptr<ID3D11Device> device)
+{
+	if (!_placeholder)
+	{
+		DecodedTexture placeholder;
+		placeholder._width = 1;
+		placeholder._height = 1;
+		placeholder._rowPitch = 4;
+		placeholder._format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		placeholder._pixels.assign(4, 0);
+		_placeholder = CreateTexture(placeholder, device);
+	}
+
+	// Textures preloaded before there was a device show the placeholder from their first use on
+	auto handle = RequestTexture(texturePath);
+	if (!handle._slot->_ready && !handle._slot->_view)
+	{
+		handle._slot->_view = _placeholder;
+	}
+
+	return handle;
+}
+
+void TextureLoader::PreloadTexture(const std::string& texturePath)
 {
+	RequestTexture(texturePath);
 }
 
-comptr<ID3D11ShaderResourceView> TextureLoader::LoadTexture(const std::string& texturePath, comptr<ID3D11Device> device)
+void TextureLoader::CreateDecodedTextures(comptr<ID3D11Device> device)
 {
-	// Textuer entry exists
-	if (_textures.count(texturePath))
+	std::vector<DecodedTexture> decodedTextures;
+	{
+		std::lock_guard<std::mutex> lock(_decodedTexturesMutex);
+		decodedTextures.swap(_decodedTextures);
+	}
+
+	if (decodedTextures.empty())
+	{
+		return;
+	}
+
+	const auto creationStart = std::chrono::high_resolution_clock::now();
+	auto createdBytes = 0U;
+	std::stringstream creationStream;
+
+	for (const auto& decodedTexture: decodedTextures)
 	{
-		// Texture found; return cached version
-		return _textures[texturePath];		
+		_pendingTextureCount--;
+
+		// Failed loads keep showing the placeholder
+		if (!decodedTexture._succeeded)
+		{
+			OutputDebugString(("Could not load texture " + decodedTexture._path + "\n").c_str());
+			continue;
+		}
+
+		decodedTexture._slot->_view = CreateTexture(decodedTexture, device);
+		decodedTexture._slot->_ready = true;
+		_loadMilliseconds[decodedTexture._path] = decodedTexture._loadMilliseconds;
+		createdBytes += decodedTexture._memorySize;
+
+		creationStream << "Texture " << decodedTexture._path << ": " << decodedTexture._width << "x" << decodedTexture._height << " " 
+		               << GetFormatName(decodedTexture._format) << ", " << decodedTexture._memorySize / 1024 << "KB with mips, loaded in " 
+		               << decodedTexture._loadMilliseconds << "ms\n";
 	}
 
-	// Load Model normally and add entry
-	comptr<ID3D11ShaderResourceView> loadedTexture;
-	HR(D3DX11CreateShaderResourceViewFromFile(device.Get(), texturePath.c_str(), 0, 0, loadedTexture.GetAddressOf(), 0));
-	_textures[texturePath] = loadedTexture;
+	const auto creationEnd = std::chrono::high_resolution_clock::now();
+
+	creationStream << "Created " << decodedTextures.size() << " textures (" << createdBytes / 1024 << "KB) in " 
+	               << std::chrono::duration<FLOAT, std::milli>(creationEnd - creationStart).count() << "ms, " 
+	               << _pendingTextureCount << " still loading\n";
+	OutputDebugString(creationStream.str().c_str());
+}
+
+void TextureLoader::WaitForPendingTextures(comptr<ID3D11Device> device)
+{
+	while (_pendingTextureCount > 0)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_decodedTexturesMutex);
+			_textureDecoded.wait(lock, [this]() { return !_decodedTextures.empty(); });
+		}
+
+		CreateDecodedTextures(device);
+	}
+}
+
+UINT TextureLoader::GetPendingTextureCount() const
+{
+	return _pendingTextureCount;
+}
+
+const std::vector<std::string>& TextureLoader::GetRequestedTexturePaths() const
+{
+	return _requestedTexturePaths;
+}
+
+FLOAT TextureLoader::GetLoadMilliseconds(const std::string& texturePath) const
+{
+	const auto loadMillisecondsIter = _loadMilliseconds.find(texturePath);
+	return loadMillisecondsIter == _loadMilliseconds.end() ? 0.0f : loadMillisecondsIter->second;
+}
+
+void TextureLoader::SetCompressedTexturesEnabled(const bool compressedTexturesEnabled)
+{
+	_compressedTexturesEnabled = compressedTexturesEnabled;
+}
+
+const texture_atlas::AtlasRegion* TextureLoader::FindAtlasRegion(const std::string& layoutPath, const std::string& texturePath)
+{
+	if (!_compressedTexturesEnabled)
+	{
+		return nullptr;
+	}
+
+	auto atlasLayoutIter = _atlasLayouts.find(layoutPath);
+	if (atlasLayoutIter == _atlasLayouts.end())
+	{
+		// A missing layout simply means nothing has been atlased; it is remembered as an empty one
+		atlasLayoutIter = _atlasLayouts.emplace(layoutPath, texture_atlas::AtlasLayout()).first;
+		if (texture_atlas::ReadLayout(layoutPath, atlasLayoutIter->second))
+		{
+			OutputDebugString((std::string("Read atlas layout: ") + layoutPath + " (" + std::to_string(atlasLayoutIter->second._regions.size()) + " atlased textures)\n").c_str());
+		}
+	}
+
+	const auto& regions = atlasLayoutIter->second._regions;
+	const auto regionIter = regions.find(texturePath);
+	return regionIter == regions.end() ? nullptr : &regionIter->second;
+}
+
+TextureHandle TextureLoader::RequestTexture(const std::string& texturePath)
+{
+	// Texture already requested; its handle resolves once, for every holder
+	auto textureIter = _textures.find(texturePath);
+	if (textureIter != _textures.end())
+	{
+		return textureIter->second;
+	}
+
+	auto slot = std::make_shared<TextureHandle::Slot>();
+	slot->_ready = false;
+
+	_pendingTextureCount++;
+	_threadPool->Submit([this, slot, texturePath]() { DecodeTexture(slot, texturePath); });
+
+	TextureHandle handle(slot);
+	_textures[texturePath] = handle;
+	_requestedTexturePaths.push_back(texturePath);
+	return handle;
+}
+
+void TextureLoader::DecodeTexture(std::shared_ptr<TextureHandle::Slot> slot, const std::string& texturePath)
+{
+	// Worker thread
+	DecodedTexture decodedTexture;
+	decodedTexture._slot = slot;
+	decodedTexture._path = texturePath;
+	decodedTexture._width = 0;
+	decodedTexture._height = 0;
+	decodedTexture._rowPitch = 0;
+	decodedTexture._format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	decodedTexture._memorySize = 0;
+
+	const auto loadStart = std::chrono::high_resolution_clock::now();
+	decodedTexture._succeeded = 
+		(_compressedTexturesEnabled && ReadBuiltTexture(texturePath, decodedTexture)) || 
+		ReadPngTexture(texturePath, decodedTexture);
+	const auto loadEnd = std::chrono::high_resolution_clock::now();
+	decodedTexture._loadMilliseconds = std::chrono::duration<FLOAT, std::milli>(loadEnd - loadStart).count();
+
+	{
+		std::lock_guard<std::mutex> lock(_decodedTexturesMutex);
+		_decodedTextures.push_back(std::move(decodedTexture));
+	}
+	_textureDecoded.notify_one();
+}
+
+bool TextureLoader::ReadBuiltTexture(const std::string& texturePath, DecodedTexture& decodedTexture) const
+{
+	const auto builtTexturePath = texture_builder::GetBuiltTexturePath(texturePath);
+	const VirtualFile builtTextureFile(builtTexturePath);
+
+	dds_file::TextureInfo textureInfo;
+	if (!builtTextureFile.IsOpen() || !dds_file::Read(builtTextureFile.GetData(), builtTextureFile.GetSize(), textureInfo))
+	{
+		return false;
+	}
+
+	// Atlases are requested by their built path and have no source of their own. Otherwise the PNG is read instead 
+	// when it is on disk and has changed since the build, or when the texture was built before sources were stamped.
+	source_stamp::Stamp sourceStamp;
+	if (builtTexturePath != texturePath && source_stamp::GetStamp(texturePath, sourceStamp) && 
+		(!textureInfo._hasSourceStamp || !source_stamp::IsSameStamp(sourceStamp, textureInfo._sourceStamp)))
+	{
+		OutputDebugString(("Stale built texture: " + builtTexturePath + ", reading " + texturePath + " instead\n").c_str());
+		return false;
+	}
+
+	// The levels are uploaded straight out of a copy of the file contents, as the view does not outlive this call
+	decodedTexture._width = textureInfo._width;
+	decodedTexture._height = textureInfo._height;
+	decodedTexture._format = GetDxgiFormat(textureInfo._format);
+	decodedTexture._mipLevels.clear();
+	for (const auto& mipLevel: textureInfo._mipLevels)
+	{
+		decodedTexture._mipLevels.push_back({ static_cast<UINT>(mipLevel._offset), mipLevel._rowPitch });
+		decodedTexture._memorySize += static_cast<UINT>(mipLevel._size);
+	}
+	decodedTexture._pixels.assign(builtTextureFile.GetData(), builtTextureFile.GetData() + builtTextureFile.GetSize());
+
+	return true;
+}
+
+bool TextureLoader::ReadPngTexture(const std::string& texturePath, DecodedTexture& decodedTexture) const
+{
+	const VirtualFile textureFile(texturePath);
+
+	png_reader::ImageInfo imageInfo;
+	if (!textureFile.IsOpen() || !png_reader::ReadInfo(textureFile.GetData(), textureFile.GetSize(), imageInfo))
+	{
+		return false;
+	}
+
+	decodedTexture._width = imageInfo._width;
+	decodedTexture._height = imageInfo._height;
+	decodedTexture._rowPitch = (imageInfo._width * 4 + TEXTURE_ROW_PITCH_ALIGNMENT - 1) & ~(TEXTURE_ROW_PITCH_ALIGNMENT - 1);
+	decodedTexture._format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	decodedTexture._pixels.resize(static_cast<size_t>(decodedTexture._rowPitch) * imageInfo._height);
+
+	// The GPU generated mips add a level of every size down to 1x1
+	for (auto width = imageInfo._width, height = imageInfo._height; ; width = (std::max)(1U, width / 2), height = (std::max)(1U, height / 2))
+	{
+		decodedTexture._memorySize += width * height * 4;
+		if (width == 1 && height == 1)
+		{
+			break;
+		}
+	}
+
+	// Decoded straight out of the file view into the buffer the GPU texture is created from
+	return png_reader::DecodeRGBA(textureFile.GetData(), textureFile.GetSize(), &decodedTexture._pixels[0], decodedTexture._rowPitch);
+}
+
+comptr<ID3D11ShaderResourceView> TextureLoader::CreateTexture(const DecodedTexture& decodedTexture, comptr<ID3D11Device> device) const
+{
+	comptr<ID3D11ShaderResourceView> textureView;
+
+	// Built textures carry their whole mip chain and never change
+	if (!decodedTexture._mipLevels.empty())
+	{
+		D3D11_TEXTURE2D_DESC td = {};
+		td.Width            = decodedTexture._width;
+		td.Height           = decodedTexture._height;
+		td.MipLevels        = static_cast<UINT>(decodedTexture._mipLevels.size());
+		td.ArraySize        = 1;
+		td.Format           = decodedTexture._format;
+		td.SampleDesc.Count = 1;
+		td.Usage            = D3D11_USAGE_IMMUTABLE;
+		td.BindFlags        = D3D11_BIND_SHADER_RESOURCE;
+
+		std::vector<D3D11_SUBRESOURCE_DATA> initialData(decodedTexture._mipLevels.size());
+		for (size_t level = 0; level < initialData.size(); ++level)
+		{
+			initialData[level].pSysMem     = &decodedTexture._pixels[decodedTexture._mipLevels[level]._offset];
+			initialData[level].SysMemPitch = decodedTexture._mipLevels[level]._rowPitch;
+		}
+
+		comptr<ID3D11Texture2D> texture;
+		HR(device->CreateTexture2D(&td, &initialData[0], texture.GetAddressOf()));
+		HR(device->CreateShaderResourceView(texture.Get(), 0, textureView.GetAddressOf()));
+		return textureView;
+	}
+
+	// Full mip chain, generated on the GPU, like D3DX produced for these files
+	D3D11_TEXTURE2D_DESC td = {};
+	td.Width            = decodedTexture._width;
+	td.Height           = decodedTexture._height;
+	td.MipLevels        = 0;
+	td.ArraySize        = 1;
+	td.Format           = DXGI_FORMAT_R8G8B8A8_UNORM;
+	td.SampleDesc.Count = 1;
+	td.Usage            = D3D11_USAGE_DEFAULT;
+	td.BindFlags        = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+	td.MiscFlags        = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+
+	comptr<ID3D11Texture2D> texture;
+	HR(device->CreateTexture2D(&td, 0, texture.GetAddressOf()));
+
+	HR(device->CreateShaderResourceView(texture.Get(), 0, textureView.GetAddressOf()));
+
+	comptr<ID3D11DeviceContext> deviceContext;
+	device->GetImmediateContext(deviceContext.GetAddressOf());
+	deviceContext->UpdateSubresource(texture.Get(), 0, 0, &decodedTexture._pixels[0], decodedTexture._rowPitch, 0);
+	deviceContext->GenerateMips(textureView.Get());
 
-	return loadedTexture;
+	return textureView;
 }
\ No newline at end of file
@@ -7,11 +7,43 @@
 
 // Local Headers
 #include "d3dcommon.h"
+#include "../util/textureatlas.h"
 
 // Remote Headers
+#include <condition_variable>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
+
+// Forward declarations
+class ThreadPool;
+
+// Texture that may still be loading. Resolves to the loader's 1x1 transparent placeholder 
+// until the texture has been decoded and created on the GPU, and to the real one from then on.
+class TextureHandle final
+{
+	friend class TextureLoader;
+
+public:
+	TextureHandle();
+
+	comptr<ID3D11ShaderResourceView> Get() const;
+	bool IsReady() const;
+
+private:
+	struct Slot
+	{
+		comptr<ID3D11ShaderResourceView> _view;
+		bool _ready;
+	};
+
+	TextureHandle(std::shared_ptr<Slot> slot);
+
+private:
+	std::shared_ptr<Slot> _slot;
+};
 
 class TextureLoader final
 {
@@ -20,15 +52,85 @@ public:
 
 	~TextureLoader();
 
-	comptr<ID3D11ShaderResourceView> LoadTexture(const std::string& texturePath, comptr<ID3D11Device> device);
+	// Returns at once; reading and decoding the file happen on the loader's worker threads. 
+	// Like the rest of the loader, only to be called from the main thread.
+	TextureHandle LoadTexture(const std::string& texturePath, comptr<ID3D11Device> device);
+
+	// Starts reading and decoding the texture before there is a device to create it with.
+	// A later LoadTexture of the same path returns the handle this load resolves.
+	void PreloadTexture(const std::string& texturePath);
+
+	// Creates the GPU textures of all decodes finished so far in one batch and resolves their handles. Called once per frame.
+	void CreateDecodedTextures(comptr<ID3D11Device> device);
+
+	// Blocks until every requested texture has been decoded and created
+	void WaitForPendingTextures(comptr<ID3D11Device> device);
+
+	UINT GetPendingTextureCount() const;
+
+	// Every texture requested so far, in request order, and how long reading one took (zero until it has been created)
+	const std::vector<std::string>& GetRequestedTexturePaths() const;
+	FLOAT GetLoadMilliseconds(const std::string& texturePath) const;
+
+	// When enabled (the default), textures built offline next to their PNGs (see texture_builder) are loaded 
+	// in place of the PNGs. Must be set before the first load.
+	void SetCompressedTexturesEnabled(const bool compressedTexturesEnabled);
+
+	// Where the texture was packed by texture_atlas::BuildAtlases according to the layout file at layoutPath, which is read 
+	// on its first lookup. Null when the texture is not in an atlas, or when compressed textures (and so atlases) are disabled.
+	const texture_atlas::AtlasRegion* FindAtlasRegion(const std::string& layoutPath, const std::string& texturePath);
 		
+private:
+	struct MipLevel
+	{
+		UINT _offset;
+		UINT _rowPitch;
+	};
+
+	// Texture read by a worker, handed to the main thread. Either the RGBA8 pixels of a decoded PNG, rows 
+	// _rowPitch bytes apart, or a built texture file whose _mipLevels locate each level within _pixels.
+	struct DecodedTexture
+	{
+		std::shared_ptr<TextureHandle::Slot> _slot;
+		std::string _path;
+		UINT _width;
+		UINT _height;
+		UINT _rowPitch;
+		DXGI_FORMAT _format;
+		std::vector<MipLevel> _mipLevels;
+		std::vector<BYTE> _pixels;
+		UINT _memorySize;
+		FLOAT _loadMilliseconds;
+		bool _succeeded;
+	};
+
 private:
 	TextureLoader();
 	
 	TextureLoader(const TextureLoader& rhs) = delete;
 	TextureLoader& operator = (const TextureLoader& rhs) = delete;
 
+	TextureHandle RequestTexture(const std::string& texturePath);
+	void DecodeTexture(std::shared_ptr<TextureHandle::Slot> slot, const std::string& texturePath);
+
+	// Fails when the texture's source PNG is on disk and has changed since the texture was built from it
+	bool ReadBuiltTexture(const std::string& texturePath, DecodedTexture& decodedTexture) const;
+	bool ReadPngTexture(const std::string& texturePath, DecodedTexture& decodedTexture) const;
+	comptr<ID3D11ShaderResourceView> CreateTexture(const DecodedTexture& decodedTexture, comptr<ID3D11Device> device) const;
+
 private:
-	std::unordered_map<std::string, comptr<ID3D11ShaderResourceView>> _textures;
+	std::unordered_map<std::string, TextureHandle> _textures;
+	std::vector<std::string> _requestedTexturePaths;
+	std::unordered_map<std::string, FLOAT> _loadMilliseconds;
+	std::unordered_map<std::string, texture_atlas::AtlasLayout> _atlasLayouts;
+	comptr<ID3D11ShaderResourceView> _placeholder;
+	UINT _pendingTextureCount;
+	bool _compressedTexturesEnabled;
+
+	std::vector<DecodedTexture> _decodedTextures;
+	std::mutex _decodedTexturesMutex;
+	std::condition_variable _textureDecoded;
 
+	// Last, so that the workers are joined before anything they use is destroyed
+	std::unique_ptr<ThreadPool> _threadPool;
 };
\ No newline at end of file
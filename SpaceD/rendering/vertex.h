@@ -22,4 +22,26 @@ struct Vertex
 		, _normal(normal)
 	{
 	}
+};
+
+// 20 byte alternative to Vertex: half float texcoords and an octahedral encoded normal in two 16 bit snorms
+struct PackedVertex
+{
+	XMFLOAT3 _pos;
+	HALF _tex[2];
+	SHORT _normal[2];
+};
+
+struct TextVertex
+{
+	XMFLOAT3 _pos;
+	XMFLOAT2 _tex;
+	XMFLOAT4 _color;
+
+	TextVertex(const XMFLOAT3 pos, const XMFLOAT2 tex, const XMFLOAT4 color)
+		: _pos(pos)
+		, _tex(tex)
+		, _color(color)
+	{
+	}
 };
\ No newline at end of file
@@ -0,0 +1,150 @@
+/**********************************************************************/
+/** vertexpacking.cpp by Alex Koukoulas (C) 2017 All Rights Reserved **/
+/** File Description:                                                **/
+/**********************************************************************/
+
+// Local Headers
+#include "vertexpacking.h"
+
+// Remote Headers
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+	static const FLOAT SNORM16_MAX = 32767.0f;
+	static const FLOAT MIN_NORMAL_LENGTH_SQUARED = 1e-12f;
+
+	// Normalising these would divide by (next to) zero or spread a NaN
+	bool IsDegenerateNormal(const XMFLOAT3& normal)
+	{
+		const auto lengthSquared = normal.x * normal.x + normal.y * normal.y + normal.z * normal.z;
+		return !(lengthSquared > MIN_NORMAL_LENGTH_SQUARED) || !std::isfinite(lengthSquared);
+	}
+
+	FLOAT SignNotZero(const FLOAT value)
+	{
+		return value >= 0.0f ? 1.0f : -1.0f;
+	}
+
+	SHORT FloatToSnorm16(const FLOAT value)
+	{
+		const auto clamped = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+		return static_cast<SHORT>(std::floor(clamped * SNORM16_MAX + 0.5f));
+	}
+
+	// Same conversion the input assembler applies to DXGI_FORMAT_R16G16_SNORM
+	FLOAT Snorm16ToFloat(const SHORT value)
+	{
+		const auto result = value / SNORM16_MAX;
+		return result < -1.0f ? -1.0f : result;
+	}
+
+	// Projects the unit normal onto the octahedron |x| + |y| + |z| = 1 and unfolds the lower hemisphere over the upper one
+	XMFLOAT2 OctEncode(const XMFLOAT3& normal)
+	{
+		const auto invL1Norm = 1.0f / (std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z));
+		auto x = normal.x * invL1Norm;
+		auto y = normal.y * invL1Norm;
+
+		if (normal.z < 0.0f)
+		{
+			const auto foldedX = (1.0f - std::fabs(y)) * SignNotZero(x);
+			const auto foldedY = (1.0f - std::fabs(x)) * SignNotZero(y);
+			x = foldedX;
+			y = foldedY;
+		}
+
+		return XMFLOAT2(x, y);
+	}
+
+	// Mirrors OctDecode in octdecode.hlsli, which the PACKED_VERTEX shader variants include
+	XMFLOAT3 OctDecode(const XMFLOAT2& encoded)
+	{
+		auto x = encoded.x;
+		auto y = encoded.y;
+		const auto z = 1.0f - std::fabs(x) - std::fabs(y);
+
+		if (z < 0.0f)
+		{
+			const auto unfoldedX = (1.0f - std::fabs(y)) * SignNotZero(x);
+			const auto unfoldedY = (1.0f - std::fabs(x)) * SignNotZero(y);
+			x = unfoldedX;
+			y = unfoldedY;
+		}
+
+		const auto invLength = 1.0f / std::sqrt(x * x + y * y + z * z);
+		return XMFLOAT3(x * invLength, y * invLength, z * invLength);
+	}
+
+	// atan2 of the cross and dot products stays accurate for the tiny angles quantisation produces, unlike acos
+	FLOAT AngleBetween(const XMFLOAT3& a, const XMFLOAT3& b)
+	{
+		const auto crossX = a.y * b.z - a.z * b.y;
+		const auto crossY = a.z * b.x - a.x * b.z;
+		const auto crossZ = a.x * b.y - a.y * b.x;
+		const auto dot = a.x * b.x + a.y * b.y + a.z * b.z;
+
+		return std::atan2(std::sqrt(crossX * crossX + crossY * crossY + crossZ * crossZ), dot);
+	}
+}
+
+PackedVertex vertex_packing::Pack(const Vertex& vertex)
+{
+	PackedVertex packedVertex;
+	packedVertex._pos = vertex._pos;
+	packedVertex._tex[0] = XMConvertFloatToHalf(vertex._tex.x);
+	packedVertex._tex[1] = XMConvertFloatToHalf(vertex._tex.y);
+
+	const auto& normal = vertex._normal;
+	if (IsDegenerateNormal(normal))
+	{
+		packedVertex._normal[0] = 0;
+		packedVertex._normal[1] = 0;
+	}
+	else
+	{
+		const auto encodedNormal = OctEncode(normal);
+		packedVertex._normal[0] = FloatToSnorm16(encodedNormal.x);
+		packedVertex._normal[1] = FloatToSnorm16(encodedNormal.y);
+	}
+
+	return packedVertex;
+}
+
+Vertex vertex_packing::Unpack(const PackedVertex& packedVertex)
+{
+	const XMFLOAT2 tex(XMConvertHalfToFloat(packedVertex._tex[0]), XMConvertHalfToFloat(packedVertex._tex[1]));
+	const auto normal = OctDecode(XMFLOAT2(Snorm16ToFloat(packedVertex._normal[0]), Snorm16ToFloat(packedVertex._normal[1])));
+
+	return Vertex(packedVertex._pos, tex, normal);
+}
+
+vertex_packing::PackingError vertex_packing::PackVertices(const std::vector<Vertex>& vertices, std::vector<PackedVertex>& outPackedVertices)
+{
+	PackingError error;
+
+	outPackedVertices.clear();
+	outPackedVertices.reserve(vertices.size());
+
+	for (const auto& vertex: vertices)
+	{
+		outPackedVertices.push_back(Pack(vertex));
+
+		const auto roundTrip = Unpack(outPackedVertices.back());
+		assert(roundTrip._pos.x == vertex._pos.x && roundTrip._pos.y == vertex._pos.y && roundTrip._pos.z == vertex._pos.z);
+
+		const auto texcoordError = math::Max2f(std::fabs(roundTrip._tex.x - vertex._tex.x), std::fabs(roundTrip._tex.y - vertex._tex.y));
+		error._maxTexcoordError = math::Max2f(error._maxTexcoordError, texcoordError);
+
+		if (IsDegenerateNormal(vertex._normal))
+		{
+			error._degenerateNormalCount++;
+			continue;
+		}
+
+		error._maxNormalAngleError = math::Max2f(error._maxNormalAngleError, AngleBetween(roundTrip._normal, vertex._normal));
+	}
+
+	return error;
+}
\ No newline at end of file
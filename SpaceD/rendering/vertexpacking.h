@@ -0,0 +1,49 @@
+/********************************************************************/
+/** vertexpacking.h by Alex Koukoulas (C) 2017 All Rights Reserved **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "vertex.h"
+
+// Remote Headers
+#include <vector>
+
+namespace vertex_packing
+{
+	// A mesh is only packed if every vertex round trips within these bounds
+	static const FLOAT MAX_TEXCOORD_ERROR = 1.0f / 2048.0f;
+	static const FLOAT MAX_NORMAL_ANGLE_ERROR = 0.002f;
+
+	// Bumped whenever the packed layout or encoding changes, so that compiled meshes packed by an older version are rebuilt
+	static const UINT PACKING_VERSION = 2U;
+
+	struct PackingError
+	{
+		FLOAT _maxTexcoordError;
+		FLOAT _maxNormalAngleError;
+		UINT _degenerateNormalCount;  // Zero length or non finite normals, which have no direction to keep and so no error
+
+		PackingError()
+			: _maxTexcoordError(0.0f)
+			, _maxNormalAngleError(0.0f)
+			, _degenerateNormalCount(0)
+		{
+		}
+
+		bool IsWithinTolerance() const
+		{
+			return _maxTexcoordError <= MAX_TEXCOORD_ERROR && _maxNormalAngleError <= MAX_NORMAL_ANGLE_ERROR;
+		}
+	};
+
+	// A degenerate normal packs as +Z
+	PackedVertex Pack(const Vertex& vertex);
+	Vertex Unpack(const PackedVertex& packedVertex);
+
+	// Packs all vertices and measures the worst texcoord (absolute, per component) and normal (radians) round trip error,
+	// counting degenerate normals instead of measuring them
+	PackingError PackVertices(const std::vector<Vertex>& vertices, std::vector<PackedVertex>& outPackedVertices);
+}
\ No newline at end of file
@@ -19,6 +19,7 @@
 #include "rendering/shaders/defaultuishader.h"
 
 // Remote Headers
+#include <cassert>
 #include <unordered_map>
 
 const FLOAT Scene::CELL_SIZE = 15.0f;
@@ -55,16 +56,21 @@ void Scene::InsertEntity(std::shared_ptr<GameEntity> entity)
 	}
 
 	const auto cellCoords = GetCellCoords(*entity);
-	
-	_sceneGraph[cellCoords._row][cellCoords._col]._residents.push_back(entity);
+	auto& cell = _sceneGraph[cellCoords._row][cellCoords._col];
+
+	cell._residents.push_back(entity);
+	cell._bounds.Expand(entity->GetTranslation(), entity->GetModel().GetBoundingSphereRadius());
 }
 
 void Scene::InsertPointLight(std::shared_ptr<PointLight> pointLight)
 {
-	if (_pointLights.size() + 1 <= Default3dWithLightingShader::MAX_POINT_LIGHTS)
+	if (_pointLights.size() + 1 > ClusteredLightGrid::MAX_LIGHTS)
 	{
-		_pointLights.push_back(pointLight);
+		OutputDebugString(("Scene is at its point light limit, rejecting " + pointLight->GetBriefDescription() + "\n").c_str());
+		return;
 	}
+
+	_pointLights.push_back(pointLight);
 }
 
 void Scene::InsertDirectionalLight(std::shared_ptr<DirectionalLight> directionalLight)
@@ -338,6 +344,15 @@ void Scene::UpdateEntities(const FLOAT deltaTime)
 	}
 
 	residentsToBeAdded.clear();
+
+	// Residents have moved, spawned or left so rebuild every cell's bounds for this frame's culling
+	for (auto y = 0U; y < CELL_ROWS; ++y)
+	{
+		for (auto x = 0U; x < CELL_COLS; ++x)
+		{
+			UpdateCellBounds(_sceneGraph[y][x]);
+		}
+	}
 }
 
 void Scene::UpdateBackground(const FLOAT deltaTime)
@@ -345,10 +360,22 @@ void Scene::UpdateBackground(const FLOAT deltaTime)
 	_backgroundOffset.y -= 0.005f * deltaTime;
 }
 
+void Scene::UpdateCellBounds(Cell& cell)
+{
+	cell._bounds.Reset();
+
+	for (const auto& entity: cell._residents)
+	{
+		cell._bounds.Expand(entity->GetTranslation(), entity->GetModel().GetBoundingSphereRadius());
+	}
+}
+
 void Scene::DebugRenderScene()
 {
 	// Debug Scene Graph Rendering
 	_renderer.SetShader(Shader::ShaderType::DEFAULT_3D);
+
+	const auto viewProj = _camera.GetViewMatrix() * _camera.GetProjectionMatrix();
 	for (auto y = 0U; y < CELL_ROWS; ++y)
 	{
 		for (auto x = 0U; x < CELL_COLS; ++x)
@@ -369,7 +396,7 @@ void Scene::DebugRenderScene()
 			Default3dShader::ConstantBuffer cb;
 			cb.gWorld = _sceneCellModel->CalculateWorldMatrix();
 			cb.gWorldInvTranspose = math::InverseTranspose(cb.gWorld);
-			cb.gWorldViewProj = cb.gWorld * _camera.GetViewMatrix() * _camera.GetProjectionMatrix();
+			cb.gWorldViewProj = cb.gWorld * viewProj;
 
 			_renderer.RenderModel(*_sceneCellModel, &cb);
 		}
@@ -406,53 +433,111 @@ void Scene::RenderEntities()
 	_renderer.SetDepthStencilEnabled(true);
 	_renderer.SetShader(Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING);
 
-	// Accumulate Lights
-	Default3dWithLightingShader::ConstantBuffer cb = {};
+	// Accumulate Lights, eye position and view projection once per frame
+	Default3dWithLightingShader::PerFrameConstantBuffer perFrameCb = {};
 
 	const auto directionalLightCount = _directionalLights.size() > Default3dWithLightingShader::MAX_DIRECTIONAL_LIGHTS ? 
 		                               Default3dWithLightingShader::MAX_DIRECTIONAL_LIGHTS : _directionalLights.size();
 
-	const auto pointLightCount = _pointLights.size() > Default3dWithLightingShader::MAX_POINT_LIGHTS ? 
-		                         Default3dWithLightingShader::MAX_POINT_LIGHTS : _pointLights.size();
-
 	for (auto i = 0U; i < directionalLightCount; ++i)
 	{
-		cb.gDirectionalLights[cb.gDirectionalLightCount++] = *_directionalLights[i];
+		perFrameCb.gDirectionalLights[perFrameCb.gDirectionalLightCount++] = *_directionalLights[i];
 	}
 
-	for (auto i = 0U; i < pointLightCount; ++i)
-	{		
-		cb.gPointLights[cb.gPointLightCount++] = *_pointLights[i];
+	// Point lights are binned into the view space clusters of the light grid instead
+	_framePointLights.clear();
+	for (const auto& pointLight: _pointLights)
+	{
+		_framePointLights.push_back(*pointLight);
+	}
+
+	_lightGrid.Build(_framePointLights, _camera.GetViewMatrix(), _camera.GetProjectionMatrix(), _camera.GetZNear(), _camera.GetZFar());
+
+	perFrameCb.gEyePosW = _camera.GetPos();
+	perFrameCb.gViewProj = _camera.GetViewMatrix() * _camera.GetProjectionMatrix();
+	perFrameCb.gClusterScreenToTile = XMFLOAT2(static_cast<FLOAT>(ClusteredLightGrid::CLUSTER_COUNT_X) / _window.GetWidth(), 
+	                                           static_cast<FLOAT>(ClusteredLightGrid::CLUSTER_COUNT_Y) / _window.GetHeight());
+	perFrameCb.gClusterDepthScale = _lightGrid.GetDepthSliceScale();
+	perFrameCb.gClusterDepthBias = _lightGrid.GetDepthSliceBias();
+
+	_renderer.UpdatePerFrameConstants(Shader::ShaderType::DEFAULT_3D_WITH_LIGHTING, &perFrameCb);
+	_renderer.UpdateLightGrid(_lightGrid);
+
+	PrepareVisibleEntities();
+
+	// Render visible entities
+	Default3dWithLightingShader::ConstantBuffer cb = {};
+
+	for (const auto* entity: _visibleEntities)
+	{
+		const auto worldMatrix = entity->GetModel().CalculateWorldMatrix();
+
+		cb.gMaterial = entity->GetModel().GetMaterial();
+		cb.gWorld = worldMatrix;
+		cb.gWorldInvTranspose = math::InverseTranspose(worldMatrix);
+
+		_renderer.RenderModel(entity->GetModel(), &cb);
 	}
+}
+
+void Scene::PrepareVisibleEntities()
+{
+	// Cells are tested first so that their residents are accepted or rejected as a whole,
+	// and only the residents of cells straddling a frustum plane are culled individually
+	_visibleEntities.clear();
+	_cullCandidates.clear();
+	_cullSpheres.Clear();
+	_visibleIndices.clear();
+
+	const auto& frustum = _camera.GetFrustum();
 
-	// Render entities
 	for (auto y = 0U; y < CELL_ROWS; ++y)
 	{
 		for (auto x = 0U; x < CELL_COLS; ++x)
 		{
-			const auto residentCount = _sceneGraph[y][x]._residents.size();
-			for (auto i = 0U; i < residentCount; ++i)
-			{
-				const auto& entity = _sceneGraph[y][x]._residents[i];
-				const auto worldMatrix = entity->GetModel().CalculateWorldMatrix();
+			const auto& cell = _sceneGraph[y][x];
 
-				auto wvp = worldMatrix * _camera.GetViewMatrix() * _camera.GetProjectionMatrix();
+			switch (frustum_culler::TestAABB(frustum, cell._bounds))
+			{
+				case frustum_culler::ContainmentType::OUTSIDE: break;
 
-				cb.gEyePosW = _camera.GetPos();
-				cb.gMaterial = entity->GetModel().GetMaterial();
-				cb.gDirectionalLightCount = _directionalLights.size();
-				cb.gPointLightCount = _pointLights.size();
-				cb.gWorld = worldMatrix;
-				cb.gWorldInvTranspose = math::InverseTranspose(worldMatrix);
-				cb.gWorldViewProj = wvp;
+				case frustum_culler::ContainmentType::INSIDE:
+				{
+					for (const auto& entity: cell._residents)
+					{
+						_visibleEntities.push_back(entity.get());
+					}
+				} break;
 
-				if (_camera.isVisible(entity->GetModel()))
+				case frustum_culler::ContainmentType::INTERSECTS:
 				{
-					_renderer.RenderModel(entity->GetModel(), &cb);
-				}
+					for (const auto& entity: cell._residents)
+					{
+						_cullCandidates.push_back(entity.get());
+						_cullSpheres.Add(entity->GetTranslation(), entity->GetModel().GetBoundingSphereRadius());
+					}
+				} break;
 			}
 		}
 	}
+
+	frustum_culler::CullSpheres(frustum, _cullSpheres, _visibleIndices);
+
+#if defined(DEBUG) || defined(_DEBUG)
+	std::vector<UINT> referenceVisibleIndices;
+	frustum_culler::CullSpheresScalar(frustum, _cullSpheres, referenceVisibleIndices);
+	assert(referenceVisibleIndices == _visibleIndices);
+#endif
+
+	for (const auto visibleIndex: _visibleIndices)
+	{
+		_visibleEntities.push_back(_cullCandidates[visibleIndex]);
+	}
+}
+
+const std::vector<const GameEntity*>& Scene::GetVisibleEntities() const
+{
+	return _visibleEntities;
 }
 
 bool Scene::IsOutOfBounds(const GameEntity& entity) const
@@ -8,7 +8,10 @@
 // Local Headers
 #include "rendering/d3dcommon.h"
 #include "rendering/lightdef.h"
+#include "rendering/clusteredlightgrid.h"
+#include "rendering/textureloader.h"
 #include "util/math.h"
+#include "util/frustumculler.h"
 
 // Remote Headers
 #include <memory>
@@ -46,6 +49,10 @@ public:
 	void Update(const FLOAT deltaTime);
 	void Render();
 
+	// Frustum culls the residents against the camera's current frustum into the visible entity list Render draws
+	void PrepareVisibleEntities();
+	const std::vector<const GameEntity*>& GetVisibleEntities() const;
+
 private:
 	static const UINT CELL_ROWS = 6U;
 	static const UINT CELL_COLS = 6U;
@@ -69,6 +76,9 @@ private:
 		FLOAT _x;
 		FLOAT _z;
 
+		// Covers the bounding spheres of all residents
+		math::AABB _bounds;
+
 		std::vector<std::shared_ptr<GameEntity>> _residents;
 
 		Cell()
@@ -90,6 +100,7 @@ private:
 	void UpdateCamera(const FLOAT deltaTime);
 	void UpdateEntities(const FLOAT deltaTime);
 	void UpdateBackground(const FLOAT deltaTime);
+	void UpdateCellBounds(Cell& cell);
 
 	void DebugRenderScene();
 	void DebugRenderLights();
@@ -106,13 +117,19 @@ private:
 
 	Cell _sceneGraph[CELL_ROWS][CELL_COLS];
 	std::vector<std::shared_ptr<GameEntity>> _outOfBoundsObjects;
+	std::vector<const GameEntity*> _visibleEntities;
+	std::vector<const GameEntity*> _cullCandidates;
+	std::vector<UINT> _visibleIndices;
+	BoundingSpheres _cullSpheres;
 	std::vector<std::shared_ptr<PointLight>> _pointLights;
+	std::vector<PointLight> _framePointLights;
+	ClusteredLightGrid _lightGrid;
 	std::vector<std::shared_ptr<DirectionalLight>> _directionalLights;
 	std::unique_ptr<Model> _background;
 	std::unique_ptr<Model> _sceneCellModel;
 
-	comptr<ID3D11ShaderResourceView> _defaultCellTexture;
-	comptr<ID3D11ShaderResourceView> _activatedCellTexture;
+	TextureHandle _defaultCellTexture;
+	TextureHandle _activatedCellTexture;
 
 	XMFLOAT2 _backgroundOffset;
 };
\ No newline at end of file
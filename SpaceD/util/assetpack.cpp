@@ -0,0 +1,302 @@
+/********************************************************************/
+/** assetpack.cpp by Alex Koukoulas (C) 2017 All Rights Reserved   **/
+/** File Description:                                              **/
+/********************************************************************/
+
+// Local Headers
+#include "assetpack.h"
+
+// Remote Headers
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <Windows.h>
+
+namespace
+{
+	static const std::uint32_t PACK_MAGIC = 0x4B415053;  // "SPAK"
+	static const std::uint32_t PACK_VERSION = 2U;
+	static const std::uint64_t DATA_ALIGNMENT = 16U;
+
+	static const std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+	static const std::uint64_t FNV_PRIME = 1099511628211ULL;
+
+	static_assert(sizeof(asset_pack::PackHeader) == 48 && sizeof(asset_pack::PackEntry) == 48, "The pack format changed; bump PACK_VERSION");
+
+	struct PackedFile
+	{
+		std::string _relativePath;
+		std::string _entryName;
+		std::uint64_t _size;
+		source_stamp::Stamp _sourceStamp;
+	};
+
+	std::uint64_t AlignUp(const std::uint64_t value)
+	{
+		return (value + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+	}
+
+	// Lower cased with forward slashes, the way both the packer and lookups spell paths
+	std::string NormalizePath(const std::string& path)
+	{
+		std::string normalizedPath(path);
+		for (auto& c: normalizedPath)
+		{
+			c = c == '\\' ? '/' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+		}
+		return normalizedPath;
+	}
+
+	// Every file under rootDirectory + relativeDirectory, recursively, by its path relative to rootDirectory
+	void FindFiles(const std::string& rootDirectory, const std::string& relativeDirectory, std::vector<std::string>& outRelativePaths)
+	{
+		WIN32_FIND_DATA findData;
+		auto findHandle = FindFirstFile((rootDirectory + relativeDirectory + "*").c_str(), &findData);
+		if (findHandle == INVALID_HANDLE_VALUE)
+		{
+			return;
+		}
+
+		do
+		{
+			const std::string fileName = findData.cFileName;
+			if (fileName == "." || fileName == "..")
+			{
+				continue;
+			}
+
+			if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			{
+				FindFiles(rootDirectory, relativeDirectory + fileName + "/", outRelativePaths);
+			}
+			else
+			{
+				outRelativePaths.push_back(relativeDirectory + fileName);
+			}
+		} while (FindNextFile(findHandle, &findData));
+		FindClose(findHandle);
+	}
+}
+
+std::string asset_pack::GetEntryName(const std::string& rootDirectory, const std::string& path)
+{
+	auto normalizedRoot = NormalizePath(rootDirectory);
+	if (!normalizedRoot.empty() && normalizedRoot.back() != '/')
+	{
+		normalizedRoot += '/';
+	}
+
+	const auto normalizedPath = NormalizePath(path);
+	if (normalizedPath.size() <= normalizedRoot.size() || normalizedPath.compare(0, normalizedRoot.size(), normalizedRoot) != 0)
+	{
+		return std::string();
+	}
+
+	return normalizedPath.substr(normalizedRoot.size());
+}
+
+std::uint64_t asset_pack::HashEntryName(const std::string& entryName)
+{
+	auto hash = FNV_OFFSET_BASIS;
+	for (const auto c: entryName)
+	{
+		hash = (hash ^ static_cast<unsigned char>(c)) * FNV_PRIME;
+	}
+	return hash;
+}
+
+const asset_pack::PackEntry* asset_pack::FindEntry(const std::uint8_t* packData, const std::string& entryName)
+{
+	if (entryName.empty())
+	{
+		return nullptr;
+	}
+
+	const auto& header = *reinterpret_cast<const PackHeader*>(packData);
+	const auto* entries = reinterpret_cast<const PackEntry*>(packData + header._tableOffset);
+	const auto* names = reinterpret_cast<const char*>(packData + header._namesOffset);
+
+	// The table is never more than half full, so probing always ends on an empty slot
+	const auto nameHash = HashEntryName(entryName);
+	const auto slotMask = header._tableCapacity - 1;
+	for (auto slot = static_cast<std::uint32_t>(nameHash) & slotMask; ; slot = (slot + 1) & slotMask)
+	{
+		const auto& entry = entries[slot];
+		if (entry._nameLength == 0)
+		{
+			return nullptr;
+		}
+
+		if (entry._nameHash == nameHash && entry._nameLength == entryName.size() && std::memcmp(names + entry._nameOffset, entryName.data(), entryName.size()) == 0)
+		{
+			return &entry;
+		}
+	}
+}
+
+bool asset_pack::ValidatePack(const std::uint8_t* packData, const size_t packSize)
+{
+	if (packSize < sizeof(PackHeader))
+	{
+		return false;
+	}
+
+	const auto& header = *reinterpret_cast<const PackHeader*>(packData);
+	if (header._magic != PACK_MAGIC || header._version != PACK_VERSION || header._fileSize != packSize || 
+		header._tableCapacity == 0 || (header._tableCapacity & (header._tableCapacity - 1)) != 0 || header._entryCount * 2ULL > header._tableCapacity ||
+		header._tableOffset % alignof(PackEntry) != 0 || header._tableOffset + header._tableCapacity * static_cast<std::uint64_t>(sizeof(PackEntry)) > header._namesOffset ||
+		header._namesOffset + header._namesSize > header._fileSize)
+	{
+		return false;
+	}
+
+	const auto* entries = reinterpret_cast<const PackEntry*>(packData + header._tableOffset);
+	for (auto slot = 0U; slot < header._tableCapacity; ++slot)
+	{
+		const auto& entry = entries[slot];
+		if (entry._nameLength != 0 && 
+			(static_cast<std::uint64_t>(entry._nameOffset) + entry._nameLength > header._namesSize || entry._dataOffset + entry._dataSize > header._fileSize))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool asset_pack::Build(const std::string& rootDirectory, const std::vector<std::string>& excludedPrefixes, const std::string& packPath, std::string& outReport)
+{
+	auto sourceDirectory = rootDirectory;
+	if (!sourceDirectory.empty() && sourceDirectory.back() != '/' && sourceDirectory.back() != '\\')
+	{
+		sourceDirectory += '/';
+	}
+
+	std::vector<std::string> relativePaths;
+	FindFiles(sourceDirectory, "", relativePaths);
+
+	std::vector<PackedFile> packedFiles;
+	for (const auto& relativePath: relativePaths)
+	{
+		const auto entryName = NormalizePath(relativePath);
+		const auto excluded = std::any_of(excludedPrefixes.begin(), excludedPrefixes.end(), [&](const std::string& excludedPrefix)
+		{
+			const auto normalizedPrefix = NormalizePath(excludedPrefix);
+			return entryName.compare(0, normalizedPrefix.size(), normalizedPrefix) == 0;
+		});
+
+		if (excluded)
+		{
+			continue;
+		}
+
+		source_stamp::Stamp sourceStamp;
+		std::ifstream sourceStream(sourceDirectory + relativePath, std::ios::binary | std::ios::ate);
+		if (!sourceStream.is_open() || !source_stamp::GetStamp(sourceDirectory + relativePath, sourceStamp))
+		{
+			outReport = sourceDirectory + relativePath + ": could not be read";
+			return false;
+		}
+
+		packedFiles.push_back({ relativePath, entryName, static_cast<std::uint64_t>(sourceStream.tellg()), sourceStamp });
+	}
+
+	// Sorted, so that packing the same files twice gives the same pack
+	std::sort(packedFiles.begin(), packedFiles.end(), [](const PackedFile& lhs, const PackedFile& rhs) { return lhs._entryName < rhs._entryName; });
+
+	PackHeader header = {};
+	header._magic = PACK_MAGIC;
+	header._version = PACK_VERSION;
+	header._entryCount = static_cast<std::uint32_t>(packedFiles.size());
+	header._tableCapacity = 1U;
+	while (header._tableCapacity < header._entryCount * 2U)
+	{
+		header._tableCapacity *= 2U;
+	}
+
+	std::string names;
+	std::vector<PackEntry> entries(header._tableCapacity, PackEntry());
+	std::vector<std::uint64_t> dataOffsets;
+
+	header._tableOffset = sizeof(PackHeader);
+	header._namesOffset = header._tableOffset + sizeof(PackEntry) * entries.size();
+	for (const auto& packedFile: packedFiles)
+	{
+		names += packedFile._entryName;
+	}
+	header._namesSize = names.size();
+
+	auto dataOffset = header._namesOffset + header._namesSize;
+	auto nameOffset = 0U;
+	for (const auto& packedFile: packedFiles)
+	{
+		dataOffset = AlignUp(dataOffset);
+		dataOffsets.push_back(dataOffset);
+
+		PackEntry entry;
+		entry._nameHash = HashEntryName(packedFile._entryName);
+		entry._nameOffset = nameOffset;
+		entry._nameLength = static_cast<std::uint32_t>(packedFile._entryName.size());
+		entry._dataOffset = dataOffset;
+		entry._dataSize = packedFile._size;
+		entry._sourceStamp = packedFile._sourceStamp;
+
+		auto slot = static_cast<std::uint32_t>(entry._nameHash) & (header._tableCapacity - 1);
+		while (entries[slot]._nameLength != 0)
+		{
+			slot = (slot + 1) & (header._tableCapacity - 1);
+		}
+		entries[slot] = entry;
+
+		nameOffset += entry._nameLength;
+		dataOffset += packedFile._size;
+	}
+	header._fileSize = dataOffset;
+
+	std::ofstream packStream(packPath, std::ios::binary);
+	if (!packStream.is_open())
+	{
+		outReport = packPath + ": could not be written";
+		return false;
+	}
+
+	packStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	packStream.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(sizeof(PackEntry) * entries.size()));
+	packStream.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+	static const char ZERO_PADDING[DATA_ALIGNMENT] = {};
+	auto paddingBytes = 0ULL;
+	for (auto i = 0U; i < packedFiles.size(); ++i)
+	{
+		const auto position = static_cast<std::uint64_t>(packStream.tellp());
+		packStream.write(ZERO_PADDING, static_cast<std::streamsize>(dataOffsets[i] - position));
+		paddingBytes += dataOffsets[i] - position;
+
+		std::ifstream sourceStream(sourceDirectory + packedFiles[i]._relativePath, std::ios::binary);
+		if (packedFiles[i]._size > 0)
+		{
+			packStream << sourceStream.rdbuf();
+		}
+
+		// A source changing size while being packed would shift everything after it
+		if (static_cast<std::uint64_t>(packStream.tellp()) != dataOffsets[i] + packedFiles[i]._size)
+		{
+			outReport = sourceDirectory + packedFiles[i]._relativePath + ": changed while being packed";
+			return false;
+		}
+	}
+
+	if (!packStream.good())
+	{
+		outReport = packPath + ": could not be written";
+		return false;
+	}
+
+	std::stringstream reportStream;
+	reportStream << packPath << ": " << header._entryCount << " files from " << sourceDirectory << ", " << header._fileSize / 1024 << "KB (" 
+	             << paddingBytes << " bytes of alignment padding), table of " << header._tableCapacity << " slots";
+	outReport = reportStream.str();
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+/********************************************************************/
+/** assetpack.h by Alex Koukoulas (C) 2017 All Rights Reserved     **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "sourcestamp.h"
+
+// Remote Headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Every asset under a root directory bundled into one file: a header, an open addressed hash table of 
+// contents, the entry names, and then the file contents themselves, each starting on a 16 byte boundary 
+// so that the alignment formats like the compiled meshes rely on survives packing. Entries are named by 
+// their path relative to the root, lower cased and with forward slashes.
+namespace asset_pack
+{
+	struct PackHeader
+	{
+		std::uint32_t _magic;
+		std::uint32_t _version;
+		std::uint32_t _entryCount;
+		std::uint32_t _tableCapacity;  // Power of two
+		std::uint64_t _tableOffset;
+		std::uint64_t _namesOffset;
+		std::uint64_t _namesSize;
+		std::uint64_t _fileSize;
+	};
+
+	// A slot whose _nameLength is zero is empty. _sourceStamp is the stamp the loose file had when it was packed.
+	struct PackEntry
+	{
+		std::uint64_t _nameHash;
+		std::uint32_t _nameOffset;
+		std::uint32_t _nameLength;
+		std::uint64_t _dataOffset;
+		std::uint64_t _dataSize;
+		source_stamp::Stamp _sourceStamp;
+	};
+
+	// Entry name of a path under rootDirectory, or an empty string when the path lies outside of it
+	std::string GetEntryName(const std::string& rootDirectory, const std::string& path);
+
+	std::uint64_t HashEntryName(const std::string& entryName);
+
+	// The entry with the given name in the pack mapped at packData, or null when there is none. 
+	// The pack must have passed ValidatePack.
+	const PackEntry* FindEntry(const std::uint8_t* packData, const std::string& entryName);
+
+	// Whether the bytes look like a complete pack of this version, with every entry inside the file
+	bool ValidatePack(const std::uint8_t* packData, const size_t packSize);
+
+	// Packs every file under rootDirectory, except those whose entry names start with one of excludedPrefixes, into packPath
+	bool Build(const std::string& rootDirectory, const std::vector<std::string>& excludedPrefixes, const std::string& packPath, std::string& outReport);
+}
\ No newline at end of file
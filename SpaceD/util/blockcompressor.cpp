@@ -0,0 +1,675 @@
+/*************************************************************************/
+/** blockcompressor.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                   **/
+/*************************************************************************/
+
+// Local Headers
+#include "blockcompressor.h"
+
+// Remote Headers
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+	static const std::uint32_t BLOCK_TEXEL_COUNT = 16U;
+	static const std::uint32_t POWER_ITERATION_COUNT = 8U;
+
+	// BC7 interpolation weights for 2 and 4 bit indices, out of 64
+	static const std::uint32_t BC7_WEIGHTS_2[] = { 0, 21, 43, 64 };
+	static const std::uint32_t BC7_WEIGHTS_4[] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	typedef std::uint8_t Block[BLOCK_TEXEL_COUNT * 4];
+
+	template<std::uint32_t CHANNELS>
+	std::uint32_t SquaredDistance(const std::uint8_t* a, const float* b)
+	{
+		auto distance = 0.0f;
+		for (auto channel = 0U; channel < CHANNELS; ++channel)
+		{
+			const auto difference = a[channel] - b[channel];
+			distance += difference * difference;
+		}
+		return static_cast<std::uint32_t>(distance + 0.5f);
+	}
+
+	// Finds the line through the block's texels that best fits them: the mean and principal axis of their 
+	// covariance, by power iteration. Projecting the texels onto it gives the endpoints' extents.
+	template<std::uint32_t CHANNELS>
+	void FitLine(const Block& block, float* outStart, float* outEnd)
+	{
+		float mean[CHANNELS] = {};
+		for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			for (auto channel = 0U; channel < CHANNELS; ++channel)
+			{
+				mean[channel] += block[i * 4 + channel];
+			}
+		}
+		for (auto channel = 0U; channel < CHANNELS; ++channel)
+		{
+			mean[channel] /= BLOCK_TEXEL_COUNT;
+		}
+
+		float covariance[CHANNELS][CHANNELS] = {};
+		for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			for (auto row = 0U; row < CHANNELS; ++row)
+			{
+				for (auto column = 0U; column < CHANNELS; ++column)
+				{
+					covariance[row][column] += (block[i * 4 + row] - mean[row]) * (block[i * 4 + column] - mean[column]);
+				}
+			}
+		}
+
+		float axis[CHANNELS];
+		for (auto channel = 0U; channel < CHANNELS; ++channel)
+		{
+			axis[channel] = 1.0f;
+		}
+
+		for (auto iteration = 0U; iteration < POWER_ITERATION_COUNT; ++iteration)
+		{
+			float next[CHANNELS] = {};
+			auto length = 0.0f;
+			for (auto row = 0U; row < CHANNELS; ++row)
+			{
+				for (auto column = 0U; column < CHANNELS; ++column)
+				{
+					next[row] += covariance[row][column] * axis[column];
+				}
+				length = (std::max)(length, std::fabs(next[row]));
+			}
+
+			// Flat blocks have no principal axis, any direction works
+			if (length < 1e-6f)
+			{
+				break;
+			}
+
+			for (auto channel = 0U; channel < CHANNELS; ++channel)
+			{
+				axis[channel] = next[channel] / length;
+			}
+		}
+
+		auto axisLengthSquared = 0.0f;
+		for (auto channel = 0U; channel < CHANNELS; ++channel)
+		{
+			axisLengthSquared += axis[channel] * axis[channel];
+		}
+
+		auto minProjection = 0.0f;
+		auto maxProjection = 0.0f;
+		for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			auto projection = 0.0f;
+			for (auto channel = 0U; channel < CHANNELS; ++channel)
+			{
+				projection += (block[i * 4 + channel] - mean[channel]) * axis[channel];
+			}
+			projection /= axisLengthSquared;
+
+			minProjection = (std::min)(minProjection, projection);
+			maxProjection = (std::max)(maxProjection, projection);
+		}
+
+		for (auto channel = 0U; channel < CHANNELS; ++channel)
+		{
+			outStart[channel] = (std::min)((std::max)(mean[channel] + axis[channel] * minProjection, 0.0f), 255.0f);
+			outEnd[channel] = (std::min)((std::max)(mean[channel] + axis[channel] * maxProjection, 0.0f), 255.0f);
+		}
+	}
+
+	// Solves for the endpoints that minimize the error of the texels given their interpolation weights
+	template<std::uint32_t CHANNELS>
+	bool RefineEndpoints(const Block& block, const float* weights, float* outStart, float* outEnd)
+	{
+		auto aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		float ax[CHANNELS] = {}, bx[CHANNELS] = {};
+		for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			const auto b = weights[i];
+			const auto a = 1.0f - b;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for (auto channel = 0U; channel < CHANNELS; ++channel)
+			{
+				ax[channel] += a * block[i * 4 + channel];
+				bx[channel] += b * block[i * 4 + channel];
+			}
+		}
+
+		const auto determinant = aa * bb - ab * ab;
+		if (std::fabs(determinant) < 1e-6f)
+		{
+			return false;
+		}
+
+		for (auto channel = 0U; channel < CHANNELS; ++channel)
+		{
+			outStart[channel] = (std::min)((std::max)((ax[channel] * bb - bx[channel] * ab) / determinant, 0.0f), 255.0f);
+			outEnd[channel] = (std::min)((std::max)((bx[channel] * aa - ax[channel] * ab) / determinant, 0.0f), 255.0f);
+		}
+		return true;
+	}
+
+	std::uint16_t QuantizeRgb565(const float* color)
+	{
+		const auto r = static_cast<std::uint32_t>(color[0] * 31.0f / 255.0f + 0.5f);
+		const auto g = static_cast<std::uint32_t>(color[1] * 63.0f / 255.0f + 0.5f);
+		const auto b = static_cast<std::uint32_t>(color[2] * 31.0f / 255.0f + 0.5f);
+		return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	void ExpandRgb565(const std::uint16_t color, float* outColor)
+	{
+		const auto r = (color >> 11) & 31;
+		const auto g = (color >> 5) & 63;
+		const auto b = color & 31;
+		outColor[0] = static_cast<float>((r << 3) | (r >> 2));
+		outColor[1] = static_cast<float>((g << 2) | (g >> 4));
+		outColor[2] = static_cast<float>((b << 3) | (b >> 2));
+	}
+
+	// Picks the nearest of the four palette colours for every texel, returning the total error
+	std::uint32_t SelectColorIndices(const Block& block, const std::uint16_t color0, const std::uint16_t color1, std::uint32_t& outIndices)
+	{
+		float palette[4][3];
+		ExpandRgb565(color0, palette[0]);
+		ExpandRgb565(color1, palette[1]);
+		for (auto channel = 0U; channel < 3; ++channel)
+		{
+			palette[2][channel] = (2.0f * palette[0][channel] + palette[1][channel]) / 3.0f;
+			palette[3][channel] = (palette[0][channel] + 2.0f * palette[1][channel]) / 3.0f;
+		}
+
+		auto totalError = 0U;
+		outIndices = 0;
+		for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			auto bestIndex = 0U;
+			auto bestError = SquaredDistance<3>(&block[i * 4], palette[0]);
+			for (auto index = 1U; index < 4; ++index)
+			{
+				const auto error = SquaredDistance<3>(&block[i * 4], palette[index]);
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = index;
+				}
+			}
+
+			outIndices |= bestIndex << (i * 2);
+			totalError += bestError;
+		}
+
+		return totalError;
+	}
+
+	// BC1 colour block, always in four colour mode so it can also serve as the colour half of BC3
+	void EncodeColorBlock(const Block& block, std::uint8_t* outBlock)
+	{
+		float start[3], end[3];
+		FitLine<3>(block, start, end);
+
+		auto color0 = QuantizeRgb565(end);
+		auto color1 = QuantizeRgb565(start);
+		auto indices = 0U;
+		auto error = SelectColorIndices(block, color0, color1, indices);
+
+		// One least squares pass over the chosen indices, kept only when it helps
+		static const float INDEX_WEIGHTS[] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+		float weights[BLOCK_TEXEL_COUNT];
+		for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			weights[i] = INDEX_WEIGHTS[(indices >> (i * 2)) & 3];
+		}
+
+		float refinedStart[3], refinedEnd[3];
+		if (RefineEndpoints<3>(block, weights, refinedStart, refinedEnd))
+		{
+			const auto refinedColor0 = QuantizeRgb565(refinedStart);
+			const auto refinedColor1 = QuantizeRgb565(refinedEnd);
+			auto refinedIndices = 0U;
+			const auto refinedError = SelectColorIndices(block, refinedColor0, refinedColor1, refinedIndices);
+			if (refinedError < error)
+			{
+				color0 = refinedColor0;
+				color1 = refinedColor1;
+				indices = refinedIndices;
+				error = refinedError;
+			}
+		}
+
+		// Four colour mode needs color0 > color1; swapping the endpoints swaps indices 0/1 and 2/3
+		if (color0 < color1)
+		{
+			std::swap(color0, color1);
+			indices ^= 0x55555555U;
+		}
+		else if (color0 == color1)
+		{
+			indices = 0;
+		}
+
+		outBlock[0] = static_cast<std::uint8_t>(color0);
+		outBlock[1] = static_cast<std::uint8_t>(color0 >> 8);
+		outBlock[2] = static_cast<std::uint8_t>(color1);
+		outBlock[3] = static_cast<std::uint8_t>(color1 >> 8);
+		std::memcpy(outBlock + 4, &indices, 4);
+	}
+
+	// BC3 alpha block: the extremes as endpoints with six values interpolated between them
+	void EncodeAlphaBlock(const Block& block, std::uint8_t* outBlock)
+	{
+		auto alpha0 = 0U;
+		auto alpha1 = 255U;
+		for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			alpha0 = (std::max)(alpha0, static_cast<std::uint32_t>(block[i * 4 + 3]));
+			alpha1 = (std::min)(alpha1, static_cast<std::uint32_t>(block[i * 4 + 3]));
+		}
+
+		std::uint64_t indices = 0;
+		if (alpha0 != alpha1)
+		{
+			std::uint32_t palette[8] = { alpha0, alpha1 };
+			for (auto index = 2U; index < 8; ++index)
+			{
+				palette[index] = ((8 - index) * alpha0 + (index - 1) * alpha1) / 7;
+			}
+
+			for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+			{
+				const auto alpha = static_cast<int>(block[i * 4 + 3]);
+				auto bestIndex = 0U;
+				auto bestError = 256;
+				for (auto index = 0U; index < 8; ++index)
+				{
+					const auto error = std::abs(alpha - static_cast<int>(palette[index]));
+					if (error < bestError)
+					{
+						bestError = error;
+						bestIndex = index;
+					}
+				}
+				indices |= static_cast<std::uint64_t>(bestIndex) << (i * 3);
+			}
+		}
+
+		outBlock[0] = static_cast<std::uint8_t>(alpha0);
+		outBlock[1] = static_cast<std::uint8_t>(alpha1);
+		for (auto i = 0U; i < 6; ++i)
+		{
+			outBlock[2 + i] = static_cast<std::uint8_t>(indices >> (i * 8));
+		}
+	}
+
+	struct Bc7Endpoints
+	{
+		std::uint32_t _values[2][4];  // 7 bit endpoint channels
+		std::uint32_t _pBits[2];
+	};
+
+	// Quantizes an endpoint to 7 bits per channel plus the shared lowest bit, trying both values of the latter
+	void QuantizeBc7Endpoint(const float* endpoint, std::uint32_t* outValues, std::uint32_t& outPBit)
+	{
+		auto bestError = -1.0f;
+		for (auto pBit = 0U; pBit < 2; ++pBit)
+		{
+			std::uint32_t values[4];
+			auto error = 0.0f;
+			for (auto channel = 0U; channel < 4; ++channel)
+			{
+				const auto value = static_cast<int>((endpoint[channel] - pBit) / 2.0f + 0.5f);
+				values[channel] = static_cast<std::uint32_t>((std::min)((std::max)(value, 0), 127));
+
+				const auto difference = endpoint[channel] - static_cast<float>((values[channel] << 1) | pBit);
+				error += difference * difference;
+			}
+
+			if (bestError < 0.0f || error < bestError)
+			{
+				bestError = error;
+				outPBit = pBit;
+				std::memcpy(outValues, values, sizeof(values));
+			}
+		}
+	}
+
+	std::uint32_t SelectBc7Indices(const Block& block, const Bc7Endpoints& endpoints, std::uint8_t* outIndices)
+	{
+		float palette[16][4];
+		for (auto index = 0U; index < 16; ++index)
+		{
+			for (auto channel = 0U; channel < 4; ++channel)
+			{
+				const auto value0 = (endpoints._values[0][channel] << 1) | endpoints._pBits[0];
+				const auto value1 = (endpoints._values[1][channel] << 1) | endpoints._pBits[1];
+				palette[index][channel] = static_cast<float>(((64 - BC7_WEIGHTS_4[index]) * value0 + BC7_WEIGHTS_4[index] * value1 + 32) >> 6);
+			}
+		}
+
+		auto totalError = 0U;
+		for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			auto bestIndex = 0U;
+			auto bestError = SquaredDistance<4>(&block[i * 4], palette[0]);
+			for (auto index = 1U; index < 16; ++index)
+			{
+				const auto error = SquaredDistance<4>(&block[i * 4], palette[index]);
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = index;
+				}
+			}
+
+			outIndices[i] = static_cast<std::uint8_t>(bestIndex);
+			totalError += bestError;
+		}
+
+		return totalError;
+	}
+
+	class Bc7BitWriter
+	{
+	public:
+		Bc7BitWriter(std::uint8_t* block)
+			: _block(block)
+			, _bitPosition(0)
+		{
+			std::memset(_block, 0, 16);
+		}
+
+		void Write(const std::uint32_t value, const std::uint32_t bitCount)
+		{
+			for (auto bit = 0U; bit < bitCount; ++bit, ++_bitPosition)
+			{
+				_block[_bitPosition >> 3] |= static_cast<std::uint8_t>(((value >> bit) & 1) << (_bitPosition & 7));
+			}
+		}
+
+	private:
+		std::uint8_t* _block;
+		std::uint32_t _bitPosition;
+	};
+
+	// BC7 mode 6: a single subset of RGBA endpoints with 7 bits per channel, a p-bit each and 4 bit indices. 
+	// Best where colour and alpha change together.
+	std::uint32_t EncodeBc7Mode6Block(const Block& block, std::uint8_t* outBlock)
+	{
+		float start[4], end[4];
+		FitLine<4>(block, start, end);
+
+		Bc7Endpoints endpoints;
+		QuantizeBc7Endpoint(start, endpoints._values[0], endpoints._pBits[0]);
+		QuantizeBc7Endpoint(end, endpoints._values[1], endpoints._pBits[1]);
+
+		std::uint8_t indices[BLOCK_TEXEL_COUNT];
+		auto error = SelectBc7Indices(block, endpoints, indices);
+
+		float weights[BLOCK_TEXEL_COUNT];
+		for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			weights[i] = BC7_WEIGHTS_4[indices[i]] / 64.0f;
+		}
+
+		float refinedStart[4], refinedEnd[4];
+		if (RefineEndpoints<4>(block, weights, refinedStart, refinedEnd))
+		{
+			Bc7Endpoints refinedEndpoints;
+			QuantizeBc7Endpoint(refinedStart, refinedEndpoints._values[0], refinedEndpoints._pBits[0]);
+			QuantizeBc7Endpoint(refinedEnd, refinedEndpoints._values[1], refinedEndpoints._pBits[1]);
+
+			std::uint8_t refinedIndices[BLOCK_TEXEL_COUNT];
+			const auto refinedError = SelectBc7Indices(block, refinedEndpoints, refinedIndices);
+			if (refinedError < error)
+			{
+				endpoints = refinedEndpoints;
+				std::memcpy(indices, refinedIndices, sizeof(indices));
+				error = refinedError;
+			}
+		}
+
+		// The first texel's index is stored without its top bit, which must therefore be zero
+		if (indices[0] & 8)
+		{
+			std::swap(endpoints._values[0], endpoints._values[1]);
+			std::swap(endpoints._pBits[0], endpoints._pBits[1]);
+			for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+			{
+				indices[i] = static_cast<std::uint8_t>(15 - indices[i]);
+			}
+		}
+
+		Bc7BitWriter writer(outBlock);
+		writer.Write(1U << 6, 7);
+		for (auto channel = 0U; channel < 4; ++channel)
+		{
+			writer.Write(endpoints._values[0][channel], 7);
+			writer.Write(endpoints._values[1][channel], 7);
+		}
+		writer.Write(endpoints._pBits[0], 1);
+		writer.Write(endpoints._pBits[1], 1);
+		writer.Write(indices[0], 3);
+		for (auto i = 1U; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			writer.Write(indices[i], 4);
+		}
+
+		return error;
+	}
+
+	std::uint32_t SelectBc7Mode5ColorIndices(const Block& block, const std::uint32_t (&endpoints)[2][3], std::uint8_t* outIndices)
+	{
+		float palette[4][3];
+		for (auto index = 0U; index < 4; ++index)
+		{
+			for (auto channel = 0U; channel < 3; ++channel)
+			{
+				const auto value0 = (endpoints[0][channel] << 1) | (endpoints[0][channel] >> 6);
+				const auto value1 = (endpoints[1][channel] << 1) | (endpoints[1][channel] >> 6);
+				palette[index][channel] = static_cast<float>(((64 - BC7_WEIGHTS_2[index]) * value0 + BC7_WEIGHTS_2[index] * value1 + 32) >> 6);
+			}
+		}
+
+		auto totalError = 0U;
+		for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			auto bestIndex = 0U;
+			auto bestError = SquaredDistance<3>(&block[i * 4], palette[0]);
+			for (auto index = 1U; index < 4; ++index)
+			{
+				const auto error = SquaredDistance<3>(&block[i * 4], palette[index]);
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = index;
+				}
+			}
+
+			outIndices[i] = static_cast<std::uint8_t>(bestIndex);
+			totalError += bestError;
+		}
+
+		return totalError;
+	}
+
+	// BC7 mode 5: 7 bit RGB and 8 bit alpha endpoints, each with their own 2 bit indices. 
+	// Best where alpha varies independently of colour, such as glyph edges.
+	std::uint32_t EncodeBc7Mode5Block(const Block& block, std::uint8_t* outBlock)
+	{
+		float start[3], end[3];
+		FitLine<3>(block, start, end);
+
+		std::uint32_t colorEndpoints[2][3];
+		for (auto channel = 0U; channel < 3; ++channel)
+		{
+			colorEndpoints[0][channel] = (std::min)(static_cast<std::uint32_t>(start[channel] / 2.0f + 0.5f), 127U);
+			colorEndpoints[1][channel] = (std::min)(static_cast<std::uint32_t>(end[channel] / 2.0f + 0.5f), 127U);
+		}
+
+		std::uint8_t colorIndices[BLOCK_TEXEL_COUNT];
+		auto colorError = SelectBc7Mode5ColorIndices(block, colorEndpoints, colorIndices);
+
+		float weights[BLOCK_TEXEL_COUNT];
+		for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			weights[i] = BC7_WEIGHTS_2[colorIndices[i]] / 64.0f;
+		}
+
+		float refinedStart[3], refinedEnd[3];
+		if (RefineEndpoints<3>(block, weights, refinedStart, refinedEnd))
+		{
+			std::uint32_t refinedEndpoints[2][3];
+			for (auto channel = 0U; channel < 3; ++channel)
+			{
+				refinedEndpoints[0][channel] = (std::min)(static_cast<std::uint32_t>(refinedStart[channel] / 2.0f + 0.5f), 127U);
+				refinedEndpoints[1][channel] = (std::min)(static_cast<std::uint32_t>(refinedEnd[channel] / 2.0f + 0.5f), 127U);
+			}
+
+			std::uint8_t refinedIndices[BLOCK_TEXEL_COUNT];
+			const auto refinedError = SelectBc7Mode5ColorIndices(block, refinedEndpoints, refinedIndices);
+			if (refinedError < colorError)
+			{
+				std::memcpy(colorEndpoints, refinedEndpoints, sizeof(colorEndpoints));
+				std::memcpy(colorIndices, refinedIndices, sizeof(colorIndices));
+				colorError = refinedError;
+			}
+		}
+
+		// Alpha spans the block's extremes
+		std::uint32_t alphaEndpoints[2] = { 255U, 0U };
+		for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			alphaEndpoints[0] = (std::min)(alphaEndpoints[0], static_cast<std::uint32_t>(block[i * 4 + 3]));
+			alphaEndpoints[1] = (std::max)(alphaEndpoints[1], static_cast<std::uint32_t>(block[i * 4 + 3]));
+		}
+
+		std::uint8_t alphaIndices[BLOCK_TEXEL_COUNT];
+		auto alphaError = 0U;
+		for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			auto bestIndex = 0U;
+			auto bestError = 0xFFFFFFFFU;
+			for (auto index = 0U; index < 4; ++index)
+			{
+				const auto alpha = static_cast<int>(((64 - BC7_WEIGHTS_2[index]) * alphaEndpoints[0] + BC7_WEIGHTS_2[index] * alphaEndpoints[1] + 32) >> 6);
+				const auto difference = alpha - block[i * 4 + 3];
+				const auto error = static_cast<std::uint32_t>(difference * difference);
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = index;
+				}
+			}
+
+			alphaIndices[i] = static_cast<std::uint8_t>(bestIndex);
+			alphaError += bestError;
+		}
+
+		// Both index sets store the first texel's index without its top bit
+		if (colorIndices[0] & 2)
+		{
+			std::swap(colorEndpoints[0], colorEndpoints[1]);
+			for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+			{
+				colorIndices[i] = static_cast<std::uint8_t>(3 - colorIndices[i]);
+			}
+		}
+		if (alphaIndices[0] & 2)
+		{
+			std::swap(alphaEndpoints[0], alphaEndpoints[1]);
+			for (auto i = 0U; i < BLOCK_TEXEL_COUNT; ++i)
+			{
+				alphaIndices[i] = static_cast<std::uint8_t>(3 - alphaIndices[i]);
+			}
+		}
+
+		// No channel rotation
+		Bc7BitWriter writer(outBlock);
+		writer.Write(1U << 5, 6);
+		writer.Write(0, 2);
+		for (auto channel = 0U; channel < 3; ++channel)
+		{
+			writer.Write(colorEndpoints[0][channel], 7);
+			writer.Write(colorEndpoints[1][channel], 7);
+		}
+		writer.Write(alphaEndpoints[0], 8);
+		writer.Write(alphaEndpoints[1], 8);
+		writer.Write(colorIndices[0], 1);
+		for (auto i = 1U; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			writer.Write(colorIndices[i], 2);
+		}
+		writer.Write(alphaIndices[0], 1);
+		for (auto i = 1U; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			writer.Write(alphaIndices[i], 2);
+		}
+
+		return colorError + alphaError;
+	}
+
+	// Encodes the block in both modes and keeps the closer one
+	void EncodeBc7Block(const Block& block, std::uint8_t* outBlock)
+	{
+		std::uint8_t mode5Block[16];
+		const auto mode6Error = EncodeBc7Mode6Block(block, outBlock);
+		const auto mode5Error = EncodeBc7Mode5Block(block, mode5Block);
+		if (mode5Error < mode6Error)
+		{
+			std::memcpy(outBlock, mode5Block, sizeof(mode5Block));
+		}
+	}
+}
+
+std::uint32_t block_compressor::GetBlockByteSize(const BlockFormat format)
+{
+	return format == BlockFormat::BC1 ? 8U : 16U;
+}
+
+size_t block_compressor::GetCompressedSize(const std::uint32_t width, const std::uint32_t height, const BlockFormat format)
+{
+	return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * GetBlockByteSize(format);
+}
+
+void block_compressor::CompressImage(const std::uint8_t* rgbaPixels, const std::uint32_t width, const std::uint32_t height, const std::uint32_t rowPitch, const BlockFormat format, std::uint8_t* outBlocks)
+{
+	const auto blockByteSize = GetBlockByteSize(format);
+
+	Block block;
+	for (auto blockY = 0U; blockY < height; blockY += 4)
+	{
+		for (auto blockX = 0U; blockX < width; blockX += 4)
+		{
+			for (auto y = 0U; y < 4; ++y)
+			{
+				const auto* row = rgbaPixels + static_cast<size_t>((std::min)(blockY + y, height - 1)) * rowPitch;
+				for (auto x = 0U; x < 4; ++x)
+				{
+					std::memcpy(&block[(y * 4 + x) * 4], row + (std::min)(blockX + x, width - 1) * 4, 4);
+				}
+			}
+
+			switch (format)
+			{
+				case BlockFormat::BC1: EncodeColorBlock(block, outBlocks); break;
+				case BlockFormat::BC3:
+				{
+					EncodeAlphaBlock(block, outBlocks);
+					EncodeColorBlock(block, outBlocks + 8);
+				} break;
+				case BlockFormat::BC7: EncodeBc7Block(block, outBlocks); break;
+			}
+
+			outBlocks += blockByteSize;
+		}
+	}
+}
\ No newline at end of file
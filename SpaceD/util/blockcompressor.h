@@ -0,0 +1,29 @@
+/***********************************************************************/
+/** blockcompressor.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                 **/
+/***********************************************************************/
+
+#pragma once
+
+// Local Headers
+
+// Remote Headers
+#include <cstddef>
+#include <cstdint>
+
+namespace block_compressor
+{
+	enum class BlockFormat
+	{
+		BC1,  // 4 bpp, opaque colour
+		BC3,  // 8 bpp, colour with an interpolated alpha block
+		BC7   // 8 bpp, RGBA encoded as mode 5 or 6 blocks, whichever is closer
+	};
+
+	std::uint32_t GetBlockByteSize(const BlockFormat format);
+	size_t GetCompressedSize(const std::uint32_t width, const std::uint32_t height, const BlockFormat format);
+
+	// Compresses an 8 bit RGBA image into 4x4 blocks, row by row. Partial blocks at the right 
+	// and bottom edges repeat the edge texels. outBlocks must hold GetCompressedSize bytes.
+	void CompressImage(const std::uint8_t* rgbaPixels, const std::uint32_t width, const std::uint32_t height, const std::uint32_t rowPitch, const BlockFormat format, std::uint8_t* outBlocks);
+}
\ No newline at end of file
@@ -0,0 +1,197 @@
+/********************************************************************/
+/** ddsfile.cpp by Alex Koukoulas (C) 2017 All Rights Reserved     **/
+/** File Description:                                              **/
+/********************************************************************/
+
+// Local Headers
+#include "ddsfile.h"
+
+// Remote Headers
+#include <algorithm>
+#include <fstream>
+
+namespace
+{
+	static const std::uint32_t DDS_MAGIC = 0x20534444U;  // "DDS "
+	static const std::uint32_t DX10_FOURCC = 0x30315844U; // "DX10"
+	static const std::uint32_t SOURCE_STAMP_FOURCC = 0x53435253U; // "SRCS", marks a source stamp in the reserved words
+	static const std::uint32_t DDS_HEADER_SIZE = 124U;
+	static const std::uint32_t DDS_PIXEL_FORMAT_SIZE = 32U;
+	static const std::uint32_t DDS_FILE_HEADER_SIZE = 4U + DDS_HEADER_SIZE + 20U;
+
+	static const std::uint32_t DDSD_CAPS        = 0x1U;
+	static const std::uint32_t DDSD_HEIGHT      = 0x2U;
+	static const std::uint32_t DDSD_WIDTH       = 0x4U;
+	static const std::uint32_t DDSD_PIXELFORMAT = 0x1000U;
+	static const std::uint32_t DDSD_MIPMAPCOUNT = 0x20000U;
+	static const std::uint32_t DDSD_LINEARSIZE  = 0x80000U;
+	static const std::uint32_t DDPF_FOURCC      = 0x4U;
+	static const std::uint32_t DDSCAPS_COMPLEX  = 0x8U;
+	static const std::uint32_t DDSCAPS_TEXTURE  = 0x1000U;
+	static const std::uint32_t DDSCAPS_MIPMAP   = 0x400000U;
+
+	// DXGI_FORMAT and D3D10_RESOURCE_DIMENSION values, spelled out to keep this file platform independent
+	static const std::uint32_t DXGI_FORMAT_BC1_UNORM_VALUE = 71U;
+	static const std::uint32_t DXGI_FORMAT_BC3_UNORM_VALUE = 77U;
+	static const std::uint32_t DXGI_FORMAT_BC7_UNORM_VALUE = 98U;
+	static const std::uint32_t RESOURCE_DIMENSION_TEXTURE2D = 3U;
+
+	void AppendLittleEndian(std::vector<std::uint8_t>& out, const std::uint32_t value)
+	{
+		out.push_back(static_cast<std::uint8_t>(value));
+		out.push_back(static_cast<std::uint8_t>(value >> 8));
+		out.push_back(static_cast<std::uint8_t>(value >> 16));
+		out.push_back(static_cast<std::uint8_t>(value >> 24));
+	}
+
+	std::uint32_t ReadLittleEndian(const std::uint8_t* data)
+	{
+		return data[0] | (static_cast<std::uint32_t>(data[1]) << 8) | (static_cast<std::uint32_t>(data[2]) << 16) | (static_cast<std::uint32_t>(data[3]) << 24);
+	}
+
+	std::uint32_t GetDxgiFormat(const block_compressor::BlockFormat format)
+	{
+		switch (format)
+		{
+			case block_compressor::BlockFormat::BC1: return DXGI_FORMAT_BC1_UNORM_VALUE;
+			case block_compressor::BlockFormat::BC3: return DXGI_FORMAT_BC3_UNORM_VALUE;
+			default: return DXGI_FORMAT_BC7_UNORM_VALUE;
+		}
+	}
+}
+
+bool dds_file::Write(const std::string& path, const block_compressor::BlockFormat format, const std::uint32_t width, const std::uint32_t height, 
+                     const std::vector<std::vector<std::uint8_t>>& mipLevels, const source_stamp::Stamp* sourceStamp)
+{
+	if (mipLevels.empty())
+	{
+		return false;
+	}
+
+	std::vector<std::uint8_t> header;
+	header.reserve(DDS_FILE_HEADER_SIZE);
+
+	AppendLittleEndian(header, DDS_MAGIC);
+	AppendLittleEndian(header, DDS_HEADER_SIZE);
+	AppendLittleEndian(header, DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE);
+	AppendLittleEndian(header, height);
+	AppendLittleEndian(header, width);
+	AppendLittleEndian(header, static_cast<std::uint32_t>(mipLevels[0].size()));
+	AppendLittleEndian(header, 0);  // Depth
+	AppendLittleEndian(header, static_cast<std::uint32_t>(mipLevels.size()));
+
+	// Reserved words, the first five of which carry the source stamp when there is one
+	auto reservedWordCount = 11;
+	if (sourceStamp)
+	{
+		AppendLittleEndian(header, SOURCE_STAMP_FOURCC);
+		AppendLittleEndian(header, static_cast<std::uint32_t>(sourceStamp->_size));
+		AppendLittleEndian(header, static_cast<std::uint32_t>(sourceStamp->_size >> 32));
+		AppendLittleEndian(header, static_cast<std::uint32_t>(sourceStamp->_writeTime));
+		AppendLittleEndian(header, static_cast<std::uint32_t>(sourceStamp->_writeTime >> 32));
+		reservedWordCount -= 5;
+	}
+
+	for (auto i = 0; i < reservedWordCount; ++i)
+	{
+		AppendLittleEndian(header, 0);
+	}
+
+	// Pixel format, deferring to the DX10 header
+	AppendLittleEndian(header, DDS_PIXEL_FORMAT_SIZE);
+	AppendLittleEndian(header, DDPF_FOURCC);
+	AppendLittleEndian(header, DX10_FOURCC);
+	for (auto i = 0; i < 5; ++i)
+	{
+		AppendLittleEndian(header, 0);
+	}
+
+	AppendLittleEndian(header, DDSCAPS_TEXTURE | (mipLevels.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0));
+	for (auto i = 0; i < 4; ++i)
+	{
+		AppendLittleEndian(header, 0);
+	}
+
+	// DX10 header: format, dimension, misc flags, array size, misc flags 2
+	AppendLittleEndian(header, GetDxgiFormat(format));
+	AppendLittleEndian(header, RESOURCE_DIMENSION_TEXTURE2D);
+	AppendLittleEndian(header, 0);
+	AppendLittleEndian(header, 1);
+	AppendLittleEndian(header, 0);
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header[0]), header.size());
+	for (const auto& mipLevel: mipLevels)
+	{
+		file.write(reinterpret_cast<const char*>(&mipLevel[0]), mipLevel.size());
+	}
+
+	return file.good();
+}
+
+bool dds_file::Read(const std::uint8_t* fileData, const size_t fileSize, TextureInfo& outInfo)
+{
+	if (fileSize < DDS_FILE_HEADER_SIZE || ReadLittleEndian(fileData) != DDS_MAGIC || ReadLittleEndian(fileData + 4) != DDS_HEADER_SIZE)
+	{
+		return false;
+	}
+
+	const auto* header = fileData + 4;
+	const auto* pixelFormat = header + 72;
+	const auto* dx10Header = fileData + 4 + DDS_HEADER_SIZE;
+	if ((ReadLittleEndian(pixelFormat + 4) & DDPF_FOURCC) == 0 || ReadLittleEndian(pixelFormat + 8) != DX10_FOURCC ||
+		ReadLittleEndian(dx10Header + 4) != RESOURCE_DIMENSION_TEXTURE2D || ReadLittleEndian(dx10Header + 12) != 1)
+	{
+		return false;
+	}
+
+	switch (ReadLittleEndian(dx10Header))
+	{
+		case DXGI_FORMAT_BC1_UNORM_VALUE: outInfo._format = block_compressor::BlockFormat::BC1; break;
+		case DXGI_FORMAT_BC3_UNORM_VALUE: outInfo._format = block_compressor::BlockFormat::BC3; break;
+		case DXGI_FORMAT_BC7_UNORM_VALUE: outInfo._format = block_compressor::BlockFormat::BC7; break;
+		default: return false;
+	}
+
+	outInfo._height = ReadLittleEndian(header + 8);
+	outInfo._width = ReadLittleEndian(header + 12);
+	const auto mipLevelCount = (std::max)(1U, ReadLittleEndian(header + 24));
+	if (outInfo._width == 0 || outInfo._height == 0 || mipLevelCount > 32)
+	{
+		return false;
+	}
+
+	const auto* reservedWords = header + 28;
+	outInfo._hasSourceStamp = ReadLittleEndian(reservedWords) == SOURCE_STAMP_FOURCC;
+	outInfo._sourceStamp._size = outInfo._hasSourceStamp ? ReadLittleEndian(reservedWords + 4) | (static_cast<std::uint64_t>(ReadLittleEndian(reservedWords + 8)) << 32) : 0;
+	outInfo._sourceStamp._writeTime = outInfo._hasSourceStamp ? ReadLittleEndian(reservedWords + 12) | (static_cast<std::uint64_t>(ReadLittleEndian(reservedWords + 16)) << 32) : 0;
+
+	const auto blockByteSize = block_compressor::GetBlockByteSize(outInfo._format);
+	auto offset = static_cast<size_t>(DDS_FILE_HEADER_SIZE);
+
+	outInfo._mipLevels.clear();
+	for (auto level = 0U; level < mipLevelCount; ++level)
+	{
+		MipLevel mipLevel;
+		mipLevel._width = (std::max)(1U, outInfo._width >> level);
+		mipLevel._height = (std::max)(1U, outInfo._height >> level);
+		mipLevel._rowPitch = (mipLevel._width + 3) / 4 * blockByteSize;
+		mipLevel._offset = offset;
+		mipLevel._size = block_compressor::GetCompressedSize(mipLevel._width, mipLevel._height, outInfo._format);
+
+		offset += mipLevel._size;
+		if (offset > fileSize)
+		{
+			return false;
+		}
+
+		outInfo._mipLevels.push_back(mipLevel);
+	}
+
+	return true;
+}
\ No newline at end of file
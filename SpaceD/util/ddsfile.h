@@ -0,0 +1,48 @@
+/********************************************************************/
+/** ddsfile.h by Alex Koukoulas (C) 2017 All Rights Reserved       **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "blockcompressor.h"
+#include "sourcestamp.h"
+
+// Remote Headers
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dds_file
+{
+	struct MipLevel
+	{
+		std::uint32_t _width;
+		std::uint32_t _height;
+		std::uint32_t _rowPitch;  // Bytes per row of blocks
+		size_t _offset;           // From the start of the file
+		size_t _size;
+	};
+
+	struct TextureInfo
+	{
+		block_compressor::BlockFormat _format;
+		std::uint32_t _width;
+		std::uint32_t _height;
+		std::vector<MipLevel> _mipLevels;
+
+		// Stamp of the image the texture was built from, kept in the header's reserved words
+		bool _hasSourceStamp;
+		source_stamp::Stamp _sourceStamp;
+	};
+
+	// Writes a block compressed 2D texture and its mip chain, largest first, as a DDS file with 
+	// the DX10 header extension. Any DDS aware tool can open the result. sourceStamp is null for textures with
+	// no single source image, such as atlases.
+	bool Write(const std::string& path, const block_compressor::BlockFormat format, const std::uint32_t width, const std::uint32_t height, 
+	           const std::vector<std::vector<std::uint8_t>>& mipLevels, const source_stamp::Stamp* sourceStamp);
+
+	// Parses the files written above, locating every mip level in place without copying the data
+	bool Read(const std::uint8_t* fileData, const size_t fileSize, TextureInfo& outInfo);
+}
\ No newline at end of file
@@ -0,0 +1,149 @@
+/**********************************************************************/
+/** frustumculler.cpp by Alex Koukoulas (C) 2017 All Rights Reserved **/
+/** File Description:                                                **/
+/**********************************************************************/
+
+// Local Headers
+#include "frustumculler.h"
+
+// Remote Headers
+#if !defined(_XM_NO_INTRINSICS_)
+#include <xmmintrin.h>
+#endif
+
+namespace
+{
+	static const UINT FRUSTUM_PLANE_COUNT = 6U;
+
+	void ExtractPlanes(const math::Frustum& frustum, XMFLOAT4 (&outPlanes)[FRUSTUM_PLANE_COUNT])
+	{
+		for (auto i = 0U; i < FRUSTUM_PLANE_COUNT; ++i)
+		{
+			XMStoreFloat4(&outPlanes[i], frustum._planes[i]);
+		}
+	}
+
+	bool IsSphereVisible(const XMFLOAT4 (&planes)[FRUSTUM_PLANE_COUNT], const FLOAT x, const FLOAT y, const FLOAT z, const FLOAT radius)
+	{
+		// Same operation order as the SIMD path so that both produce identical results
+		for (const auto& plane: planes)
+		{
+			auto distance = plane.x * x + plane.w;
+			distance += plane.y * y;
+			distance += plane.z * z;
+
+			if (distance + radius < 0.0f)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void CullSpheresScalarRange(const XMFLOAT4 (&planes)[FRUSTUM_PLANE_COUNT], const BoundingSpheres& spheres, const UINT begin, const UINT end, std::vector<UINT>& outVisibleIndices)
+	{
+		for (auto i = begin; i < end; ++i)
+		{
+			if (IsSphereVisible(planes, spheres._centerX[i], spheres._centerY[i], spheres._centerZ[i], spheres._radius[i]))
+			{
+				outVisibleIndices.push_back(i);
+			}
+		}
+	}
+}
+
+frustum_culler::ContainmentType frustum_culler::TestAABB(const math::Frustum& frustum, const math::AABB& aabb)
+{
+	if (aabb.IsEmpty())
+	{
+		return ContainmentType::OUTSIDE;
+	}
+
+	XMFLOAT4 planes[FRUSTUM_PLANE_COUNT];
+	ExtractPlanes(frustum, planes);
+
+	auto result = ContainmentType::INSIDE;
+	for (const auto& plane: planes)
+	{
+		// The corner furthest along the plane's normal decides rejection, the nearest one decides full containment
+		const auto farX  = plane.x >= 0.0f ? aabb._max.x : aabb._min.x;
+		const auto farY  = plane.y >= 0.0f ? aabb._max.y : aabb._min.y;
+		const auto farZ  = plane.z >= 0.0f ? aabb._max.z : aabb._min.z;
+		const auto nearX = plane.x >= 0.0f ? aabb._min.x : aabb._max.x;
+		const auto nearY = plane.y >= 0.0f ? aabb._min.y : aabb._max.y;
+		const auto nearZ = plane.z >= 0.0f ? aabb._min.z : aabb._max.z;
+
+		if (plane.x * farX + plane.y * farY + plane.z * farZ + plane.w < 0.0f)
+		{
+			return ContainmentType::OUTSIDE;
+		}
+
+		if (plane.x * nearX + plane.y * nearY + plane.z * nearZ + plane.w < 0.0f)
+		{
+			result = ContainmentType::INTERSECTS;
+		}
+	}
+
+	return result;
+}
+
+void frustum_culler::CullSpheres(const math::Frustum& frustum, const BoundingSpheres& spheres, std::vector<UINT>& outVisibleIndices)
+{
+	XMFLOAT4 planes[FRUSTUM_PLANE_COUNT];
+	ExtractPlanes(frustum, planes);
+
+	const auto sphereCount = spheres.Count();
+	auto i = 0U;
+
+#if !defined(_XM_NO_INTRINSICS_)
+	__m128 planeX[FRUSTUM_PLANE_COUNT], planeY[FRUSTUM_PLANE_COUNT], planeZ[FRUSTUM_PLANE_COUNT], planeW[FRUSTUM_PLANE_COUNT];
+	for (auto p = 0U; p < FRUSTUM_PLANE_COUNT; ++p)
+	{
+		planeX[p] = _mm_set1_ps(planes[p].x);
+		planeY[p] = _mm_set1_ps(planes[p].y);
+		planeZ[p] = _mm_set1_ps(planes[p].z);
+		planeW[p] = _mm_set1_ps(planes[p].w);
+	}
+
+	const auto zero = _mm_setzero_ps();
+
+	// Four spheres per iteration: signed distance + radius must be non negative for all six planes
+	for (; i + 4 <= sphereCount; i += 4)
+	{
+		const auto x = _mm_loadu_ps(&spheres._centerX[i]);
+		const auto y = _mm_loadu_ps(&spheres._centerY[i]);
+		const auto z = _mm_loadu_ps(&spheres._centerZ[i]);
+		const auto r = _mm_loadu_ps(&spheres._radius[i]);
+
+		auto visible = _mm_cmpeq_ps(zero, zero);
+		for (auto p = 0U; p < FRUSTUM_PLANE_COUNT; ++p)
+		{
+			auto distance = _mm_add_ps(_mm_mul_ps(planeX[p], x), planeW[p]);
+			distance = _mm_add_ps(distance, _mm_mul_ps(planeY[p], y));
+			distance = _mm_add_ps(distance, _mm_mul_ps(planeZ[p], z));
+			visible  = _mm_and_ps(visible, _mm_cmpge_ps(_mm_add_ps(distance, r), zero));
+		}
+
+		// Compact the surviving lanes into the output list
+		auto mask = _mm_movemask_ps(visible);
+		for (auto lane = 0U; mask != 0; ++lane, mask >>= 1)
+		{
+			if (mask & 1)
+			{
+				outVisibleIndices.push_back(i + lane);
+			}
+		}
+	}
+#endif
+
+	// Remaining spheres that do not fill a whole SIMD batch
+	CullSpheresScalarRange(planes, spheres, i, sphereCount, outVisibleIndices);
+}
+
+void frustum_culler::CullSpheresScalar(const math::Frustum& frustum, const BoundingSpheres& spheres, std::vector<UINT>& outVisibleIndices)
+{
+	XMFLOAT4 planes[FRUSTUM_PLANE_COUNT];
+	ExtractPlanes(frustum, planes);
+
+	CullSpheresScalarRange(planes, spheres, 0, spheres.Count(), outVisibleIndices);
+}
\ No newline at end of file
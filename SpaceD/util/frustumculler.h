@@ -0,0 +1,62 @@
+/********************************************************************/
+/** frustumculler.h by Alex Koukoulas (C) 2017 All Rights Reserved **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "math.h"
+
+// Remote Headers
+#include <vector>
+
+// Bounding spheres packed as structure of arrays so that they can be 
+// culled four at a time
+struct BoundingSpheres
+{
+	std::vector<FLOAT> _centerX;
+	std::vector<FLOAT> _centerY;
+	std::vector<FLOAT> _centerZ;
+	std::vector<FLOAT> _radius;
+
+	void Clear()
+	{
+		_centerX.clear();
+		_centerY.clear();
+		_centerZ.clear();
+		_radius.clear();
+	}
+
+	void Add(const XMFLOAT3& center, const FLOAT radius)
+	{
+		_centerX.push_back(center.x);
+		_centerY.push_back(center.y);
+		_centerZ.push_back(center.z);
+		_radius.push_back(radius);
+	}
+
+	UINT Count() const
+	{
+		return static_cast<UINT>(_radius.size());
+	}
+};
+
+namespace frustum_culler
+{
+	enum class ContainmentType
+	{
+		OUTSIDE, INTERSECTS, INSIDE
+	};
+
+	// Classifies the box as fully behind one of the frustum's planes, fully in front of all of them
+	// or straddling at least one. Empty boxes are always OUTSIDE.
+	ContainmentType TestAABB(const math::Frustum& frustum, const math::AABB& aabb);
+
+	// Appends the indices of the spheres that are not fully behind any of the frustum's planes
+	// to outVisibleIndices, in ascending order. 
+	void CullSpheres(const math::Frustum& frustum, const BoundingSpheres& spheres, std::vector<UINT>& outVisibleIndices);
+
+	// Scalar reference implementation of CullSpheres used for validation
+	void CullSpheresScalar(const math::Frustum& frustum, const BoundingSpheres& spheres, std::vector<UINT>& outVisibleIndices);
+}
\ No newline at end of file
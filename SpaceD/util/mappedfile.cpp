@@ -0,0 +1,74 @@
+/********************************************************************/
+/** mappedfile.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                              **/
+/********************************************************************/
+
+// Local Headers
+#include "mappedfile.h"
+
+// Remote Headers
+
+MappedFile::MappedFile(const std::string& path)
+	: _fileHandle(INVALID_HANDLE_VALUE)
+	, _mappingHandle(nullptr)
+	, _data(nullptr)
+	, _size(0)
+{
+	_fileHandle = CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (_fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(_fileHandle, &fileSize) || fileSize.QuadPart == 0 || static_cast<ULONGLONG>(fileSize.QuadPart) > SIZE_MAX)
+	{
+		return;
+	}
+
+	// Mapping an empty file fails, which is why that case is turned away above
+	_mappingHandle = CreateFileMapping(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!_mappingHandle)
+	{
+		return;
+	}
+
+	_data = static_cast<const std::uint8_t*>(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (_data)
+	{
+		_size = static_cast<size_t>(fileSize.QuadPart);
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	if (_data)
+	{
+		UnmapViewOfFile(_data);
+	}
+
+	if (_mappingHandle)
+	{
+		CloseHandle(_mappingHandle);
+	}
+
+	if (_fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(_fileHandle);
+	}
+}
+
+bool MappedFile::IsOpen() const
+{
+	return _data != nullptr;
+}
+
+const std::uint8_t* MappedFile::GetData() const
+{
+	return _data;
+}
+
+size_t MappedFile::GetSize() const
+{
+	return _size;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+/********************************************************************/
+/** mappedfile.h by Alex Koukoulas (C) 2017 All Rights Reserved    **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+
+// Remote Headers
+#include <cstdint>
+#include <string>
+#include <Windows.h>
+
+// Read only view of a whole file mapped into the address space. Pages are brought in by the OS as they are
+// touched, so nothing is read up front and the file's contents are never copied into a buffer of our own.
+class MappedFile final
+{
+public:
+	MappedFile(const std::string& path);
+	~MappedFile();
+
+	// False when the file is missing, empty or could not be mapped
+	bool IsOpen() const;
+
+	// The view starts on a page boundary, so any alignment within the file carries over to memory
+	const std::uint8_t* GetData() const;
+	size_t GetSize() const;
+
+private:
+	MappedFile(const MappedFile& rhs) = delete;
+	MappedFile& operator = (const MappedFile& rhs) = delete;
+
+private:
+	HANDLE _fileHandle;
+	HANDLE _mappingHandle;
+	const std::uint8_t* _data;
+	size_t _size;
+};
\ No newline at end of file
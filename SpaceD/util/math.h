@@ -10,6 +10,7 @@
 // Remote Headers
 #include <Windows.h>
 #include <xnamath.h>
+#include <cfloat>
 #include <vector>
 
 typedef float FLOAT;
@@ -80,6 +81,39 @@ namespace math
 		XMVECTOR _planes[6];
 	};
 
+	struct AABB
+	{
+		XMFLOAT3 _min;
+		XMFLOAT3 _max;
+
+		AABB()
+		{
+			Reset();
+		}
+
+		// An empty box has its minimum above its maximum so that the first Expand snaps to the expanding sphere
+		void Reset()
+		{
+			_min = XMFLOAT3( FLT_MAX,  FLT_MAX,  FLT_MAX);
+			_max = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		}
+
+		void Expand(const XMFLOAT3& center, const FLOAT radius)
+		{
+			_min.x = center.x - radius < _min.x ? center.x - radius : _min.x;
+			_min.y = center.y - radius < _min.y ? center.y - radius : _min.y;
+			_min.z = center.z - radius < _min.z ? center.z - radius : _min.z;
+			_max.x = center.x + radius > _max.x ? center.x + radius : _max.x;
+			_max.y = center.y + radius > _max.y ? center.y + radius : _max.y;
+			_max.z = center.z + radius > _max.z ? center.z + radius : _max.z;
+		}
+
+		bool IsEmpty() const
+		{
+			return _min.x > _max.x;
+		}
+	};
+
 	static XMFLOAT2 MouseToNDC(const INT mouseX, const INT mouseY, const INT windowWidth, const INT windowHeight)
 	{
 		FLOAT pointX, pointY;
@@ -175,17 +209,4 @@ namespace math
 	{
 		return sqrtf(DistanceNoSqrt(pos1, pos2));
 	}
-
-	static bool NonZeroTexCoords(const std::vector<XMFLOAT2>& texcoordVec)
-	{
-		for (const auto& texcoord: texcoordVec)
-		{
-			if (texcoord.x != 0.0f || texcoord.y != 0.0f)
-			{
-				return true;
-			}
-		}
-
-		return false;
-	}
 }
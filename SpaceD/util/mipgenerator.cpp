@@ -0,0 +1,221 @@
+/**********************************************************************/
+/** mipgenerator.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                **/
+/**********************************************************************/
+
+// Local Headers
+#include "mipgenerator.h"
+
+// Remote Headers
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	static const float PI = 3.14159265358979f;
+
+	// Filter radius in destination texels and window shape, as commonly used for mip generation
+	static const float KAISER_WIDTH = 3.0f;
+	static const float KAISER_ALPHA = 4.0f;
+
+	struct Tap
+	{
+		std::uint32_t _index;
+		float _weight;
+	};
+
+	typedef std::vector<std::vector<Tap>> Kernels;
+
+	float Sinc(const float x)
+	{
+		return std::fabs(x) < 1e-5f ? 1.0f : std::sin(PI * x) / (PI * x);
+	}
+
+	// Zeroth order modified Bessel function of the first kind
+	float BesselI0(const float x)
+	{
+		auto sum = 1.0f;
+		auto term = 1.0f;
+		for (auto k = 1; k < 32; ++k)
+		{
+			const auto halfXOverK = x / (2.0f * k);
+			term *= halfXOverK * halfXOverK;
+			sum += term;
+			if (term < sum * 1e-7f)
+			{
+				break;
+			}
+		}
+		return sum;
+	}
+
+	float KaiserWindow(const float x)
+	{
+		const auto t = x / KAISER_WIDTH;
+		return t * t >= 1.0f ? 0.0f : BesselI0(KAISER_ALPHA * std::sqrt(1.0f - t * t)) / BesselI0(KAISER_ALPHA);
+	}
+
+	// One normalized set of source taps per destination texel along an axis. 
+	// Taps past the edges are clamped onto the border texels.
+	Kernels BuildKernels(const std::uint32_t sourceSize, const std::uint32_t targetSize, const mip_generator::MipFilter filter)
+	{
+		const auto scale = static_cast<float>(sourceSize) / targetSize;
+
+		Kernels kernels(targetSize);
+		for (auto target = 0U; target < targetSize; ++target)
+		{
+			auto& kernel = kernels[target];
+
+			if (filter == mip_generator::MipFilter::BOX)
+			{
+				const auto start = target * scale;
+				const auto end = (target + 1) * scale;
+				for (auto source = static_cast<std::uint32_t>(start); source < sourceSize && source < end; ++source)
+				{
+					const auto coverage = (std::min)(end, source + 1.0f) - (std::max)(start, static_cast<float>(source));
+					if (coverage > 0.0f)
+					{
+						kernel.push_back({ source, coverage });
+					}
+				}
+			}
+			else
+			{
+				const auto center = (target + 0.5f) * scale;
+				const auto radius = KAISER_WIDTH * scale;
+				const auto first = static_cast<int>(std::floor(center - radius));
+				const auto last = static_cast<int>(std::ceil(center + radius));
+				for (auto source = first; source <= last; ++source)
+				{
+					const auto distance = (source + 0.5f - center) / scale;
+					const auto weight = Sinc(distance) * KaiserWindow(distance);
+					if (weight != 0.0f)
+					{
+						const auto clampedSource = static_cast<std::uint32_t>((std::min)((std::max)(source, 0), static_cast<int>(sourceSize) - 1));
+						kernel.push_back({ clampedSource, weight });
+					}
+				}
+			}
+
+			auto weightSum = 0.0f;
+			for (const auto& tap: kernel)
+			{
+				weightSum += tap._weight;
+			}
+			for (auto& tap: kernel)
+			{
+				tap._weight /= weightSum;
+			}
+		}
+
+		return kernels;
+	}
+
+	// Separable resample of a premultiplied float RGBA image
+	std::vector<float> Downsample(const std::vector<float>& source, const std::uint32_t sourceWidth, const std::uint32_t sourceHeight, const std::uint32_t targetWidth, const std::uint32_t targetHeight, const mip_generator::MipFilter filter)
+	{
+		const auto horizontalKernels = BuildKernels(sourceWidth, targetWidth, filter);
+		const auto verticalKernels = BuildKernels(sourceHeight, targetHeight, filter);
+
+		std::vector<float> horizontallyFiltered(static_cast<size_t>(targetWidth) * sourceHeight * 4, 0.0f);
+		for (auto y = 0U; y < sourceHeight; ++y)
+		{
+			const auto* sourceRow = &source[static_cast<size_t>(y) * sourceWidth * 4];
+			auto* targetRow = &horizontallyFiltered[static_cast<size_t>(y) * targetWidth * 4];
+			for (auto x = 0U; x < targetWidth; ++x)
+			{
+				for (const auto& tap: horizontalKernels[x])
+				{
+					for (auto channel = 0U; channel < 4; ++channel)
+					{
+						targetRow[x * 4 + channel] += sourceRow[tap._index * 4 + channel] * tap._weight;
+					}
+				}
+			}
+		}
+
+		std::vector<float> target(static_cast<size_t>(targetWidth) * targetHeight * 4, 0.0f);
+		for (auto y = 0U; y < targetHeight; ++y)
+		{
+			auto* targetRow = &target[static_cast<size_t>(y) * targetWidth * 4];
+			for (const auto& tap: verticalKernels[y])
+			{
+				const auto* sourceRow = &horizontallyFiltered[static_cast<size_t>(tap._index) * targetWidth * 4];
+				for (auto i = 0U; i < targetWidth * 4; ++i)
+				{
+					targetRow[i] += sourceRow[i] * tap._weight;
+				}
+			}
+		}
+
+		return target;
+	}
+
+	std::uint8_t QuantizeChannel(const float value)
+	{
+		return static_cast<std::uint8_t>((std::min)((std::max)(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+	}
+
+	void Quantize(const std::vector<float>& premultiplied, std::vector<std::uint8_t>& outPixels)
+	{
+		outPixels.resize(premultiplied.size());
+		for (size_t i = 0; i < premultiplied.size(); i += 4)
+		{
+			// Sharper filters can ring past the valid range
+			const auto alpha = (std::min)((std::max)(premultiplied[i + 3], 0.0f), 1.0f);
+			const auto inverseAlpha = alpha > 0.0f ? 1.0f / alpha : 0.0f;
+
+			outPixels[i + 0] = QuantizeChannel(premultiplied[i + 0] * inverseAlpha);
+			outPixels[i + 1] = QuantizeChannel(premultiplied[i + 1] * inverseAlpha);
+			outPixels[i + 2] = QuantizeChannel(premultiplied[i + 2] * inverseAlpha);
+			outPixels[i + 3] = QuantizeChannel(alpha);
+		}
+	}
+}
+
+std::vector<mip_generator::MipLevel> mip_generator::GenerateMipChain(const std::uint8_t* rgbaPixels, const std::uint32_t width, const std::uint32_t height, const std::uint32_t rowPitch, const MipFilter filter)
+{
+	std::vector<MipLevel> mipChain(1);
+	mipChain[0]._width = width;
+	mipChain[0]._height = height;
+	mipChain[0]._pixels.resize(static_cast<size_t>(width) * height * 4);
+
+	std::vector<float> premultiplied(mipChain[0]._pixels.size());
+	for (auto y = 0U; y < height; ++y)
+	{
+		const auto* sourceRow = rgbaPixels + static_cast<size_t>(y) * rowPitch;
+		std::memcpy(&mipChain[0]._pixels[static_cast<size_t>(y) * width * 4], sourceRow, width * 4);
+
+		auto* targetRow = &premultiplied[static_cast<size_t>(y) * width * 4];
+		for (auto x = 0U; x < width; ++x)
+		{
+			const auto alpha = sourceRow[x * 4 + 3] / 255.0f;
+			targetRow[x * 4 + 0] = sourceRow[x * 4 + 0] / 255.0f * alpha;
+			targetRow[x * 4 + 1] = sourceRow[x * 4 + 1] / 255.0f * alpha;
+			targetRow[x * 4 + 2] = sourceRow[x * 4 + 2] / 255.0f * alpha;
+			targetRow[x * 4 + 3] = alpha;
+		}
+	}
+
+	// Every level is filtered from the unquantized level above it
+	auto levelWidth = width;
+	auto levelHeight = height;
+	while (levelWidth > 1 || levelHeight > 1)
+	{
+		const auto nextWidth = (std::max)(1U, levelWidth / 2);
+		const auto nextHeight = (std::max)(1U, levelHeight / 2);
+		premultiplied = Downsample(premultiplied, levelWidth, levelHeight, nextWidth, nextHeight, filter);
+
+		MipLevel mipLevel;
+		mipLevel._width = nextWidth;
+		mipLevel._height = nextHeight;
+		Quantize(premultiplied, mipLevel._pixels);
+		mipChain.push_back(std::move(mipLevel));
+
+		levelWidth = nextWidth;
+		levelHeight = nextHeight;
+	}
+
+	return mipChain;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+/********************************************************************/
+/** mipgenerator.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+
+// Remote Headers
+#include <cstdint>
+#include <vector>
+
+namespace mip_generator
+{
+	enum class MipFilter
+	{
+		BOX,    // Area average of the texels each mip texel covers
+		KAISER  // Kaiser windowed sinc, sharper than box at the cost of some ringing
+	};
+
+	struct MipLevel
+	{
+		std::uint32_t _width;
+		std::uint32_t _height;
+		std::vector<std::uint8_t> _pixels;  // 8 bit RGBA, rows tightly packed
+	};
+
+	// Builds the full mip chain of an 8 bit RGBA image, from a copy of the image itself down to 1x1. 
+	// Filtering happens on alpha premultiplied colours so transparent texels do not bleed into their neighbours.
+	std::vector<MipLevel> GenerateMipChain(const std::uint8_t* rgbaPixels, const std::uint32_t width, const std::uint32_t height, const std::uint32_t rowPitch, const MipFilter filter);
+}
\ No newline at end of file
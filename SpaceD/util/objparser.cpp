@@ -0,0 +1,391 @@
+/********************************************************************/
+/** objparser.cpp by Alex Koukoulas (C) 2017 All Rights Reserved   **/
+/** File Description:                                              **/
+/********************************************************************/
+
+// Local Headers
+#include "objparser.h"
+
+// Remote Headers
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+	static const double POWERS_OF_TEN[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	static const int MAX_EXACT_POWER_OF_TEN = 22;
+
+	// Digits past this many no longer fit a 64 bit mantissa and only move the exponent
+	static const int MAX_MANTISSA_DIGITS = 19;
+
+	enum class LineType
+	{
+		POSITION,
+		TEXCOORD,
+		NORMAL,
+		FACE,
+		AMBIENT,
+		DIFFUSE,
+		SPECULAR,
+		OTHER
+	};
+
+	bool IsSpace(const char c)
+	{
+		return c == ' ' || c == '\t';
+	}
+
+	bool IsLineEnd(const char c)
+	{
+		return c == '\n' || c == '\r';
+	}
+
+	void SkipSpaces(const char*& cursor, const char* end)
+	{
+		while (cursor != end && IsSpace(*cursor)) ++cursor;
+	}
+
+	const char* FindLineEnd(const char* cursor, const char* end)
+	{
+		while (cursor != end && *cursor != '\n') ++cursor;
+		return cursor;
+	}
+
+	// Reads the keyword at the start of a line and leaves the cursor after it
+	LineType ReadLineType(const char*& cursor, const char* lineEnd)
+	{
+		SkipSpaces(cursor, lineEnd);
+		const auto* keywordStart = cursor;
+		while (cursor != lineEnd && !IsSpace(*cursor) && !IsLineEnd(*cursor)) ++cursor;
+
+		const auto keywordLength = cursor - keywordStart;
+		if (keywordLength == 1)
+		{
+			if (keywordStart[0] == 'v') return LineType::POSITION;
+			if (keywordStart[0] == 'f') return LineType::FACE;
+		}
+		else if (keywordLength == 2)
+		{
+			if (keywordStart[0] == 'v' && keywordStart[1] == 't') return LineType::TEXCOORD;
+			if (keywordStart[0] == 'v' && keywordStart[1] == 'n') return LineType::NORMAL;
+			if (keywordStart[0] == 'm' && keywordStart[1] == 'a') return LineType::AMBIENT;
+			if (keywordStart[0] == 'm' && keywordStart[1] == 'd') return LineType::DIFFUSE;
+			if (keywordStart[0] == 'm') return LineType::SPECULAR;
+		}
+
+		return LineType::OTHER;
+	}
+
+	bool ParseFloat(const char*& cursor, const char* end, float& outValue)
+	{
+		SkipSpaces(cursor, end);
+
+		auto negative = false;
+		if (cursor != end && (*cursor == '-' || *cursor == '+'))
+		{
+			negative = *cursor == '-';
+			++cursor;
+		}
+
+		std::uint64_t mantissa = 0;
+		auto mantissaDigits = 0;
+		auto exponent = 0;
+		auto anyDigits = false;
+
+		for (; cursor != end && *cursor >= '0' && *cursor <= '9'; ++cursor)
+		{
+			anyDigits = true;
+			if (mantissaDigits < MAX_MANTISSA_DIGITS)
+			{
+				mantissa = mantissa * 10 + (*cursor - '0');
+				mantissaDigits += mantissa != 0;
+			}
+			else
+			{
+				exponent++;
+			}
+		}
+
+		if (cursor != end && *cursor == '.')
+		{
+			for (++cursor; cursor != end && *cursor >= '0' && *cursor <= '9'; ++cursor)
+			{
+				anyDigits = true;
+				if (mantissaDigits < MAX_MANTISSA_DIGITS)
+				{
+					mantissa = mantissa * 10 + (*cursor - '0');
+					mantissaDigits += mantissa != 0;
+					exponent--;
+				}
+			}
+		}
+
+		if (!anyDigits)
+		{
+			return false;
+		}
+
+		if (cursor != end && (*cursor == 'e' || *cursor == 'E'))
+		{
+			++cursor;
+			auto negativeExponent = false;
+			if (cursor != end && (*cursor == '-' || *cursor == '+'))
+			{
+				negativeExponent = *cursor == '-';
+				++cursor;
+			}
+
+			auto writtenExponent = 0;
+			for (; cursor != end && *cursor >= '0' && *cursor <= '9'; ++cursor)
+			{
+				writtenExponent = (std::min)(writtenExponent * 10 + (*cursor - '0'), 10000);
+			}
+			exponent += negativeExponent ? -writtenExponent : writtenExponent;
+		}
+
+		auto value = static_cast<double>(mantissa);
+		if (mantissa != 0 && exponent != 0)
+		{
+			if (exponent < 0 && exponent >= -MAX_EXACT_POWER_OF_TEN) value /= POWERS_OF_TEN[-exponent];
+			else if (exponent > 0 && exponent <= MAX_EXACT_POWER_OF_TEN) value *= POWERS_OF_TEN[exponent];
+			else value *= std::pow(10.0, exponent);
+		}
+
+		outValue = static_cast<float>(negative ? -value : value);
+		return true;
+	}
+
+	bool ParseInteger(const char*& cursor, const char* end, std::int64_t& outValue)
+	{
+		auto negative = false;
+		if (cursor != end && (*cursor == '-' || *cursor == '+'))
+		{
+			negative = *cursor == '-';
+			++cursor;
+		}
+
+		if (cursor == end || *cursor < '0' || *cursor > '9')
+		{
+			return false;
+		}
+
+		std::int64_t value = 0;
+		for (; cursor != end && *cursor >= '0' && *cursor <= '9'; ++cursor)
+		{
+			value = (std::min)(value * 10 + (*cursor - '0'), static_cast<std::int64_t>(UINT32_MAX));
+		}
+
+		outValue = negative ? -value : value;
+		return true;
+	}
+
+	// One based indices count from the start of the file, negative ones back from the latest attribute read so far
+	bool ResolveIndex(const std::int64_t writtenIndex, const size_t attributeCount, std::uint32_t& outIndex)
+	{
+		if (writtenIndex > 0)
+		{
+			outIndex = static_cast<std::uint32_t>(writtenIndex - 1);
+			return true;
+		}
+
+		if (writtenIndex < 0 && static_cast<std::uint64_t>(-writtenIndex) <= attributeCount)
+		{
+			outIndex = static_cast<std::uint32_t>(static_cast<std::int64_t>(attributeCount) + writtenIndex);
+			return true;
+		}
+
+		return false;
+	}
+
+	bool ParseCorner(const char*& cursor, const char* end, const obj_parser::ParsedOBJ& parsedOBJ, obj_parser::FaceCorner& outCorner)
+	{
+		std::int64_t writtenIndex;
+		if (!ParseInteger(cursor, end, writtenIndex) || !ResolveIndex(writtenIndex, parsedOBJ._positions.size() / 3, outCorner._position))
+		{
+			return false;
+		}
+
+		outCorner._texcoord = obj_parser::NO_INDEX;
+		outCorner._normal = obj_parser::NO_INDEX;
+		if (cursor == end || *cursor != '/')
+		{
+			return true;
+		}
+
+		++cursor;
+		if (cursor != end && *cursor != '/')
+		{
+			if (!ParseInteger(cursor, end, writtenIndex) || !ResolveIndex(writtenIndex, parsedOBJ._texcoords.size() / 2, outCorner._texcoord))
+			{
+				return false;
+			}
+		}
+
+		if (cursor == end || *cursor != '/')
+		{
+			return true;
+		}
+
+		++cursor;
+		return ParseInteger(cursor, end, writtenIndex) && ResolveIndex(writtenIndex, parsedOBJ._normals.size() / 3, outCorner._normal);
+	}
+
+	bool ParseFloats(const char*& cursor, const char* end, const int count, float* outValues)
+	{
+		for (auto i = 0; i < count; ++i)
+		{
+			if (!ParseFloat(cursor, end, outValues[i]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	size_t CountFaceCorners(const char* cursor, const char* lineEnd)
+	{
+		size_t cornerCount = 0;
+		while (true)
+		{
+			SkipSpaces(cursor, lineEnd);
+			if (cursor == lineEnd || IsLineEnd(*cursor))
+			{
+				return cornerCount;
+			}
+
+			cornerCount++;
+			while (cursor != lineEnd && !IsSpace(*cursor) && !IsLineEnd(*cursor)) ++cursor;
+		}
+	}
+}
+
+bool obj_parser::Parse(const char* data, const size_t size, ParsedOBJ& outParsedOBJ, std::string& outError)
+{
+	const auto* end = data + size;
+
+	// Counting pass, so that no array grows while the attributes are read
+	size_t positionCount = 0, texcoordCount = 0, normalCount = 0, cornerCount = 0;
+	for (const auto* cursor = data; cursor != end;)
+	{
+		const auto* lineEnd = FindLineEnd(cursor, end);
+		switch (ReadLineType(cursor, lineEnd))
+		{
+			case LineType::POSITION: positionCount++; break;
+			case LineType::TEXCOORD: texcoordCount++; break;
+			case LineType::NORMAL:   normalCount++; break;
+			case LineType::FACE:     cornerCount += ((std::max)(CountFaceCorners(cursor, lineEnd), size_t(2)) - 2) * 3; break;
+			default: break;
+		}
+		cursor = lineEnd == end ? end : lineEnd + 1;
+	}
+
+	outParsedOBJ._positions.clear();
+	outParsedOBJ._texcoords.clear();
+	outParsedOBJ._normals.clear();
+	outParsedOBJ._corners.clear();
+	outParsedOBJ._positions.reserve(positionCount * 3);
+	outParsedOBJ._texcoords.reserve(texcoordCount * 2);
+	outParsedOBJ._normals.reserve(normalCount * 3);
+	outParsedOBJ._corners.reserve(cornerCount);
+	std::fill(outParsedOBJ._ambient, outParsedOBJ._ambient + 4, 1.0f);
+	std::fill(outParsedOBJ._diffuse, outParsedOBJ._diffuse + 4, 1.0f);
+	std::fill(outParsedOBJ._specular, outParsedOBJ._specular + 4, 1.0f);
+
+	// First corner and line of every face, so that an index checked after reading can be traced back to its line
+	std::vector<std::pair<size_t, std::uint32_t>> faceLines;
+	faceLines.reserve(cornerCount / 3);
+
+	std::vector<FaceCorner> polygonCorners;
+	auto lineNumber = std::uint32_t(0);
+	for (const auto* cursor = data; cursor != end;)
+	{
+		const auto* lineEnd = FindLineEnd(cursor, end);
+		lineNumber++;
+
+		auto parsed = true;
+		float values[4];
+		switch (ReadLineType(cursor, lineEnd))
+		{
+			case LineType::POSITION:
+			{
+				parsed = ParseFloats(cursor, lineEnd, 3, values);
+				outParsedOBJ._positions.insert(outParsedOBJ._positions.end(), values, values + 3);
+			} break;
+
+			case LineType::TEXCOORD:
+			{
+				parsed = ParseFloats(cursor, lineEnd, 2, values);
+				outParsedOBJ._texcoords.insert(outParsedOBJ._texcoords.end(), values, values + 2);
+			} break;
+
+			case LineType::NORMAL:
+			{
+				parsed = ParseFloats(cursor, lineEnd, 3, values);
+				outParsedOBJ._normals.insert(outParsedOBJ._normals.end(), values, values + 3);
+			} break;
+
+			case LineType::AMBIENT:  parsed = ParseFloats(cursor, lineEnd, 4, outParsedOBJ._ambient); break;
+			case LineType::DIFFUSE:  parsed = ParseFloats(cursor, lineEnd, 4, outParsedOBJ._diffuse); break;
+			case LineType::SPECULAR: parsed = ParseFloats(cursor, lineEnd, 4, outParsedOBJ._specular); break;
+
+			case LineType::FACE:
+			{
+				polygonCorners.clear();
+				while (parsed)
+				{
+					SkipSpaces(cursor, lineEnd);
+					if (cursor == lineEnd || IsLineEnd(*cursor) || *cursor == '#')
+					{
+						break;
+					}
+
+					FaceCorner corner;
+					parsed = ParseCorner(cursor, lineEnd, outParsedOBJ, corner);
+					polygonCorners.push_back(corner);
+				}
+
+				parsed = parsed && polygonCorners.size() >= 3;
+				faceLines.emplace_back(outParsedOBJ._corners.size(), lineNumber);
+
+				// Polygons are fanned around their first corner
+				for (size_t i = 2; parsed && i < polygonCorners.size(); ++i)
+				{
+					outParsedOBJ._corners.push_back(polygonCorners[0]);
+					outParsedOBJ._corners.push_back(polygonCorners[i - 1]);
+					outParsedOBJ._corners.push_back(polygonCorners[i]);
+				}
+			} break;
+
+			default: break;
+		}
+
+		if (!parsed)
+		{
+			outError = "malformed line " + std::to_string(lineNumber);
+			return false;
+		}
+
+		cursor = lineEnd == end ? end : lineEnd + 1;
+	}
+
+	// Positive indices may point forwards, so they can only be checked once everything has been read
+	const auto finalPositionCount = outParsedOBJ._positions.size() / 3;
+	const auto finalTexcoordCount = outParsedOBJ._texcoords.size() / 2;
+	const auto finalNormalCount = outParsedOBJ._normals.size() / 3;
+	for (size_t cornerIndex = 0; cornerIndex < outParsedOBJ._corners.size(); ++cornerIndex)
+	{
+		const auto& corner = outParsedOBJ._corners[cornerIndex];
+		if (corner._position >= finalPositionCount || 
+			(corner._texcoord != NO_INDEX && corner._texcoord >= finalTexcoordCount) || 
+			(corner._normal != NO_INDEX && corner._normal >= finalNormalCount))
+		{
+			const auto faceLineIter = std::upper_bound(faceLines.begin(), faceLines.end(), cornerIndex, 
+				[](const size_t index, const std::pair<size_t, std::uint32_t>& faceLine) { return index < faceLine.first; }) - 1;
+			outError = "face on line " + std::to_string(faceLineIter->second) + " refers to a missing attribute";
+			return false;
+		}
+	}
+
+	return true;
+}
\ No newline at end of file
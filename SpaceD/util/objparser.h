@@ -0,0 +1,48 @@
+/********************************************************************/
+/** objparser.h by Alex Koukoulas (C) 2017 All Rights Reserved     **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+
+// Remote Headers
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Single pass OBJ tokeniser working directly on the file's bytes (typically a mapped view), with no per line
+// strings or streams. A counting pass sizes every array up front. Faces may have any number of corners, which are
+// fanned into triangles, and corners may be written as p, p/t, p//n or p/t/n with negative (relative) indices.
+namespace obj_parser
+{
+	// Marks a corner written without a texcoord or normal
+	static const std::uint32_t NO_INDEX = 0xFFFFFFFFU;
+
+	// Zero based indices into the attribute arrays of ParsedOBJ
+	struct FaceCorner
+	{
+		std::uint32_t _position;
+		std::uint32_t _texcoord;
+		std::uint32_t _normal;
+	};
+
+	struct ParsedOBJ
+	{
+		std::vector<float> _positions;    // x, y, z
+		std::vector<float> _texcoords;    // u, v as written in the file
+		std::vector<float> _normals;      // x, y, z
+		std::vector<FaceCorner> _corners; // Three per triangle
+
+		// The game's own material lines: "ma", "md" and any other two letter "m" entry for specular.
+		// Colours that are not given are left white.
+		float _ambient[4];
+		float _diffuse[4];
+		float _specular[4];
+	};
+
+	// False when the text is malformed or a face refers to an attribute that does not exist, 
+	// with outError naming the offending line
+	bool Parse(const char* data, const size_t size, ParsedOBJ& outParsedOBJ, std::string& outError);
+}
\ No newline at end of file
@@ -0,0 +1,957 @@
+/********************************************************************/
+/** pngreader.cpp by Alex Koukoulas (C) 2017 All Rights Reserved   **/
+/** File Description:                                              **/
+/********************************************************************/
+
+// Local Headers
+#include "pngreader.h"
+
+// Remote Headers
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+#include <vector>
+
+namespace
+{
+	static const std::uint8_t PNG_SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+	// Lengths up to this many bits are resolved with a single table lookup
+	static const std::uint32_t HUFFMAN_FAST_BITS = 10U;
+	static const std::uint32_t HUFFMAN_FAST_MASK = (1U << HUFFMAN_FAST_BITS) - 1;
+
+	// Back references are copied 8 bytes at a time and may run this far past their end
+	static const std::uint32_t INFLATE_OUTPUT_SLACK = 8U;
+
+	static const std::uint16_t LENGTH_BASE[]  = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	static const std::uint8_t  LENGTH_EXTRA[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	static const std::uint16_t DIST_BASE[]    = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	static const std::uint8_t  DIST_EXTRA[]   = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	static const std::uint8_t  CODE_LENGTH_ORDER[] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	// Adam7 pass origins and steps
+	static const std::uint32_t ADAM7_X_START[] = { 0, 4, 0, 2, 0, 1, 0 };
+	static const std::uint32_t ADAM7_Y_START[] = { 0, 0, 4, 0, 2, 0, 1 };
+	static const std::uint32_t ADAM7_X_STEP[]  = { 8, 8, 4, 4, 2, 2, 1 };
+	static const std::uint32_t ADAM7_Y_STEP[]  = { 8, 8, 8, 4, 4, 2, 2 };
+
+	enum ColorType
+	{
+		GRAYSCALE       = 0,
+		RGB             = 2,
+		PALETTE         = 3,
+		GRAYSCALE_ALPHA = 4,
+		RGBA            = 6
+	};
+
+	struct Header
+	{
+		std::uint32_t _width;
+		std::uint32_t _height;
+		std::uint32_t _bitDepth;
+		std::uint32_t _colorType;
+		std::uint32_t _channelCount;
+		bool _interlaced;
+	};
+
+	std::uint32_t ReadBigEndian(const std::uint8_t* data)
+	{
+		return (static_cast<std::uint32_t>(data[0]) << 24) | (static_cast<std::uint32_t>(data[1]) << 16) | (static_cast<std::uint32_t>(data[2]) << 8) | data[3];
+	}
+
+	bool ParseHeader(const std::uint8_t* fileData, const size_t fileSize, Header& outHeader)
+	{
+		// Signature followed by IHDR, which must come first
+		if (fileSize < 8 + 8 + 13 + 4 || std::memcmp(fileData, PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) != 0 ||
+			ReadBigEndian(fileData + 8) != 13 || std::memcmp(fileData + 12, "IHDR", 4) != 0)
+		{
+			return false;
+		}
+
+		const auto* ihdr = fileData + 16;
+		outHeader._width      = ReadBigEndian(ihdr);
+		outHeader._height     = ReadBigEndian(ihdr + 4);
+		outHeader._bitDepth   = ihdr[8];
+		outHeader._colorType  = ihdr[9];
+		outHeader._interlaced = ihdr[12] == 1;
+
+		if (outHeader._width == 0 || outHeader._height == 0 || outHeader._width > png_reader::MAX_IMAGE_DIMENSION || outHeader._height > png_reader::MAX_IMAGE_DIMENSION ||
+			ihdr[10] != 0 || ihdr[11] != 0 || ihdr[12] > 1)
+		{
+			return false;
+		}
+
+		const auto depth = outHeader._bitDepth;
+		switch (outHeader._colorType)
+		{
+			case GRAYSCALE:       outHeader._channelCount = 1; return depth == 1 || depth == 2 || depth == 4 || depth == 8 || depth == 16;
+			case RGB:             outHeader._channelCount = 3; return depth == 8 || depth == 16;
+			case PALETTE:         outHeader._channelCount = 1; return depth == 1 || depth == 2 || depth == 4 || depth == 8;
+			case GRAYSCALE_ALPHA: outHeader._channelCount = 2; return depth == 8 || depth == 16;
+			case RGBA:            outHeader._channelCount = 4; return depth == 8 || depth == 16;
+			default: return false;
+		}
+	}
+
+	std::uint32_t GetRowBytes(const Header& header, const std::uint32_t width)
+	{
+		return (width * header._channelCount * header._bitDepth + 7) / 8;
+	}
+
+	std::uint32_t GetPassExtent(const std::uint32_t extent, const std::uint32_t start, const std::uint32_t step)
+	{
+		return extent > start ? (extent - start + step - 1) / step : 0;
+	}
+
+	std::uint32_t ReverseBits16(std::uint32_t value)
+	{
+		value = ((value & 0xAAAA) >> 1) | ((value & 0x5555) << 1);
+		value = ((value & 0xCCCC) >> 2) | ((value & 0x3333) << 2);
+		value = ((value & 0xF0F0) >> 4) | ((value & 0x0F0F) << 4);
+		value = ((value & 0xFF00) >> 8) | ((value & 0x00FF) << 8);
+		return value;
+	}
+
+	// Canonical Huffman code. Short codes resolve through _fast, indexed by the next bits of the 
+	// stream (which deflate stores least significant bit first); longer ones walk the code lengths.
+	struct Huffman
+	{
+		std::uint16_t _fast[1 << HUFFMAN_FAST_BITS];  // (code length << 9) | symbol, 0 when the code is longer
+		std::uint16_t _firstCode[16];
+		std::uint32_t _maxCode[17];
+		std::uint16_t _firstSymbol[16];
+		std::uint8_t _size[288];
+		std::uint16_t _value[288];
+	};
+
+	bool BuildHuffman(Huffman& huffman, const std::uint8_t* codeLengths, const std::uint32_t symbolCount)
+	{
+		std::uint32_t lengthCounts[17] = {};
+		std::uint32_t nextCode[16];
+
+		std::memset(huffman._fast, 0, sizeof(huffman._fast));
+		for (auto i = 0U; i < symbolCount; ++i)
+		{
+			lengthCounts[codeLengths[i]]++;
+		}
+		lengthCounts[0] = 0;
+
+		auto code = 0U;
+		auto symbolIndex = 0U;
+		for (auto length = 1U; length < 16; ++length)
+		{
+			nextCode[length] = code;
+			huffman._firstCode[length] = static_cast<std::uint16_t>(code);
+			huffman._firstSymbol[length] = static_cast<std::uint16_t>(symbolIndex);
+			code += lengthCounts[length];
+
+			// Oversubscribed code
+			if (lengthCounts[length] && code - 1 >= (1U << length))
+			{
+				return false;
+			}
+
+			huffman._maxCode[length] = code << (16 - length);
+			code <<= 1;
+			symbolIndex += lengthCounts[length];
+		}
+		huffman._maxCode[16] = 0x10000;
+
+		for (auto symbol = 0U; symbol < symbolCount; ++symbol)
+		{
+			const auto length = codeLengths[symbol];
+			if (length == 0)
+			{
+				continue;
+			}
+
+			const auto index = nextCode[length] - huffman._firstCode[length] + huffman._firstSymbol[length];
+			huffman._size[index] = length;
+			huffman._value[index] = static_cast<std::uint16_t>(symbol);
+
+			if (length <= HUFFMAN_FAST_BITS)
+			{
+				const auto fastEntry = static_cast<std::uint16_t>((length << 9) | symbol);
+				for (auto j = ReverseBits16(nextCode[length]) >> (16 - length); j < (1U << HUFFMAN_FAST_BITS); j += 1U << length)
+				{
+					huffman._fast[j] = fastEntry;
+				}
+			}
+			nextCode[length]++;
+		}
+
+		return true;
+	}
+
+	struct FixedHuffmanTables
+	{
+		Huffman _literals;
+		Huffman _distances;
+
+		FixedHuffmanTables()
+		{
+			std::uint8_t codeLengths[288];
+			std::memset(codeLengths, 8, 144);
+			std::memset(codeLengths + 144, 9, 256 - 144);
+			std::memset(codeLengths + 256, 7, 280 - 256);
+			std::memset(codeLengths + 280, 8, 288 - 280);
+			BuildHuffman(_literals, codeLengths, 288);
+
+			std::memset(codeLengths, 5, 30);
+			BuildHuffman(_distances, codeLengths, 30);
+		}
+	};
+
+	// zlib stream decompressor writing into a buffer of known size. The bit buffer is refilled 
+	// eight bytes at a time while the input allows it.
+	class Inflater
+	{
+	public:
+		Inflater(const std::uint8_t* input, const size_t inputSize, std::uint8_t* output, const size_t outputSize, const size_t outputCapacity)
+			: _input(input)
+			, _inputEnd(input + inputSize)
+			, _output(output)
+			, _outputSize(outputSize)
+			, _outputCapacity(outputCapacity)
+			, _outputPosition(0)
+			, _bits(0)
+			, _bitCount(0)
+			, _overreadBytes(0)
+		{
+		}
+
+		bool Run()
+		{
+			// zlib header: deflate, no preset dictionary
+			if (_inputEnd - _input < 2 || (_input[0] & 0x0F) != 8 || (_input[1] & 0x20) != 0 || ((_input[0] << 8) | _input[1]) % 31 != 0)
+			{
+				return false;
+			}
+			_input += 2;
+
+			auto finalBlock = false;
+			do
+			{
+				finalBlock = ReadBits(1) == 1;
+				const auto blockType = ReadBits(2);
+
+				auto blockDecoded = false;
+				switch (blockType)
+				{
+					case 0: blockDecoded = InflateStoredBlock(); break;
+					case 1:
+					{
+						static const FixedHuffmanTables fixedTables;
+						blockDecoded = InflateHuffmanBlock(fixedTables._literals, fixedTables._distances);
+					} break;
+					case 2:
+					{
+						Huffman literals, distances;
+						blockDecoded = ReadDynamicTables(literals, distances) && InflateHuffmanBlock(literals, distances);
+					} break;
+				}
+
+				if (!blockDecoded || _overreadBytes > 8)
+				{
+					return false;
+				}
+			} while (!finalBlock);
+
+			return _outputPosition == _outputSize;
+		}
+
+	private:
+		void Refill()
+		{
+			if (_inputEnd - _input >= 8)
+			{
+				// Bytes that do not fit entirely are loaded again, to the same position, by the next refill
+				std::uint64_t word;
+				std::memcpy(&word, _input, sizeof(word));
+				_bits |= word << _bitCount;
+				_input += (63 - _bitCount) >> 3;
+				_bitCount |= 56;
+				return;
+			}
+
+			while (_bitCount <= 56)
+			{
+				std::uint64_t byte = 0;
+				if (_input < _inputEnd)
+				{
+					byte = *_input++;
+				}
+				else
+				{
+					_overreadBytes++;
+				}
+
+				_bits |= byte << _bitCount;
+				_bitCount += 8;
+			}
+		}
+
+		std::uint32_t ReadBits(const std::uint32_t count)
+		{
+			if (_bitCount < count)
+			{
+				Refill();
+			}
+
+			const auto value = static_cast<std::uint32_t>(_bits & ((1ULL << count) - 1));
+			_bits >>= count;
+			_bitCount -= count;
+			return value;
+		}
+
+		int DecodeSymbol(const Huffman& huffman)
+		{
+			if (_bitCount < 16)
+			{
+				Refill();
+			}
+
+			const auto fastEntry = huffman._fast[_bits & HUFFMAN_FAST_MASK];
+			if (fastEntry)
+			{
+				const auto length = fastEntry >> 9;
+				_bits >>= length;
+				_bitCount -= length;
+				return fastEntry & 511;
+			}
+
+			// Codes compare numerically once put back in most significant bit first order
+			const auto code = ReverseBits16(static_cast<std::uint32_t>(_bits & 0xFFFF));
+			auto length = HUFFMAN_FAST_BITS + 1;
+			while (length < 16 && code >= huffman._maxCode[length])
+			{
+				length++;
+			}
+			if (length == 16)
+			{
+				return -1;
+			}
+
+			const auto index = (code >> (16 - length)) - huffman._firstCode[length] + huffman._firstSymbol[length];
+			if (index >= 288 || huffman._size[index] != length)
+			{
+				return -1;
+			}
+
+			_bits >>= length;
+			_bitCount -= length;
+			return huffman._value[index];
+		}
+
+		bool InflateStoredBlock()
+		{
+			ReadBits(_bitCount & 7);
+			const auto length = ReadBits(16);
+			const auto lengthComplement = ReadBits(16);
+			if ((length ^ 0xFFFF) != lengthComplement || length > _outputSize - _outputPosition)
+			{
+				return false;
+			}
+
+			auto remaining = length;
+			while (remaining > 0 && _bitCount >= 8)
+			{
+				_output[_outputPosition++] = static_cast<std::uint8_t>(ReadBits(8));
+				remaining--;
+			}
+
+			if (remaining == 0)
+			{
+				return true;
+			}
+
+			// The bit buffer is drained, the rest is copied straight from the input. 
+			// Leftover bits of an earlier refill belong to the bytes copied here.
+			_bits = 0;
+			_bitCount = 0;
+			if (static_cast<size_t>(_inputEnd - _input) < remaining)
+			{
+				return false;
+			}
+
+			std::memcpy(_output + _outputPosition, _input, remaining);
+			_input += remaining;
+			_outputPosition += remaining;
+			return true;
+		}
+
+		bool ReadDynamicTables(Huffman& literals, Huffman& distances)
+		{
+			const auto literalCount = ReadBits(5) + 257;
+			const auto distanceCount = ReadBits(5) + 1;
+			const auto codeLengthCount = ReadBits(4) + 4;
+			if (literalCount > 286 || distanceCount > 30)
+			{
+				return false;
+			}
+
+			std::uint8_t codeLengthLengths[19] = {};
+			for (auto i = 0U; i < codeLengthCount; ++i)
+			{
+				codeLengthLengths[CODE_LENGTH_ORDER[i]] = static_cast<std::uint8_t>(ReadBits(3));
+			}
+
+			Huffman codeLengthHuffman;
+			if (!BuildHuffman(codeLengthHuffman, codeLengthLengths, 19))
+			{
+				return false;
+			}
+
+			std::uint8_t codeLengths[286 + 30];
+			const auto totalCount = literalCount + distanceCount;
+			auto count = 0U;
+			while (count < totalCount)
+			{
+				const auto symbol = DecodeSymbol(codeLengthHuffman);
+				if (symbol < 0 || symbol >= 19)
+				{
+					return false;
+				}
+
+				if (symbol < 16)
+				{
+					codeLengths[count++] = static_cast<std::uint8_t>(symbol);
+					continue;
+				}
+
+				std::uint8_t repeatedLength = 0;
+				std::uint32_t repeatCount = 0;
+				if (symbol == 16)
+				{
+					if (count == 0)
+					{
+						return false;
+					}
+					repeatedLength = codeLengths[count - 1];
+					repeatCount = 3 + ReadBits(2);
+				}
+				else if (symbol == 17)
+				{
+					repeatCount = 3 + ReadBits(3);
+				}
+				else
+				{
+					repeatCount = 11 + ReadBits(7);
+				}
+
+				if (count + repeatCount > totalCount)
+				{
+					return false;
+				}
+
+				std::memset(codeLengths + count, repeatedLength, repeatCount);
+				count += repeatCount;
+			}
+
+			return BuildHuffman(literals, codeLengths, literalCount) && BuildHuffman(distances, codeLengths + literalCount, distanceCount);
+		}
+
+		bool InflateHuffmanBlock(const Huffman& literals, const Huffman& distances)
+		{
+			for (;;)
+			{
+				auto symbol = DecodeSymbol(literals);
+				if (symbol < 256)
+				{
+					if (symbol < 0 || _outputPosition >= _outputSize)
+					{
+						return false;
+					}
+					_output[_outputPosition++] = static_cast<std::uint8_t>(symbol);
+					continue;
+				}
+
+				if (symbol == 256)
+				{
+					return true;
+				}
+
+				symbol -= 257;
+				if (symbol >= 29)
+				{
+					return false;
+				}
+				const auto length = LENGTH_BASE[symbol] + ReadBits(LENGTH_EXTRA[symbol]);
+
+				const auto distanceSymbol = DecodeSymbol(distances);
+				if (distanceSymbol < 0 || distanceSymbol >= 30)
+				{
+					return false;
+				}
+				const auto distance = DIST_BASE[distanceSymbol] + ReadBits(DIST_EXTRA[distanceSymbol]);
+
+				if (distance > _outputPosition || length > _outputSize - _outputPosition)
+				{
+					return false;
+				}
+
+				auto* target = _output + _outputPosition;
+				const auto* source = target - distance;
+				if (distance >= 8 && _outputPosition + length + INFLATE_OUTPUT_SLACK <= _outputCapacity)
+				{
+					// Chunks never overlap their own source, the overshoot is overwritten later
+					for (auto copied = 0U; copied < length; copied += 8)
+					{
+						std::uint64_t chunk;
+						std::memcpy(&chunk, source + copied, sizeof(chunk));
+						std::memcpy(target + copied, &chunk, sizeof(chunk));
+					}
+				}
+				else if (distance == 1)
+				{
+					std::memset(target, *source, length);
+				}
+				else
+				{
+					for (auto i = 0U; i < length; ++i)
+					{
+						target[i] = source[i];
+					}
+				}
+				_outputPosition += length;
+			}
+		}
+
+	private:
+		const std::uint8_t* _input;
+		const std::uint8_t* _inputEnd;
+		std::uint8_t* _output;
+		const size_t _outputSize;
+		const size_t _outputCapacity;
+		size_t _outputPosition;
+		std::uint64_t _bits;
+		std::uint32_t _bitCount;
+		std::uint32_t _overreadBytes;
+	};
+
+	int PaethPredictor(const int a, const int b, const int c)
+	{
+		const auto p = a + b - c;
+		const auto pa = p > a ? p - a : a - p;
+		const auto pb = p > b ? p - b : b - p;
+		const auto pc = p > c ? p - c : c - p;
+		return pa <= pb && pa <= pc ? a : (pb <= pc ? b : c);
+	}
+
+	template<int BPP>
+	__m128i LoadPixel(const std::uint8_t* data)
+	{
+		std::int32_t pixel = 0;
+		std::memcpy(&pixel, data, BPP);
+		return _mm_cvtsi32_si128(pixel);
+	}
+
+	template<int BPP>
+	void StorePixel(std::uint8_t* data, const __m128i pixel)
+	{
+		const std::int32_t value = _mm_cvtsi128_si32(pixel);
+		std::memcpy(data, &value, BPP);
+	}
+
+	// Sub, Average and Paeth depend on the pixel to the left, so 3 and 4 byte pixels are 
+	// reconstructed one whole pixel per SSE2 operation instead of one byte at a time
+	template<int BPP>
+	void UnfilterSubSse2(const std::uint8_t* filtered, std::uint8_t* row, const std::uint32_t rowBytes)
+	{
+		auto left = _mm_setzero_si128();
+		for (auto i = 0U; i < rowBytes; i += BPP)
+		{
+			left = _mm_add_epi8(left, LoadPixel<BPP>(filtered + i));
+			StorePixel<BPP>(row + i, left);
+		}
+	}
+
+	template<int BPP>
+	void UnfilterAverageSse2(const std::uint8_t* filtered, const std::uint8_t* prior, std::uint8_t* row, const std::uint32_t rowBytes)
+	{
+		const auto one = _mm_set1_epi8(1);
+		auto left = _mm_setzero_si128();
+		for (auto i = 0U; i < rowBytes; i += BPP)
+		{
+			const auto above = LoadPixel<BPP>(prior + i);
+
+			// _mm_avg_epu8 rounds up, the filter rounds down
+			const auto average = _mm_sub_epi8(_mm_avg_epu8(left, above), _mm_and_si128(_mm_xor_si128(left, above), one));
+			left = _mm_add_epi8(LoadPixel<BPP>(filtered + i), average);
+			StorePixel<BPP>(row + i, left);
+		}
+	}
+
+	template<int BPP>
+	void UnfilterPaethSse2(const std::uint8_t* filtered, const std::uint8_t* prior, std::uint8_t* row, const std::uint32_t rowBytes)
+	{
+		const auto zero = _mm_setzero_si128();
+		auto left = zero;
+		auto aboveLeft = zero;
+		for (auto i = 0U; i < rowBytes; i += BPP)
+		{
+			// Widened to 16 bits so the predictor distances cannot overflow
+			const auto above = _mm_unpacklo_epi8(LoadPixel<BPP>(prior + i), zero);
+			const auto a = _mm_unpacklo_epi8(left, zero);
+
+			auto pa = _mm_sub_epi16(above, aboveLeft);
+			auto pb = _mm_sub_epi16(a, aboveLeft);
+			auto pc = _mm_add_epi16(pa, pb);
+			pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+			pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+			pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+
+			// Ties prefer left, then above, like the scalar predictor
+			const auto smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+			const auto useLeft = _mm_cmpeq_epi16(pa, smallest);
+			const auto useAbove = _mm_cmpeq_epi16(pb, smallest);
+			const auto aboveOrAboveLeft = _mm_or_si128(_mm_and_si128(useAbove, above), _mm_andnot_si128(useAbove, aboveLeft));
+			const auto predicted = _mm_or_si128(_mm_and_si128(useLeft, a), _mm_andnot_si128(useLeft, aboveOrAboveLeft));
+
+			left = _mm_add_epi8(LoadPixel<BPP>(filtered + i), _mm_packus_epi16(predicted, predicted));
+			StorePixel<BPP>(row + i, left);
+			aboveLeft = above;
+		}
+	}
+
+	// Reverses the filter of one scanline into row. prior is the previous reconstructed scanline, 
+	// all zero for the first one; bytesPerPixel is rounded up to one for sub byte depths.
+	bool UnfilterRow(const std::uint32_t filterType, const std::uint8_t* filtered, const std::uint8_t* prior, std::uint8_t* row, const std::uint32_t rowBytes, const std::uint32_t bytesPerPixel)
+	{
+		switch (filterType)
+		{
+			case 0:
+			{
+				std::memcpy(row, filtered, rowBytes);
+			} break;
+
+			case 1:
+			{
+				if (bytesPerPixel == 4) { UnfilterSubSse2<4>(filtered, row, rowBytes); break; }
+				if (bytesPerPixel == 3) { UnfilterSubSse2<3>(filtered, row, rowBytes); break; }
+
+				for (auto i = 0U; i < rowBytes; ++i)
+				{
+					row[i] = static_cast<std::uint8_t>(filtered[i] + (i >= bytesPerPixel ? row[i - bytesPerPixel] : 0));
+				}
+			} break;
+
+			case 2:
+			{
+				auto i = 0U;
+				for (; i + 16 <= rowBytes; i += 16)
+				{
+					const auto sum = _mm_add_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(filtered + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(prior + i)));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), sum);
+				}
+				for (; i < rowBytes; ++i)
+				{
+					row[i] = static_cast<std::uint8_t>(filtered[i] + prior[i]);
+				}
+			} break;
+
+			case 3:
+			{
+				if (bytesPerPixel == 4) { UnfilterAverageSse2<4>(filtered, prior, row, rowBytes); break; }
+				if (bytesPerPixel == 3) { UnfilterAverageSse2<3>(filtered, prior, row, rowBytes); break; }
+
+				for (auto i = 0U; i < rowBytes; ++i)
+				{
+					row[i] = static_cast<std::uint8_t>(filtered[i] + (((i >= bytesPerPixel ? row[i - bytesPerPixel] : 0) + prior[i]) >> 1));
+				}
+			} break;
+
+			case 4:
+			{
+				if (bytesPerPixel == 4) { UnfilterPaethSse2<4>(filtered, prior, row, rowBytes); break; }
+				if (bytesPerPixel == 3) { UnfilterPaethSse2<3>(filtered, prior, row, rowBytes); break; }
+
+				for (auto i = 0U; i < rowBytes; ++i)
+				{
+					const auto left = i >= bytesPerPixel ? row[i - bytesPerPixel] : 0;
+					const auto aboveLeft = i >= bytesPerPixel ? prior[i - bytesPerPixel] : 0;
+					row[i] = static_cast<std::uint8_t>(filtered[i] + PaethPredictor(left, prior[i], aboveLeft));
+				}
+			} break;
+
+			default: return false;
+		}
+
+		return true;
+	}
+
+	struct Transparency
+	{
+		std::uint8_t _palette[256 * 4];  // RGBA, opaque black past the PLTE entries
+		std::uint16_t _key[3];           // Sample values drawn transparent for grayscale and RGB images
+		bool _hasKey;
+	};
+
+	std::uint32_t ReadSample(const std::uint8_t* row, const std::uint32_t index, const std::uint32_t bitDepth)
+	{
+		switch (bitDepth)
+		{
+			case 8:  return row[index];
+			case 16: return (row[index * 2] << 8) | row[index * 2 + 1];
+			default:
+			{
+				const auto bitOffset = index * bitDepth;
+				return (row[bitOffset >> 3] >> (8 - bitDepth - (bitOffset & 7))) & ((1U << bitDepth) - 1);
+			}
+		}
+	}
+
+	std::uint8_t ScaleSample(const std::uint32_t sample, const std::uint32_t bitDepth)
+	{
+		// 1, 2 and 4 bit samples scale to 8 bits exactly by 255, 85 and 17
+		return static_cast<std::uint8_t>(bitDepth == 16 ? sample >> 8 : (bitDepth == 8 ? sample : sample * (255U / ((1U << bitDepth) - 1))));
+	}
+
+	// Converts one reconstructed scanline of width pixels to RGBA8
+	void ExpandRow(const Header& header, const Transparency& transparency, const std::uint8_t* row, const std::uint32_t width, std::uint8_t* rgba)
+	{
+		const auto depth = header._bitDepth;
+
+		if (header._colorType == RGBA && depth == 8)
+		{
+			std::memcpy(rgba, row, width * 4);
+			return;
+		}
+
+		if (header._colorType == RGB && depth == 8 && !transparency._hasKey)
+		{
+			for (auto x = 0U; x < width; ++x)
+			{
+				rgba[x * 4 + 0] = row[x * 3 + 0];
+				rgba[x * 4 + 1] = row[x * 3 + 1];
+				rgba[x * 4 + 2] = row[x * 3 + 2];
+				rgba[x * 4 + 3] = 0xFF;
+			}
+			return;
+		}
+
+		for (auto x = 0U; x < width; ++x)
+		{
+			auto* pixel = rgba + x * 4;
+			switch (header._colorType)
+			{
+				case GRAYSCALE:
+				{
+					const auto sample = ReadSample(row, x, depth);
+					pixel[0] = pixel[1] = pixel[2] = ScaleSample(sample, depth);
+					pixel[3] = transparency._hasKey && sample == transparency._key[0] ? 0 : 0xFF;
+				} break;
+
+				case RGB:
+				{
+					const auto r = ReadSample(row, x * 3 + 0, depth);
+					const auto g = ReadSample(row, x * 3 + 1, depth);
+					const auto b = ReadSample(row, x * 3 + 2, depth);
+					pixel[0] = ScaleSample(r, depth);
+					pixel[1] = ScaleSample(g, depth);
+					pixel[2] = ScaleSample(b, depth);
+					pixel[3] = transparency._hasKey && r == transparency._key[0] && g == transparency._key[1] && b == transparency._key[2] ? 0 : 0xFF;
+				} break;
+
+				case PALETTE:
+				{
+					std::memcpy(pixel, transparency._palette + ReadSample(row, x, depth) * 4, 4);
+				} break;
+
+				case GRAYSCALE_ALPHA:
+				{
+					pixel[0] = pixel[1] = pixel[2] = ScaleSample(ReadSample(row, x * 2, depth), depth);
+					pixel[3] = ScaleSample(ReadSample(row, x * 2 + 1, depth), depth);
+				} break;
+
+				case RGBA:
+				{
+					for (auto channel = 0U; channel < 4; ++channel)
+					{
+						pixel[channel] = ScaleSample(ReadSample(row, x * 4 + channel, depth), depth);
+					}
+				} break;
+			}
+		}
+	}
+}
+
+bool png_reader::ReadInfo(const std::uint8_t* fileData, const size_t fileSize, ImageInfo& outInfo)
+{
+	Header header;
+	if (!ParseHeader(fileData, fileSize, header))
+	{
+		return false;
+	}
+
+	outInfo._width = header._width;
+	outInfo._height = header._height;
+	return true;
+}
+
+bool png_reader::DecodeRGBA(const std::uint8_t* fileData, const size_t fileSize, std::uint8_t* rgbaPixels, const std::uint32_t rowPitch)
+{
+	Header header;
+	if (!ParseHeader(fileData, fileSize, header) || rowPitch < header._width * 4)
+	{
+		return false;
+	}
+
+	Transparency transparency;
+	transparency._hasKey = false;
+	for (auto i = 0U; i < 256; ++i)
+	{
+		transparency._palette[i * 4 + 0] = 0;
+		transparency._palette[i * 4 + 1] = 0;
+		transparency._palette[i * 4 + 2] = 0;
+		transparency._palette[i * 4 + 3] = 0xFF;
+	}
+
+	// Gather the compressed stream, which may be split across any number of IDAT chunks
+	std::vector<std::uint8_t> compressedData;
+	auto hasPalette = false;
+	size_t offset = sizeof(PNG_SIGNATURE);
+	while (offset + 12 <= fileSize)
+	{
+		const auto chunkSize = ReadBigEndian(fileData + offset);
+		const auto* chunkType = fileData + offset + 4;
+		const auto* chunkData = fileData + offset + 8;
+		if (chunkSize > fileSize - offset - 12)
+		{
+			return false;
+		}
+
+		if (std::memcmp(chunkType, "IDAT", 4) == 0)
+		{
+			compressedData.insert(compressedData.end(), chunkData, chunkData + chunkSize);
+		}
+		else if (std::memcmp(chunkType, "PLTE", 4) == 0)
+		{
+			if (chunkSize % 3 != 0 || chunkSize > 256 * 3)
+			{
+				return false;
+			}
+
+			for (auto i = 0U; i < chunkSize / 3; ++i)
+			{
+				std::memcpy(transparency._palette + i * 4, chunkData + i * 3, 3);
+			}
+			hasPalette = true;
+		}
+		else if (std::memcmp(chunkType, "tRNS", 4) == 0)
+		{
+			if (header._colorType == PALETTE)
+			{
+				for (auto i = 0U; i < chunkSize && i < 256; ++i)
+				{
+					transparency._palette[i * 4 + 3] = chunkData[i];
+				}
+			}
+			else if ((header._colorType == GRAYSCALE && chunkSize >= 2) || (header._colorType == RGB && chunkSize >= 6))
+			{
+				for (auto i = 0U; i < header._channelCount; ++i)
+				{
+					transparency._key[i] = static_cast<std::uint16_t>((chunkData[i * 2] << 8) | chunkData[i * 2 + 1]);
+				}
+				transparency._hasKey = true;
+			}
+		}
+		else if (std::memcmp(chunkType, "IEND", 4) == 0)
+		{
+			break;
+		}
+
+		offset += chunkSize + 12;
+	}
+
+	if (compressedData.empty() || (header._colorType == PALETTE && !hasPalette))
+	{
+		return false;
+	}
+
+	// Without interlacing there is a single pass covering the whole image
+	const auto passCount = header._interlaced ? 7U : 1U;
+	std::uint32_t passWidths[7], passHeights[7];
+	size_t filteredSize = 0;
+	for (auto pass = 0U; pass < passCount; ++pass)
+	{
+		passWidths[pass]  = header._interlaced ? GetPassExtent(header._width, ADAM7_X_START[pass], ADAM7_X_STEP[pass]) : header._width;
+		passHeights[pass] = header._interlaced ? GetPassExtent(header._height, ADAM7_Y_START[pass], ADAM7_Y_STEP[pass]) : header._height;
+		if (passWidths[pass] > 0)
+		{
+			filteredSize += static_cast<size_t>(passHeights[pass]) * (GetRowBytes(header, passWidths[pass]) + 1);
+		}
+	}
+
+	std::vector<std::uint8_t> filteredData(filteredSize + INFLATE_OUTPUT_SLACK);
+	Inflater inflater(&compressedData[0], compressedData.size(), &filteredData[0], filteredSize, filteredData.size());
+	if (!inflater.Run())
+	{
+		return false;
+	}
+
+	const auto bytesPerPixel = (std::max)(1U, header._channelCount * header._bitDepth / 8);
+	const auto* filteredRow = &filteredData[0];
+
+	// 8 bit RGBA scanlines are reconstructed straight into the caller's rows, each one the prior of the next
+	if (header._colorType == RGBA && header._bitDepth == 8 && !header._interlaced)
+	{
+		const auto rowBytes = header._width * 4;
+		const std::vector<std::uint8_t> zeroRow(rowBytes, 0);
+		for (auto y = 0U; y < header._height; ++y, filteredRow += rowBytes + 1)
+		{
+			auto* row = rgbaPixels + static_cast<size_t>(y) * rowPitch;
+			const auto* prior = y > 0 ? row - rowPitch : &zeroRow[0];
+			if (!UnfilterRow(filteredRow[0], filteredRow + 1, prior, row, rowBytes, bytesPerPixel))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Everything else is reconstructed into two alternating scanlines and expanded from there
+	const auto maxRowBytes = GetRowBytes(header, header._width);
+	std::vector<std::uint8_t> rows(maxRowBytes * 3, 0);
+	std::vector<std::uint8_t> expandedRow(header._interlaced ? header._width * 4 : 0);
+
+	for (auto pass = 0U; pass < passCount; ++pass)
+	{
+		const auto passWidth = passWidths[pass];
+		if (passWidth == 0 || passHeights[pass] == 0)
+		{
+			continue;
+		}
+
+		const auto rowBytes = GetRowBytes(header, passWidth);
+		auto* zeroRow = &rows[maxRowBytes * 2];
+		auto* prior = zeroRow;
+
+		for (auto y = 0U; y < passHeights[pass]; ++y, filteredRow += rowBytes + 1)
+		{
+			auto* row = &rows[(y & 1) * maxRowBytes];
+			if (!UnfilterRow(filteredRow[0], filteredRow + 1, prior, row, rowBytes, bytesPerPixel))
+			{
+				return false;
+			}
+			prior = row;
+
+			if (!header._interlaced)
+			{
+				ExpandRow(header, transparency, row, passWidth, rgbaPixels + static_cast<size_t>(y) * rowPitch);
+				continue;
+			}
+
+			ExpandRow(header, transparency, row, passWidth, &expandedRow[0]);
+
+			auto* target = rgbaPixels + static_cast<size_t>(ADAM7_Y_START[pass] + y * ADAM7_Y_STEP[pass]) * rowPitch;
+			for (auto x = 0U; x < passWidth; ++x)
+			{
+				std::memcpy(target + (ADAM7_X_START[pass] + x * ADAM7_X_STEP[pass]) * 4, &expandedRow[x * 4], 4);
+			}
+		}
+	}
+
+	return true;
+}
\ No newline at end of file
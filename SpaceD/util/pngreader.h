@@ -0,0 +1,34 @@
+/********************************************************************/
+/** pngreader.h by Alex Koukoulas (C) 2017 All Rights Reserved     **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+
+// Remote Headers
+#include <cstddef>
+#include <cstdint>
+
+namespace png_reader
+{
+	// Largest width or height accepted, D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION, so that no texture that could never 
+	// be created is decoded and a full RGBA image stays well within 32 bit sizes
+	static const std::uint32_t MAX_IMAGE_DIMENSION = 16384U;
+
+	struct ImageInfo
+	{
+		std::uint32_t _width;
+		std::uint32_t _height;
+	};
+
+	// Reads the image dimensions from the header without decoding anything. Fails for images with a side larger 
+	// than MAX_IMAGE_DIMENSION, so callers can size their buffers from the result.
+	bool ReadInfo(const std::uint8_t* fileData, const size_t fileSize, ImageInfo& outInfo);
+
+	// Decodes a PNG of any colour type, bit depth and interlacing to 8 bit RGBA, rows top to bottom, 
+	// straight into rgbaPixels. Rows are written rowPitch bytes apart, which must be at least width * 4, 
+	// so the buffer must hold height * rowPitch bytes. Chunk CRCs and the zlib checksum are not verified.
+	bool DecodeRGBA(const std::uint8_t* fileData, const size_t fileSize, std::uint8_t* rgbaPixels, const std::uint32_t rowPitch);
+}
\ No newline at end of file
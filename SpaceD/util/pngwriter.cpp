@@ -0,0 +1,137 @@
+/********************************************************************/
+/** pngwriter.cpp by Alex Koukoulas (C) 2017 All Rights Reserved   **/
+/** File Description:                                              **/
+/********************************************************************/
+
+// Local Headers
+#include "pngwriter.h"
+
+// Remote Headers
+#include <fstream>
+#include <vector>
+
+namespace
+{
+	static const std::uint32_t MAX_STORED_BLOCK_SIZE = 65535U;
+
+	std::uint32_t Crc32(const std::uint8_t* data, const size_t size, std::uint32_t crc = 0xFFFFFFFFU)
+	{
+		static std::uint32_t table[256];
+		static bool tableInitialized = false;
+
+		if (!tableInitialized)
+		{
+			for (auto i = 0U; i < 256U; ++i)
+			{
+				auto c = i;
+				for (auto k = 0; k < 8; ++k)
+				{
+					c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+				}
+				table[i] = c;
+			}
+			tableInitialized = true;
+		}
+
+		for (size_t i = 0; i < size; ++i)
+		{
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return crc;
+	}
+
+	std::uint32_t Adler32(const std::vector<std::uint8_t>& data)
+	{
+		std::uint32_t a = 1, b = 0;
+		for (const auto byte: data)
+		{
+			a = (a + byte) % 65521U;
+			b = (b + a) % 65521U;
+		}
+		return (b << 16) | a;
+	}
+
+	void AppendBigEndian(std::vector<std::uint8_t>& out, const std::uint32_t value)
+	{
+		out.push_back(static_cast<std::uint8_t>(value >> 24));
+		out.push_back(static_cast<std::uint8_t>(value >> 16));
+		out.push_back(static_cast<std::uint8_t>(value >> 8));
+		out.push_back(static_cast<std::uint8_t>(value));
+	}
+
+	void WriteChunk(std::ofstream& file, const char* type, const std::vector<std::uint8_t>& data)
+	{
+		std::vector<std::uint8_t> chunk;
+		chunk.reserve(data.size() + 12);
+
+		AppendBigEndian(chunk, static_cast<std::uint32_t>(data.size()));
+		chunk.insert(chunk.end(), type, type + 4);
+		chunk.insert(chunk.end(), data.begin(), data.end());
+
+		// The CRC covers the chunk type and data but not the length
+		AppendBigEndian(chunk, Crc32(&chunk[4], chunk.size() - 4) ^ 0xFFFFFFFFU);
+
+		file.write(reinterpret_cast<const char*>(&chunk[0]), chunk.size());
+	}
+}
+
+bool png_writer::WriteRGBA(const std::string& path, const std::uint32_t width, const std::uint32_t height, const std::uint8_t* rgbaPixels)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	static const std::uint8_t PNG_SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	file.write(reinterpret_cast<const char*>(PNG_SIGNATURE), sizeof(PNG_SIGNATURE));
+
+	// 8 bits per channel, colour type 6 (RGBA), default compression and filtering, no interlacing
+	std::vector<std::uint8_t> header;
+	AppendBigEndian(header, width);
+	AppendBigEndian(header, height);
+	header.push_back(8);
+	header.push_back(6);
+	header.push_back(0);
+	header.push_back(0);
+	header.push_back(0);
+	WriteChunk(file, "IHDR", header);
+
+	// Every scanline is prefixed with filter type 0 (none)
+	const auto rowSize = width * 4;
+	std::vector<std::uint8_t> scanlines;
+	scanlines.reserve((rowSize + 1) * height);
+	for (auto y = 0U; y < height; ++y)
+	{
+		scanlines.push_back(0);
+		scanlines.insert(scanlines.end(), rgbaPixels + y * rowSize, rgbaPixels + (y + 1) * rowSize);
+	}
+
+	// zlib stream made of stored deflate blocks
+	std::vector<std::uint8_t> imageData;
+	imageData.reserve(scanlines.size() + (scanlines.size() / MAX_STORED_BLOCK_SIZE + 1) * 5 + 6);
+	imageData.push_back(0x78);
+	imageData.push_back(0x01);
+
+	size_t offset = 0;
+	do
+	{
+		const auto blockSize = static_cast<std::uint32_t>(scanlines.size() - offset < MAX_STORED_BLOCK_SIZE ? scanlines.size() - offset : MAX_STORED_BLOCK_SIZE);
+		const auto finalBlock = offset + blockSize == scanlines.size();
+
+		imageData.push_back(finalBlock ? 1 : 0);
+		imageData.push_back(static_cast<std::uint8_t>(blockSize));
+		imageData.push_back(static_cast<std::uint8_t>(blockSize >> 8));
+		imageData.push_back(static_cast<std::uint8_t>(~blockSize));
+		imageData.push_back(static_cast<std::uint8_t>(~blockSize >> 8));
+		imageData.insert(imageData.end(), scanlines.begin() + offset, scanlines.begin() + offset + blockSize);
+
+		offset += blockSize;
+	} while (offset < scanlines.size());
+
+	AppendBigEndian(imageData, Adler32(scanlines));
+	WriteChunk(file, "IDAT", imageData);
+	WriteChunk(file, "IEND", std::vector<std::uint8_t>());
+
+	return file.good();
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+/********************************************************************/
+/** pngwriter.h by Alex Koukoulas (C) 2017 All Rights Reserved     **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+
+// Remote Headers
+#include <cstdint>
+#include <string>
+
+namespace png_writer
+{
+	// Writes 8 bit RGBA pixels, rows top to bottom, as a PNG. The image data is zlib
+	// wrapped but stored uncompressed, which keeps the writer dependency free and fast.
+	bool WriteRGBA(const std::string& path, const std::uint32_t width, const std::uint32_t height, const std::uint8_t* rgbaPixels);
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+/***********************************************************************/
+/** skylinepacker.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                 **/
+/***********************************************************************/
+
+// Local Headers
+#include "skylinepacker.h"
+
+// Remote Headers
+#include <algorithm>
+
+SkylinePacker::SkylinePacker(const std::uint32_t width, const std::uint32_t height)
+	: _width(width)
+	, _height(height)
+	, _usedWidth(0)
+	, _usedHeight(0)
+{
+	SkylineSegment floorSegment = { 0, 0, width };
+	_skyline.push_back(floorSegment);
+}
+
+bool SkylinePacker::Insert(const std::uint32_t width, const std::uint32_t height, std::uint32_t& outX, std::uint32_t& outY)
+{
+	// Bottom left rule: lowest resulting top edge, then the narrowest segment to keep wide gaps for wide rectangles
+	auto bestIndex = _skyline.size();
+	auto bestTop = UINT32_MAX;
+	auto bestSegmentWidth = UINT32_MAX;
+	auto bestY = 0U;
+
+	for (size_t i = 0; i < _skyline.size(); ++i)
+	{
+		std::uint32_t y;
+		if (!FindRestingHeight(i, width, height, y))
+		{
+			continue;
+		}
+
+		const auto top = y + height;
+		if (top < bestTop || (top == bestTop && _skyline[i]._width < bestSegmentWidth))
+		{
+			bestIndex = i;
+			bestTop = top;
+			bestSegmentWidth = _skyline[i]._width;
+			bestY = y;
+		}
+	}
+
+	if (bestIndex == _skyline.size())
+	{
+		return false;
+	}
+
+	outX = _skyline[bestIndex]._x;
+	outY = bestY;
+
+	// The new rectangle's top becomes a segment, swallowing whatever part of the skyline it now covers
+	SkylineSegment placedSegment = { outX, bestTop, width };
+	_skyline.insert(_skyline.begin() + bestIndex, placedSegment);
+
+	const auto placedRight = outX + width;
+	for (auto i = bestIndex + 1; i < _skyline.size();)
+	{
+		auto& segment = _skyline[i];
+		if (segment._x >= placedRight)
+		{
+			break;
+		}
+
+		const auto segmentRight = segment._x + segment._width;
+		if (segmentRight <= placedRight)
+		{
+			_skyline.erase(_skyline.begin() + i);
+			continue;
+		}
+
+		segment._width = segmentRight - placedRight;
+		segment._x = placedRight;
+		break;
+	}
+
+	// Neighbouring segments at the same height are one and the same ledge
+	for (size_t i = 0; i + 1 < _skyline.size();)
+	{
+		if (_skyline[i]._y == _skyline[i + 1]._y)
+		{
+			_skyline[i]._width += _skyline[i + 1]._width;
+			_skyline.erase(_skyline.begin() + i + 1);
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	_usedWidth = (std::max)(_usedWidth, placedRight);
+	_usedHeight = (std::max)(_usedHeight, bestTop);
+	return true;
+}
+
+std::uint32_t SkylinePacker::GetUsedWidth() const
+{
+	return _usedWidth;
+}
+
+std::uint32_t SkylinePacker::GetUsedHeight() const
+{
+	return _usedHeight;
+}
+
+bool SkylinePacker::FindRestingHeight(const size_t segmentIndex, const std::uint32_t width, const std::uint32_t height, std::uint32_t& outY) const
+{
+	if (_skyline[segmentIndex]._x + width > _width)
+	{
+		return false;
+	}
+
+	// The rectangle rests on the highest segment underneath any part of it
+	auto y = 0U;
+	auto remainingWidth = width;
+	for (auto i = segmentIndex; remainingWidth > 0; ++i)
+	{
+		y = (std::max)(y, _skyline[i]._y);
+		if (y + height > _height)
+		{
+			return false;
+		}
+
+		remainingWidth -= (std::min)(remainingWidth, _skyline[i]._width);
+	}
+
+	outY = y;
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+/*********************************************************************/
+/** skylinepacker.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                               **/
+/*********************************************************************/
+
+#pragma once
+
+// Local Headers
+
+// Remote Headers
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Packs rectangles into a fixed size area by tracking the top edge ("skyline") of everything placed so far,
+// and putting each new rectangle where its top ends up lowest. Space below an overhang is never reclaimed,
+// which wastes a little area compared to max rects but keeps every insertion linear in the skyline length.
+class SkylinePacker final
+{
+public:
+	SkylinePacker(const std::uint32_t width, const std::uint32_t height);
+
+	// False when the rectangle fits nowhere, in which case the packer is left untouched
+	bool Insert(const std::uint32_t width, const std::uint32_t height, std::uint32_t& outX, std::uint32_t& outY);
+
+	// Smallest area, anchored at the origin, that covers every rectangle inserted so far
+	std::uint32_t GetUsedWidth() const;
+	std::uint32_t GetUsedHeight() const;
+
+private:
+	struct SkylineSegment
+	{
+		std::uint32_t _x;
+		std::uint32_t _y;
+		std::uint32_t _width;
+	};
+
+	// The lowest y a rectangle of the given width can rest at when its left edge starts at the segment's, or false when it overflows
+	bool FindRestingHeight(const size_t segmentIndex, const std::uint32_t width, const std::uint32_t height, std::uint32_t& outY) const;
+
+private:
+	const std::uint32_t _width;
+	const std::uint32_t _height;
+
+	std::vector<SkylineSegment> _skyline;
+	std::uint32_t _usedWidth;
+	std::uint32_t _usedHeight;
+};
\ No newline at end of file
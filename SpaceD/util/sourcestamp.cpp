@@ -0,0 +1,28 @@
+/*********************************************************************/
+/** sourcestamp.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                               **/
+/*********************************************************************/
+
+// Local Headers
+#include "sourcestamp.h"
+
+// Remote Headers
+#include <Windows.h>
+
+bool source_stamp::GetStamp(const std::string& sourcePath, Stamp& outStamp)
+{
+	WIN32_FILE_ATTRIBUTE_DATA sourceAttributes;
+	if (!GetFileAttributesEx(sourcePath.c_str(), GetFileExInfoStandard, &sourceAttributes))
+	{
+		return false;
+	}
+
+	outStamp._size = (static_cast<std::uint64_t>(sourceAttributes.nFileSizeHigh) << 32) | sourceAttributes.nFileSizeLow;
+	outStamp._writeTime = (static_cast<std::uint64_t>(sourceAttributes.ftLastWriteTime.dwHighDateTime) << 32) | sourceAttributes.ftLastWriteTime.dwLowDateTime;
+	return true;
+}
+
+bool source_stamp::IsSameStamp(const Stamp& lhs, const Stamp& rhs)
+{
+	return lhs._size == rhs._size && lhs._writeTime == rhs._writeTime;
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+/********************************************************************/
+/** sourcestamp.h by Alex Koukoulas (C) 2017 All Rights Reserved   **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+
+// Remote Headers
+#include <cstdint>
+#include <string>
+
+namespace source_stamp
+{
+	// Size and last write time of a source asset, recorded by the files built from it so that they can 
+	// tell when the source has changed since
+	struct Stamp
+	{
+		std::uint64_t _size;
+		std::uint64_t _writeTime;
+	};
+
+	// False when the source is not a loose file on disk, as when it only ships inside the asset pack
+	bool GetStamp(const std::string& sourcePath, Stamp& outStamp);
+
+	bool IsSameStamp(const Stamp& lhs, const Stamp& rhs);
+}
\ No newline at end of file
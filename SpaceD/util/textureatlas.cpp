@@ -0,0 +1,349 @@
+/**********************************************************************/
+/** textureatlas.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                **/
+/**********************************************************************/
+
+// Local Headers
+#include "textureatlas.h"
+#include "pngreader.h"
+#include "skylinepacker.h"
+#include "virtualfilesystem.h"
+
+// Remote Headers
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+
+namespace
+{
+	static const std::string LAYOUT_FILE_NAME = "atlas_layout.txt";
+	static const std::string ATLAS_FILE_PREFIX = "atlas_";
+	static const std::string ATLAS_FILE_EXTENSION = ".dds";
+
+	static const std::uint32_t TEXTURE_PADDING = 1U << (texture_atlas::ATLAS_MIP_LEVELS - 1);
+	static const std::uint32_t TILE_ALIGNMENT = 4U << (texture_atlas::ATLAS_MIP_LEVELS - 1);
+
+	// A decoded source texture surrounded by its padding, rounded up to whole tile alignments
+	struct AtlasTile
+	{
+		size_t _sourceIndex;
+		std::uint32_t _textureWidth;
+		std::uint32_t _textureHeight;
+		std::uint32_t _width;
+		std::uint32_t _height;
+		std::vector<std::uint8_t> _pixels;
+		source_stamp::Stamp _sourceStamp;
+
+		size_t _atlasIndex;
+		std::uint32_t _x;
+		std::uint32_t _y;
+	};
+
+	std::uint32_t AlignUp(const std::uint32_t value, const std::uint32_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	// Decodes the source and extrudes its edge texels into the padding around it
+	bool LoadTile(const std::string& sourcePath, AtlasTile& outTile, std::string& outError)
+	{
+		if (!source_stamp::GetStamp(sourcePath, outTile._sourceStamp))
+		{
+			outError = "not found";
+			return false;
+		}
+
+		std::vector<std::uint8_t> fileData;
+		{
+			std::ifstream fileStream(sourcePath, std::ios::binary);
+			fileData.assign(std::istreambuf_iterator<char>(fileStream), std::istreambuf_iterator<char>());
+		}
+
+		png_reader::ImageInfo imageInfo;
+		if (fileData.empty() || !png_reader::ReadInfo(&fileData[0], fileData.size(), imageInfo))
+		{
+			outError = "not a PNG";
+			return false;
+		}
+
+		if (imageInfo._width > texture_atlas::MAX_ATLASED_TEXTURE_SIZE || imageInfo._height > texture_atlas::MAX_ATLASED_TEXTURE_SIZE)
+		{
+			outError = "too large for an atlas";
+			return false;
+		}
+
+		if (imageInfo._width % 4 != 0 || imageInfo._height % 4 != 0)
+		{
+			outError = "dimensions are not multiples of 4";
+			return false;
+		}
+
+		const auto rowPitch = imageInfo._width * 4;
+		std::vector<std::uint8_t> pixels(static_cast<size_t>(rowPitch) * imageInfo._height);
+		if (!png_reader::DecodeRGBA(&fileData[0], fileData.size(), &pixels[0], rowPitch))
+		{
+			outError = "decode failed";
+			return false;
+		}
+
+		outTile._textureWidth = imageInfo._width;
+		outTile._textureHeight = imageInfo._height;
+		outTile._width = AlignUp(imageInfo._width + 2 * TEXTURE_PADDING, TILE_ALIGNMENT);
+		outTile._height = AlignUp(imageInfo._height + 2 * TEXTURE_PADDING, TILE_ALIGNMENT);
+		outTile._pixels.resize(static_cast<size_t>(outTile._width) * outTile._height * 4);
+
+		for (auto y = 0U; y < outTile._height; ++y)
+		{
+			const auto sourceY = static_cast<std::uint32_t>((std::min)((std::max)(static_cast<int>(y) - static_cast<int>(TEXTURE_PADDING), 0), static_cast<int>(imageInfo._height) - 1));
+			auto* tileRow = &outTile._pixels[static_cast<size_t>(y) * outTile._width * 4];
+			const auto* sourceRow = &pixels[static_cast<size_t>(sourceY) * rowPitch];
+
+			for (auto x = 0U; x < outTile._width; ++x)
+			{
+				const auto sourceX = static_cast<std::uint32_t>((std::min)((std::max)(static_cast<int>(x) - static_cast<int>(TEXTURE_PADDING), 0), static_cast<int>(imageInfo._width) - 1));
+				std::copy(sourceRow + sourceX * 4, sourceRow + sourceX * 4 + 4, tileRow + x * 4);
+			}
+		}
+
+		return true;
+	}
+}
+
+bool texture_atlas::BuildAtlases(const std::vector<std::string>& sourcePaths, const std::string& outputDirectory, const texture_builder::BuildOptions& options, std::string& outReport)
+{
+	std::stringstream reportStream;
+
+	std::vector<AtlasTile> tiles;
+	for (size_t sourceIndex = 0; sourceIndex < sourcePaths.size(); ++sourceIndex)
+	{
+		AtlasTile tile;
+		std::string error;
+		if (!LoadTile(sourcePaths[sourceIndex], tile, error))
+		{
+			reportStream << sourcePaths[sourceIndex] << ": " << error << ", not atlased\n";
+			continue;
+		}
+
+		tile._sourceIndex = sourceIndex;
+		tiles.push_back(std::move(tile));
+	}
+
+	// Tallest first packs a skyline most tightly. Each atlas gets the smallest square bound that still takes every 
+	// remaining tile, or the largest one filled with as many as fit when none does
+	std::stable_sort(tiles.begin(), tiles.end(), [](const AtlasTile& lhs, const AtlasTile& rhs) { return lhs._height > rhs._height; });
+
+	std::vector<SkylinePacker> packers;
+	std::vector<bool> tilesPlaced(tiles.size(), false);
+	auto remainingTileCount = tiles.size();
+
+	while (remainingTileCount > 0)
+	{
+		auto atlasSize = 0U;
+		for (size_t i = 0; i < tiles.size(); ++i)
+		{
+			if (!tilesPlaced[i]) atlasSize = (std::max)(atlasSize, (std::max)(tiles[i]._width, tiles[i]._height));
+		}
+
+		// Tile positions are only final for the attempt that is kept, which is always the last one
+		std::vector<size_t> fittedTiles;
+		for (;; atlasSize = (std::min)(atlasSize + TILE_ALIGNMENT, MAX_ATLAS_SIZE))
+		{
+			SkylinePacker packer(atlasSize, atlasSize);
+			fittedTiles.clear();
+			for (size_t i = 0; i < tiles.size(); ++i)
+			{
+				if (!tilesPlaced[i] && packer.Insert(tiles[i]._width, tiles[i]._height, tiles[i]._x, tiles[i]._y))
+				{
+					fittedTiles.push_back(i);
+				}
+			}
+
+			if (fittedTiles.size() == remainingTileCount || atlasSize == MAX_ATLAS_SIZE)
+			{
+				packers.push_back(packer);
+				break;
+			}
+		}
+
+		for (const auto tileIndex: fittedTiles)
+		{
+			tiles[tileIndex]._atlasIndex = packers.size() - 1;
+			tilesPlaced[tileIndex] = true;
+		}
+		remainingTileCount -= fittedTiles.size();
+	}
+
+	// Tiles keep their top levels apart, so each one's own mip chain is copied into the atlas levels rather than 
+	// filtering across the whole atlas and bleeding neighbours into each other
+	AtlasLayout layout;
+	std::vector<std::string> atlasFileNames;
+	auto succeeded = true;
+
+	for (size_t atlasIndex = 0; atlasIndex < packers.size(); ++atlasIndex)
+	{
+		const auto atlasWidth = packers[atlasIndex].GetUsedWidth();
+		const auto atlasHeight = packers[atlasIndex].GetUsedHeight();
+
+		std::vector<mip_generator::MipLevel> atlasMipChain(ATLAS_MIP_LEVELS);
+		for (auto level = 0U; level < ATLAS_MIP_LEVELS; ++level)
+		{
+			atlasMipChain[level]._width = atlasWidth >> level;
+			atlasMipChain[level]._height = atlasHeight >> level;
+			atlasMipChain[level]._pixels.assign(static_cast<size_t>(atlasMipChain[level]._width) * atlasMipChain[level]._height * 4, 0);
+		}
+
+		const auto atlasFileName = ATLAS_FILE_PREFIX + std::to_string(atlasIndex) + ATLAS_FILE_EXTENSION;
+		auto atlasTextureCount = 0U;
+		auto atlasUsedArea = 0.0;
+
+		for (const auto& tile: tiles)
+		{
+			if (tile._atlasIndex != atlasIndex)
+			{
+				continue;
+			}
+
+			const auto tileMipChain = mip_generator::GenerateMipChain(&tile._pixels[0], tile._width, tile._height, tile._width * 4, options._mipFilter);
+			for (auto level = 0U; level < ATLAS_MIP_LEVELS; ++level)
+			{
+				const auto& tileLevel = tileMipChain[level];
+				auto& atlasLevel = atlasMipChain[level];
+				for (auto y = 0U; y < tileLevel._height; ++y)
+				{
+					const auto* tileRow = &tileLevel._pixels[static_cast<size_t>(y) * tileLevel._width * 4];
+					auto* atlasRow = &atlasLevel._pixels[(static_cast<size_t>((tile._y >> level) + y) * atlasLevel._width + (tile._x >> level)) * 4];
+					std::copy(tileRow, tileRow + tileLevel._width * 4, atlasRow);
+				}
+			}
+
+			AtlasRegion region;
+			region._atlasPath = outputDirectory + atlasFileName;
+			region._texcoordOffset[0] = static_cast<float>(tile._x + TEXTURE_PADDING) / atlasWidth;
+			region._texcoordOffset[1] = static_cast<float>(tile._y + TEXTURE_PADDING) / atlasHeight;
+			region._texcoordScale[0] = static_cast<float>(tile._textureWidth) / atlasWidth;
+			region._texcoordScale[1] = static_cast<float>(tile._textureHeight) / atlasHeight;
+			region._sourceStamp = tile._sourceStamp;
+			layout._regions[sourcePaths[tile._sourceIndex]] = region;
+
+			atlasTextureCount++;
+			atlasUsedArea += static_cast<double>(tile._textureWidth) * tile._textureHeight;
+		}
+
+		std::string writeReport;
+		if (!texture_builder::WriteMipChain(atlasMipChain, options, outputDirectory + atlasFileName, nullptr, writeReport))
+		{
+			reportStream << outputDirectory << atlasFileName << ": " << writeReport << "\n";
+			succeeded = false;
+			continue;
+		}
+
+		atlasFileNames.push_back(atlasFileName);
+		reportStream << outputDirectory << atlasFileName << ": " << atlasTextureCount << " textures, " << writeReport << ", "
+		             << static_cast<int>(100.0 * atlasUsedArea / (static_cast<double>(atlasWidth) * atlasHeight)) << "% covered by textures\n";
+	}
+
+	// The layout is rewritten even when nothing was atlased so a stale one never outlives its atlases
+	std::ofstream layoutStream(GetLayoutPath(outputDirectory));
+	if (!layoutStream.is_open())
+	{
+		outReport = reportStream.str() + "could not write " + GetLayoutPath(outputDirectory);
+		return false;
+	}
+
+	layoutStream << "# atlas <file name>\n";
+	layoutStream << "# region <atlas file name> <texcoord offset u> <texcoord offset v> <texcoord scale u> <texcoord scale v> <source size> <source write time> <source texture path>\n";
+	for (const auto& atlasFileName: atlasFileNames)
+	{
+		layoutStream << "atlas " << atlasFileName << "\n";
+	}
+
+	layoutStream << std::setprecision(9);
+	for (const auto& regionEntry: layout._regions)
+	{
+		const auto& region = regionEntry.second;
+		const auto atlasFileName = region._atlasPath.substr(outputDirectory.size());
+		if (std::find(atlasFileNames.begin(), atlasFileNames.end(), atlasFileName) == atlasFileNames.end())
+		{
+			continue;
+		}
+
+		layoutStream << "region " << atlasFileName << " " << region._texcoordOffset[0] << " " << region._texcoordOffset[1] << " " 
+		             << region._texcoordScale[0] << " " << region._texcoordScale[1] << " " << region._sourceStamp._size << " " << region._sourceStamp._writeTime << " " 
+		             << regionEntry.first << "\n";
+	}
+
+	outReport = reportStream.str();
+	return succeeded;
+}
+
+std::string texture_atlas::GetLayoutPath(const std::string& outputDirectory)
+{
+	return outputDirectory + LAYOUT_FILE_NAME;
+}
+
+bool texture_atlas::ReadLayout(const std::string& layoutPath, AtlasLayout& outLayout)
+{
+	const VirtualFile layoutFile(layoutPath);
+	if (!layoutFile.IsOpen())
+	{
+		return false;
+	}
+
+	const auto directoryEnd = layoutPath.find_last_of("/\\");
+	const auto layoutDirectory = directoryEnd == std::string::npos ? std::string() : layoutPath.substr(0, directoryEnd + 1);
+
+	// The layout is written in text mode, so its lines end in CRLF, which raw bytes keep
+	std::istringstream layoutStream(std::string(reinterpret_cast<const char*>(layoutFile.GetData()), layoutFile.GetSize()));
+	std::vector<std::string> presentAtlasFileNames;
+	std::string line;
+	while (std::getline(layoutStream, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+
+		std::istringstream lineStream(line);
+		std::string entryType;
+		lineStream >> entryType;
+
+		if (entryType == "atlas")
+		{
+			std::string atlasFileName;
+			lineStream >> atlasFileName;
+			if (VirtualFileSystem::Get().Exists(layoutDirectory + atlasFileName))
+			{
+				presentAtlasFileNames.push_back(atlasFileName);
+			}
+		}
+		else if (entryType == "region")
+		{
+			std::string atlasFileName;
+			AtlasRegion region;
+			lineStream >> atlasFileName >> region._texcoordOffset[0] >> region._texcoordOffset[1] >> region._texcoordScale[0] >> region._texcoordScale[1]
+			           >> region._sourceStamp._size >> region._sourceStamp._writeTime;
+
+			// Layouts written before sources were stamped fail here and lose all their regions
+			std::string sourcePath;
+			std::getline(lineStream >> std::ws, sourcePath);
+			if (!lineStream || sourcePath.empty() || std::find(presentAtlasFileNames.begin(), presentAtlasFileNames.end(), atlasFileName) == presentAtlasFileNames.end())
+			{
+				continue;
+			}
+
+			source_stamp::Stamp sourceStamp;
+			if (source_stamp::GetStamp(sourcePath, sourceStamp) && !source_stamp::IsSameStamp(sourceStamp, region._sourceStamp))
+			{
+				OutputDebugString(("Stale atlas region: " + sourcePath + " changed since " + atlasFileName + " was built\n").c_str());
+				continue;
+			}
+
+			region._atlasPath = layoutDirectory + atlasFileName;
+			outLayout._regions[sourcePath] = region;
+		}
+	}
+
+	return true;
+}
\ No newline at end of file
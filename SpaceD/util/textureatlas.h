@@ -0,0 +1,56 @@
+/********************************************************************/
+/** textureatlas.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "sourcestamp.h"
+#include "texturebuilder.h"
+
+// Remote Headers
+#include <map>
+#include <string>
+#include <vector>
+
+namespace texture_atlas
+{
+	// Where a source texture ended up: texcoords addressing the source map to offset + texcoord * scale in the atlas
+	struct AtlasRegion
+	{
+		std::string _atlasPath;
+		float _texcoordOffset[2];
+		float _texcoordScale[2];
+
+		// The source texture as it was when atlased
+		source_stamp::Stamp _sourceStamp;
+	};
+
+	// Regions keyed by the path of the source texture, exactly as it was handed to BuildAtlases
+	struct AtlasLayout
+	{
+		std::map<std::string, AtlasRegion> _regions;
+	};
+
+	// Textures with a side larger than this keep a texture of their own
+	static const std::uint32_t MAX_ATLASED_TEXTURE_SIZE = 1024U;
+	static const std::uint32_t MAX_ATLAS_SIZE = 4096U;
+
+	// Atlases stop at this many mips: every texture is padded by 2^(ATLAS_MIP_LEVELS - 1) edge texels and placed on 
+	// 4 * 2^(ATLAS_MIP_LEVELS - 1) texel boundaries, so neither bilinear filtering nor a compressed block of any 
+	// kept level reaches into a neighbour
+	static const std::uint32_t ATLAS_MIP_LEVELS = 4U;
+
+	// Packs the PNG textures at sourcePaths into as few atlases as fit, and writes them as mip mapped, block compressed 
+	// atlas_<n>.dds textures to outputDirectory together with the layout file describing them. Sources that fail to
+	// decode, are too large or are not multiples of 4 are left out of the atlases. outReport describes the result.
+	bool BuildAtlases(const std::vector<std::string>& sourcePaths, const std::string& outputDirectory, const texture_builder::BuildOptions& options, std::string& outReport);
+
+	// Path of the layout file BuildAtlases writes to outputDirectory
+	std::string GetLayoutPath(const std::string& outputDirectory);
+
+	// Reads a layout file written by BuildAtlases. Regions of atlases that no longer exist on disk are dropped, and so are
+	// regions whose source texture is on disk and has changed since, so that its model goes back to the texture itself.
+	bool ReadLayout(const std::string& layoutPath, AtlasLayout& outLayout);
+}
\ No newline at end of file
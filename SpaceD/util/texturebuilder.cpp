@@ -0,0 +1,148 @@
+/************************************************************************/
+/** texturebuilder.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                  **/
+/************************************************************************/
+
+// Local Headers
+#include "texturebuilder.h"
+#include "ddsfile.h"
+#include "pngreader.h"
+
+// Remote Headers
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+	static const std::string BUILT_TEXTURE_EXTENSION = ".dds";
+
+	const char* GetFormatName(const block_compressor::BlockFormat format)
+	{
+		switch (format)
+		{
+			case block_compressor::BlockFormat::BC1: return "BC1";
+			case block_compressor::BlockFormat::BC3: return "BC3";
+			default: return "BC7";
+		}
+	}
+}
+
+std::string texture_builder::GetBuiltTexturePath(const std::string& sourcePath)
+{
+	const auto extensionStart = sourcePath.find_last_of('.');
+	const auto directoryEnd = sourcePath.find_last_of("/\\");
+	if (extensionStart == std::string::npos || (directoryEnd != std::string::npos && extensionStart < directoryEnd))
+	{
+		return sourcePath + BUILT_TEXTURE_EXTENSION;
+	}
+
+	return sourcePath.substr(0, extensionStart) + BUILT_TEXTURE_EXTENSION;
+}
+
+bool texture_builder::BuildTexture(const std::string& sourcePath, const BuildOptions& options, std::string& outReport)
+{
+	const auto buildStart = std::chrono::high_resolution_clock::now();
+	std::stringstream reportStream;
+	reportStream << sourcePath << ": ";
+
+	// Stamped before reading, so that a source changed while building reads as stale
+	source_stamp::Stamp sourceStamp;
+	if (!source_stamp::GetStamp(sourcePath, sourceStamp))
+	{
+		outReport = reportStream.str() + "not found";
+		return false;
+	}
+
+	std::vector<std::uint8_t> fileData;
+	{
+		std::ifstream fileStream(sourcePath, std::ios::binary);
+		fileData.assign(std::istreambuf_iterator<char>(fileStream), std::istreambuf_iterator<char>());
+	}
+
+	png_reader::ImageInfo imageInfo;
+	if (fileData.empty() || !png_reader::ReadInfo(&fileData[0], fileData.size(), imageInfo))
+	{
+		outReport = reportStream.str() + "not a PNG";
+		return false;
+	}
+
+	// D3D11 only accepts block compressed textures whose top level is made of whole blocks
+	if (imageInfo._width % 4 != 0 || imageInfo._height % 4 != 0)
+	{
+		outReport = reportStream.str() + "dimensions are not multiples of 4";
+		return false;
+	}
+
+	const auto rowPitch = imageInfo._width * 4;
+	std::vector<std::uint8_t> pixels(static_cast<size_t>(rowPitch) * imageInfo._height);
+	if (!png_reader::DecodeRGBA(&fileData[0], fileData.size(), &pixels[0], rowPitch))
+	{
+		outReport = reportStream.str() + "decode failed";
+		return false;
+	}
+
+	const auto mipChain = mip_generator::GenerateMipChain(&pixels[0], imageInfo._width, imageInfo._height, rowPitch, options._mipFilter);
+
+	std::string writeReport;
+	if (!WriteMipChain(mipChain, options, GetBuiltTexturePath(sourcePath), &sourceStamp, writeReport))
+	{
+		outReport = reportStream.str() + writeReport;
+		return false;
+	}
+
+	const auto buildEnd = std::chrono::high_resolution_clock::now();
+	reportStream << writeReport << " in " << std::chrono::duration<float, std::milli>(buildEnd - buildStart).count() << "ms";
+	outReport = reportStream.str();
+	return true;
+}
+
+bool texture_builder::WriteMipChain(const std::vector<mip_generator::MipLevel>& mipChain, const BuildOptions& options, const std::string& builtPath, 
+                                    const source_stamp::Stamp* sourceStamp, std::string& outReport)
+{
+	if (mipChain.empty() || mipChain[0]._width % 4 != 0 || mipChain[0]._height % 4 != 0)
+	{
+		outReport = "top level dimensions are not multiples of 4";
+		return false;
+	}
+
+	const auto& topLevel = mipChain[0];
+
+	auto format = options._format;
+	if (!options._forceFormat)
+	{
+		auto opaque = true;
+		for (size_t i = 3; i < topLevel._pixels.size() && opaque; i += 4)
+		{
+			opaque = topLevel._pixels[i] == 0xFF;
+		}
+		format = opaque ? block_compressor::BlockFormat::BC1 : block_compressor::BlockFormat::BC7;
+	}
+
+	std::vector<std::vector<std::uint8_t>> compressedMipChain(mipChain.size());
+	auto uncompressedSize = size_t(0);
+	auto compressedSize = size_t(0);
+	for (size_t level = 0; level < mipChain.size(); ++level)
+	{
+		const auto& mipLevel = mipChain[level];
+		compressedMipChain[level].resize(block_compressor::GetCompressedSize(mipLevel._width, mipLevel._height, format));
+		block_compressor::CompressImage(&mipLevel._pixels[0], mipLevel._width, mipLevel._height, mipLevel._width * 4, format, &compressedMipChain[level][0]);
+
+		uncompressedSize += mipLevel._pixels.size();
+		compressedSize += compressedMipChain[level].size();
+	}
+
+	if (!dds_file::Write(builtPath, format, topLevel._width, topLevel._height, compressedMipChain, sourceStamp))
+	{
+		outReport = "could not write " + builtPath;
+		return false;
+	}
+
+	std::stringstream reportStream;
+	reportStream << topLevel._width << "x" << topLevel._height << " " << GetFormatName(format) << ", " << mipChain.size() << " mips, " 
+	             << uncompressedSize / 1024 << "KB -> " << compressedSize / 1024 << "KB";
+	outReport = reportStream.str();
+	return true;
+}
\ No newline at end of file
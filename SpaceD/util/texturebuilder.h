@@ -0,0 +1,41 @@
+/**********************************************************************/
+/** texturebuilder.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                **/
+/**********************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "blockcompressor.h"
+#include "mipgenerator.h"
+#include "sourcestamp.h"
+
+// Remote Headers
+#include <string>
+#include <vector>
+
+namespace texture_builder
+{
+	struct BuildOptions
+	{
+		mip_generator::MipFilter _mipFilter;
+
+		// Without a forced format opaque textures become BC1 and the rest BC7
+		bool _forceFormat;
+		block_compressor::BlockFormat _format;
+	};
+
+	// Path of the built texture for a source texture: the same path with a .dds extension
+	std::string GetBuiltTexturePath(const std::string& sourcePath);
+
+	// Decodes a PNG, generates its mip chain, block compresses every level and writes the result to 
+	// GetBuiltTexturePath, stamped with the PNG's size and write time. outReport describes the result 
+	// or why building failed.
+	bool BuildTexture(const std::string& sourcePath, const BuildOptions& options, std::string& outReport);
+
+	// Block compresses an already generated mip chain and writes it to builtPath, for builds that assemble
+	// their levels themselves. sourceStamp is recorded in the texture when given. outReport describes the 
+	// written texture or why writing failed.
+	bool WriteMipChain(const std::vector<mip_generator::MipLevel>& mipChain, const BuildOptions& options, const std::string& builtPath, 
+	                   const source_stamp::Stamp* sourceStamp, std::string& outReport);
+}
\ No newline at end of file
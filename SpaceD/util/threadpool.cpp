@@ -0,0 +1,121 @@
+/********************************************************************/
+/** threadpool.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                              **/
+/********************************************************************/
+
+// Local Headers
+#include "threadpool.h"
+
+// Remote Headers
+#include <atomic>
+
+ThreadPool::ThreadPool(const UINT workerCount)
+	: _shuttingDown(false)
+{
+	auto targetWorkerCount = workerCount;
+	if (targetWorkerCount == 0)
+	{
+		targetWorkerCount = std::thread::hardware_concurrency();
+		targetWorkerCount = targetWorkerCount > 0 ? targetWorkerCount : 1;
+	}
+
+	for (auto i = 0U; i < targetWorkerCount; ++i)
+	{
+		_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(_jobsMutex);
+		_shuttingDown = true;
+	}
+
+	_jobsAvailable.notify_all();
+
+	for (auto& worker: _workers)
+	{
+		worker.join();
+	}
+}
+
+UINT ThreadPool::GetWorkerCount() const
+{
+	return static_cast<UINT>(_workers.size());
+}
+
+void ThreadPool::Submit(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(_jobsMutex);
+		_jobs.push_back(std::move(job));
+	}
+
+	_jobsAvailable.notify_one();
+}
+
+void ThreadPool::ParallelFor(const UINT taskCount, const std::function<void(const UINT)>& task)
+{
+	if (taskCount == 0)
+	{
+		return;
+	}
+
+	// Workers and the calling thread pull task indices from a shared counter until they run out
+	std::atomic<UINT> nextTaskIndex(0);
+	const auto runTasks = [&nextTaskIndex, taskCount, &task]()
+	{
+		for (auto taskIndex = nextTaskIndex++; taskIndex < taskCount; taskIndex = nextTaskIndex++)
+		{
+			task(taskIndex);
+		}
+	};
+
+	const auto helperCount = taskCount - 1 < GetWorkerCount() ? taskCount - 1 : GetWorkerCount();
+	
+	std::mutex helpersMutex;
+	std::condition_variable helpersFinished;
+	auto finishedHelperCount = 0U;
+
+	for (auto i = 0U; i < helperCount; ++i)
+	{
+		Submit([&runTasks, &helpersMutex, &helpersFinished, &finishedHelperCount]()
+		{
+			runTasks();
+
+			std::lock_guard<std::mutex> lock(helpersMutex);
+			finishedHelperCount++;
+			helpersFinished.notify_one();
+		});
+	}
+
+	runTasks();
+
+	// Helpers reference this stack frame, so wait for every one of them to exit and not just for the tasks to finish
+	std::unique_lock<std::mutex> lock(helpersMutex);
+	helpersFinished.wait(lock, [&finishedHelperCount, helperCount]() { return finishedHelperCount == helperCount; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+	for (;;)
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock(_jobsMutex);
+			_jobsAvailable.wait(lock, [this]() { return _shuttingDown || !_jobs.empty(); });
+
+			if (_jobs.empty())
+			{
+				return;
+			}
+
+			job = std::move(_jobs.front());
+			_jobs.pop_front();
+		}
+
+		job();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+/********************************************************************/
+/** threadpool.h by Alex Koukoulas (C) 2017 All Rights Reserved    **/
+/** File Description:                                              **/
+/********************************************************************/
+
+#pragma once
+
+// Local Headers
+
+// Remote Headers
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef unsigned int UINT;
+
+// Fixed set of worker threads consuming a shared job queue
+class ThreadPool final
+{
+public:
+	// A worker count of zero creates one worker per hardware thread
+	ThreadPool(const UINT workerCount = 0);
+	~ThreadPool();
+
+	UINT GetWorkerCount() const;
+
+	// Queues a job to run on one of the workers
+	void Submit(std::function<void()> job);
+
+	// Runs task(i) for every i in [0, taskCount) on the workers and the calling thread, 
+	// returning once all of them have completed. Must not be called from inside a job.
+	void ParallelFor(const UINT taskCount, const std::function<void(const UINT)>& task);
+
+private:
+	ThreadPool(const ThreadPool& rhs) = delete;
+	ThreadPool& operator = (const ThreadPool& rhs) = delete;
+
+	void WorkerLoop();
+
+private:
+	std::vector<std::thread> _workers;
+	std::deque<std::function<void()>> _jobs;
+	std::mutex _jobsMutex;
+	std::condition_variable _jobsAvailable;
+	bool _shuttingDown;
+};
\ No newline at end of file
@@ -0,0 +1,122 @@
+/***************************************************************************/
+/** virtualfilesystem.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                     **/
+/***************************************************************************/
+
+// Local Headers
+#include "virtualfilesystem.h"
+#include "assetpack.h"
+#include "sourcestamp.h"
+
+// Remote Headers
+
+VirtualFileSystem& VirtualFileSystem::Get()
+{
+	static VirtualFileSystem instance;
+	return instance;
+}
+
+VirtualFileSystem::VirtualFileSystem()
+	: _packedFileCount(0)
+{
+}
+
+VirtualFileSystem::~VirtualFileSystem()
+{
+}
+
+bool VirtualFileSystem::Mount(const std::string& packPath, const std::string& rootDirectory)
+{
+	auto pack = std::make_unique<MappedFile>(packPath);
+	if (!pack->IsOpen() || !asset_pack::ValidatePack(pack->GetData(), pack->GetSize()))
+	{
+		return false;
+	}
+
+	_packedFileCount = reinterpret_cast<const asset_pack::PackHeader*>(pack->GetData())->_entryCount;
+	_rootDirectory = rootDirectory;
+	_pack = std::move(pack);
+
+	OutputDebugString((std::string("Mounted asset pack: ") + packPath + " with " + std::to_string(_packedFileCount) + " files under " + _rootDirectory + "\n").c_str());
+	return true;
+}
+
+bool VirtualFileSystem::IsMounted() const
+{
+	return _pack != nullptr;
+}
+
+UINT VirtualFileSystem::GetPackedFileCount() const
+{
+	return _packedFileCount;
+}
+
+bool VirtualFileSystem::FindPackedFile(const std::string& path, const std::uint8_t*& outData, size_t& outSize) const
+{
+	if (!_pack)
+	{
+		return false;
+	}
+
+	const auto* entry = asset_pack::FindEntry(_pack->GetData(), asset_pack::GetEntryName(_rootDirectory, path));
+	if (!entry)
+	{
+		return false;
+	}
+
+	// A loose copy that was edited after packing is read instead, the same file the built asset stamp checks look at
+	source_stamp::Stamp looseStamp;
+	if (source_stamp::GetStamp(path, looseStamp) && !source_stamp::IsSameStamp(looseStamp, entry->_sourceStamp))
+	{
+		return false;
+	}
+
+	outData = _pack->GetData() + entry->_dataOffset;
+	outSize = static_cast<size_t>(entry->_dataSize);
+	return true;
+}
+
+bool VirtualFileSystem::Exists(const std::string& path) const
+{
+	const std::uint8_t* data;
+	size_t size;
+	return FindPackedFile(path, data, size) || GetFileAttributes(path.c_str()) != INVALID_FILE_ATTRIBUTES;
+}
+
+VirtualFile::VirtualFile(const std::string& path)
+	: _data(nullptr)
+	, _size(0)
+{
+	if (VirtualFileSystem::Get().FindPackedFile(path, _data, _size))
+	{
+		return;
+	}
+
+	_looseFile = std::make_unique<MappedFile>(path);
+	_data = _looseFile->GetData();
+	_size = _looseFile->GetSize();
+}
+
+VirtualFile::~VirtualFile()
+{
+}
+
+bool VirtualFile::IsOpen() const
+{
+	return _data != nullptr && _size > 0;
+}
+
+bool VirtualFile::IsPacked() const
+{
+	return _data != nullptr && !_looseFile;
+}
+
+const std::uint8_t* VirtualFile::GetData() const
+{
+	return _data;
+}
+
+size_t VirtualFile::GetSize() const
+{
+	return _size;
+}
\ No newline at end of file
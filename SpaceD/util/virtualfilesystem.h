@@ -0,0 +1,77 @@
+/*************************************************************************/
+/** virtualfilesystem.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                   **/
+/*************************************************************************/
+
+#pragma once
+
+// Local Headers
+#include "mappedfile.h"
+
+// Remote Headers
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Where asset files are read from. With a pack mounted (see asset_pack::Build), files under its root directory are 
+// found through the pack's table of contents and read straight out of its single mapping, costing an attribute query 
+// but no open of their own. The pack records the stamp each file had when it was packed, and a loose copy whose stamp 
+// differs, i.e. one edited since, is read from disk instead, so an out of date pack never hides an edit. Anything 
+// missing from the pack, or every file when none is mounted, is read loose as well.
+class VirtualFileSystem final
+{
+public:
+	static VirtualFileSystem& Get();
+
+	~VirtualFileSystem();
+
+	// Paths under rootDirectory are looked up in the pack at packPath from then on. False, leaving every file loose, 
+	// when the pack is missing or malformed. Must happen before the first file is opened, as lookups take no lock.
+	bool Mount(const std::string& packPath, const std::string& rootDirectory);
+
+	bool IsMounted() const;
+	UINT GetPackedFileCount() const;
+
+	// The file's bytes within the mounted pack. False when nothing is mounted, the file is not in it, or 
+	// its loose copy has been edited since it was packed.
+	bool FindPackedFile(const std::string& path, const std::uint8_t*& outData, size_t& outSize) const;
+
+	// Whether the file is in the mounted pack or on disk
+	bool Exists(const std::string& path) const;
+
+private:
+	VirtualFileSystem();
+
+	VirtualFileSystem(const VirtualFileSystem& rhs) = delete;
+	VirtualFileSystem& operator = (const VirtualFileSystem& rhs) = delete;
+
+private:
+	std::unique_ptr<MappedFile> _pack;
+	std::string _rootDirectory;
+	UINT _packedFileCount;
+};
+
+// Read only view of a file opened through the virtual file system: a span into the mounted pack when the file
+// is packed and up to date, the loose file mapped on its own otherwise. Packed views stay valid for as long as the process runs.
+class VirtualFile final
+{
+public:
+	VirtualFile(const std::string& path);
+	~VirtualFile();
+
+	// False when the file is neither packed nor on disk, or is empty
+	bool IsOpen() const;
+	bool IsPacked() const;
+
+	const std::uint8_t* GetData() const;
+	size_t GetSize() const;
+
+private:
+	VirtualFile(const VirtualFile& rhs) = delete;
+	VirtualFile& operator = (const VirtualFile& rhs) = delete;
+
+private:
+	std::unique_ptr<MappedFile> _looseFile;
+	const std::uint8_t* _data;
+	size_t _size;
+};
\ No newline at end of file
@@ -0,0 +1,70 @@
+/*************************************************************************/
+/** workpartitioner.cpp by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                   **/
+/*************************************************************************/
+
+// Local Headers
+#include "workpartitioner.h"
+
+// Remote Headers
+#include <cassert>
+
+namespace work_partitioner
+{
+	std::vector<Range> PartitionByCost(const std::vector<UINT>& itemCosts, const UINT maxPartitionCount, const UINT minPartitionCost)
+	{
+		std::vector<Range> ranges;
+
+		const auto itemCount = static_cast<UINT>(itemCosts.size());
+		if (itemCount == 0 || maxPartitionCount == 0)
+		{
+			return ranges;
+		}
+
+		unsigned long long totalCost = 0;
+		for (const auto cost: itemCosts)
+		{
+			totalCost += cost;
+		}
+
+		auto partitionCount = maxPartitionCount;
+		if (minPartitionCost > 0)
+		{
+			const auto affordablePartitionCount = totalCost / minPartitionCost;
+			partitionCount = affordablePartitionCount < partitionCount ? static_cast<UINT>(affordablePartitionCount) : partitionCount;
+		}
+		partitionCount = partitionCount < itemCount ? partitionCount : itemCount;
+		partitionCount = partitionCount > 0 ? partitionCount : 1;
+
+		// Close the k-th range as soon as the running cost reaches k/partitionCount of the total. Comparing
+		// against the ideal prefix rather than a per range budget keeps rounding errors from piling up on the last range.
+		ranges.reserve(partitionCount);
+
+		Range currentRange = { 0, 0 };
+		unsigned long long runningCost = 0;
+		for (auto i = 0U; i < itemCount; ++i)
+		{
+			runningCost += itemCosts[i];
+			currentRange._end = i + 1;
+
+			const auto closedRangeCount = static_cast<UINT>(ranges.size()) + 1;
+			const auto remainingItems = itemCount - currentRange._end;
+			const auto remainingRanges = partitionCount - closedRangeCount;
+			if (closedRangeCount == partitionCount || remainingItems < remainingRanges)
+			{
+				continue;
+			}
+
+			if (runningCost * partitionCount >= totalCost * closedRangeCount || remainingItems == remainingRanges)
+			{
+				ranges.push_back(currentRange);
+				currentRange._begin = currentRange._end;
+			}
+		}
+
+		ranges.push_back(currentRange);
+
+		assert(ranges.size() <= partitionCount && ranges.back()._end == itemCount);
+		return ranges;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+/***********************************************************************/
+/** workpartitioner.h by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                                 **/
+/***********************************************************************/
+
+#pragma once
+
+// Local Headers
+
+// Remote Headers
+#include <vector>
+
+typedef unsigned int UINT;
+
+namespace work_partitioner
+{
+	// Half open range [_begin, _end) of work item indices
+	struct Range
+	{
+		UINT _begin;
+		UINT _end;
+	};
+
+	// Splits the ordered work items into at most maxPartitionCount contiguous, non empty ranges of
+	// roughly equal total cost, preserving item order. Fewer ranges are produced when a range would
+	// cost less than minPartitionCost, so that small workloads are not spread over threads needlessly.
+	std::vector<Range> PartitionByCost(const std::vector<UINT>& itemCosts, const UINT maxPartitionCount, const UINT minPartitionCost);
+}
\ No newline at end of file
@@ -14,9 +14,17 @@ struct VertexIn
 {
 	float3 PosL    : POSITION;	
 	float2 TexcoordL: TEXCOORD;
+#ifdef PACKED_VERTEX
+	float2 NormalL : NORMAL;
+#else
 	float3 NormalL : NORMAL;
+#endif
 };
 
+#ifdef PACKED_VERTEX
+#include "octdecode.hlsli"
+#endif
+
 struct VertexOut
 {
 	float4 PosH    : SV_POSITION;
@@ -28,10 +36,16 @@ struct VertexOut
 VertexOut VS(VertexIn vin)
 {
 	VertexOut vout;
+
+#ifdef PACKED_VERTEX
+	float3 normalL = OctDecode(vin.NormalL);
+#else
+	float3 normalL = vin.NormalL;
+#endif
 	
 	// Transform to world space space.
 	vout.PosW    = mul(gWorld, float4(vin.PosL, 1.0f)).xyz;
-	vout.NormalW = mul((float3x3)gWorldInvTranspose, vin.NormalL);
+	vout.NormalW = mul((float3x3)gWorldInvTranspose, normalL);
 		
 	// Transform to homogeneous clip space.
 	vout.PosH = mul(gWorldViewProj, float4(vin.PosL, 1.0f));
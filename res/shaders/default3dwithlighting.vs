@@ -49,19 +49,23 @@ struct SpotLight
 	float pad;
 };
 
-cbuffer cbPerObject
+cbuffer cbPerObject : register(b0)
 {
 	float4x4 gWorld;                
 	float4x4 gWorldInvTranspose;    
-	float4x4 gWorldViewProj;	    
 	Material gMaterial;             
+}; 
+
+cbuffer cbPerFrame : register(b1)
+{
+	float4x4 gViewProj;
 	DirectionalLight gDirectionalLights[4];     
-	PointLight gPointLights[16];         
 	SpotLight gSpotLight;           
 	float3 gEyePosW;
 	int gDirectionalLightCount;
-	int gPointLightCount; 
-	float3 gPad;
+	float2 gClusterScreenToTile;    // Cluster tiles per pixel
+	float gClusterDepthScale;       // Depth slice = log(view depth) * scale + bias
+	float gClusterDepthBias;
 }; 
 
 
@@ -69,9 +73,17 @@ struct VertexIn
 {
 	float3 PosL    : POSITION;	
 	float2 TexcoordL: TEXCOORD;
+#ifdef PACKED_VERTEX
+	float2 NormalL : NORMAL;
+#else
 	float3 NormalL : NORMAL;
+#endif
 };
 
+#ifdef PACKED_VERTEX
+#include "octdecode.hlsli"
+#endif
+
 struct VertexOut
 {
 	float4 PosH    : SV_POSITION;
@@ -83,13 +95,19 @@ struct VertexOut
 VertexOut VS(VertexIn vin)
 {
 	VertexOut vout;
+
+#ifdef PACKED_VERTEX
+	float3 normalL = OctDecode(vin.NormalL);
+#else
+	float3 normalL = vin.NormalL;
+#endif
 	
 	// Transform to world space space.
 	vout.PosW    = mul(gWorld, float4(vin.PosL, 1.0f)).xyz;
-	vout.NormalW = mul((float3x3)gWorldInvTranspose, vin.NormalL);
+	vout.NormalW = mul((float3x3)gWorldInvTranspose, normalL);
 		
 	// Transform to homogeneous clip space.
-	vout.PosH = mul(gWorldViewProj, float4(vin.PosL, 1.0f));
+	vout.PosH = mul(gViewProj, float4(vout.PosW, 1.0f));
 	vout.texcoord = vin.TexcoordL;
 
 	return vout;
@@ -0,0 +1,30 @@
+/*************************************************************************************/
+/** defaulttext.vs by Alex Koukoulas (C) 2017 All Rights Reserved                   **/
+/** File Description:                                                               **/
+/*************************************************************************************/
+
+struct VertexIn
+{
+	float3 PosL     : POSITION;
+	float2 TexcoordL: TEXCOORD;
+	float4 Color    : COLOR;
+};
+
+struct VertexOut
+{
+	float4 PosH     : SV_POSITION;
+	float2 texcoord : TEXCOORD0;
+	float4 Color    : COLOR;
+};
+
+VertexOut VS(VertexIn vin)
+{
+	VertexOut vout;
+
+	// Glyph quads are laid out directly in normalized device coordinates
+	vout.PosH     = float4(vin.PosL, 1.0f);
+	vout.texcoord = vin.TexcoordL;
+	vout.Color    = vin.Color;
+
+	return vout;
+}
@@ -3,6 +3,11 @@
 /** File Description:                                                               **/
 /*************************************************************************************/
 
+// Permutation define, set per variant by the shader_permutation table
+#ifndef SCROLL_TEXCOORDS
+#define SCROLL_TEXCOORDS 0
+#endif
+
 cbuffer cbPerObject
 {
 	float4x4 gWorld;
@@ -17,9 +22,17 @@ struct VertexIn
 {
 	float3 PosL    : POSITION;	
 	float2 TexcoordL: TEXCOORD;
+#ifdef PACKED_VERTEX
+	float2 NormalL : NORMAL;
+#else
 	float3 NormalL : NORMAL;
+#endif
 };
 
+#ifdef PACKED_VERTEX
+#include "octdecode.hlsli"
+#endif
+
 struct VertexOut
 {
 	float4 PosH    : SV_POSITION;
@@ -31,17 +44,22 @@ struct VertexOut
 VertexOut VS(VertexIn vin)
 {
 	VertexOut vout;
+
+#ifdef PACKED_VERTEX
+	float3 normalL = OctDecode(vin.NormalL);
+#else
+	float3 normalL = vin.NormalL;
+#endif
 	
 	vout.PosW    = mul(gWorld, float4(vin.PosL, 1.0f)).xyz;
-	vout.NormalW = vin.NormalL;	
+	vout.NormalW = normalL;	
 	vout.PosH     = float4(vout.PosW, 1.0f);
 	vout.texcoord = vin.TexcoordL;
 	
-	if (gScrollTexCoordsEnabled)
-	{
-	    vout.texcoord.x += gTexCoordOffsets.x;
-		vout.texcoord.y += gTexCoordOffsets.y;
-	}
+#if SCROLL_TEXCOORDS
+	vout.texcoord.x += gTexCoordOffsets.x;
+	vout.texcoord.y += gTexCoordOffsets.y;
+#endif
 
 	return vout;
 }
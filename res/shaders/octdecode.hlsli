@@ -0,0 +1,15 @@
+/*********************************************************************/
+/** octdecode.hlsli by Alex Koukoulas (C) 2017 All Rights Reserved  **/
+/** File Description:                                               **/
+/*********************************************************************/
+
+// Inverse of the octahedral normal encoding in vertexpacking.cpp, shared by the PACKED_VERTEX vertex shader variants
+float3 OctDecode(float2 e)
+{
+	float3 n = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+	if (n.z < 0.0f)
+	{
+		n.xy = (1.0f - abs(n.yx)) * (n.xy >= 0.0f ? 1.0f : -1.0f);
+	}
+	return normalize(n);
+}
\ No newline at end of file